@@ -0,0 +1,16 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_CMDS
+    
+
+// Module headers:
+#include "ipv4-cmds-flow-table.h"
+#include "ipv4-cmds-p4-pipeline.h"
+#include "ipv4-cmds-queue-tracker.h"
+#include "ipv4-cmds-routing-helper.h"
+#include "ipv4-cmds-routing-table.h"
+#include "ipv4-cmds-routing.h"
+#endif
@@ -0,0 +1,14 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CMDSTAG_HELPER_H
+#define CMDSTAG_HELPER_H
+
+#include "ns3/ipv4-cmds-tag.h"
+
+namespace ns3 {
+
+/* ... */
+
+}
+
+#endif /* CMDSTAG_HELPER_H */
+
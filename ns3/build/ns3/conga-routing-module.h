@@ -0,0 +1,13 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_CONGA_ROUTING
+    
+
+// Module headers:
+#include "ipv4-conga-routing-helper.h"
+#include "ipv4-conga-routing.h"
+#include "ipv4-conga-tag.h"
+#endif
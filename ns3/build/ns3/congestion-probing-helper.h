@@ -0,0 +1,14 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CONGESTION_PROBING_HELPER_H
+#define CONGESTION_PROBING_HELPER_H
+
+#include "ns3/congestion-probing.h"
+
+namespace ns3 {
+
+/* ... */
+
+}
+
+#endif /* CONGESTION_PROBING_HELPER_H */
+
@@ -0,0 +1,13 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_CONGESTION_PROBING
+    
+
+// Module headers:
+#include "congestion-probing-helper.h"
+#include "congestion-probing-tag.h"
+#include "congestion-probing.h"
+#endif
@@ -0,0 +1,43 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FLOW_HASH_H
+#define FLOW_HASH_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief The hash functions a switch spreads the flows over its equal
+ * cost routes with, computed over the raw bytes of the flow key.
+ *
+ * Crc32 and Crc16 are the CRC-32 and CRC-16 (ARC) algorithms the Tofino
+ * hashes of src/switch/cmds.p4 default to, Toeplitz is the RSS hash with
+ * the Microsoft key, and MultiplyShift is a multiplicative hash of a 64
+ * bit key.  Every function takes a seed: switches sharing the function
+ * and the seed split a flow the same way, which models hash polarization,
+ * while distinct seeds de-polarize them.  A zero seed gives the standard
+ * result of the algorithm.
+ */
+class FlowHash
+{
+public:
+  /// CRC-32, the seed is XORed into the initial value
+  static uint32_t Crc32 (const uint8_t *data, uint32_t size, uint32_t seed);
+
+  /// CRC-16 (ARC), the low 16 bits of the seed are the initial value
+  static uint16_t Crc16 (const uint8_t *data, uint32_t size, uint32_t seed);
+
+  /**
+   * Toeplitz hash, the seed is XORed into the first 32 bits of the key.
+   *
+   * \param size at most 36 bytes, as long as the key allows
+   */
+  static uint32_t Toeplitz (const uint8_t *data, uint32_t size, uint32_t seed);
+
+  /// The high 32 bits of the key, XORed with the seed, times an odd constant
+  static uint32_t MultiplyShift (uint64_t key, uint32_t seed);
+};
+
+} // namespace ns3
+
+#endif /* FLOW_HASH_H */
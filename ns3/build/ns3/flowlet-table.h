@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FLOWLET_TABLE_H
+#define FLOWLET_TABLE_H
+
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ * \brief A fixed number of flowlet slots indexed by a hash of the flow id,
+ * as kept by the flowlet switching hardware of load balancers.
+ *
+ * In exact mode every flow has a flowlet of its own: a flow is looked for
+ * in the few slots following its hash, and a flow without a flowlet takes
+ * a free or expired one among them, or else the least recently seen.  In
+ * hash collision mode the flows hashed to a slot share its flowlet, like
+ * in a switch that keeps no flow id.  Flowlets expire lazily, when their
+ * slot is looked at, so the memory used is that of the slots whatever the
+ * number of flows seen.  The slots are allocated on the first lookup.
+ */
+class FlowletTable
+{
+public:
+  struct Flowlet
+  {
+    uint32_t flowId;
+    uint32_t port;        //!< output port, or path, of the flowlet
+    Time lastSeen;
+    bool used;            //!< false until the port and time are set
+  };
+
+  /// The number of slots looked at for a flow in exact mode
+  static const uint32_t PROBES = 8;
+
+  FlowletTable ();
+
+  /**
+   * Drops every flowlet.
+   * \param size the number of slots, rounded up to a power of two
+   */
+  void SetSize (uint32_t size);
+  uint32_t GetSize (void) const;
+
+  /**
+   * Drops every flowlet.
+   * \param exact whether flows hashed to the same slots are told apart
+   */
+  void SetExact (bool exact);
+  bool IsExact (void) const;
+
+  /**
+   * Returns the flowlet of the flow.  If the flow has none, the slot it is
+   * given is returned with used false, for the caller to fill.  Whether
+   * the flowlet is still active is left to the caller, timeout is only
+   * used to reuse slots in exact mode.
+   */
+  Flowlet &Lookup (uint32_t flowId, Time now, Time timeout);
+
+  /// The number of flowlets dropped before expiring, to make room for another flow
+  uint64_t GetNEvictions (void) const;
+
+private:
+  uint32_t Hash (uint32_t flowId) const;
+
+  std::vector<Flowlet> m_slots;
+  uint32_t m_size;
+  uint32_t m_bits;
+  bool m_exact;
+  uint64_t m_nEvictions;
+};
+
+}
+
+#endif /* FLOWLET_TABLE_H */
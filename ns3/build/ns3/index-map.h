@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef INDEX_MAP_H
+#define INDEX_MAP_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ * \brief An open addressing hash table from 64 bit keys to 32 bit values,
+ * such as the dense indices given to ToRs, paths or routes.
+ *
+ * Keys are placed by multiplicative (Fibonacci) hashing: the key is
+ * multiplied by 2^64 divided by the golden ratio and the high bits of the
+ * product are kept, so that consecutive keys, as flow ids, addresses and
+ * switch ids often are, are spread over the table instead of filling a
+ * run of it.  Collisions are resolved by linear probing, and the table
+ * doubles before it gets more than half full, so the probes stay short.
+ *
+ * The hash functions are public for the fixed size tables of switches,
+ * which place flows the same way but probe and evict in their own way.
+ */
+class IndexMap
+{
+public:
+  /// The value of a key that is not in the map, never a value of the map
+  static const uint32_t NONE = 0xffffffff;
+
+  /// \return the slot of the key in a table of 2^bits slots, bits at most 32
+  static uint32_t Hash (uint64_t key, uint32_t bits);
+
+  /// \return the slot of the key in a table of size slots, of any size
+  static uint32_t HashRange (uint64_t key, uint32_t size);
+
+  IndexMap ();
+
+  /// Empties the map, sized for nKeys keys without growing
+  void Reset (uint32_t nKeys);
+
+  /// \return the value of the key or NONE
+  uint32_t Find (uint64_t key) const;
+
+  /// \return the value of the key, value if the key is new
+  uint32_t Insert (uint64_t key, uint32_t value);
+
+  /// Sets the value of the key, whether it is new or not
+  void Set (uint64_t key, uint32_t value);
+
+  /// \return the number of keys in the map
+  uint32_t GetNKeys (void) const;
+
+private:
+  /// An entry of the table, value NONE when empty
+  struct Entry
+  {
+    uint64_t key;
+    uint32_t value;
+  };
+
+  /// \return the entry of the key, or the empty entry it would take
+  Entry &Probe (uint64_t key);
+  void Grow (void);
+
+  std::vector<Entry> m_entries;
+  uint32_t m_bits;
+  uint32_t m_used;
+};
+
+}
+
+#endif /* INDEX_MAP_H */
@@ -0,0 +1,103 @@
+#ifndef NS3_IPV4_CMDS_P4_PIPELINE
+#define NS3_IPV4_CMDS_P4_PIPELINE
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Behavioral model of the ingress pipeline of src/switch/cmds.p4.
+ *
+ * Reproduces, register for register, what the Tofino program does with
+ * one packet:
+ *
+ *  - id = CRC32, index = CRC16 and hopindex = CRC8 (low 4 bits) over
+ *    {ipv4.src, ipv4.dst, ipv4.protocol, first 32 bits of L4};
+ *  - the frequency sketch id1_fre_reg1/2 (+k on a match, -1 otherwise,
+ *    takeover at zero), which sets the MSB of the timestamp for the flow
+ *    owning the slot;
+ *  - the flowlet predicate id2_ts_reg1/2 with thresh;
+ *  - the id3_nexthop_reg scheduling between the ECMP hop, the least
+ *    loaded hop and the remembered hop.
+ *
+ * Register actions follow P4-16 statement order: each condition sees the
+ * updates of the statements before it.  The two register arrays of each
+ * stage run the same action at the same index, so each pair is kept as
+ * one array holding the state both would hold.  Arithmetic is on 32-bit
+ * unsigned values and wraps like bit<32>.
+ */
+class Ipv4CmdSP4Pipeline {
+public:
+  // Number of entries of findecmphop_t, addressed by the 4-bit hopindex
+  static const uint32_t ECMP_TABLE_SIZE = 16;
+
+  struct FlowKey
+  {
+    uint32_t src;
+    uint32_t dst;
+    uint8_t proto;
+    uint32_t lookup;   // first 32 bits after the IPv4 header (ports for TCP/UDP)
+  };
+
+  Ipv4CmdSP4Pipeline ();
+
+  void SetRegisterSize (uint32_t size);
+  uint32_t GetRegisterSize (void) const;
+  void SetK (uint32_t k);
+  void SetThresh (uint32_t thresh);
+
+  /**
+   * \brief Run one packet through the pipeline
+   * \param key the hashed header fields
+   * \param ts the 32 low bits of the ingress MAC timestamp in nanoseconds
+   * \param ecmpTable the ECMP_TABLE_SIZE ports of findecmphop_t
+   * \param leastHop the port findleast currently returns
+   * \return the egress port (0 if the remembered hop was never written)
+   */
+  uint32_t Process (const FlowKey &key, uint32_t ts, const uint32_t *ecmpTable, uint32_t leastHop);
+
+  void Reset (void);
+
+  static uint32_t Crc32 (const uint8_t *data, uint32_t size);
+  static uint16_t Crc16 (const uint8_t *data, uint32_t size);
+  static uint8_t Crc8 (const uint8_t *data, uint32_t size);
+
+  // Serializes the key in header order, as the Tofino hash engine sees it
+  static void Serialize (const FlowKey &key, uint8_t buf[13]);
+
+  uint64_t GetPackets (void) const;
+  uint64_t GetSketchTakeovers (void) const;
+  uint64_t GetFlowletCollisions (void) const;
+  uint64_t GetNewFlowlets (void) const;
+
+private:
+  struct Id1Fre
+  {
+    uint32_t id1;
+    uint32_t fre;
+  };
+
+  struct Id2Ts
+  {
+    uint32_t id2;
+    uint32_t ts;
+  };
+
+  uint32_t m_size;
+  uint32_t m_k;
+  uint32_t m_thresh;
+
+  std::vector<Id1Fre> m_id1Fre;       // id1_fre_reg1 and id1_fre_reg2
+  std::vector<Id2Ts> m_id2Ts;         // id2_ts_reg1 and id2_ts_reg2
+  std::vector<uint32_t> m_nexthop;    // id3_nexthop_reg
+
+  uint64_t m_packets;
+  uint64_t m_takeovers;               // sketch slots taken over by another id
+  uint64_t m_flowletCollisions;       // packets whose flowlet slot belongs to another id
+  uint64_t m_newFlowlets;             // packets past thresh that were rescheduled
+};
+
+}
+
+#endif
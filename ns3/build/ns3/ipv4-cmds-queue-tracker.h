@@ -0,0 +1,89 @@
+#ifndef NS3_IPV4_CMDS_QUEUE_TRACKER
+#define NS3_IPV4_CMDS_QUEUE_TRACKER
+
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Incremental load of a set of queues, fed by their trace sources.
+ *
+ * Each queue added is followed through its Enqueue, Dequeue and Drop
+ * traces, so reading its depth, the EWMA of its depth or its DRE never
+ * walks the queues.  The EWMA is updated on every enqueue and dequeue
+ * with the given gain.  The DRE counts the bytes dequeued and is
+ * multiplied by (1 - alpha) every TDre, as the DRE of CONGA, but the
+ * decay is applied lazily when the register is touched, so no event is
+ * scheduled.  Totals over all queues are kept alongside and are O(1) too.
+ */
+class Ipv4CmdSQueueTracker {
+public:
+  Ipv4CmdSQueueTracker ();
+  ~Ipv4CmdSQueueTracker ();
+
+  void SetEwmaGain (double gain);
+  void SetAlpha (double alpha);
+  void SetTDre (Time tdre);
+
+  // Starts following queue, returns its index
+  uint32_t AddQueue (Ptr<Queue> queue);
+  uint32_t GetNQueues (void) const;
+
+  uint32_t GetPackets (uint32_t index) const;
+  uint32_t GetBytes (uint32_t index) const;
+  double GetAveragePackets (uint32_t index) const;
+  double GetDreBytes (uint32_t index) const;
+  uint64_t GetDrops (uint32_t index) const;
+
+  uint32_t GetTotalPackets (void) const;
+  double GetTotalAveragePackets (void) const;
+  double GetTotalDreBytes (void) const;
+
+  // Stops following all queues
+  void Clear (void);
+
+private:
+  struct Dre
+  {
+    double bytes;
+    int64_t epoch;      // number of TDre periods already applied
+  };
+
+  struct QueueState
+  {
+    Ptr<Queue> queue;
+    uint32_t packets;
+    uint32_t bytes;
+    double avgPackets;
+    Dre dre;
+    uint64_t drops;
+  };
+
+  static void Enqueued (Ipv4CmdSQueueTracker *tracker, uint32_t index, Ptr<const Packet> packet);
+  static void Dequeued (Ipv4CmdSQueueTracker *tracker, uint32_t index, Ptr<const Packet> packet);
+  static void Dropped (Ipv4CmdSQueueTracker *tracker, uint32_t index, Ptr<const Packet> packet);
+
+  void UpdateAverage (QueueState &state);
+  int64_t GetEpoch (void) const;
+  double Decayed (const Dre &dre, int64_t epoch) const;
+  void Decay (Dre &dre, int64_t epoch) const;
+
+  std::vector<QueueState> m_queues;
+
+  double m_gain;
+  double m_alpha;
+  Time m_tdre;
+
+  uint32_t m_totalPackets;
+  double m_totalAvgPackets;
+  Dre m_totalDre;
+};
+
+}
+
+#endif
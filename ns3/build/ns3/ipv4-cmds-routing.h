@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV4_CMDS_ROUTING_H
+#define IPV4_CMDS_ROUTING_H
+
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/shared-tick.h"
+
+#include "ns3/queue.h"
+#include "ns3/ptr.h"
+
+#include "ns3/ipv4-cmds-routing-table.h"
+#include "ns3/ipv4-cmds-tag.h"
+#include "ns3/ipv4-cmds-queue-tracker.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+class Ipv4CmdSRouting : public Ipv4RoutingProtocol
+{
+public:
+  // How neighbors learn the queue sizes of this switch
+  enum QueueSyncMode
+  {
+    SYNC_BROADCAST = 0,   // load of all queues in a UDP broadcast every sync period
+    SYNC_INBAND           // egress queue depth piggybacked on forwarded packets
+  };
+
+  // What the broadcast sync reports, summed over the queues added with AddQueue
+  enum SyncMetric
+  {
+    METRIC_PACKETS = 0,   // queued packets
+    METRIC_AVG_PACKETS,   // EWMA of queued packets
+    METRIC_DRE_BYTES      // DRE of dequeued bytes
+  };
+
+  Ipv4CmdSRouting ();
+  ~Ipv4CmdSRouting ();
+
+  static TypeId GetTypeId (void);
+
+  void AddRoute (Ipv4Address network, Ipv4Mask networkMask, std::vector<uint32_t> interfaces);
+  void AddQueue (Ptr<Queue> queue);
+
+  void SetCompiledFib (bool compiled);
+  bool GetCompiledFib (void) const;
+
+  void SetFlowTableSize (uint32_t size);
+  uint32_t GetFlowTableSize (void) const;
+  void SetFlowTableAgingTime (Time agingTime);
+  Time GetFlowTableAgingTime (void) const;
+  void SetFlowTableMaxProbes (uint32_t probes);
+  uint32_t GetFlowTableMaxProbes (void) const;
+  void SetFlowTableEviction (Ipv4CmdSFlowTable::EvictionPolicy policy);
+  Ipv4CmdSFlowTable::EvictionPolicy GetFlowTableEviction (void) const;
+
+  // Occupancy and collision/eviction counters of the bounded flow table
+  const Ipv4CmdSFlowTable &GetFlowTable (void) const;
+
+  void SetP4RegisterSize (uint32_t size);
+  void SetP4K (uint32_t k);
+  void SetP4Thresh (uint32_t thresh);
+
+  // Register state and collision counters of the cmds.p4 model
+  const Ipv4CmdSP4Pipeline &GetP4Pipeline (void) const;
+
+  void SetQueueSyncMode (QueueSyncMode mode);
+  void SetTelemetrySampleRatio (uint32_t ratio);
+
+  // Queue size this switch currently holds for a neighbor, UINT32_MAX if unknown
+  uint32_t GetNeighborQueueSize (Ipv4Address neighbor) const;
+
+  // Overhead counters of the queue sync
+  uint64_t GetSyncMessages (void) const;
+  uint64_t GetTelemetryStamps (void) const;
+  uint64_t GetTelemetryUpdates (void) const;
+
+  void HandleMessage (Ptr<const Packet> p, const Ipv4Header &header);
+  void SendMessage (uint32_t npkt);
+
+  void Start ();
+
+  void SetSyncPeriod (Time period);
+  void SetSyncMetric (SyncMetric metric);
+  void SetQueueEwmaGain (double gain);
+  void SetAlpha (double alpha);
+  void SetTDre (Time time);
+
+  const Ipv4CmdSQueueTracker &GetQueueTracker (void) const;
+
+  // Load of the local queues as the next sync would report it
+  uint32_t GetLocalLoad (void) const;
+
+  bool SyncQueueSize ();
+
+  /* Inherit From Ipv4RoutingProtocol */
+  virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+  virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                           UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                           LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+  virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+
+  virtual void DoDispose (void);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+
+  static Ipv4CmdSP4Pipeline::FlowKey GetP4FlowKey (Ptr<const Packet> packet, const Ipv4Header &header);
+
+  // In-band telemetry: read on the ingress interface, written when an egress queue releases a packet
+  void HandleTelemetry (uint32_t iif, uint16_t queueLength);
+  void ConnectTelemetry (void);
+  static void StampTelemetry (Ipv4CmdSRouting *routing, Ptr<Queue> queue, Ptr<const Packet> packet);
+
+  Ipv4CmdSRoutingTable m_rtable;
+
+  bool m_p4DataPlane;
+  Ipv4CmdSP4Pipeline m_p4Pipeline;
+  
+  Time m_syncPeriod;
+  // Shared with the other switches syncing with the same period
+  SharedTick m_syncTick;
+
+  SyncMetric m_syncMetric;
+  Ipv4CmdSQueueTracker m_queueTracker;
+
+  QueueSyncMode m_queueSync;
+  uint32_t m_telemetrySampleRatio;
+  std::vector<uint32_t> m_telemetryCounters;  // telemetry packets seen per interface since the last update
+
+  uint64_t m_syncMessages;
+  uint64_t m_telemetryStamps;
+  uint64_t m_telemetryUpdates;
+
+  Ptr<Socket> m_socket;
+
+  Ptr<Ipv4> m_ipv4;
+
+  Ptr<Ipv4RouteCache> m_routeCache;
+};
+
+}
+
+#endif /* CmdS_ROUTING_H */
+
@@ -0,0 +1,250 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV4_CONGA_ROUTING_H
+#define IPV4_CONGA_ROUTING_H
+
+#include <cstring>
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route-cache.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/address.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/callback.h"
+#include "ns3/packet.h"
+#include "ns3/traced-callback.h"
+#include "ns3/ptr.h"
+#include "ns3/mac48-address.h"
+#include "ns3/queue.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/flowlet-table.h"
+
+
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+struct FeedbackInfo {
+  uint32_t ce;
+  bool change;
+  Time updateTime;
+  bool valid;
+};
+
+struct CongaToLeafEntry {
+  uint32_t ce;
+  Time updateTime;
+  bool valid;
+};
+
+struct CongaRouteEntry {
+  Ipv4Address network;
+  Ipv4Mask networkMask;
+  uint32_t port;
+};
+
+class Ipv4CongaRouting : public Ipv4RoutingProtocol
+{
+public:
+  Ipv4CongaRouting ();
+  ~Ipv4CongaRouting ();
+
+  static TypeId GetTypeId (void);
+
+  void SetLeafId (uint32_t leafId);
+
+  void SetAlpha (double alpha);
+
+  void SetTDre (Time time);
+
+  void SetLinkCapacity (DataRate dataRate);
+
+  void SetLinkCapacity (uint32_t interface, DataRate dataRate);
+
+  void SetQ (uint32_t q);
+
+  void SetFlowletTimeout (Time timeout);
+
+  void SetFlowletTableSize (uint32_t size);
+
+  void AddAddressToLeafIdMap (Ipv4Address addr, uint32_t leafId);
+
+  void AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port);
+
+  void InitCongestion (uint32_t destLeafId, uint32_t port, uint32_t congestion);
+
+  void EnableEcmpMode ();
+
+   /**
+   * Attach a queue to the PointToPointNetDevice.
+   *
+   * The PointToPointNetDevice "owns" a queue that implements a queueing 
+   * method such as DropTailQueue or RedQueue
+   *
+   * \param queue Ptr to the new queue.
+   */
+
+  void SetQueue (Ptr<Queue> queue);
+
+  /**
+   * Get a copy of the attached Queue.
+   *
+   * \returns Ptr to the queue.
+   */
+  Ptr<Queue> GetQueue (void) const;
+
+  /* Inherit From Ipv4RoutingProtocol */
+  virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+  virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                           UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                           LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+  virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+
+  virtual void DoDispose (void);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+
+  // ------ Parameters ------
+
+  // Used to determine whether this switch is leaf switch
+  bool m_isLeaf;
+  uint32_t m_leafId;
+
+  // DRE algorithm related parameters
+  Time m_tdre;
+  double m_alpha;
+
+  // Link capacity used to quantizing X
+
+  DataRate m_C;
+
+  // Per interface capacity, a zero rate means m_C
+  std::vector<DataRate> m_Cs;
+
+  // Quantizing bits
+  uint32_t m_Q;
+
+  Time m_agingTime;
+
+  // Flowlet Timeout
+  Time m_flowletTimeout;
+
+  // Dev use
+  bool m_ecmpMode;
+
+  // ------ Variables ------
+  // Used to maintain the round robin
+  unsigned long m_feedbackIndex;
+
+  // The DRE and aging events are not scheduled, the ones due are run
+  // when the next packet arrives, so an idle switch costs nothing
+  bool m_dreRunning;
+  Time m_dreNextTick;
+
+  bool m_agingRunning;
+  Time m_agingNextTick;
+
+  // Ipv4 associated with this router
+  Ptr<Ipv4> m_ipv4;
+  Ptr<Ipv4RouteCache> m_routeCache;
+
+  Ptr<UniformRandomVariable> m_rand;
+
+  // Route table
+  std::vector<CongaRouteEntry> m_routeEntryList;
+
+  // Candidate ports of each destination seen, as spans of m_candidatePorts
+  struct CandidatePortSpan
+  {
+    uint32_t begin;
+    uint32_t size;
+  };
+  std::map<Ipv4Address, CandidatePortSpan> m_candidatePortSpans;
+  std::vector<uint32_t> m_candidatePorts;
+
+  // Best ports of a new flowlet, kept across packets to reuse its storage
+  std::vector<uint32_t> m_portCandidates;
+
+  // Ip and leaf switch map,
+  // used to determine the which leaf switch the packet would go through
+  std::map<Ipv4Address, uint32_t> m_ipLeafIdMap;
+
+  // Congestion To Leaf Table, indexed by [leaf id][port]
+  std::vector<std::vector<CongaToLeafEntry> > m_congaToLeafTable;
+
+  // Congestion From Leaf Table, indexed by [leaf id][port]
+  std::vector<std::vector<FeedbackInfo> > m_congaFromLeafTable;
+
+  // Number of valid entries in each row of the Congestion From Leaf Table
+  std::vector<uint32_t> m_congaFromLeafSize;
+
+  // Flowlet Table
+  FlowletTable m_flowletTable;
+
+  // Parameters
+  // DRE, indexed by port
+  std::vector<uint32_t> m_XMap;
+
+  // ------ Functions ------
+  // DRE algorithm
+  uint32_t UpdateLocalDre (const Ipv4Header &header, Ptr<Packet> packet, uint32_t path);
+
+  void RunDueEvents (Time now);
+
+  // Both return whether the event keeps running
+  bool DreEvent();
+
+  bool AgingEvent (Time now);
+
+  // Entries of the congestion tables, the rows grow on demand
+  CongaToLeafEntry &GetCongaToLeafEntry (uint32_t leafId, uint32_t port);
+  FeedbackInfo &GetCongaFromLeafEntry (uint32_t leafId, uint32_t port);
+
+  // Quantizing X to metrics degree
+  // X is bytes here and we quantizing it to 0 - 2^Q
+  uint32_t QuantizingX (uint32_t interface, uint32_t X);
+
+  // Ports of the route entries matching dest, computed on the first lookup
+  const uint32_t *LookupCandidatePorts (Ipv4Address dest, uint32_t &size);
+
+  Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
+
+  // Debug use
+  void PrintCongaToLeafTable ();
+  void PrintCongaFromLeafTable ();
+  void PrintFlowletTable ();
+  void PrintDreTable ();
+
+  /**
+   * The Queue which this PointToPointNetDevice uses as a packet source.
+   * Management of this Queue has been delegated to the PointToPointNetDevice
+   * and it has the responsibility for deletion.
+   * \see class DropTailQueue
+   */
+
+  Ptr<Queue> m_queue;
+
+};
+
+}
+
+#endif /* CONGA_ROUTING_H */
+
@@ -0,0 +1,86 @@
+#ifndef IPV4_ROUTE_CACHE_H
+#define IPV4_ROUTE_CACHE_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-route.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Per-node cache of pre-built point-to-point forwarding routes.
+ *
+ * Data center load balancers (CmdS, CONGA, DRILL, LetFlow, XPath) forward
+ * every packet to the peer at the other end of the chosen interface.  The
+ * cache resolves that peer once per interface and hands out one shared
+ * Ipv4Route per (output interface, destination), instead of walking the
+ * channel and allocating a new route for every packet at every hop.
+ *
+ * The cache is aggregated to the node, so all routing protocols of a node
+ * share it.  Routes must be treated as read-only by their users.
+ */
+class Ipv4RouteCache : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  Ipv4RouteCache ();
+  ~Ipv4RouteCache ();
+
+  /**
+   * \brief Get the route cache of the node owning ipv4, creating and
+   * aggregating it the first time it is asked for.
+   */
+  static Ptr<Ipv4RouteCache> GetRouteCache (Ptr<Ipv4> ipv4);
+
+  void SetIpv4 (Ptr<Ipv4> ipv4);
+
+  /**
+   * \brief Get the route forwarding to dest through the peer of interface
+   */
+  Ptr<Ipv4Route> GetRoute (uint32_t interface, Ipv4Address dest);
+
+  /**
+   * \brief Get the address of the peer at the other end of interface
+   */
+  Ipv4Address GetGateway (uint32_t interface);
+
+  /**
+   * \brief Drop everything cached for interface, e.g. when it goes down or
+   * changes address
+   */
+  void Invalidate (uint32_t interface);
+
+  void InvalidateAll (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  struct InterfaceState
+  {
+    bool m_valid;
+    Ptr<NetDevice> m_device;
+    Ipv4Address m_gateway;
+    Ipv4Address m_source;
+    std::map<Ipv4Address, Ptr<Ipv4Route> > m_routes;
+  };
+
+  InterfaceState &GetInterfaceState (uint32_t interface);
+
+  Ptr<Ipv4> m_ipv4;
+
+  std::vector<InterfaceState> m_interfaces;
+};
+
+}
+
+#endif
@@ -0,0 +1,344 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV4_TLB_H
+#define IPV4_TLB_H
+
+#include "ns3/object.h"
+#include "ns3/callback.h"
+#include "ns3/traced-value.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/shared-tick.h"
+#include "ns3/random-variable-stream.h"
+#include "tlb-flow-info.h"
+#include "tlb-path-info.h"
+#include "tlb-path-scoreboard.h"
+#include "tlb-tor-registry.h"
+#include "tlb-path-catalog.h"
+#include "tlb-rack-state.h"
+
+#include <vector>
+#include <map>
+#include <utility>
+#include <string>
+
+#define TLB_RUNMODE_COUNTER 0
+#define TLB_RUNMODE_MINRTT 1
+#define TLB_RUNMODE_RANDOM 2
+#define TLB_RUNMODE_RTT_COUNTER 11
+#define TLB_RUNMODE_RTT_DRE 12
+
+namespace ns3 {
+
+struct PathInfo {
+    uint32_t pathId;
+    PathType pathType;
+    Time rttMin;
+    uint32_t size;
+    double ecnPortion;
+    uint32_t counter;
+    uint32_t quantifiedDre;
+};
+
+// An ACK or a probe reply on its way to the path state
+struct TLBPathFeedback {
+    uint32_t destTor;
+    uint32_t path;
+    uint32_t size;
+    bool withECN;
+    Time rtt;
+    bool isProbing;
+};
+
+struct TLBAcklet {
+    uint32_t pathId;
+    Time activeTime;
+};
+
+class Node;
+
+class Ipv4TLB : public Object
+{
+
+public:
+
+    Ipv4TLB ();
+
+    Ipv4TLB (const Ipv4TLB&);
+
+    static TypeId GetTypeId (void);
+
+    // For the hosts without a path catalog only: the hosts using one share
+    // the registry of their ToR, adding an address or a path to them is a fatal error
+    void AddAddressWithTor (Ipv4Address address, uint32_t torId);
+
+    void AddAvailPath (uint32_t destTor, uint32_t path);
+
+    // Takes the addresses and the paths from the ToR registry of the catalog, shared with the other hosts
+    void UsePathCatalog (Ptr<TLBPathCatalog> catalog, uint32_t sourceTor);
+
+    // Shares the path state of another host under the same ToR, both using the same path catalog
+    void ShareRackState (Ptr<Ipv4TLB> tlb);
+
+    bool IsRackStateSharedWith (Ptr<Ipv4TLB> tlb) const;
+
+    std::vector<uint32_t> GetAvailPath (Ipv4Address daddr);
+
+    // The output ports of a path of the catalog in use, for Ipv4XPathTag::SetRoute,
+    // 0 without a catalog, the path id being then the base-100 route of Ipv4XPathTag::SetPathId
+    const uint32_t *GetRoute (uint32_t path, uint32_t &nPorts) const;
+
+    // These methods are used for TCP flows
+    uint32_t GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr);
+
+    uint32_t GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr);
+
+    Time GetPauseTime (uint32_t flowId);
+
+    void FlowRecv (uint32_t flowId, uint32_t path, Ipv4Address daddr, uint32_t size, bool withECN, Time rtt);
+
+    void FlowSend (uint32_t flowId, Ipv4Address daddr, uint32_t path, uint32_t size, bool isRetrasmission);
+
+    void FlowTimeout (uint32_t flowId, Ipv4Address daddr, uint32_t path);
+
+    void FlowFinish (uint32_t flowId, Ipv4Address daddr);
+
+    // These methods are used in probing
+    void ProbeSend (Ipv4Address daddr, uint32_t path);
+
+    void ProbeRecv (uint32_t path, Ipv4Address daddr, uint32_t size, bool withECN, Time rtt);
+
+    void ProbeTimeout (uint32_t path, Ipv4Address daddr);
+
+    // When the path last carried a data ACK, false if it never did
+    bool GetLastAckTime (Ipv4Address daddr, uint32_t path, Time &ackTime);
+
+    // The same for the path of a slot of the registry
+    bool GetLastAckTime (uint32_t slot, Time &ackTime) const;
+
+    // The ToR indices and the path slots of the available paths
+    const TLBTorRegistry &GetRegistry (void) const;
+
+    // Node
+    void SetNode (Ptr<Node> node);
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.  Return the number of streams (possibly zero) that
+     * have been assigned.
+     */
+    int64_t AssignStreams (int64_t stream);
+
+    static std::string GetPathType (PathType type);
+
+    static std::string GetLogo (void);
+
+private:
+
+    void PacketReceive (uint32_t flowId, uint32_t path, uint32_t destTorId,
+                        uint32_t size, bool withECN, Time rtt, bool isProbing);
+
+    bool UpdateFlowInfo (uint32_t flowId, uint32_t path, uint32_t size, bool withECN, Time rtt);
+
+    TLBPathInfo GetInitPathInfo (uint32_t path);
+
+    // Gives the paths of the registry a scoreboard entry in a new path state, the path infos are created lazily
+    void ResetPathState (void);
+
+    // A data ACK also stamps the ack time of its path, with the rest of the path state
+    void UpdatePathInfo (TLBPathFeedback feedback);
+
+    bool TimeoutFlow (uint32_t flowId, uint32_t path, bool &isVeryTimeout);
+
+    void TimeoutPath (uint32_t destTor, uint32_t path, bool isProbing, bool isVeryTimeout);
+
+    bool SendFlow (uint32_t flowId, uint32_t path, uint32_t size);
+
+    void SendPath (uint32_t destTor, uint32_t path, uint32_t size);
+
+    bool RetransFlow (uint32_t flowId, uint32_t path, uint32_t size, bool &needRetranPath, bool &needHighRetransPath);
+
+    void RetransPath (uint32_t destTor, uint32_t path, bool needHighRetransPath);
+
+    void UpdateFlowPath (uint32_t flowId, uint32_t path, uint32_t destTor);
+
+    void AssignFlowToPath (uint32_t flowId, uint32_t destTor, uint32_t path);
+
+    void RemoveFlowFromPath (uint32_t flowId, uint32_t destTor, uint32_t path);
+
+    bool WhereToChange (uint32_t destTor, struct PathInfo &newPath, bool hasOldPath, uint32_t oldPath);
+
+    struct PathInfo SelectRandomPath (uint32_t destTor);
+
+    struct PathInfo JudgePath (uint32_t destTor, uint32_t path);
+
+    PathType ClassifyPath (const TLBPathInfo &pathInfo);
+
+    // The rank of a good or grey path in the current run mode, lower is better
+    uint64_t RankPath (uint32_t counter, Time rtt);
+
+    // Called whenever the info of a path changes, to keep its scoreboard in sync
+    void ScorePath (uint32_t slot);
+
+    // Returns the slot of the path if it has an info, NONE otherwise
+    uint32_t FindPathInfo (uint32_t destTor, uint32_t path);
+
+    // Returns the slot of the path, giving it an initial info if it has none,
+    // or NONE if the path is not available
+    uint32_t InsertPathInfo (uint32_t destTor, uint32_t path);
+
+    bool SelectBestPath (uint32_t destTor, const TLBPathScoreboard &scoreboard,
+                         PathType type, Time maxRtt, struct PathInfo &newPath);
+
+    // Sets the index of the ToR of the address, the ToRs are indexed by m_registry
+    bool FindTorId (Ipv4Address daddr, uint32_t &destTor);
+
+    bool PathAging (void);
+
+    // Ages the path infos of the rack state, once per tick whatever the number of hosts sharing it
+    void AgePaths (void);
+
+    void DreAging (TLBPathInfo &pathInfo);
+
+    int64_t GetDreEpoch (void) const;
+
+    std::vector<PathInfo> GatherParallelPaths (uint32_t destTor);
+
+    // The parallel paths of the select and change traces are only gathered when they have sinks
+    // fromTorId is a ToR id, toTor a ToR index
+    void TracePathSelect (uint32_t flowId, uint32_t fromTorId, uint32_t toTor, const struct PathInfo &newPath, bool isRandom);
+    void TracePathChange (uint32_t flowId, uint32_t fromTorId, uint32_t toTor, uint32_t newPath, uint32_t oldPath, bool isRandom);
+
+    uint32_t QuantifyRtt (Time rtt);
+    uint32_t QuantifyDre (uint32_t dre);
+
+    // Parameters
+    uint32_t m_runMode; // Running Mode 0 for minimize counter, 1 for minimize RTT, 2 for random
+
+    bool m_rerouteEnable;
+
+    uint32_t m_S;
+
+    Time m_T;
+
+    uint32_t m_K;
+
+    Time m_T1;
+
+    Time m_T2;
+
+    Time m_agingCheckTime;
+
+    Time m_dreTime;
+
+    double m_dreAlpha;
+
+    DataRate m_dreDataRate;
+
+    uint32_t m_dreQ;
+
+    uint32_t m_dreMultiply;
+
+    Time m_minRtt;
+
+    Time m_highRtt;
+
+    uint32_t m_ecnSampleMin;
+
+    double m_ecnPortionLow;
+
+    double m_ecnPortionHigh;
+
+    // Failure Related Configurations
+    bool m_respondToFailure;
+    uint32_t m_flowRetransHigh;
+    uint32_t m_flowRetransVeryHigh;
+
+    uint32_t m_flowTimeoutCount;
+    // End of Failure Related Configurations
+
+    double m_betterPathEcnThresh;
+
+    Time m_betterPathRttThresh;
+
+    uint32_t m_pathChangePoss;
+
+    Time m_flowDieTime;
+
+    bool m_isSmooth;
+    uint32_t m_smoothAlpha;
+    uint32_t m_smoothDesired;
+    uint32_t m_smoothBeta1;
+    uint32_t m_smoothBeta2;
+
+    Time m_quantifyRttBase;
+
+    Time m_ackletTimeout;
+
+    // Added at Jan 11st
+    /*
+    double m_epDefaultEcnPortion;
+    double m_epAlpha;
+    Time m_epCheckTime;
+    Time m_epAgingTime;
+    */
+    // --
+
+    // Added at Jan 12nd
+    Time m_flowletTimeout;
+    // --
+
+    double m_rttAlpha;
+    double m_ecnBeta;
+
+    // The delay of the feedback to the path state, modelling a rack agent
+    Time m_rackStateDelay;
+
+    // Variables
+    std::map<uint32_t, TLBFlowInfo> m_flowInfo; /* <FlowId, TLBFlowInfo> */
+    // The ToR indices and the path slots of the available paths
+    Ptr<TLBTorRegistry> m_registry;
+
+    // The catalog the registry comes from, if any, resolving the paths to their routes
+    Ptr<TLBPathCatalog> m_catalog;
+
+    // The path infos and the scoreboards, possibly shared by the hosts under the ToR
+    Ptr<TLBRackState> m_rack;
+
+    std::map<uint32_t, TLBAcklet> m_acklets; /* <FlowId, TLBAcklet> */
+
+    std::map<uint32_t, Ipv4Address> m_probingAgent; /* <DestTorId, ProbingAgentAddress>*/
+
+    // Shared with the other hosts aging their paths with the same period
+    SharedTick m_agingTick;
+
+    Ptr<Node> m_node;
+
+    // Draws the random path choices, instead of the global rand ()
+    Ptr<UniformRandomVariable> m_rand;
+
+    std::map<uint32_t, Time> m_pauseTime; // Used in the TCP pause, not mandatory
+
+    typedef void (* TLBPathCallback) (uint32_t flowId, uint32_t fromTor,
+            uint32_t toTor, uint32_t path, bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths);
+
+    typedef void (* TLBPathChangeCallback) (uint32_t flowId, uint32_t fromTor, uint32_t toTor,
+            uint32_t newPath, uint32_t oldPath, bool isRandom, std::vector<PathInfo> parallelPaths);
+
+    TracedCallback <uint32_t, uint32_t, uint32_t, uint32_t, bool, PathInfo, std::vector<PathInfo> > m_pathSelectTrace;
+
+    TracedCallback <uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, bool, std::vector<PathInfo> > m_pathChangeTrace;
+
+    typedef void (* TLBPathDecisionCallback) (uint32_t flowId, uint32_t fromTor, uint32_t toTor,
+            uint32_t newPath, uint32_t oldPath, bool isNewFlow, bool isRandom);
+
+    // Both selections and changes, without the path infos, cheap enough to be always connected
+    TracedCallback <uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, bool, bool> m_pathDecisionTrace;
+
+
+};
+
+}
+
+#endif /* TLB_H */
+
@@ -0,0 +1,12 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_LETFLOW_ROUTING
+    
+
+// Module headers:
+#include "ipv4-letflow-routing-helper.h"
+#include "ipv4-letflow-routing.h"
+#endif
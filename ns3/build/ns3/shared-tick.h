@@ -0,0 +1,64 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef SHARED_TICK_H
+#define SHARED_TICK_H
+
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+class SharedTickRegistry;
+
+/**
+ * \ingroup network
+ * \brief A periodic timer whose simulator event is shared with every
+ * other SharedTick of the same period.
+ *
+ * Ticks fire on the multiples of the period, so all the SharedTick
+ * objects running with one period, on however many nodes, are serviced
+ * by a single event per period.  The function returns whether it wants
+ * to keep ticking: a tick that returns false, or is cancelled, leaves
+ * its period, and a period with no tick left schedules nothing until a
+ * tick is started again.  A function that cancels and starts its own
+ * tick keeps the new registration, whatever it returns.
+ */
+class SharedTick
+{
+public:
+  SharedTick ();
+  ~SharedTick ();
+
+  /**
+   * \param function called on every tick, returns false to stop
+   */
+  void SetFunction (Callback<bool> function);
+
+  /**
+   * \param period the interval between two ticks, only read by Start
+   */
+  void SetPeriod (Time period);
+  Time GetPeriod (void) const;
+
+  /**
+   * Ticks on the next multiple of the period and every period after.
+   * Does nothing if the tick is already running.
+   */
+  void Start (void);
+  void Cancel (void);
+  bool IsRunning (void) const;
+
+private:
+  friend class SharedTickRegistry;
+
+  SharedTick (const SharedTick &);
+  SharedTick &operator = (const SharedTick &);
+
+  Callback<bool> m_function;
+  Time m_period;
+  int64_t m_runningPeriod;     //!< timesteps of the period it was started with
+  bool m_running;
+};
+
+}
+
+#endif /* SHARED_TICK_H */
@@ -0,0 +1,140 @@
+#ifndef TCP_RESEQUENCE_BUFFER_H
+#define TCP_RESEQUENCE_BUFFER_H
+
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/sequence-number.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/callback.h"
+#include "ns3/traced-value.h"
+
+#include <vector>
+#include <map>
+
+namespace ns3
+{
+
+enum TcpRBPopReason
+{
+  IN_ORDER_FULL = 0,
+  IN_ORDER_TIMEOUT,
+  OUT_ORDER_TIMEOUT,
+  RE_TRANS
+};
+
+class TcpSocketBase;
+
+class TcpResequenceBufferElement
+{
+
+public:
+  SequenceNumber32 m_seq;
+
+  bool m_isSyn;
+
+  bool m_isFin;
+
+  uint32_t m_dataSize; // In bytes
+
+  Ptr<Packet> m_packet;
+
+  Address m_fromAddress;
+
+  Address m_toAddress;
+
+  friend inline bool operator < (const TcpResequenceBufferElement &l, const TcpResequenceBufferElement &r)
+  {
+    return l.m_seq < r.m_seq;
+  }
+};
+
+class TcpResequenceBuffer : public Object
+{
+
+public:
+
+  static TypeId GetTypeId (void);
+
+  TcpResequenceBuffer ();
+  //TcpResequenceBuffer (const TcpResequenceBuffer &);
+  ~TcpResequenceBuffer ();
+
+  virtual void DoDispose (void);
+
+  void BufferPacket (Ptr<Packet> packet, const Address& fromAddress, const Address& toAddress);
+
+  void SetTcp (TcpSocketBase *tcp);
+
+  void Stop (void);
+
+  TracedCallback <uint32_t, Time, SequenceNumber32, SequenceNumber32> m_tcpRBBuffer;
+  TracedCallback <uint32_t, Time, SequenceNumber32, uint32_t, uint32_t, TcpRBPopReason> m_tcpRBFlush;
+
+private:
+
+  bool PutInTheInOrderQueue (const TcpResequenceBufferElement &element);
+  SequenceNumber32 CalculateNextSeq (const TcpResequenceBufferElement &element);
+
+  // Keeps the timeout event at the earliest deadline of the non empty queues
+  void UpdateTimeout (void);
+  void Timeout (void);
+
+  void FlushOneElement (const TcpResequenceBufferElement &element, TcpRBPopReason reason);
+  void FlushInOrderQueue (TcpRBPopReason reason);
+  void FlushOutOrderQueue (TcpRBPopReason reason);
+
+  // The out order queue, returns false for a duplicate packet
+  bool InsertOutOrder (const TcpResequenceBufferElement &element);
+  bool TakeOutOrder (SequenceNumber32 seq, TcpResequenceBufferElement &element);
+  void InitOutOrderWindow (void);
+  uint32_t GetOutOrderSlot (SequenceNumber32 seq) const;
+  // Whether the seq is in the slots ahead of the next seq, without wrapping around
+  bool IsInOutOrderWindow (SequenceNumber32 seq) const;
+
+  // Parameters
+  uint32_t m_sizeLimit;
+
+  Time m_inOrderQueueTimerLimit;
+  Time m_outOrderQueueTimerLimit;
+  Time m_periodicalCheckTime; // Unused, the timeouts are scheduled at their deadlines
+
+  uint32_t m_traceFlowId;
+
+  // Variables
+  uint32_t m_size;
+  // The timers start when the buffer gets a packet while idle, and restart
+  // when their queue is flushed
+  Time m_inOrderQueueTimer;
+  Time m_outOrderQueueTimer;
+
+  EventId m_timeoutEvent;
+  Time m_timeoutDeadline;
+  bool m_hasStopped;
+
+  SequenceNumber32 m_firstSeq;
+  SequenceNumber32 m_nextSeq;
+
+  std::vector<TcpResequenceBufferElement> m_inOrderQueue;
+
+  // The out order queue is a circular window of slots indexed by seq / segment size,
+  // with a bitmap of the slots holding a packet.  A packet out of the window ahead of
+  // the next seq, or whose slot is taken by another seq, goes to the overflow map instead
+  std::vector<TcpResequenceBufferElement> m_outOrderWindow;
+  std::vector<bool> m_outOrderPresent;
+  uint32_t m_outOrderSegSize;
+  uint32_t m_outOrderSlotMask;
+  std::map<SequenceNumber32, TcpResequenceBufferElement> m_outOrderOverflow;
+  uint32_t m_outOrderSize; // In packets
+
+  TcpSocketBase *m_tcp;
+
+  typedef void (* TcpRBBuffer) (uint32_t flowId, Time time, SequenceNumber32 recSeq,
+          SequenceNumber32 nextSeq);
+  typedef void (* TcpRBFlush) (uint32_t flowId, Time time, SequenceNumber32 popSeq,
+          uint32_t inOrderLength, uint32_t outOrderLength, TcpRBPopReason reason);
+};
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TLB_PATH_SCOREBOARD_H
+#define TLB_PATH_SCOREBOARD_H
+
+#include "ns3/nstime.h"
+#include "tlb-path-info.h"
+
+#include <vector>
+#include <set>
+#include <utility>
+
+namespace ns3 {
+
+/**
+ * \brief The parallel paths towards one destination ToR, bucketed by type.
+ *
+ * Every path carries its type, a rank (lower is better) and its RTT,
+ * kept up to date by Ipv4TLB whenever the path info changes.  Inside a
+ * bucket the paths are ordered by rank, then by the order they were
+ * added in, so the best paths of a type are found without judging all
+ * the paths again.  Only good and grey paths are ranked, bad and fail
+ * paths are kept in path order.
+ */
+class TLBPathScoreboard
+{
+public:
+
+    TLBPathScoreboard ();
+
+    // Returns the order of the path, its position among the paths
+    uint32_t AddPath (uint32_t path, PathType type, uint64_t rank, Time rtt);
+
+    void Update (uint32_t order, PathType type, uint64_t rank, Time rtt);
+
+    // The paths in the order they were added
+    const std::vector<uint32_t> &GetPaths (void) const;
+
+    uint32_t GetNPaths (void) const;
+
+    uint32_t GetNPaths (PathType type) const;
+
+    /**
+     * Counts the paths of the type with an RTT no more than maxRtt that
+     * share the lowest rank among them.
+     *
+     * \param rank set to that lowest rank if any path is found
+     */
+    uint32_t CountBest (PathType type, Time maxRtt, uint64_t &rank) const;
+
+    // The index-th, in path order, of the paths counted by CountBest
+    bool GetBest (PathType type, Time maxRtt, uint32_t index, uint32_t &path) const;
+
+    // The index-th path, in path order, which is not a FailPath
+    uint32_t GetUsable (uint32_t index) const;
+
+private:
+
+    struct Entry
+    {
+        PathType type;
+        uint64_t rank;
+        Time rtt;
+    };
+
+    typedef std::set<std::pair<uint64_t, uint32_t> > Bucket; /* <Rank, Order> */
+
+    std::vector<uint32_t> m_paths;
+
+    std::vector<Entry> m_entries;
+
+    Bucket m_buckets[FailPath + 1];
+};
+
+}
+
+#endif /* TLB_PATH_SCOREBOARD_H */
@@ -0,0 +1,14 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV4_TLB_PROBING_HELPER_H
+#define IPV4_TLB_PROBING_HELPER_H
+
+#include "ns3/ipv4-tlb-probing.h"
+
+namespace ns3 {
+
+/* ... */
+
+}
+
+#endif /* TLB_PROBING_HELPER_H */
+
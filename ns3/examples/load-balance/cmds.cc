@@ -137,12 +137,18 @@ int main (int argc, char *argv[])
 
     CommandLine cmd;
     cmd.AddValue ("cdfFileName", "File name for flow distribution", cdfFileName);
-    cmd.AddValue ("randomSeed", "Random seed, 0 for random generated", randomSeed);
+    cmd.AddValue ("randomSeed", "Random seed, 0 for random generated, also the ns-3 seed of the load balancers", randomSeed);
     cmd.AddValue ("load", "Load of the network, 0.0 - 1.0", load);
     cmd.Parse (argc, argv);
 
     randomSeed = 2222;
 
+    if (randomSeed != 0)
+    {
+        // The runs of a seed are still told apart by --RngRun
+        RngSeedManager::SetSeed (randomSeed);
+    }
+
     if (load < 0.0 || load > 1.0)
     {
         NS_LOG_ERROR ("The network load should within 0.0 and 1.0");
@@ -392,6 +398,9 @@ int main (int argc, char *argv[])
 		        AddRoute (Ipv4Address ((iter1->first).first), Ipv4Mask ((iter1->first).second), iter1->second);
     }
 
+    NS_LOG_INFO ("Assigning the random streams of the load balancers");
+    cmdsRoutingHelper.AssignStreams (NodeContainer (NodeContainer (leaf0, leaf1), NodeContainer (spine0, spine1)), 1000);
+
     NS_LOG_INFO ("Initialize random seed: " << randomSeed);
     if (randomSeed == 0)
     {
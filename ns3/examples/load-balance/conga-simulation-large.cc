@@ -10,7 +10,10 @@
 #include "ns3/ipv4-drb-routing-helper.h"
 #include "ns3/ipv4-xpath-routing-helper.h"
 #include "ns3/ipv4-tlb.h"
+#include "ns3/ipv4-tlb-helper.h"
+#include "ns3/ipv4-tlb-path-log.h"
 #include "ns3/ipv4-clove.h"
+#include "ns3/clove-helper.h"
 #include "ns3/ipv4-tlb-probing.h"
 #include "ns3/link-monitor-module.h"
 #include "ns3/traffic-control-module.h"
@@ -283,12 +286,15 @@ int main (int argc, char *argv[])
     uint32_t TLBRunMode = 0;
     bool TLBProbingEnable = true;
     uint32_t TLBProbingInterval = 50;
+    bool TLBProbingAdaptive = false;
+    bool TLBProbingPerLeaf = false;
     bool TLBSmooth = true;
     bool TLBRerouting = true;
     uint32_t TLBDREMultiply = 5;
     uint32_t TLBS = 64000;
     bool TLBReverseACK = false;
     uint32_t TLBFlowletTimeout = 500;
+    bool TLBBinaryPathLog = false;
 
     bool tcpPause = false;
 
@@ -302,10 +308,17 @@ int main (int argc, char *argv[])
 
     uint32_t quantifyRTTBase = 10;
 
+    bool rackShared = false;
+    uint32_t rackStateDelay = 0;
+
+    std::string ecmpHash = "String";
+    bool ecmpHashSwitchSeed = false;
+
     bool enableLargeDupAck = false;
 
     uint32_t congaFlowletTimeout = 500;
     uint32_t letFlowFlowletTimeout = 500;
+    bool letFlowCapacityWeighted = false;
 
     bool enableRandomDrop = false;
     double randomDropRate = 0.005; // 0.5%
@@ -331,7 +344,7 @@ int main (int argc, char *argv[])
     cmd.AddValue ("EndTime", "End time of the simulation", END_TIME);
     cmd.AddValue ("FlowLaunchEndTime", "End time of the flow launch period", FLOW_LAUNCH_END_TIME);
     cmd.AddValue ("runMode", "Running mode of this simulation: Conga, Conga-flow, Presto, Weighted-Presto, DRB, FlowBender, ECMP, Clove, DRILL, LetFlow", runModeStr);
-    cmd.AddValue ("randomSeed", "Random seed, 0 for random generated", randomSeed);
+    cmd.AddValue ("randomSeed", "Random seed, 0 for random generated, also the ns-3 seed of the load balancers", randomSeed);
     cmd.AddValue ("cdfFileName", "File name for flow distribution", cdfFileName);
     cmd.AddValue ("load", "Load of the network, 0.0 - 1.0", load);
     cmd.AddValue ("transportProt", "Transport protocol to use: Tcp, DcTcp", transportProt);
@@ -366,6 +379,8 @@ int main (int argc, char *argv[])
     cmd.AddValue ("TLBRunMode", "The running mode of TLB, 0 for minimize counter, 1 for minimize RTT, 2 for random, 11 for RTT counter, 12 for RTT DRE", TLBRunMode);
     cmd.AddValue ("TLBProbingEnable", "Whether the TLB probing is enable", TLBProbingEnable);
     cmd.AddValue ("TLBProbingInterval", "Probing interval for TLB probing", TLBProbingInterval);
+    cmd.AddValue ("TLBProbingAdaptive", "Whether the TLB probing skips the paths with fresh ACKs and backs off on the stable ones", TLBProbingAdaptive);
+    cmd.AddValue ("TLBProbingPerLeaf", "Whether one prober under every leaf probes all the other leaves for all its servers", TLBProbingPerLeaf);
     cmd.AddValue ("TLBSmooth", "Whether the RTT calculation is smooth", TLBSmooth);
     cmd.AddValue ("TLBRerouting", "Whether the rerouting is enabled in TLB", TLBRerouting);
     cmd.AddValue ("TLBDREMultiply", "DRE multiply factor in TLB", TLBDREMultiply);
@@ -373,6 +388,7 @@ int main (int argc, char *argv[])
     cmd.AddValue ("TLBReverseACK", "Whether to enable the TLB reverse ACK path selection", TLBReverseACK);
     cmd.AddValue ("quantifyRTTBase", "The quantify RTT base in TLB", quantifyRTTBase);
     cmd.AddValue ("TLBFlowletTimeout", "The TLB flowlet timeout", TLBFlowletTimeout);
+    cmd.AddValue ("TLBBinaryPathLog", "Whether TLB path decisions are logged in binary instead of the text bible", TLBBinaryPathLog);
 
     cmd.AddValue ("TcpPause", "Whether TCP will pause in TLB & FlowBender", tcpPause);
 
@@ -384,10 +400,17 @@ int main (int argc, char *argv[])
     cmd.AddValue ("cloveHalfRTT", "Half RTT used in Clove ECN", cloveHalfRTT);
     cmd.AddValue ("cloveDisToUncongestedPath", "Whether Clove will distribute the weight to uncongested path (no ECN) or all paths", cloveDisToUncongestedPath);
 
+    cmd.AddValue ("rackShared", "Whether the TLB or Clove hosts under a leaf share their path state", rackShared);
+    cmd.AddValue ("rackStateDelay", "The delay before the feedback reaches the TLB or Clove path state, in MicroSeconds", rackStateDelay);
+
+    cmd.AddValue ("ecmpHash", "The per flow ECMP hash of the switches: String, Crc32, Crc16, Toeplitz, MultiplyShift", ecmpHash);
+    cmd.AddValue ("ecmpHashSwitchSeed", "Whether every switch seeds its ECMP hash with its node id instead of sharing one seed", ecmpHashSwitchSeed);
+
     cmd.AddValue ("enableLargeDupAck", "Whether to set the ReTxThreshold to a very large value to mask reordering", enableLargeDupAck);
 
     cmd.AddValue ("congaFlowletTimeout", "Flowlet timeout in Conga", congaFlowletTimeout);
     cmd.AddValue ("letFlowFlowletTimeout", "Flowlet timeout in LetFlow", letFlowFlowletTimeout);
+    cmd.AddValue ("letFlowCapacityWeighted", "Whether LetFlow picks the ports of new flowlets in proportion to their capacity", letFlowCapacityWeighted);
 
     cmd.AddValue ("enableRandomDrop", "Whether the Spine-0 to other leaves has the random drop problem", enableRandomDrop);
     cmd.AddValue ("randomDropRate", "The random drop rate when the random drop is enabled", randomDropRate);
@@ -408,6 +431,12 @@ int main (int argc, char *argv[])
 
     cmd.Parse (argc, argv);
 
+    if (randomSeed != 0)
+    {
+        // The runs of a seed are still told apart by --RngRun
+        RngSeedManager::SetSeed (randomSeed);
+    }
+
     uint64_t SPINE_LEAF_CAPACITY = spineLeafCapacity * LINK_CAPACITY_BASE;
     uint64_t LEAF_SERVER_CAPACITY = leafServerCapacity * LINK_CAPACITY_BASE;
     Time LINK_LATENCY = MicroSeconds (linkLatency);
@@ -532,12 +561,14 @@ int main (int argc, char *argv[])
         Config::SetDefault ("ns3::Ipv4TLB::ECNPortionLow", DoubleValue (TLBECNPortionLow));
         Config::SetDefault ("ns3::Ipv4TLB::RunMode", UintegerValue (TLBRunMode));
         Config::SetDefault ("ns3::Ipv4TLBProbing::ProbeInterval", TimeValue (MicroSeconds (TLBProbingInterval)));
+        Config::SetDefault ("ns3::Ipv4TLBProbing::Adaptive", BooleanValue (TLBProbingAdaptive));
         Config::SetDefault ("ns3::Ipv4TLB::IsSmooth", BooleanValue (TLBSmooth));
         Config::SetDefault ("ns3::Ipv4TLB::Rerouting", BooleanValue (TLBRerouting));
         Config::SetDefault ("ns3::Ipv4TLB::DREMultiply", UintegerValue (TLBDREMultiply));
         Config::SetDefault ("ns3::Ipv4TLB::S", UintegerValue(TLBS));
         Config::SetDefault ("ns3::Ipv4TLB::QuantifyRttBase", TimeValue (MicroSeconds (quantifyRTTBase)));
         Config::SetDefault ("ns3::Ipv4TLB::FlowletTimeout", TimeValue (MicroSeconds (TLBFlowletTimeout)));
+        Config::SetDefault ("ns3::Ipv4TLB::RackStateDelay", TimeValue (MicroSeconds (rackStateDelay)));
     }
 
     if (runMode == Clove)
@@ -548,6 +579,7 @@ int main (int argc, char *argv[])
         Config::SetDefault ("ns3::Ipv4Clove::RunMode", UintegerValue (cloveRunMode));
         Config::SetDefault ("ns3::Ipv4Clove::HalfRTT", TimeValue (MicroSeconds (cloveHalfRTT)));
         Config::SetDefault ("ns3::Ipv4Clove::DisToUncongestedPath", BooleanValue (cloveDisToUncongestedPath));
+        Config::SetDefault ("ns3::Ipv4Clove::RackStateDelay", TimeValue (MicroSeconds (rackStateDelay)));
     }
 
     if (tcpPause)
@@ -607,6 +639,8 @@ int main (int argc, char *argv[])
     Ipv4DrillRoutingHelper drillRoutingHelper;
     Ipv4LetFlowRoutingHelper letFlowRoutingHelper;
 
+    Config::SetDefault ("ns3::Ipv4GlobalRouting::EcmpHash", StringValue (ecmpHash));
+
     if (runMode == CONGA || runMode == CONGA_FLOW || runMode == CONGA_ECMP)
     {
 	    internet.SetRoutingHelper (staticRoutingHelper);
@@ -678,6 +712,8 @@ int main (int argc, char *argv[])
     }
     else if (runMode == LetFlow)
     {
+        Config::SetDefault ("ns3::Ipv4LetFlowRouting::CapacityWeighted", BooleanValue (letFlowCapacityWeighted));
+
         internet.SetRoutingHelper (staticRoutingHelper);
         internet.Install (servers);
 
@@ -708,6 +744,19 @@ int main (int argc, char *argv[])
     	internet.Install (leaves);
     }
 
+    if (ecmpHashSwitchSeed)
+    {
+        NodeContainer switches (spines, leaves);
+        for (uint32_t i = 0; i < switches.GetN (); ++i)
+        {
+            Ptr<GlobalRouter> router = switches.Get (i)->GetObject<GlobalRouter> ();
+            if (router != NULL)
+            {
+                router->GetRoutingProtocol ()->SetAttribute ("EcmpHashSeed", UintegerValue (switches.Get (i)->GetId ()));
+            }
+        }
+    }
+
 
     NS_LOG_INFO ("Install channels and assign addresses");
 
@@ -745,6 +794,9 @@ int main (int argc, char *argv[])
 
     std::vector<Ptr<Ipv4TLBProbing> > probings (SERVER_COUNT * LEAF_COUNT);
 
+    // The paths between the leaves, shared by the TLB or Clove servers under each leaf
+    Ptr<TLBPathCatalog> pathCatalog = Create<TLBPathCatalog> ();
+
     for (int i = 0; i < LEAF_COUNT; i++)
     {
 	    Ipv4Address network = ipv4.NewNetwork ();
@@ -824,24 +876,9 @@ int main (int argc, char *argv[])
                 letFlowLeaf->SetFlowletTimeout (MicroSeconds (letFlowFlowletTimeout));
             }
 
-            if (runMode == TLB)
-            {
-                for (int k = 0; k < SERVER_COUNT * LEAF_COUNT; k++)
-                {
-                    Ptr<Ipv4TLB> tlb = servers.Get (k)->GetObject<Ipv4TLB> ();
-                    tlb->AddAddressWithTor (interfaceContainer.GetAddress (1), i);
-                    // NS_LOG_INFO ("Configuring TLB with " << k << "'s server, inserting server: " << j << " under leaf: " << i);
-                }
-            }
-
-            if (runMode == Clove)
+            if (runMode == TLB || runMode == Clove)
             {
-                for (int k = 0; k < SERVER_COUNT * LEAF_COUNT; k++)
-                {
-                    Ptr<Ipv4Clove> clove = servers.Get (k)->GetObject<Ipv4Clove> ();
-                    clove->AddAddressWithTor (interfaceContainer.GetAddress (1), i);
-                }
-
+                pathCatalog->AddAddress (interfaceContainer.GetAddress (1), i);
             }
         }
     }
@@ -1114,102 +1151,125 @@ int main (int argc, char *argv[])
         }
     }
 
-    if (runMode == Clove)
+    if (runMode == TLB || runMode == Clove)
     {
-        NS_LOG_INFO ("Configuring Clove available paths");
+        NS_LOG_INFO ("Building the path catalog");
+        for (int i = 0; i < LEAF_COUNT; i++)
+        {
+            pathCatalog->AddTor (i, leaves.Get (i));
+        }
+        for (int k = 0; k < SPINE_COUNT; k++)
+        {
+            pathCatalog->AddSwitch (spines.Get (k));
+        }
+        pathCatalog->Build ();
+
+        NS_LOG_INFO ("Configuring " << (runMode == TLB ? "TLB" : "Clove") << " available paths");
         for (int i = 0; i < LEAF_COUNT; i++)
         {
+            NodeContainer serversUnderLeaf;
             for (int j = 0; j < SERVER_COUNT; j++)
             {
-                int serverIndex = i * SERVER_COUNT + j;
-                for (int k = 0; k < SPINE_COUNT; k++)
-                {
-                    int path = 0;
-                    int pathBase = 1;
-                    path += leafToSpinePath[std::make_pair (i, k)] * pathBase;
-                    pathBase *= 100;
-                    for (int l = 0; l < LEAF_COUNT; l++)
-                    {
-                        if (i == l)
-                        {
-                            continue;
-                        }
-                        int newPath = spineToLeafPath[std::make_pair (k, l)] * pathBase + path;
-                        Ptr<Ipv4Clove> clove = servers.Get (serverIndex)->GetObject<Ipv4Clove> ();
-                        clove->AddAvailPath (l, newPath);
-                    }
-                }
+                serversUnderLeaf.Add (servers.Get (i * SERVER_COUNT + j));
+            }
+            Ipv4TLBHelper::UsePathCatalog (serversUnderLeaf, pathCatalog, i);
+            CloveHelper::UsePathCatalog (serversUnderLeaf, pathCatalog, i);
+            if (rackShared)
+            {
+                Ipv4TLBHelper::ShareRackState (serversUnderLeaf);
+                CloveHelper::ShareRackState (serversUnderLeaf);
             }
         }
     }
 
-    if (runMode == TLB)
+    if (runMode == TLB && TLBProbingEnable)
     {
-        NS_LOG_INFO ("Configuring TLB available paths");
-        for (int i = 0; i < LEAF_COUNT; i++)
+        if (TLBProbingPerLeaf)
         {
-            for (int j = 0; j < SERVER_COUNT; j++)
+            NS_LOG_INFO ("Configuring TLB Probing, one prober per leaf");
+            for (int i = 0; i < SERVER_COUNT * LEAF_COUNT; i++)
             {
-                int serverIndex = i * SERVER_COUNT + j;
-                for (int k = 0; k < SPINE_COUNT; k++)
+                // The first server under every leaf probes the first servers under the other leaves
+                // and answers their probes, on behalf of all the servers under its leaf
+                int leafIndex = i / SERVER_COUNT;
+                if (i % SERVER_COUNT != 0)
                 {
-                    int path = 0;
-                    int pathBase = 1;
-                    path += leafToSpinePath[std::make_pair (i, k)] * pathBase;
-                    pathBase *= 100;
-                    for (int l = 0; l < LEAF_COUNT; l++)
+                    continue;
+                }
+                Ptr<Ipv4TLBProbing> probing = CreateObject<Ipv4TLBProbing> ();
+                probings[i] = probing;
+                probing->SetNode (servers.Get (i));
+                probing->SetSourceAddress (serverAddresses[i]);
+                probing->Init ();
+                for (int k = 0; k < LEAF_COUNT; k++)
+                {
+                    if (k != leafIndex)
                     {
-                        if (i == l)
-                        {
-                            continue;
-                        }
-                        int newPath = spineToLeafPath[std::make_pair (k, l)] * pathBase + path;
-                        Ptr<Ipv4TLB> tlb = servers.Get (serverIndex)->GetObject<Ipv4TLB> ();
-                        tlb->AddAvailPath (l, newPath);
-                        //NS_LOG_INFO ("Configuring server: " << serverIndex << " to leaf: " << l << " with path: " << newPath);
+                        probing->AddProbeAddress (serverAddresses[k * SERVER_COUNT]);
                     }
                 }
+                for (int j = i + 1; j < i + SERVER_COUNT; j++)
+                {
+                    probing->AddRackHost (servers.Get (j));
+                }
+                probing->StartProbe ();
+                probing->StopProbe (Seconds (END_TIME));
             }
         }
-
-
-        if (runMode == TLB && TLBProbingEnable)
-        {
-        NS_LOG_INFO ("Configuring TLB Probing");
-        for (int i = 0; i < SERVER_COUNT * LEAF_COUNT; i++)
+        else
         {
-            // The i th server under one leaf is used to probe the leaf i by contacting the i th server under that leaf
-            Ptr<Ipv4TLBProbing> probing = CreateObject<Ipv4TLBProbing> ();
-            probings[i] = probing;
-            probing->SetNode (servers.Get (i));
-            probing->SetSourceAddress (serverAddresses[i]);
-            probing->Init ();
+            NS_LOG_INFO ("Configuring TLB Probing");
+            for (int i = 0; i < SERVER_COUNT * LEAF_COUNT; i++)
+            {
+                // The i th server under one leaf is used to probe the leaf i by contacting the i th server under that leaf
+                Ptr<Ipv4TLBProbing> probing = CreateObject<Ipv4TLBProbing> ();
+                probings[i] = probing;
+                probing->SetNode (servers.Get (i));
+                probing->SetSourceAddress (serverAddresses[i]);
+                probing->Init ();
 
-            int serverIndexUnderLeaf = i % SERVER_COUNT;
+                int serverIndexUnderLeaf = i % SERVER_COUNT;
 
-            if (serverIndexUnderLeaf < LEAF_COUNT)
-            {
-                int serverBeingProbed = SERVER_COUNT * serverIndexUnderLeaf;
-                if (serverBeingProbed == i)
-                {
-                    continue;
-                }
-                probing->SetProbeAddress (serverAddresses[serverBeingProbed]);
-                //NS_LOG_INFO ("Server: " << i << " is going to probe server: " << serverBeingProbed);
-                int leafIndex = i / SERVER_COUNT;
-                for (int j = leafIndex * SERVER_COUNT; j < leafIndex * SERVER_COUNT + SERVER_COUNT; j++)
+                if (serverIndexUnderLeaf < LEAF_COUNT)
                 {
-                    if (i == j)
+                    int serverBeingProbed = SERVER_COUNT * serverIndexUnderLeaf;
+                    if (serverBeingProbed == i)
                     {
                         continue;
                     }
-                    probing->AddBroadCastAddress (serverAddresses[j]);
-                    //NS_LOG_INFO ("Server:" << i << " is going to broadcast to server: " << j);
+                    probing->SetProbeAddress (serverAddresses[serverBeingProbed]);
+                    //NS_LOG_INFO ("Server: " << i << " is going to probe server: " << serverBeingProbed);
+                    int leafIndex = i / SERVER_COUNT;
+                    for (int j = leafIndex * SERVER_COUNT; j < leafIndex * SERVER_COUNT + SERVER_COUNT; j++)
+                    {
+                        if (i == j)
+                        {
+                            continue;
+                        }
+                        probing->AddBroadCastAddress (serverAddresses[j]);
+                        //NS_LOG_INFO ("Server:" << i << " is going to broadcast to server: " << j);
+                    }
+                    probing->StartProbe ();
+                    probing->StopProbe (Seconds (END_TIME));
                 }
-                probing->StartProbe ();
-                probing->StopProbe (Seconds (END_TIME));
             }
         }
+    }
+
+    NS_LOG_INFO ("Assigning the random streams of the load balancers");
+    NodeContainer allNodes = NodeContainer (spines, leaves, servers);
+    int64_t stream = 1000;
+    stream += congaRoutingHelper.AssignStreams (allNodes, stream);
+    stream += drbRoutingHelper.AssignStreams (allNodes, stream);
+    stream += drillRoutingHelper.AssignStreams (allNodes, stream);
+    stream += letFlowRoutingHelper.AssignStreams (allNodes, stream);
+    stream += Ipv4TLBHelper::AssignStreams (allNodes, stream);
+    stream += CloveHelper::AssignStreams (allNodes, stream);
+    for (uint32_t i = 0; i < probings.size (); i++)
+    {
+        if (probings[i])
+        {
+            stream += probings[i]->AssignStreams (stream);
         }
     }
 
@@ -1418,8 +1478,18 @@ int main (int argc, char *argv[])
     tlbBibleFilename << "b" << BUFFER_SIZE << "-bible.txt";
     tlbBibleFilename2 << "b" << BUFFER_SIZE << "-piple.txt";
     rbTraceFilename << "b" << BUFFER_SIZE << "-RBTrace.txt";
+    std::string tlbPathLogFilename = tlbBibleFilename.str ();
+    tlbPathLogFilename.replace (tlbPathLogFilename.size () - 4, 4, ".bin");
 
-    if (runMode == TLB)
+    Ipv4TLBPathLog tlbPathLog;
+
+    if (runMode == TLB && TLBBinaryPathLog)
+    {
+        NS_LOG_INFO ("Enabling TLB binary path log");
+        tlbPathLog.Open (tlbPathLogFilename);
+        tlbPathLog.ConnectAll ();
+    }
+    else if (runMode == TLB)
     {
         NS_LOG_INFO ("Enabling TLB tracing");
         remove (tlbBibleFilename.str ().c_str ());
@@ -1450,6 +1520,7 @@ int main (int argc, char *argv[])
     linkMonitor->OutputToFile (linkMonitorFilename.str (), &LinkMonitor::DefaultFormat);
 
     Simulator::Destroy ();
+    tlbPathLog.Close ();
     free_cdf (cdfTable);
     NS_LOG_INFO ("Stop simulation");
 }
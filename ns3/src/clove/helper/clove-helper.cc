@@ -2,10 +2,58 @@
 
 #include "clove-helper.h"
 
+#include "ns3/node.h"
+
 namespace ns3 {
 
-/* ... */
+int64_t
+CloveHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+    int64_t currentStream = stream;
+    for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+        Ptr<Ipv4Clove> clove = (*i)->GetObject<Ipv4Clove> ();
+        if (clove)
+        {
+            currentStream += clove->AssignStreams (currentStream);
+        }
+    }
+    return (currentStream - stream);
+}
 
+void
+CloveHelper::UsePathCatalog (NodeContainer c, Ptr<TLBPathCatalog> catalog, uint32_t sourceTor)
+{
+    for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+        Ptr<Ipv4Clove> clove = (*i)->GetObject<Ipv4Clove> ();
+        if (clove)
+        {
+            clove->UsePathCatalog (catalog, sourceTor);
+        }
+    }
+}
 
+void
+CloveHelper::ShareRackState (NodeContainer c)
+{
+    Ptr<Ipv4Clove> first;
+    for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+        Ptr<Ipv4Clove> clove = (*i)->GetObject<Ipv4Clove> ();
+        if (!clove)
+        {
+            continue;
+        }
+        if (first)
+        {
+            clove->ShareRackState (first);
+        }
+        else
+        {
+            first = clove;
+        }
+    }
 }
 
+}
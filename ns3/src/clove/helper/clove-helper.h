@@ -3,12 +3,34 @@
 #define CLOVE_HELPER_H
 
 #include "ns3/ipv4-clove.h"
+#include "ns3/node-container.h"
 
 namespace ns3 {
 
-/* ... */
+class CloveHelper
+{
+public:
+    /**
+     * Assign a fixed random variable stream number to the Ipv4Clove
+     * aggregated to each node of the container, nodes without one are
+     * skipped.  Return the number of streams that have been assigned.
+     */
+    static int64_t AssignStreams (NodeContainer c, int64_t stream);
+
+    /**
+     * Make the Ipv4Clove aggregated to each node of the container, all of
+     * them under the source ToR, share the paths of the built catalog.
+     */
+    static void UsePathCatalog (NodeContainer c, Ptr<TLBPathCatalog> catalog, uint32_t sourceTor);
+
+    /**
+     * Make the Ipv4Clove aggregated to each node of the container, all of
+     * them under one ToR and using the same path catalog, share the path weights
+     * of the first one.
+     */
+    static void ShareRackState (NodeContainer c);
+};
 
 }
 
 #endif /* CLOVE_HELPER_H */
-
@@ -15,19 +15,29 @@ NS_OBJECT_ENSURE_REGISTERED (Ipv4Clove);
 Ipv4Clove::Ipv4Clove () :
     m_flowletTimeout (MicroSeconds (200)),
     m_runMode (CLOVE_RUNMODE_EDGE_FLOWLET),
+    m_registry (Create<TLBTorRegistry> ()),
+    m_rackStateDelay (Time (0)),
     m_halfRTT (MicroSeconds (40)),
-    m_disToUncongestedPath (false)
+    m_disToUncongestedPath (false),
+    m_rack (Create<CloveRackState> ())
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4Clove::Ipv4Clove (const Ipv4Clove &other) :
     m_flowletTimeout (other.m_flowletTimeout),
     m_runMode (other.m_runMode),
+    m_registry (Create<TLBTorRegistry> ()),
+    m_rackStateDelay (other.m_rackStateDelay),
     m_halfRTT (other.m_halfRTT),
-    m_disToUncongestedPath (other.m_disToUncongestedPath)
+    m_disToUncongestedPath (other.m_disToUncongestedPath),
+    m_rack (Create<CloveRackState> ())
 {
     NS_LOG_FUNCTION (this);
+    m_flowletTable.SetSize (other.m_flowletTable.GetSize ());
+    m_flowletTable.SetExact (other.m_flowletTable.IsExact ());
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 TypeId
@@ -53,6 +63,22 @@ Ipv4Clove::GetTypeId (void)
                        BooleanValue (false),
                        MakeBooleanAccessor (&Ipv4Clove::m_disToUncongestedPath),
                        MakeBooleanChecker ())
+        .AddAttribute ("FlowletTableSize", "The number of slots of the flowlet table",
+                       UintegerValue (4096),
+                       MakeUintegerAccessor (&Ipv4Clove::SetFlowletTableSize,
+                                             &Ipv4Clove::GetFlowletTableSize),
+                       MakeUintegerChecker<uint32_t> (1))
+        .AddAttribute ("ExactFlowlets", "Whether flows hashed to the same flowlet slots are told apart, "
+                       "otherwise they share the flowlet like in a switch, unless its path does not go to their ToR",
+                       BooleanValue (true),
+                       MakeBooleanAccessor (&Ipv4Clove::SetExactFlowlets,
+                                            &Ipv4Clove::GetExactFlowlets),
+                       MakeBooleanChecker ())
+        .AddAttribute ("RackStateDelay", "The delay before the ECN feedback reaches the path weights, "
+                       "like the reports to a rack agent when the hosts under a ToR share their path weights",
+                       TimeValue (Time (0)),
+                       MakeTimeAccessor (&Ipv4Clove::m_rackStateDelay),
+                       MakeTimeChecker (Time (0)))
     ;
 
     return tid;
@@ -61,23 +87,67 @@ Ipv4Clove::GetTypeId (void)
 void
 Ipv4Clove::AddAddressWithTor (Ipv4Address address, uint32_t torId)
 {
-    m_ipTorMap[address] = torId;
+    if (m_catalog != 0)
+    {
+        NS_FATAL_ERROR ("Cannot add address " << address << " to a host using a path catalog, "
+                        "add it to the catalog before building it");
+    }
+    m_registry->AddAddress (address, torId);
 }
 
 void
 Ipv4Clove::AddAvailPath (uint32_t destTor, uint32_t path)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    if (m_catalog != 0)
     {
-        std::vector<uint32_t> paths;
-        m_availablePath[destTor] = paths;
-        itr = m_availablePath.find (destTor);
+        NS_FATAL_ERROR ("Cannot add path " << path << " to a host using a path catalog, "
+                        "the paths of a catalog are the ones it finds when it is built");
     }
-    (itr->second).push_back (path);
+    if (m_registry->FindPath (m_registry->GetTorIndex (destTor), path) != TLBTorRegistry::NONE)
+    {
+        NS_LOG_ERROR ("Path " << path << " to tor " << destTor << " is already available");
+        return;
+    }
+    m_registry->AddPath (m_registry->AddTor (destTor), path);
 
-    std::pair<uint32_t, uint32_t> key = std::make_pair (destTor, path);
-    m_pathWeight[key] = 1;
+    ClovePathState pathState;
+    pathState.weight = 1;
+    pathState.isECNSeen = false;
+    m_rack->pathStates.push_back (pathState);
+}
+
+void
+Ipv4Clove::UsePathCatalog (Ptr<TLBPathCatalog> catalog, uint32_t sourceTor)
+{
+    m_registry = catalog->GetRegistry (sourceTor);
+    m_catalog = catalog;
+
+    ClovePathState pathState;
+    pathState.weight = 1;
+    pathState.isECNSeen = false;
+    m_rack = Create<CloveRackState> ();
+    m_rack->pathStates.assign (m_registry->GetNSlots (), pathState);
+}
+
+void
+Ipv4Clove::ShareRackState (Ptr<Ipv4Clove> clove)
+{
+    if (m_registry != clove->m_registry)
+    {
+        NS_FATAL_ERROR ("Only the hosts under a ToR using the same path catalog can share their path weights");
+    }
+    m_rack = clove->m_rack;
+}
+
+const uint32_t *
+Ipv4Clove::GetRoute (uint32_t path, uint32_t &nPorts) const
+{
+    if (m_catalog == 0)
+    {
+        nPorts = 0;
+        return 0;
+    }
+    return m_catalog->GetRoute (path, nPorts);
 }
 
 uint32_t
@@ -96,72 +166,96 @@ Ipv4Clove::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
         NS_LOG_ERROR ("Cannot find source tor id based on the given source address");
     }
 
-    struct CloveFlowlet flowlet;
-    std::map<uint32_t, CloveFlowlet>::iterator flowletItr = m_flowletMap.find (flowId);
-    if (flowletItr != m_flowletMap.end ())
-    {
-        flowlet = flowletItr->second;
-    }
-    else
-    {
-        flowlet.path = Ipv4Clove::CalPath (destTor);
-    }
-
-    if (Simulator::Now () - flowlet.lastSeen >= m_flowletTimeout)
+    Time now = Simulator::Now ();
+    // Without ExactFlowlets the slot may hold the path of a flow to another
+    // ToR, which is not a path to this one
+    FlowletTable::Flowlet &flowlet = m_flowletTable.Lookup (flowId, now, m_flowletTimeout);
+    if (!flowlet.used || now - flowlet.lastSeen >= m_flowletTimeout
+        || m_registry->FindPath (destTor, flowlet.port) == TLBTorRegistry::NONE)
     {
-        flowlet.path = Ipv4Clove::CalPath (destTor);
+        flowlet.used = true;
+        flowlet.port = Ipv4Clove::CalPath (destTor);
     }
 
-    flowlet.lastSeen = Simulator::Now ();
-    m_flowletMap[flowId] = flowlet;
+    flowlet.lastSeen = now;
 
-    return flowlet.path;
+    return flowlet.port;
 }
 
 
 bool
-Ipv4Clove::FindTorId (Ipv4Address daddr, uint32_t &destTorId)
+Ipv4Clove::FindTorId (Ipv4Address daddr, uint32_t &torIndex)
 {
-    std::map<Ipv4Address, uint32_t>::iterator torItr = m_ipTorMap.find (daddr);
-
-    if (torItr == m_ipTorMap.end ())
+    uint32_t index = m_registry->FindTor (daddr);
+    if (index == TLBTorRegistry::NONE)
     {
         return false;
     }
-    destTorId = torItr->second;
+    torIndex = index;
     return true;
 }
 
+int64_t
+Ipv4Clove::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
+void
+Ipv4Clove::SetFlowletTableSize (uint32_t size)
+{
+    m_flowletTable.SetSize (size);
+}
+
+uint32_t
+Ipv4Clove::GetFlowletTableSize (void) const
+{
+    return m_flowletTable.GetSize ();
+}
+
+void
+Ipv4Clove::SetExactFlowlets (bool exact)
+{
+    m_flowletTable.SetExact (exact);
+}
+
+bool
+Ipv4Clove::GetExactFlowlets (void) const
+{
+    return m_flowletTable.IsExact ();
+}
+
+uint64_t
+Ipv4Clove::GetNFlowletEvictions (void) const
+{
+    return m_flowletTable.GetNEvictions ();
+}
+
 uint32_t
 Ipv4Clove::CalPath (uint32_t destTor)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    const std::vector<uint32_t> &slots = m_registry->GetSlots (destTor);
+    if (slots.empty ())
     {
         return 0;
     }
-    std::vector<uint32_t> paths = itr->second;
     if (m_runMode == CLOVE_RUNMODE_EDGE_FLOWLET)
     {
-        return paths[rand() % paths.size ()];
+        return m_registry->GetPath (slots[m_rand->GetInteger (0, slots.size () - 1)]);
     }
     else if (m_runMode == CLOVE_RUNMODE_ECN)
     {
-        double r = ((double) rand () / RAND_MAX);
-        std::vector<uint32_t>::iterator itr = paths.begin ();
+        double r = m_rand->GetValue (0.0, 1.0);
+        std::vector<uint32_t>::const_iterator itr = slots.begin ();
         double weightSum = 0.0;
-        for ( ; itr != paths.end (); ++itr)
+        for ( ; itr != slots.end (); ++itr)
         {
-            uint32_t path = *itr;
-            std::pair<uint32_t, uint32_t> key = std::make_pair (destTor, path);
-            std::map<std::pair<uint32_t, uint32_t>, double>::iterator pathWeightItr = m_pathWeight.find (key);
-            if (pathWeightItr != m_pathWeight.end ())
-            {
-                weightSum += pathWeightItr->second;
-            }
-            if (r <= (weightSum / (double) paths.size ()))
+            weightSum += m_rack->pathStates[*itr].weight;
+            if (r <= (weightSum / (double) slots.size ()))
             {
-                return path;
+                return m_registry->GetPath (*itr);
             }
         }
         return 0;
@@ -181,6 +275,19 @@ Ipv4Clove::FlowRecv (uint32_t path, Ipv4Address daddr, bool withECN)
         return;
     }
 
+    if (m_rackStateDelay.IsZero ())
+    {
+        Ipv4Clove::EcnRecv (path, daddr);
+    }
+    else
+    {
+        Simulator::Schedule (m_rackStateDelay, &Ipv4Clove::EcnRecv, this, path, daddr);
+    }
+}
+
+void
+Ipv4Clove::EcnRecv (uint32_t path, Ipv4Address daddr)
+{
     uint32_t destTor = 0;
     if (!Ipv4Clove::FindTorId (daddr, destTor))
     {
@@ -188,44 +295,38 @@ Ipv4Clove::FlowRecv (uint32_t path, Ipv4Address daddr, bool withECN)
         return;
     }
 
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    uint32_t slot = m_registry->FindPath (destTor, path);
+    if (slot == TLBTorRegistry::NONE)
     {
+        NS_LOG_LOGIC ("Path " << path << " is not available");
         return;
     }
 
-    std::vector<uint32_t> paths = itr->second;
-    std::pair<uint32_t, uint32_t> key = std::make_pair (destTor, path);
-
-    std::map<std::pair<uint32_t, uint32_t>, Time>::iterator ecnItr = m_pathECNSeen.find (key);
+    const std::vector<uint32_t> &slots = m_registry->GetSlots (destTor);
+    ClovePathState &pathState = m_rack->pathStates[slot];
 
-    if (ecnItr == m_pathECNSeen.end ()
-            || Simulator::Now () - ecnItr->second >= m_halfRTT)
+    if (!pathState.isECNSeen
+            || Simulator::Now () - pathState.ecnSeen >= m_halfRTT)
     {
         // Update the weight
-        m_pathECNSeen[key] = Simulator::Now ();
+        pathState.isECNSeen = true;
+        pathState.ecnSeen = Simulator::Now ();
 
-        double originalPathWeight = 1.0;
-        std::map<std::pair<uint32_t, uint32_t>, double>::iterator weightItr = m_pathWeight.find (key);
-        if (weightItr != m_pathWeight.end ())
-        {
-            originalPathWeight = weightItr->second;
-        }
+        double originalPathWeight = pathState.weight;
 
-        m_pathWeight[key] = 0.67 * originalPathWeight;
+        pathState.weight = 0.67 * originalPathWeight;
 
-        std::vector<uint32_t>::iterator pathItr = paths.begin ();
+        std::vector<uint32_t>::const_iterator slotItr = slots.begin ();
 
         uint32_t uncongestedPathCount = 0;
 
-        for ( ; pathItr != paths.end (); ++pathItr)
+        for ( ; slotItr != slots.end (); ++slotItr)
         {
-            if (*pathItr != path)
+            if (*slotItr != slot)
             {
-                std::pair<uint32_t, uint32_t> uKey = std::make_pair (destTor, *pathItr);
-                std::map<std::pair<uint32_t, uint32_t>, Time>::iterator uEcnItr = m_pathECNSeen.find (uKey);
+                const ClovePathState &uPathState = m_rack->pathStates[*slotItr];
                 if (!m_disToUncongestedPath ||
-                        (m_disToUncongestedPath && Simulator::Now () - uEcnItr->second < m_halfRTT))
+                        (uPathState.isECNSeen && Simulator::Now () - uPathState.ecnSeen < m_halfRTT))
                 {
                     uncongestedPathCount ++;
                 }
@@ -234,27 +335,20 @@ Ipv4Clove::FlowRecv (uint32_t path, Ipv4Address daddr, bool withECN)
 
         if (uncongestedPathCount == 0)
         {
-            m_pathWeight[key] = originalPathWeight;
+            pathState.weight = originalPathWeight;
             return;
         }
 
-        pathItr = paths.begin ();
-        for ( ; pathItr != paths.end (); ++pathItr)
+        slotItr = slots.begin ();
+        for ( ; slotItr != slots.end (); ++slotItr)
         {
-            if (*pathItr != path)
+            if (*slotItr != slot)
             {
-                std::pair<uint32_t, uint32_t> uKey = std::make_pair (destTor, *pathItr);
-                std::map<std::pair<uint32_t, uint32_t>, Time>::iterator uEcnItr = m_pathECNSeen.find (uKey);
+                ClovePathState &uPathState = m_rack->pathStates[*slotItr];
                 if (!m_disToUncongestedPath ||
-                        (m_disToUncongestedPath && Simulator::Now () - uEcnItr->second < m_halfRTT))
+                        (uPathState.isECNSeen && Simulator::Now () - uPathState.ecnSeen < m_halfRTT))
                 {
-                    double uPathWeight = 1.0;
-                    std::map<std::pair<uint32_t, uint32_t>, double>::iterator uPathWeightItr = m_pathWeight.find (uKey);
-                    if (uPathWeightItr != m_pathWeight.end ())
-                    {
-                        uPathWeight = uPathWeightItr->second;
-                    }
-                    m_pathWeight[uKey] = uPathWeight + (0.33 * originalPathWeight) / uncongestedPathCount;
+                    uPathState.weight += (0.33 * originalPathWeight) / uncongestedPathCount;
                 }
             }
         }
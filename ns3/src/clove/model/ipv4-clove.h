@@ -5,10 +5,13 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/tlb-tor-registry.h"
+#include "ns3/tlb-path-catalog.h"
+#include "ns3/flowlet-table.h"
 
 #include <vector>
-#include <map>
-#include <utility>
 
 #define CLOVE_RUNMODE_EDGE_FLOWLET 0
 #define CLOVE_RUNMODE_ECN 1
@@ -16,9 +19,16 @@
 
 namespace ns3 {
 
-struct CloveFlowlet {
-    Time lastSeen;
-    uint32_t path;
+struct ClovePathState {
+    double weight;
+    bool isECNSeen;
+    Time ecnSeen;
+};
+
+// The path states of Ipv4Clove, possibly shared by the hosts under a ToR
+class CloveRackState : public SimpleRefCount<CloveRackState> {
+public:
+    std::vector<ClovePathState> pathStates; /* <Slot, ClovePathState> */
 };
 
 class Ipv4Clove : public Object {
@@ -29,30 +39,65 @@ public:
 
     static TypeId GetTypeId (void);
 
+    // For the hosts without a path catalog only: the hosts using one share
+    // the registry of their ToR, adding an address or a path to them is a fatal error
     void AddAddressWithTor (Ipv4Address address, uint32_t torId);
     void AddAvailPath (uint32_t destTor, uint32_t path);
 
+    // Takes the addresses and the paths from the ToR registry of the catalog, shared with the other hosts
+    void UsePathCatalog (Ptr<TLBPathCatalog> catalog, uint32_t sourceTor);
+
+    // Shares the path weights of another host under the same ToR, both using the same path catalog
+    void ShareRackState (Ptr<Ipv4Clove> clove);
+
     uint32_t GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr);
 
+    // The output ports of a path of the catalog in use, for Ipv4XPathTag::SetRoute,
+    // 0 without a catalog, the path id being then the base-100 route of Ipv4XPathTag::SetPathId
+    const uint32_t *GetRoute (uint32_t path, uint32_t &nPorts) const;
+
     void FlowRecv (uint32_t path, Ipv4Address daddr, bool withECN);
 
-    bool FindTorId (Ipv4Address daddr, uint32_t &torId);
+    // Sets the index of the ToR in the registry
+    bool FindTorId (Ipv4Address daddr, uint32_t &torIndex);
+
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.  Return the number of streams (possibly zero) that
+     * have been assigned.
+     */
+    int64_t AssignStreams (int64_t stream);
+
+    void SetFlowletTableSize (uint32_t size);
+    uint32_t GetFlowletTableSize (void) const;
+
+    void SetExactFlowlets (bool exact);
+    bool GetExactFlowlets (void) const;
+
+    // The number of flowlets dropped before expiring, to make room for another flow
+    uint64_t GetNFlowletEvictions (void) const;
 
 private:
     uint32_t CalPath (uint32_t destTor);
 
+    // Lowers the weight of the path which has seen ECN
+    void EcnRecv (uint32_t path, Ipv4Address daddr);
+
     Time m_flowletTimeout;
     uint32_t m_runMode;
 
-    std::map<uint32_t, std::vector<uint32_t> > m_availablePath;
-    std::map<Ipv4Address, uint32_t> m_ipTorMap;
-    std::map<uint32_t, CloveFlowlet> m_flowletMap;
+    Ptr<TLBTorRegistry> m_registry;
+    // The catalog the registry comes from, if any, resolving the paths to their routes
+    Ptr<TLBPathCatalog> m_catalog;
+    // The delay of the ECN feedback to the path weights, modelling a rack agent
+    Time m_rackStateDelay;
+    Ptr<UniformRandomVariable> m_rand;
+    FlowletTable m_flowletTable;
 
     // Clove ECN
     Time m_halfRTT;
     bool m_disToUncongestedPath;
-    std::map<std::pair<uint32_t, uint32_t>, double> m_pathWeight;
-    std::map<std::pair<uint32_t, uint32_t>, Time> m_pathECNSeen;
+    Ptr<CloveRackState> m_rack;
 };
 
 }
@@ -2,48 +2,222 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-clove.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <set>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
 
-// This is an example TestCase.
-class CloveTestCase1 : public TestCase
+namespace {
+
+const Ipv4Address g_source ("10.1.0.1");
+const Ipv4Address g_dest ("10.2.0.1");
+
+// A Clove host under ToR 1 with the paths 1 to nPaths to ToR 2, and a
+// flowlet timeout of 50us
+Ptr<Ipv4Clove>
+CreateClove (uint32_t nPaths, int64_t stream)
+{
+  Ptr<Ipv4Clove> clove = CreateObject<Ipv4Clove> ();
+  clove->SetAttribute ("FlowletTimeout", TimeValue (MicroSeconds (50)));
+  clove->AddAddressWithTor (g_source, 1);
+  clove->AddAddressWithTor (g_dest, 2);
+  for (uint32_t path = 1; path <= nPaths; ++path)
+    {
+      clove->AddAvailPath (2, path);
+    }
+  clove->AssignStreams (stream);
+  return clove;
+}
+
+}
+
+class CloveFlowletTimeoutTestCase : public TestCase
 {
 public:
-  CloveTestCase1 ();
-  virtual ~CloveTestCase1 ();
+  CloveFlowletTimeoutTestCase ();
 
 private:
   virtual void DoRun (void);
 };
 
-// Add some help text to this case to describe what it is intended to test
-CloveTestCase1::CloveTestCase1 ()
-  : TestCase ("Clove test case (does nothing)")
+CloveFlowletTimeoutTestCase::CloveFlowletTimeoutTestCase ()
+  : TestCase ("A flowlet keeps its path within the timeout and picks a path again after it")
 {
 }
 
-// This destructor does nothing but we include it as a reminder that
-// the test case should clean up after itself
-CloveTestCase1::~CloveTestCase1 ()
+void
+CloveFlowletTimeoutTestCase::DoRun (void)
+{
+  Ptr<Ipv4Clove> clove = CreateClove (4, 1);
+
+  const uint32_t flows = 64;
+  std::vector<uint32_t> first (flows);
+  for (uint32_t flowId = 0; flowId < flows; ++flowId)
+    {
+      first[flowId] = clove->GetPath (flowId, g_source, g_dest);
+      NS_TEST_ASSERT_MSG_EQ ((first[flowId] >= 1 && first[flowId] <= 4), true, "Flow " << flowId << " is not given a path to the ToR");
+    }
+
+  // Gaps below the timeout, adding up to more than it: each packet renews the flowlet
+  for (uint32_t round = 0; round < 5; ++round)
+    {
+      Simulator::Stop (MicroSeconds (40));
+      Simulator::Run ();
+      for (uint32_t flowId = 0; flowId < flows; ++flowId)
+        {
+          NS_TEST_ASSERT_MSG_EQ (clove->GetPath (flowId, g_source, g_dest), first[flowId], "Flow " << flowId << " left its path within the timeout");
+        }
+    }
+
+  // A gap above the timeout starts a new flowlet, on a path drawn again
+  Simulator::Stop (MicroSeconds (60));
+  Simulator::Run ();
+  uint32_t moved = 0;
+  for (uint32_t flowId = 0; flowId < flows; ++flowId)
+    {
+      uint32_t path = clove->GetPath (flowId, g_source, g_dest);
+      NS_TEST_ASSERT_MSG_EQ ((path >= 1 && path <= 4), true, "Flow " << flowId << " is not given a path to the ToR");
+      if (path != first[flowId])
+        {
+          moved++;
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (moved, flows / 2, "Too few new flowlets changed path, they should be drawn again");
+  NS_TEST_ASSERT_MSG_EQ (clove->GetNFlowletEvictions (), 0, "The default table should evict no flowlet");
+
+  Simulator::Destroy ();
+}
+
+class CloveHashCollisionTestCase : public TestCase
+{
+public:
+  CloveHashCollisionTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CloveHashCollisionTestCase::CloveHashCollisionTestCase ()
+  : TestCase ("Without ExactFlowlets the flows hashed to a slot share its path")
+{
+}
+
+void
+CloveHashCollisionTestCase::DoRun (void)
+{
+  const uint32_t flows = 64;
+
+  // One slot: every flow lands on the flowlet of the first one
+  Ptr<Ipv4Clove> clove = CreateClove (8, 2);
+  clove->SetAttribute ("FlowletTableSize", UintegerValue (1));
+  clove->SetAttribute ("ExactFlowlets", BooleanValue (false));
+  uint32_t shared = clove->GetPath (0, g_source, g_dest);
+  for (uint32_t flowId = 1; flowId < flows; ++flowId)
+    {
+      NS_TEST_ASSERT_MSG_EQ (clove->GetPath (flowId, g_source, g_dest), shared, "Flow " << flowId << " does not share the path of its slot");
+    }
+  NS_TEST_ASSERT_MSG_EQ (clove->GetNFlowletEvictions (), 0, "Shared flowlets are not evicted");
+
+  // The same slot with ExactFlowlets: each flow evicts the flowlet of the last one
+  clove = CreateClove (8, 2);
+  clove->SetAttribute ("FlowletTableSize", UintegerValue (1));
+  std::set<uint32_t> used;
+  for (uint32_t flowId = 0; flowId < flows; ++flowId)
+    {
+      used.insert (clove->GetPath (flowId, g_source, g_dest));
+    }
+  NS_TEST_ASSERT_MSG_GT (used.size (), 1, "Flows told apart should draw paths of their own");
+  NS_TEST_ASSERT_MSG_EQ (clove->GetNFlowletEvictions (), flows - 1, "Each flow should evict the flowlet in the slot");
+
+  // Four slots: at most four paths in use, and each flow keeps the path of its slot
+  clove = CreateClove (8, 3);
+  clove->SetAttribute ("FlowletTableSize", UintegerValue (4));
+  clove->SetAttribute ("ExactFlowlets", BooleanValue (false));
+  std::vector<uint32_t> first (flows);
+  used.clear ();
+  for (uint32_t flowId = 0; flowId < flows; ++flowId)
+    {
+      first[flowId] = clove->GetPath (flowId, g_source, g_dest);
+      used.insert (first[flowId]);
+    }
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (used.size (), 4, "More flowlets than slots");
+  Simulator::Stop (MicroSeconds (40));
+  Simulator::Run ();
+  for (uint32_t flowId = 0; flowId < flows; ++flowId)
+    {
+      NS_TEST_ASSERT_MSG_EQ (clove->GetPath (flowId, g_source, g_dest), first[flowId], "Flow " << flowId << " left the path of its slot");
+    }
+
+  // One slot shared by flows to two ToRs: a flow never takes the path of
+  // a flow to the other ToR
+  const Ipv4Address other ("10.3.0.1");
+  clove = CreateClove (4, 4);
+  clove->AddAddressWithTor (other, 3);
+  for (uint32_t path = 11; path <= 14; ++path)
+    {
+      clove->AddAvailPath (3, path);
+    }
+  clove->SetAttribute ("FlowletTableSize", UintegerValue (1));
+  clove->SetAttribute ("ExactFlowlets", BooleanValue (false));
+  for (uint32_t flowId = 0; flowId < flows; flowId += 2)
+    {
+      uint32_t path = clove->GetPath (flowId, g_source, g_dest);
+      NS_TEST_ASSERT_MSG_EQ ((path >= 1 && path <= 4), true, "Flow " << flowId << " took a path to another ToR");
+      path = clove->GetPath (flowId + 1, g_source, other);
+      NS_TEST_ASSERT_MSG_EQ ((path >= 11 && path <= 14), true, "Flow " << flowId + 1 << " took a path to another ToR");
+    }
+
+  Simulator::Destroy ();
+}
+
+class CloveFlowletMemoryTestCase : public TestCase
+{
+public:
+  CloveFlowletMemoryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CloveFlowletMemoryTestCase::CloveFlowletMemoryTestCase ()
+  : TestCase ("The flowlets kept are bounded by the slots of the table whatever the number of flows")
 {
 }
 
-//
-// This method is the pure virtual method from class TestCase that every
-// TestCase must implement
-//
 void
-CloveTestCase1::DoRun (void)
+CloveFlowletMemoryTestCase::DoRun (void)
 {
-  // A wide variety of test macros are available in src/core/test.h
-  NS_TEST_ASSERT_MSG_EQ (true, true, "true doesn't equal true for some reason");
-  // Use this one for floating point comparisons
-  NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
+  Ptr<Ipv4Clove> clove = CreateClove (4, 4);
+  clove->SetAttribute ("FlowletTableSize", UintegerValue (64));
+
+  // Ten thousand flows active at once: all but the slots are evicted
+  const uint32_t flows = 10000;
+  for (uint32_t flowId = 0; flowId < flows; ++flowId)
+    {
+      NS_TEST_ASSERT_MSG_NE (clove->GetPath (flowId, g_source, g_dest), 0, "Flow " << flowId << " is not given a path");
+    }
+  NS_TEST_ASSERT_MSG_EQ (clove->GetFlowletTableSize (), 64, "The table should not grow");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (clove->GetNFlowletEvictions (), flows - 64, "More flowlets kept than slots");
+
+  // Once they expired, the slots are reused without eviction
+  Simulator::Stop (MicroSeconds (60));
+  Simulator::Run ();
+  uint64_t evictions = clove->GetNFlowletEvictions ();
+  for (uint32_t flowId = 0; flowId < 8; ++flowId)
+    {
+      clove->GetPath (flows + flowId * 64, g_source, g_dest);
+    }
+  NS_TEST_ASSERT_MSG_EQ (clove->GetNFlowletEvictions (), evictions, "Expired flowlets should be reused, not evicted");
+
+  Simulator::Destroy ();
 }
 
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
@@ -59,10 +233,10 @@ public:
 CloveTestSuite::CloveTestSuite ()
   : TestSuite ("clove", UNIT)
 {
-  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
-  AddTestCase (new CloveTestCase1, TestCase::QUICK);
+  AddTestCase (new CloveFlowletTimeoutTestCase, TestCase::QUICK);
+  AddTestCase (new CloveHashCollisionTestCase, TestCase::QUICK);
+  AddTestCase (new CloveFlowletMemoryTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
 static CloveTestSuite cloveTestSuite;
-
@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+// Microbenchmark of Ipv4CmdSRoutingTable::Lookup on the table of one leaf
+// of a leaf-spine fat-tree: one /24 per remote leaf spread over all spine
+// uplinks, one /32 per local host and a default route.  The same lookups
+// are timed with the linear table and with the compiled trie.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ipv4-cmds-routing-table.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+static double
+RunLookups (Ipv4CmdSRoutingTable &table, Ptr<Ipv4> ipv4,
+            const std::vector<Ipv4Address> &dests, const std::vector<uint32_t> &flows,
+            uint32_t rounds)
+{
+  uint32_t found = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; ++r)
+    {
+      for (uint32_t i = 0; i < dests.size (); ++i)
+        {
+          if (table.Lookup (ipv4, flows[i], dests[i]) != 0)
+            {
+              found++;
+            }
+        }
+    }
+  int64_t ms = clock.End ();
+  NS_ABORT_MSG_UNLESS (found == rounds * dests.size (), "Every destination should be routable");
+  return ms == 0 ? 0 : 1000.0 * found / ms;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t leafCount = 128;
+  uint32_t spineCount = 8;
+  uint32_t serverCount = 16;
+  uint32_t flowCount = 10000;
+  uint32_t lookupCount = 100000;
+  uint32_t rounds = 10;
+
+  CommandLine cmd;
+  cmd.AddValue ("leafCount", "Number of leaves in the fat-tree", leafCount);
+  cmd.AddValue ("spineCount", "Number of spine uplinks of the measured leaf", spineCount);
+  cmd.AddValue ("serverCount", "Number of servers per leaf", serverCount);
+  cmd.AddValue ("flowCount", "Number of distinct flow ids", flowCount);
+  cmd.AddValue ("lookupCount", "Number of distinct lookups per round", lookupCount);
+  cmd.AddValue ("rounds", "Number of rounds over the lookups", rounds);
+  cmd.Parse (argc, argv);
+
+  NodeContainer leaf;
+  leaf.Create (1);
+  NodeContainer spines;
+  spines.Create (spineCount);
+  NodeContainer servers;
+  servers.Create (serverCount);
+
+  InternetStackHelper internet;
+  internet.Install (leaf);
+  internet.Install (spines);
+  internet.Install (servers);
+
+  PointToPointHelper p2p;
+  Ipv4AddressHelper ipv4;
+
+  std::vector<uint32_t> uplinks;
+  ipv4.SetBase ("192.168.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < spineCount; ++i)
+    {
+      NetDeviceContainer devices = p2p.Install (leaf.Get (0), spines.Get (i));
+      ipv4.Assign (devices);
+      ipv4.NewNetwork ();
+      uplinks.push_back (devices.Get (0)->GetIfIndex ());
+    }
+
+  std::vector<uint32_t> downlinks;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < serverCount; ++i)
+    {
+      NetDeviceContainer devices = p2p.Install (leaf.Get (0), servers.Get (i));
+      ipv4.Assign (devices);
+      ipv4.NewNetwork ();
+      downlinks.push_back (devices.Get (0)->GetIfIndex ());
+    }
+
+  Ptr<Ipv4> leafIpv4 = leaf.Get (0)->GetObject<Ipv4> ();
+
+  Ipv4CmdSRoutingTable linear;
+  Ipv4CmdSRoutingTable compiled;
+  compiled.SetCompiled (true);
+
+  Ipv4CmdSRoutingTable *tables[] = { &linear, &compiled };
+  for (uint32_t t = 0; t < 2; ++t)
+    {
+      tables[t]->AddEntry (leafIpv4, Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), uplinks);
+      for (uint32_t l = 1; l < leafCount; ++l)
+        {
+          std::stringstream ss;
+          ss << "10." << (l >> 8) + 1 << "." << (l & 0xff) << ".0";
+          tables[t]->AddEntry (leafIpv4, Ipv4Address (ss.str ().c_str ()), Ipv4Mask ("255.255.255.0"), uplinks);
+        }
+      for (uint32_t s = 0; s < serverCount; ++s)
+        {
+          std::vector<uint32_t> interfaces (1, downlinks[s]);
+          tables[t]->AddEntry (leafIpv4, Ipv4Address (0x0a000000 + 4 * s + 2), Ipv4Mask ("255.255.255.255"), interfaces);
+        }
+      for (uint32_t i = 0; i < spineCount; ++i)
+        {
+          Ipv4Address neighbor = spines.Get (i)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+          tables[t]->UpdateQueueSize (neighbor, i % 3);
+        }
+    }
+
+  srand (1);
+  std::vector<Ipv4Address> dests;
+  std::vector<uint32_t> flows;
+  for (uint32_t i = 0; i < lookupCount; ++i)
+    {
+      uint32_t l = 1 + rand () % (leafCount - 1);
+      uint32_t s = rand () % serverCount;
+      dests.push_back (Ipv4Address ((10u << 24) | (((l >> 8) + 1) << 16) | ((l & 0xff) << 8) | (s + 2)));
+      flows.push_back (rand () % flowCount);
+    }
+
+  double linearRate = RunLookups (linear, leafIpv4, dests, flows, rounds);
+  double compiledRate = RunLookups (compiled, leafIpv4, dests, flows, rounds);
+
+  std::cout << "entries: " << leafCount + serverCount << std::endl;
+  std::cout << "linear:   " << linearRate << " lookups/s" << std::endl;
+  std::cout << "compiled: " << compiledRate << " lookups/s" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+// Compares the two ways CmdS switches learn the queue sizes of their
+// neighbors.  Two switches A and B are joined by a slow link; a server
+// behind B sends on/off UDP bursts to a server behind A faster than the
+// link drains, so the queue of B towards A keeps filling and emptying.
+// The view A holds of B is sampled against the real queue:
+//
+//  - detection: time from B's queue first crossing the threshold to A's
+//    view of B crossing it;
+//  - error: mean absolute difference between view and queue, in packets;
+//  - overhead: extra packets and bytes spent on the sync.  A broadcast
+//    sync message is a 1 byte UDP payload sent on every interface; an
+//    in-band stamp costs the 4 bytes of the cmds_h TCP option.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/ipv4-cmds-routing-helper.h"
+#include "ns3/ipv4-cmds-routing.h"
+
+#include <cmath>
+#include <iostream>
+
+using namespace ns3;
+
+// IPv4 + UDP headers, the 1 byte payload and the PPP header
+static const uint32_t SYNC_MESSAGE_BYTES = 20 + 8 + 1 + 2;
+static const uint32_t STAMP_BYTES = 4;
+
+struct SyncResult
+{
+  double detection;          // seconds, negative if never detected
+  double meanError;
+  uint64_t controlPackets;
+  uint64_t overheadBytes;
+  uint64_t updates;
+};
+
+struct Sampler
+{
+  Ptr<Queue> queue;
+  Ptr<Ipv4CmdSRouting> observer;
+  Ipv4Address neighbor;
+  Time interval;
+  uint32_t threshold;
+
+  Time queueCrossed;
+  Time viewCrossed;
+  double errorSum;
+  uint64_t samples;
+
+  void Sample (void)
+  {
+    uint32_t actual = queue->GetNPackets ();
+    uint32_t view = observer->GetNeighborQueueSize (neighbor);
+    if (view == UINT32_MAX)
+      {
+        view = 0;
+      }
+    Time now = Simulator::Now ();
+    if (queueCrossed.IsNegative () && actual >= threshold)
+      {
+        queueCrossed = now;
+      }
+    if (!queueCrossed.IsNegative () && viewCrossed.IsNegative () && view >= threshold)
+      {
+        viewCrossed = now;
+      }
+    errorSum += std::fabs ((double) actual - (double) view);
+    samples++;
+    Simulator::Schedule (interval, &Sampler::Sample, this);
+  }
+};
+
+static SyncResult
+RunSync (Ipv4CmdSRouting::QueueSyncMode mode, uint32_t sampleRatio, Time endTime)
+{
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::QueueSync", EnumValue (mode));
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::TelemetrySampleRatio", UintegerValue (sampleRatio));
+
+  NodeContainer switches;
+  switches.Create (2);
+  NodeContainer servers;
+  servers.Create (2);
+
+  InternetStackHelper internet;
+  Ipv4StaticRoutingHelper staticRoutingHelper;
+  Ipv4CmdSRoutingHelper cmdsRoutingHelper;
+  internet.SetRoutingHelper (staticRoutingHelper);
+  internet.Install (servers);
+  internet.SetRoutingHelper (cmdsRoutingHelper);
+  internet.Install (switches);
+
+  PointToPointHelper p2p;
+  Ipv4AddressHelper ipv4;
+  p2p.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (10)));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (100));
+
+  p2p.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  NetDeviceContainer core = p2p.Install (switches.Get (0), switches.Get (1));
+  Ipv4InterfaceContainer coreAddr = ipv4.Assign (core);
+
+  p2p.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Gbps")));
+  ipv4.SetBase ("10.1.0.0", "255.255.255.0");
+  NetDeviceContainer edgeA = p2p.Install (switches.Get (0), servers.Get (0));
+  Ipv4InterfaceContainer edgeAAddr = ipv4.Assign (edgeA);
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  NetDeviceContainer edgeB = p2p.Install (switches.Get (1), servers.Get (1));
+  Ipv4InterfaceContainer edgeBAddr = ipv4.Assign (edgeB);
+
+  Ptr<Ipv4CmdSRouting> routingA = cmdsRoutingHelper.GetCmdSRouting (switches.Get (0)->GetObject<Ipv4> ());
+  Ptr<Ipv4CmdSRouting> routingB = cmdsRoutingHelper.GetCmdSRouting (switches.Get (1)->GetObject<Ipv4> ());
+
+  Ptr<Queue> queueBA = core.Get (1)->GetObject<PointToPointNetDevice> ()->GetQueue ();
+  routingA->AddQueue (core.Get (0)->GetObject<PointToPointNetDevice> ()->GetQueue ());
+  routingA->AddQueue (edgeA.Get (0)->GetObject<PointToPointNetDevice> ()->GetQueue ());
+  routingB->AddQueue (queueBA);
+  routingB->AddQueue (edgeB.Get (0)->GetObject<PointToPointNetDevice> ()->GetQueue ());
+
+  std::vector<uint32_t> interfaces (1);
+  interfaces[0] = edgeA.Get (0)->GetIfIndex ();
+  routingA->AddRoute (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.255.0"), interfaces);
+  interfaces[0] = core.Get (0)->GetIfIndex ();
+  routingA->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.255.0"), interfaces);
+  interfaces[0] = edgeB.Get (0)->GetIfIndex ();
+  routingB->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.255.0"), interfaces);
+  interfaces[0] = core.Get (1)->GetIfIndex ();
+  routingB->AddRoute (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.255.0"), interfaces);
+
+  for (uint32_t i = 0; i < servers.GetN (); ++i)
+    {
+      staticRoutingHelper.GetStaticRouting (servers.Get (i)->GetObject<Ipv4> ())->
+        AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), 1);
+    }
+
+  uint16_t port = 5000;
+  PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinkApp = sink.Install (servers.Get (0));
+  sinkApp.Start (Seconds (0.0));
+
+  OnOffHelper source ("ns3::UdpSocketFactory", InetSocketAddress (edgeAAddr.GetAddress (1), port));
+  source.SetAttribute ("DataRate", DataRateValue (DataRate ("2Gbps")));
+  source.SetAttribute ("PacketSize", UintegerValue (1400));
+  source.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.001]"));
+  source.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.002]"));
+  ApplicationContainer sourceApp = source.Install (servers.Get (1));
+  sourceApp.Start (MilliSeconds (5));
+  sourceApp.Stop (endTime);
+
+  Sampler sampler;
+  sampler.queue = queueBA;
+  sampler.observer = routingA;
+  sampler.neighbor = coreAddr.GetAddress (1);
+  sampler.interval = MicroSeconds (50);
+  sampler.threshold = 50;
+  sampler.queueCrossed = Time (-1);
+  sampler.viewCrossed = Time (-1);
+  sampler.errorSum = 0;
+  sampler.samples = 0;
+  Simulator::Schedule (MilliSeconds (5), &Sampler::Sample, &sampler);
+
+  Simulator::Stop (endTime);
+  Simulator::Run ();
+
+  SyncResult result;
+  result.detection = sampler.viewCrossed.IsNegative () ? -1 : (sampler.viewCrossed - sampler.queueCrossed).GetSeconds ();
+  result.meanError = sampler.samples == 0 ? 0 : sampler.errorSum / sampler.samples;
+  result.controlPackets = 0;
+  result.overheadBytes = 0;
+  result.updates = routingA->GetTelemetryUpdates ();
+
+  Ptr<Ipv4CmdSRouting> routings[] = { routingA, routingB };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      // Broadcasts leave on every interface but the loopback
+      uint32_t ports = routings[i]->GetObject<Ipv4> ()->GetNInterfaces () - 1;
+      result.controlPackets += routings[i]->GetSyncMessages () * ports;
+      result.overheadBytes += routings[i]->GetSyncMessages () * ports * SYNC_MESSAGE_BYTES;
+      result.overheadBytes += routings[i]->GetTelemetryStamps () * STAMP_BYTES;
+    }
+
+  Simulator::Destroy ();
+  return result;
+}
+
+static void
+PrintResult (const char *name, const SyncResult &result)
+{
+  std::cout << name << ": detection ";
+  if (result.detection < 0)
+    {
+      std::cout << "never";
+    }
+  else
+    {
+      std::cout << result.detection * 1e6 << " us";
+    }
+  std::cout << ", mean error " << result.meanError << " pkts"
+            << ", control packets " << result.controlPackets
+            << ", overhead " << result.overheadBytes << " bytes";
+  if (result.updates != 0)
+    {
+      std::cout << ", view updates " << result.updates;
+    }
+  std::cout << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  double endTime = 0.1;
+  uint32_t sampleRatio = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("endTime", "Simulated time of each run in seconds", endTime);
+  cmd.AddValue ("sampleRatio", "TelemetrySampleRatio of the in-band run", sampleRatio);
+  cmd.Parse (argc, argv);
+
+  SyncResult broadcast = RunSync (Ipv4CmdSRouting::SYNC_BROADCAST, 1, Seconds (endTime));
+  SyncResult inband = RunSync (Ipv4CmdSRouting::SYNC_INBAND, sampleRatio, Seconds (endTime));
+
+  PrintResult ("broadcast", broadcast);
+  PrintResult ("in-band  ", inband);
+  return 0;
+}
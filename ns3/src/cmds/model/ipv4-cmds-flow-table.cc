@@ -0,0 +1,244 @@
+#include "ipv4-cmds-flow-table.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/index-map.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4CmdSFlowTable");
+
+Ipv4CmdSFlowTable::Ipv4CmdSFlowTable ()
+  : m_agingTime (Time (0)),
+    m_maxProbes (4),
+    m_policy (EVICT_LRU),
+    m_occupancy (0),
+    m_collisions (0),
+    m_evictions (0),
+    m_expirations (0),
+    m_rejections (0)
+{
+}
+
+void
+Ipv4CmdSFlowTable::SetSize (uint32_t size)
+{
+  Slot empty;
+  empty.valid = false;
+  empty.flowid = 0;
+  empty.interface = 0;
+  m_slots.assign (size, empty);
+  m_occupancy = 0;
+}
+
+uint32_t
+Ipv4CmdSFlowTable::GetSize (void) const
+{
+  return m_slots.size ();
+}
+
+void
+Ipv4CmdSFlowTable::SetAgingTime (Time agingTime)
+{
+  m_agingTime = agingTime;
+}
+
+Time
+Ipv4CmdSFlowTable::GetAgingTime (void) const
+{
+  return m_agingTime;
+}
+
+void
+Ipv4CmdSFlowTable::SetMaxProbes (uint32_t probes)
+{
+  m_maxProbes = probes == 0 ? 1 : probes;
+}
+
+uint32_t
+Ipv4CmdSFlowTable::GetMaxProbes (void) const
+{
+  return m_maxProbes;
+}
+
+void
+Ipv4CmdSFlowTable::SetEvictionPolicy (EvictionPolicy policy)
+{
+  m_policy = policy;
+}
+
+Ipv4CmdSFlowTable::EvictionPolicy
+Ipv4CmdSFlowTable::GetEvictionPolicy (void) const
+{
+  return m_policy;
+}
+
+uint32_t
+Ipv4CmdSFlowTable::Hash (uint32_t flowid) const
+{
+  return IndexMap::HashRange (flowid, m_slots.size ());
+}
+
+bool
+Ipv4CmdSFlowTable::IsLive (const Slot &slot, Time now) const
+{
+  return slot.valid && (m_agingTime.IsZero () || now - slot.lastSeen <= m_agingTime);
+}
+
+bool
+Ipv4CmdSFlowTable::Lookup (uint32_t flowid, uint32_t &interface)
+{
+  if (m_slots.empty ())
+    {
+      return false;
+    }
+
+  Time now = Simulator::Now ();
+  uint32_t size = m_slots.size ();
+  uint32_t home = Hash (flowid);
+  uint32_t probes = std::min (m_maxProbes, size);
+
+  for (uint32_t i = 0; i < probes; ++i)
+    {
+      Slot &slot = m_slots[(home + i) % size];
+      if (!slot.valid || slot.flowid != flowid)
+        {
+          continue;
+        }
+      if (!IsLive (slot, now))
+        {
+          NS_LOG_LOGIC ("Flow " << flowid << " aged out");
+          slot.valid = false;
+          m_occupancy--;
+          m_expirations++;
+          return false;
+        }
+      slot.lastSeen = now;
+      interface = slot.interface;
+      return true;
+    }
+  return false;
+}
+
+void
+Ipv4CmdSFlowTable::Insert (uint32_t flowid, uint32_t interface)
+{
+  if (m_slots.empty ())
+    {
+      return;
+    }
+
+  Time now = Simulator::Now ();
+  uint32_t size = m_slots.size ();
+  uint32_t home = Hash (flowid);
+  uint32_t probes = std::min (m_maxProbes, size);
+
+  // The flow is refreshed wherever it is pinned, an earlier slot may have
+  // been freed since
+  for (uint32_t i = 0; i < probes; ++i)
+    {
+      Slot &slot = m_slots[(home + i) % size];
+      if (slot.valid && slot.flowid == flowid)
+        {
+          slot.interface = interface;
+          slot.lastSeen = now;
+          return;
+        }
+    }
+
+  // A new flow collides when another live flow holds its home slot
+  if (IsLive (m_slots[home], now))
+    {
+      m_collisions++;
+    }
+
+  Slot *target = 0;
+  Slot *oldest = 0;
+  for (uint32_t i = 0; i < probes; ++i)
+    {
+      Slot &slot = m_slots[(home + i) % size];
+      if (!IsLive (slot, now))
+        {
+          if (target == 0)
+            {
+              target = &slot;
+            }
+          continue;
+        }
+      if (oldest == 0 || slot.lastSeen < oldest->lastSeen)
+        {
+          oldest = &slot;
+        }
+    }
+
+  if (target == 0)
+    {
+      switch (m_policy)
+        {
+        case EVICT_LRU:
+          target = oldest;
+          break;
+        case EVICT_OVERWRITE:
+          target = &m_slots[home];
+          break;
+        case EVICT_NONE:
+          m_rejections++;
+          return;
+        }
+      NS_LOG_LOGIC ("Flow " << flowid << " evicts flow " << target->flowid);
+      m_evictions++;
+    }
+  else if (!target->valid)
+    {
+      m_occupancy++;
+    }
+  else
+    {
+      // Reusing a slot whose flow has aged out
+      m_expirations++;
+    }
+
+  target->valid = true;
+  target->flowid = flowid;
+  target->interface = interface;
+  target->lastSeen = now;
+}
+
+void
+Ipv4CmdSFlowTable::Clear (void)
+{
+  SetSize (m_slots.size ());
+}
+
+uint32_t
+Ipv4CmdSFlowTable::GetOccupancy (void) const
+{
+  return m_occupancy;
+}
+
+uint64_t
+Ipv4CmdSFlowTable::GetCollisions (void) const
+{
+  return m_collisions;
+}
+
+uint64_t
+Ipv4CmdSFlowTable::GetEvictions (void) const
+{
+  return m_evictions;
+}
+
+uint64_t
+Ipv4CmdSFlowTable::GetExpirations (void) const
+{
+  return m_expirations;
+}
+
+uint64_t
+Ipv4CmdSFlowTable::GetRejections (void) const
+{
+  return m_rejections;
+}
+
+}
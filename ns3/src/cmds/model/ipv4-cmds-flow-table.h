@@ -0,0 +1,83 @@
+#ifndef NS3_IPV4_CMDS_FLOW_TABLE
+#define NS3_IPV4_CMDS_FLOW_TABLE
+
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Fixed-capacity flow id -> interface table with timestamp aging.
+ *
+ * Mirrors the hash-indexed register arrays of src/switch/cmds.p4 (0xFFFF
+ * slots by default): a flow hashes to a home slot and may probe a few
+ * neighbouring slots.  Entries idle for longer than the aging time are
+ * treated as free, so memory stays flat no matter how many flows a long
+ * run sees.  When every probed slot holds a live flow, the eviction policy
+ * decides what happens to the new flow.
+ */
+class Ipv4CmdSFlowTable {
+public:
+  enum EvictionPolicy
+  {
+    EVICT_LRU = 0,      // replace the least recently seen probed slot
+    EVICT_OVERWRITE,    // replace the home slot, like a single register
+    EVICT_NONE          // keep the old flows and do not pin the new one
+  };
+
+  Ipv4CmdSFlowTable ();
+
+  void SetSize (uint32_t size);
+  uint32_t GetSize (void) const;
+
+  void SetAgingTime (Time agingTime);
+  Time GetAgingTime (void) const;
+  void SetMaxProbes (uint32_t probes);
+  uint32_t GetMaxProbes (void) const;
+  void SetEvictionPolicy (EvictionPolicy policy);
+  EvictionPolicy GetEvictionPolicy (void) const;
+
+  /**
+   * \brief Find the interface pinned for flowid and refresh its timestamp
+   * \return false if the flow has no live entry
+   */
+  bool Lookup (uint32_t flowid, uint32_t &interface);
+
+  void Insert (uint32_t flowid, uint32_t interface);
+
+  void Clear (void);
+
+  uint32_t GetOccupancy (void) const;
+  uint64_t GetCollisions (void) const;
+  uint64_t GetEvictions (void) const;
+  uint64_t GetExpirations (void) const;
+  uint64_t GetRejections (void) const;
+
+private:
+  struct Slot
+  {
+    bool valid;
+    uint32_t flowid;
+    uint32_t interface;
+    Time lastSeen;
+  };
+
+  uint32_t Hash (uint32_t flowid) const;
+  bool IsLive (const Slot &slot, Time now) const;
+
+  std::vector<Slot> m_slots;
+  Time m_agingTime;
+  uint32_t m_maxProbes;
+  EvictionPolicy m_policy;
+
+  uint32_t m_occupancy;
+  uint64_t m_collisions;   // new flows whose home slot held another live flow
+  uint64_t m_evictions;    // live flows replaced by a new one
+  uint64_t m_expirations;  // aged-out flows reclaimed
+  uint64_t m_rejections;   // new flows not stored under EVICT_NONE
+};
+
+}
+
+#endif
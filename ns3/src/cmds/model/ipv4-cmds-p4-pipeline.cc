@@ -0,0 +1,298 @@
+#include "ipv4-cmds-p4-pipeline.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4CmdSP4Pipeline");
+
+const uint32_t Ipv4CmdSP4Pipeline::ECMP_TABLE_SIZE;
+
+namespace {
+
+// Tofino CRC32: polynomial 0x04C11DB7, reflected, init and xor-out 0xFFFFFFFF
+struct Crc32Table
+{
+  uint32_t v[256];
+  Crc32Table ()
+  {
+    for (uint32_t i = 0; i < 256; ++i)
+      {
+        uint32_t c = i;
+        for (int b = 0; b < 8; ++b)
+          {
+            c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+          }
+        v[i] = c;
+      }
+  }
+};
+
+// Tofino CRC16: polynomial 0x8005, reflected, init and xor-out 0
+struct Crc16Table
+{
+  uint16_t v[256];
+  Crc16Table ()
+  {
+    for (uint32_t i = 0; i < 256; ++i)
+      {
+        uint16_t c = i;
+        for (int b = 0; b < 8; ++b)
+          {
+            c = (c & 1) ? (c >> 1) ^ 0xA001 : c >> 1;
+          }
+        v[i] = c;
+      }
+  }
+};
+
+// Tofino CRC8: polynomial 0x07, not reflected, init and xor-out 0
+struct Crc8Table
+{
+  uint8_t v[256];
+  Crc8Table ()
+  {
+    for (uint32_t i = 0; i < 256; ++i)
+      {
+        uint8_t c = i;
+        for (int b = 0; b < 8; ++b)
+          {
+            c = (c & 0x80) ? (c << 1) ^ 0x07 : c << 1;
+          }
+        v[i] = c;
+      }
+  }
+};
+
+const Crc32Table g_crc32;
+const Crc16Table g_crc16;
+const Crc8Table g_crc8;
+
+}
+
+Ipv4CmdSP4Pipeline::Ipv4CmdSP4Pipeline ()
+  : m_size (0),
+    m_k (5),
+    m_thresh (5),
+    m_packets (0),
+    m_takeovers (0),
+    m_flowletCollisions (0),
+    m_newFlowlets (0)
+{
+  SetRegisterSize (0xFFFF);
+}
+
+void
+Ipv4CmdSP4Pipeline::SetRegisterSize (uint32_t size)
+{
+  NS_ASSERT (size > 0);
+  m_size = size;
+  Reset ();
+}
+
+uint32_t
+Ipv4CmdSP4Pipeline::GetRegisterSize (void) const
+{
+  return m_size;
+}
+
+void
+Ipv4CmdSP4Pipeline::SetK (uint32_t k)
+{
+  m_k = k;
+}
+
+void
+Ipv4CmdSP4Pipeline::SetThresh (uint32_t thresh)
+{
+  m_thresh = thresh;
+}
+
+void
+Ipv4CmdSP4Pipeline::Reset (void)
+{
+  Id1Fre r1 = { 0, 0 };
+  Id2Ts r2 = { 0, 0 };
+  m_id1Fre.assign (m_size, r1);
+  m_id2Ts.assign (m_size, r2);
+  m_nexthop.assign (m_size, 0);
+  m_packets = 0;
+  m_takeovers = 0;
+  m_flowletCollisions = 0;
+  m_newFlowlets = 0;
+}
+
+uint32_t
+Ipv4CmdSP4Pipeline::Crc32 (const uint8_t *data, uint32_t size)
+{
+  uint32_t crc = 0xFFFFFFFFu;
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      crc = (crc >> 8) ^ g_crc32.v[(crc ^ data[i]) & 0xff];
+    }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+uint16_t
+Ipv4CmdSP4Pipeline::Crc16 (const uint8_t *data, uint32_t size)
+{
+  uint16_t crc = 0;
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      crc = (crc >> 8) ^ g_crc16.v[(crc ^ data[i]) & 0xff];
+    }
+  return crc;
+}
+
+uint8_t
+Ipv4CmdSP4Pipeline::Crc8 (const uint8_t *data, uint32_t size)
+{
+  uint8_t crc = 0;
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      crc = g_crc8.v[crc ^ data[i]];
+    }
+  return crc;
+}
+
+void
+Ipv4CmdSP4Pipeline::Serialize (const FlowKey &key, uint8_t buf[13])
+{
+  buf[0] = key.src >> 24;
+  buf[1] = key.src >> 16;
+  buf[2] = key.src >> 8;
+  buf[3] = key.src;
+  buf[4] = key.dst >> 24;
+  buf[5] = key.dst >> 16;
+  buf[6] = key.dst >> 8;
+  buf[7] = key.dst;
+  buf[8] = key.proto;
+  buf[9] = key.lookup >> 24;
+  buf[10] = key.lookup >> 16;
+  buf[11] = key.lookup >> 8;
+  buf[12] = key.lookup;
+}
+
+uint32_t
+Ipv4CmdSP4Pipeline::Process (const FlowKey &key, uint32_t ts, const uint32_t *ecmpTable, uint32_t leastHop)
+{
+  uint8_t buf[13];
+  Serialize (key, buf);
+
+  // calid_t, calindex_t, calnexthop_t, findecmphop_t
+  uint32_t id = Crc32 (buf, sizeof (buf));
+  uint32_t index = Crc16 (buf, sizeof (buf)) % m_size;
+  uint32_t hopindex = Crc8 (buf, sizeof (buf)) & 0xf;
+  uint32_t ecmphop = ecmpTable[hopindex];
+
+  m_packets++;
+
+  // work1_fre / work1_id1
+  Id1Fre &r1 = m_id1Fre[index];
+  if (r1.id1 == id)
+    {
+      r1.fre = r1.fre + m_k;
+    }
+  if (r1.id1 != id && r1.fre != 0)
+    {
+      r1.fre = r1.fre - 1;
+    }
+  if (r1.id1 != id && r1.fre == 0)
+    {
+      r1.id1 = id;
+      m_takeovers++;
+    }
+
+  if (r1.id1 != id)
+    {
+      ts = ts & 0x7fffffffu;
+    }
+  else
+    {
+      ts = ts | 0x80000000u;
+    }
+
+  // work2_pre1 / work2_pre2 return the register before the update
+  Id2Ts &r2 = m_id2Ts[index];
+  uint32_t oldTs = r2.ts;
+  uint32_t oldId2 = r2.id2;
+  if (ts > r2.ts + m_thresh)
+    {
+      r2.ts = ts;
+    }
+  if (ts > r2.ts + m_thresh && id != r2.id2)
+    {
+      r2.id2 = id;
+    }
+  if (ts <= r2.ts + m_thresh && id == r2.id2)
+    {
+      r2.ts = ts | 0x80000000u;
+    }
+
+  bool flagforpend2 = (id == oldId2);
+  if (!flagforpend2 && oldId2 != 0)
+    {
+      m_flowletCollisions++;
+    }
+  uint32_t tsd = oldTs + m_thresh;
+  uint32_t flag4pend = std::max (tsd, ts);
+
+  uint32_t nexthop;
+  bool sch;
+  if (flag4pend == ts)
+    {
+      nexthop = flagforpend2 ? leastHop : ecmphop;
+      sch = true;
+      m_newFlowlets++;
+    }
+  else if (flagforpend2)
+    {
+      nexthop = 0;
+      sch = true;
+    }
+  else
+    {
+      nexthop = ecmphop;
+      sch = false;
+    }
+
+  // work3_sch
+  if (!sch)
+    {
+      return ecmphop;
+    }
+  uint32_t &r3 = m_nexthop[index];
+  if (nexthop != 0)
+    {
+      r3 = nexthop;
+    }
+  return r3;
+}
+
+uint64_t
+Ipv4CmdSP4Pipeline::GetPackets (void) const
+{
+  return m_packets;
+}
+
+uint64_t
+Ipv4CmdSP4Pipeline::GetSketchTakeovers (void) const
+{
+  return m_takeovers;
+}
+
+uint64_t
+Ipv4CmdSP4Pipeline::GetFlowletCollisions (void) const
+{
+  return m_flowletCollisions;
+}
+
+uint64_t
+Ipv4CmdSP4Pipeline::GetNewFlowlets (void) const
+{
+  return m_newFlowlets;
+}
+
+}
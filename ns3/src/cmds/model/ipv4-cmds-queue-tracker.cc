@@ -0,0 +1,206 @@
+#include "ipv4-cmds-queue-tracker.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4CmdSQueueTracker");
+
+Ipv4CmdSQueueTracker::Ipv4CmdSQueueTracker ()
+  : m_gain (0.125),
+    m_alpha (0.2),
+    m_tdre (MicroSeconds (200)),
+    m_totalPackets (0),
+    m_totalAvgPackets (0)
+{
+  m_totalDre.bytes = 0;
+  m_totalDre.epoch = 0;
+}
+
+Ipv4CmdSQueueTracker::~Ipv4CmdSQueueTracker ()
+{
+  Clear ();
+}
+
+void
+Ipv4CmdSQueueTracker::SetEwmaGain (double gain)
+{
+  m_gain = gain;
+}
+
+void
+Ipv4CmdSQueueTracker::SetAlpha (double alpha)
+{
+  m_alpha = alpha;
+}
+
+void
+Ipv4CmdSQueueTracker::SetTDre (Time tdre)
+{
+  NS_ASSERT (tdre.IsStrictlyPositive ());
+  m_tdre = tdre;
+}
+
+uint32_t
+Ipv4CmdSQueueTracker::AddQueue (Ptr<Queue> queue)
+{
+  uint32_t index = m_queues.size ();
+
+  QueueState state;
+  state.queue = queue;
+  state.packets = queue->GetNPackets ();
+  state.bytes = queue->GetNBytes ();
+  state.avgPackets = state.packets;
+  state.dre.bytes = 0;
+  state.dre.epoch = GetEpoch ();
+  state.drops = 0;
+  m_queues.push_back (state);
+
+  m_totalPackets += state.packets;
+  m_totalAvgPackets += state.avgPackets;
+
+  queue->TraceConnectWithoutContext ("Enqueue", MakeBoundCallback (&Ipv4CmdSQueueTracker::Enqueued, this, index));
+  queue->TraceConnectWithoutContext ("Dequeue", MakeBoundCallback (&Ipv4CmdSQueueTracker::Dequeued, this, index));
+  queue->TraceConnectWithoutContext ("Drop", MakeBoundCallback (&Ipv4CmdSQueueTracker::Dropped, this, index));
+  return index;
+}
+
+uint32_t
+Ipv4CmdSQueueTracker::GetNQueues (void) const
+{
+  return m_queues.size ();
+}
+
+void
+Ipv4CmdSQueueTracker::Clear (void)
+{
+  for (uint32_t index = 0; index < m_queues.size (); ++index)
+    {
+      Ptr<Queue> queue = m_queues[index].queue;
+      queue->TraceDisconnectWithoutContext ("Enqueue", MakeBoundCallback (&Ipv4CmdSQueueTracker::Enqueued, this, index));
+      queue->TraceDisconnectWithoutContext ("Dequeue", MakeBoundCallback (&Ipv4CmdSQueueTracker::Dequeued, this, index));
+      queue->TraceDisconnectWithoutContext ("Drop", MakeBoundCallback (&Ipv4CmdSQueueTracker::Dropped, this, index));
+    }
+  m_queues.clear ();
+  m_totalPackets = 0;
+  m_totalAvgPackets = 0;
+  m_totalDre.bytes = 0;
+}
+
+int64_t
+Ipv4CmdSQueueTracker::GetEpoch (void) const
+{
+  return Simulator::Now ().GetTimeStep () / m_tdre.GetTimeStep ();
+}
+
+double
+Ipv4CmdSQueueTracker::Decayed (const Dre &dre, int64_t epoch) const
+{
+  if (epoch <= dre.epoch || dre.bytes == 0)
+    {
+      return dre.bytes;
+    }
+  return dre.bytes * std::pow (1 - m_alpha, static_cast<double> (epoch - dre.epoch));
+}
+
+void
+Ipv4CmdSQueueTracker::Decay (Dre &dre, int64_t epoch) const
+{
+  dre.bytes = Decayed (dre, epoch);
+  dre.epoch = epoch;
+}
+
+void
+Ipv4CmdSQueueTracker::UpdateAverage (QueueState &state)
+{
+  double avg = state.avgPackets + m_gain * (state.packets - state.avgPackets);
+  m_totalAvgPackets += avg - state.avgPackets;
+  state.avgPackets = avg;
+}
+
+void
+Ipv4CmdSQueueTracker::Enqueued (Ipv4CmdSQueueTracker *tracker, uint32_t index, Ptr<const Packet> packet)
+{
+  QueueState &state = tracker->m_queues[index];
+  state.packets++;
+  state.bytes += packet->GetSize ();
+  tracker->m_totalPackets++;
+  tracker->UpdateAverage (state);
+}
+
+void
+Ipv4CmdSQueueTracker::Dequeued (Ipv4CmdSQueueTracker *tracker, uint32_t index, Ptr<const Packet> packet)
+{
+  QueueState &state = tracker->m_queues[index];
+  NS_ASSERT (state.packets > 0);
+  uint32_t size = packet->GetSize ();
+  state.packets--;
+  state.bytes -= size;
+  tracker->m_totalPackets--;
+  tracker->UpdateAverage (state);
+
+  int64_t epoch = tracker->GetEpoch ();
+  tracker->Decay (state.dre, epoch);
+  state.dre.bytes += size;
+  tracker->Decay (tracker->m_totalDre, epoch);
+  tracker->m_totalDre.bytes += size;
+}
+
+void
+Ipv4CmdSQueueTracker::Dropped (Ipv4CmdSQueueTracker *tracker, uint32_t index, Ptr<const Packet> packet)
+{
+  tracker->m_queues[index].drops++;
+}
+
+uint32_t
+Ipv4CmdSQueueTracker::GetPackets (uint32_t index) const
+{
+  return m_queues[index].packets;
+}
+
+uint32_t
+Ipv4CmdSQueueTracker::GetBytes (uint32_t index) const
+{
+  return m_queues[index].bytes;
+}
+
+double
+Ipv4CmdSQueueTracker::GetAveragePackets (uint32_t index) const
+{
+  return m_queues[index].avgPackets;
+}
+
+double
+Ipv4CmdSQueueTracker::GetDreBytes (uint32_t index) const
+{
+  return Decayed (m_queues[index].dre, GetEpoch ());
+}
+
+uint64_t
+Ipv4CmdSQueueTracker::GetDrops (uint32_t index) const
+{
+  return m_queues[index].drops;
+}
+
+uint32_t
+Ipv4CmdSQueueTracker::GetTotalPackets (void) const
+{
+  return m_totalPackets;
+}
+
+double
+Ipv4CmdSQueueTracker::GetTotalAveragePackets (void) const
+{
+  return m_totalAvgPackets;
+}
+
+double
+Ipv4CmdSQueueTracker::GetTotalDreBytes (void) const
+{
+  return Decayed (m_totalDre, GetEpoch ());
+}
+
+}
@@ -1,149 +1,457 @@
-#include "ipv4-cmds-routing-table.h"
-#include "ns3/simulator.h"
-#include "ns3/net-device.h"
-#include "ns3/channel.h"
-#include "ns3/node.h"
-#include "ns3/log.h"
-#include <algorithm>
-
-namespace ns3 {
-
-NS_LOG_COMPONENT_DEFINE ("Ipv4CmdSRoutingTable");
-
-Ipv4CmdSRoutingTableEntry::Ipv4CmdSRoutingTableEntry (Ptr<Ipv4> ipv4, Ipv4Address dest, Ipv4Mask mask, 
-  const std::vector<uint32_t> &interfaces) : m_dest(dest), m_mask(mask)
-{
-  for (std::vector<uint32_t>::const_iterator it = interfaces.begin (); it != interfaces.end (); ++it)
-    {
-      uint32_t interface = *it;
-      Ptr<NetDevice> dev = ipv4->GetNetDevice (interface);
-      Ptr<Channel> channel = dev->GetChannel ();
-      uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-      Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-      uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-      Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4> ()->GetAddress (nextIf,0).GetLocal ();
-
-      m_routes.push_back (RouteEntry (interface, nextHopAddr));
-    }
-}
-
-bool Ipv4CmdSRoutingTableEntry::IsMatch (Ipv4Address dest) const
-{
-  return m_mask.IsMatch (m_dest, dest);
-}
-
-Ptr<Ipv4Route>
-Ipv4CmdSRoutingTableEntry::ConstructIpv4Route (Ptr<Ipv4> ipv4, uint32_t interface, Ipv4Address dest)
-{
-  Ptr<NetDevice> dev = ipv4->GetNetDevice (interface);
-  Ptr<Channel> channel = dev->GetChannel ();
-
-  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-  Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-  uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-  Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4> ()->GetAddress (nextIf,0).GetLocal ();
-  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (ipv4->GetNetDevice (interface));
-  route->SetGateway (nextHopAddr);
-  route->SetSource (ipv4->GetAddress (interface, 0).GetLocal ());
-  route->SetDestination (dest);
-  
-  //NS_LOG_LOGIC ("Forward " << dest << " to " << nextHopAddr);
-  
-  
-  return route;
-}
-
-bool Ipv4CmdSRoutingTableEntry::operator< (const Ipv4CmdSRoutingTableEntry &oth) const
-{
-  return m_mask.GetPrefixLength () > oth.m_mask.GetPrefixLength ();
-}
-
-Ptr<Ipv4Route> Ipv4CmdSRoutingTableEntry::GetRoute (uint32_t flowid, Ipv4Address dest, Ptr<Ipv4> ipv4,
-  const std::map<Ipv4Address, uint32_t> &queueSizeMap, bool chbest)
-{
-  
-  if (!chbest)
-    {
-      std::map<uint32_t, uint32_t>::iterator it = m_current.find (flowid);
-
-      if (it != m_current.end())
-        {
-          return Ipv4CmdSRoutingTableEntry::ConstructIpv4Route (ipv4, it->second, dest);
-        }
-    }
-    
-    NS_LOG_DEBUG (this << " getroute " << flowid);
-
-    std::vector<uint32_t> best_choices;
-    std::vector<RouteEntry>::iterator it = m_routes.begin();
-    best_choices.push_back (it->first);
-    std::map<Ipv4Address, uint32_t>::const_iterator mit = queueSizeMap.find (it->second);
-    uint32_t bestVal = mit == queueSizeMap.end () ? UINT32_MAX : mit->second; 
-
-
-    if (bestVal != UINT32_MAX) 
-      NS_LOG_DEBUG ("Best: " << it->second << " " << bestVal << " " << best_choices.size ());
-    for (++it; it != m_routes.end (); ++it)
-      {
-        mit = queueSizeMap.find (it->second);
-        uint32_t curVal = mit == queueSizeMap.end () ? UINT32_MAX : mit->second;
-        
-
-        if (curVal < bestVal)
-          {
-            best_choices.clear();
-            best_choices.push_back (it->first);
-            bestVal = curVal;
-          }
-        else if (curVal == bestVal)
-          best_choices.push_back (it->first);
-        
-        if (curVal != UINT32_MAX) 
-          NS_LOG_DEBUG ("Best: " << it->second << " " << curVal<< " " << best_choices.size ());
-      }
-    
-    
-
-    uint32_t choice = best_choices[rand() % best_choices.size ()];
-
-    /*std::map<Ipv4Address, uint32_t>::iterator _it = m_current.find (flowid);
-
-    if (_it != m_current.end ())
-      {
-        NS_LOG_DEBUG ("Switch from " << _it->second << " to " << choice);
-      }*/
-
-    m_current[flowid] = choice;
-    return Ipv4CmdSRoutingTableEntry::ConstructIpv4Route (ipv4, choice, dest);
-}
-
-Ipv4CmdSRoutingTable::Ipv4CmdSRoutingTable() : sorted (true) {}
-
-void Ipv4CmdSRoutingTable::UpdateQueueSize (Ipv4Address neighbor, uint32_t queueSize)
-{
-  m_queueSizeMap[neighbor] = queueSize;
-}
-
-void Ipv4CmdSRoutingTable::AddEntry (Ptr<Ipv4> ipv4, Ipv4Address dest, Ipv4Mask mask, 
-  const std::vector<uint32_t> &interfaces)
-{
-  m_table.push_back (Ipv4CmdSRoutingTableEntry (ipv4, dest, mask, interfaces));
-  sorted = false;
-}
-
-Ptr<Ipv4Route> Ipv4CmdSRoutingTable::Lookup (Ptr<Ipv4> ipv4, uint32_t flowid, Ipv4Address dest, bool best) 
-{
-  if (!sorted)
-    {
-      std::sort (m_table.begin (), m_table.end ());
-      sorted = true;
-    }
-
-  for (table_iterator i = m_table.begin (); i != m_table.end (); i++) 
-    if (i->IsMatch (dest))
-        return i->GetRoute (flowid, dest, ipv4, m_queueSizeMap, best);        
-  return 0;
-}
-
+#include "ipv4-cmds-routing-table.h"
+#include "ns3/simulator.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4CmdSRoutingTable");
+
+Ipv4CmdSRoutingTableEntry::Ipv4CmdSRoutingTableEntry (Ptr<Ipv4> ipv4, Ipv4Address dest, Ipv4Mask mask, 
+  const std::vector<uint32_t> &interfaces) : m_dest(dest), m_mask(mask)
+{
+  Ptr<Ipv4RouteCache> cache = Ipv4RouteCache::GetRouteCache (ipv4);
+  for (std::vector<uint32_t>::const_iterator it = interfaces.begin (); it != interfaces.end (); ++it)
+    {
+      uint32_t interface = *it;
+      m_routes.push_back (RouteEntry (interface, cache->GetGateway (interface)));
+    }
+}
+
+bool Ipv4CmdSRoutingTableEntry::IsMatch (Ipv4Address dest) const
+{
+  return m_mask.IsMatch (m_dest, dest);
+}
+
+Ptr<Ipv4Route>
+Ipv4CmdSRoutingTableEntry::ConstructIpv4Route (Ptr<Ipv4> ipv4, uint32_t interface, Ipv4Address dest)
+{
+  return Ipv4RouteCache::GetRouteCache (ipv4)->GetRoute (interface, dest);
+}
+
+bool Ipv4CmdSRoutingTableEntry::operator< (const Ipv4CmdSRoutingTableEntry &oth) const
+{
+  return m_mask.GetPrefixLength () > oth.m_mask.GetPrefixLength ();
+}
+
+Ptr<Ipv4Route> Ipv4CmdSRoutingTableEntry::GetRoute (uint32_t flowid, Ipv4Address dest, Ptr<Ipv4RouteCache> cache, Ipv4CmdSFlowTable *flows,
+  const std::map<Ipv4Address, uint32_t> &queueSizeMap, bool chbest, UniformRandomVariable &rand)
+{
+  
+  if (!chbest)
+    {
+      uint32_t current;
+      if (FindCurrent (flowid, flows, current))
+        {
+          return cache->GetRoute (current, dest);
+        }
+    }
+    
+    NS_LOG_DEBUG (this << " getroute " << flowid);
+
+    std::vector<uint32_t> best_choices;
+    std::vector<RouteEntry>::iterator it = m_routes.begin();
+    best_choices.push_back (it->first);
+    std::map<Ipv4Address, uint32_t>::const_iterator mit = queueSizeMap.find (it->second);
+    uint32_t bestVal = mit == queueSizeMap.end () ? UINT32_MAX : mit->second; 
+
+
+    if (bestVal != UINT32_MAX) 
+      NS_LOG_DEBUG ("Best: " << it->second << " " << bestVal << " " << best_choices.size ());
+    for (++it; it != m_routes.end (); ++it)
+      {
+        mit = queueSizeMap.find (it->second);
+        uint32_t curVal = mit == queueSizeMap.end () ? UINT32_MAX : mit->second;
+        
+
+        if (curVal < bestVal)
+          {
+            best_choices.clear();
+            best_choices.push_back (it->first);
+            bestVal = curVal;
+          }
+        else if (curVal == bestVal)
+          best_choices.push_back (it->first);
+        
+        if (curVal != UINT32_MAX) 
+          NS_LOG_DEBUG ("Best: " << it->second << " " << curVal<< " " << best_choices.size ());
+      }
+    
+    
+
+    uint32_t choice = best_choices[rand.GetInteger (0, best_choices.size () - 1)];
+
+    /*std::map<Ipv4Address, uint32_t>::iterator _it = m_current.find (flowid);
+
+    if (_it != m_current.end ())
+      {
+        NS_LOG_DEBUG ("Switch from " << _it->second << " to " << choice);
+      }*/
+
+    SetCurrent (flowid, flows, choice);
+    return cache->GetRoute (choice, dest);
+}
+
+Ptr<Ipv4Route> Ipv4CmdSRoutingTableEntry::GetRoute (uint32_t flowid, Ipv4Address dest, Ptr<Ipv4RouteCache> cache, Ipv4CmdSFlowTable *flows,
+  const NextHop *begin, const NextHop *end, const std::vector<uint32_t> &queueSizes, bool chbest,
+  UniformRandomVariable &rand)
+{
+  if (!chbest)
+    {
+      uint32_t current;
+      if (FindCurrent (flowid, flows, current))
+        {
+          return cache->GetRoute (current, dest);
+        }
+    }
+
+  // Count the ties first and then pick the n-th one, which draws the same
+  // interface as the best_choices vector of the uncompiled path without
+  // allocating anything per packet
+  uint32_t bestVal = queueSizes[begin->neighbor];
+  uint32_t nbest = 0;
+  for (const NextHop *it = begin; it != end; ++it)
+    {
+      uint32_t curVal = queueSizes[it->neighbor];
+      if (curVal < bestVal)
+        {
+          bestVal = curVal;
+          nbest = 1;
+        }
+      else if (curVal == bestVal)
+        nbest++;
+    }
+
+  uint32_t pick = rand.GetInteger (0, nbest - 1);
+  uint32_t choice = begin->interface;
+  for (const NextHop *it = begin; it != end; ++it)
+    {
+      if (queueSizes[it->neighbor] == bestVal && pick-- == 0)
+        {
+          choice = it->interface;
+          break;
+        }
+    }
+
+  SetCurrent (flowid, flows, choice);
+  return cache->GetRoute (choice, dest);
+}
+
+bool Ipv4CmdSRoutingTableEntry::FindCurrent (uint32_t flowid, Ipv4CmdSFlowTable *flows, uint32_t &interface) const
+{
+  if (flows != 0)
+    {
+      return flows->Lookup (flowid, interface);
+    }
+
+  std::map<uint32_t, uint32_t>::const_iterator it = m_current.find (flowid);
+  if (it == m_current.end ())
+    {
+      return false;
+    }
+  interface = it->second;
+  return true;
+}
+
+void Ipv4CmdSRoutingTableEntry::SetCurrent (uint32_t flowid, Ipv4CmdSFlowTable *flows, uint32_t interface)
+{
+  if (flows != 0)
+    {
+      flows->Insert (flowid, interface);
+    }
+  else
+    {
+      m_current[flowid] = interface;
+    }
+}
+
+Ipv4Address Ipv4CmdSRoutingTableEntry::GetDest (void) const
+{
+  return m_dest;
+}
+
+Ipv4Mask Ipv4CmdSRoutingTableEntry::GetMask (void) const
+{
+  return m_mask;
+}
+
+const std::vector<Ipv4CmdSRoutingTableEntry::RouteEntry> &Ipv4CmdSRoutingTableEntry::GetRoutes (void) const
+{
+  return m_routes;
+}
+
+const uint32_t Ipv4CmdSRoutingTable::TRIE_CHILD;
+const uint32_t Ipv4CmdSRoutingTable::TRIE_STRIDE;
+const uint32_t Ipv4CmdSRoutingTable::TRIE_FANOUT;
+
+Ipv4CmdSRoutingTable::Ipv4CmdSRoutingTable() : sorted (true), m_compiled (false), m_dirty (true)
+{
+  m_rand = CreateObject<UniformRandomVariable> ();
+}
+
+void Ipv4CmdSRoutingTable::UpdateQueueSize (Ipv4Address neighbor, uint32_t queueSize)
+{
+  m_queueSizeMap[neighbor] = queueSize;
+  m_queueSizes[GetNeighborIndex (neighbor)] = queueSize;
+}
+
+uint32_t Ipv4CmdSRoutingTable::GetQueueSize (Ipv4Address neighbor) const
+{
+  std::map<Ipv4Address, uint32_t>::const_iterator it = m_queueSizeMap.find (neighbor);
+  return it == m_queueSizeMap.end () ? UINT32_MAX : it->second;
+}
+
+void Ipv4CmdSRoutingTable::AddEntry (Ptr<Ipv4> ipv4, Ipv4Address dest, Ipv4Mask mask, 
+  const std::vector<uint32_t> &interfaces)
+{
+  m_table.push_back (Ipv4CmdSRoutingTableEntry (ipv4, dest, mask, interfaces));
+  sorted = false;
+  m_dirty = true;
+}
+
+void Ipv4CmdSRoutingTable::SetCompiled (bool compiled)
+{
+  m_compiled = compiled;
+}
+
+bool Ipv4CmdSRoutingTable::IsCompiled (void) const
+{
+  return m_compiled;
+}
+
+uint32_t Ipv4CmdSRoutingTable::GetNeighborIndex (Ipv4Address neighbor)
+{
+  std::map<Ipv4Address, uint32_t>::iterator it = m_neighborIndex.find (neighbor);
+  if (it != m_neighborIndex.end ())
+    {
+      return it->second;
+    }
+
+  uint32_t index = m_queueSizes.size ();
+  m_neighborIndex[neighbor] = index;
+  m_queueSizes.push_back (UINT32_MAX);
+  return index;
+}
+
+uint32_t Ipv4CmdSRoutingTable::NewTrieNode (uint32_t fill)
+{
+  uint32_t node = m_trie.size () / TRIE_FANOUT;
+  m_trie.insert (m_trie.end (), TRIE_FANOUT, fill);
+  return node;
+}
+
+void Ipv4CmdSRoutingTable::InsertPrefix (uint32_t prefix, uint32_t length, uint32_t value)
+{
+  // Prefixes are inserted shortest first, so a slot can only point at a
+  // child when the child was created by an earlier prefix of at most the
+  // same length, and overwriting the whole expanded range is correct
+  uint32_t node = 0;
+  for (uint32_t level = 0; ; ++level)
+    {
+      uint32_t shift = 32 - TRIE_STRIDE * (level + 1);
+      uint32_t slot = (prefix >> shift) & (TRIE_FANOUT - 1);
+      uint32_t depth = TRIE_STRIDE * (level + 1);
+
+      if (length <= depth)
+        {
+          uint32_t span = 1u << (depth - length);
+          slot &= ~(span - 1);
+          for (uint32_t i = slot; i < slot + span; ++i)
+            {
+              m_trie[node * TRIE_FANOUT + i] = value;
+            }
+          return;
+        }
+
+      uint32_t cur = m_trie[node * TRIE_FANOUT + slot];
+      if (cur & TRIE_CHILD)
+        {
+          node = cur & ~TRIE_CHILD;
+        }
+      else
+        {
+          uint32_t child = NewTrieNode (cur);
+          m_trie[node * TRIE_FANOUT + slot] = child | TRIE_CHILD;
+          node = child;
+        }
+    }
+}
+
+uint32_t Ipv4CmdSRoutingTable::LookupTrie (uint32_t dest) const
+{
+  uint32_t node = 0;
+  uint32_t shift = 32;
+  uint32_t cur;
+  do
+    {
+      shift -= TRIE_STRIDE;
+      cur = m_trie[node * TRIE_FANOUT + ((dest >> shift) & (TRIE_FANOUT - 1))];
+      node = cur & ~TRIE_CHILD;
+    }
+  while (cur & TRIE_CHILD);
+  return cur;
+}
+
+void Ipv4CmdSRoutingTable::Compile (void)
+{
+  NS_LOG_FUNCTION (this << m_table.size ());
+
+  if (!sorted)
+    {
+      std::sort (m_table.begin (), m_table.end ());
+      sorted = true;
+    }
+
+  m_nextHops.clear ();
+  m_groups.clear ();
+  m_trie.clear ();
+  NewTrieNode (0);
+
+  for (uint32_t i = 0; i < m_table.size (); ++i)
+    {
+      const std::vector<Ipv4CmdSRoutingTableEntry::RouteEntry> &routes = m_table[i].GetRoutes ();
+      Group group;
+      group.entry = i;
+      group.offset = m_nextHops.size ();
+      group.count = routes.size ();
+      for (std::vector<Ipv4CmdSRoutingTableEntry::RouteEntry>::const_iterator it = routes.begin ();
+           it != routes.end (); ++it)
+        {
+          Ipv4CmdSRoutingTableEntry::NextHop hop;
+          hop.interface = it->first;
+          hop.neighbor = GetNeighborIndex (it->second);
+          m_nextHops.push_back (hop);
+        }
+      m_groups.push_back (group);
+    }
+
+  // m_table is sorted longest prefix first; walk it backwards so that when
+  // two entries share a prefix, the one the linear scan would hit first wins
+  for (uint32_t i = m_table.size (); i-- > 0; )
+    {
+      if (m_groups[i].count == 0)
+        {
+          continue;
+        }
+      uint32_t length = m_table[i].GetMask ().GetPrefixLength ();
+      uint32_t prefix = m_table[i].GetDest ().CombineMask (m_table[i].GetMask ()).Get ();
+      InsertPrefix (prefix, length, i + 1);
+    }
+
+  m_dirty = false;
+}
+
+Ipv4CmdSFlowTable &Ipv4CmdSRoutingTable::GetFlowTable (void)
+{
+  return m_flowTable;
+}
+
+const Ipv4CmdSFlowTable &Ipv4CmdSRoutingTable::GetFlowTable (void) const
+{
+  return m_flowTable;
+}
+
+int64_t Ipv4CmdSRoutingTable::AssignStreams (int64_t stream)
+{
+  m_rand->SetStream (stream);
+  return 1;
+}
+
+void Ipv4CmdSRoutingTable::SetRouteCache (Ptr<Ipv4RouteCache> cache)
+{
+  m_routeCache = cache;
+}
+
+Ptr<Ipv4Route> Ipv4CmdSRoutingTable::Lookup (Ptr<Ipv4> ipv4, uint32_t flowid, Ipv4Address dest, bool best) 
+{
+  if (m_routeCache == 0)
+    {
+      m_routeCache = Ipv4RouteCache::GetRouteCache (ipv4);
+    }
+
+  Ipv4CmdSFlowTable *flows = m_flowTable.GetSize () > 0 ? &m_flowTable : 0;
+
+  if (m_compiled)
+    {
+      if (m_dirty)
+        {
+          Compile ();
+        }
+
+      uint32_t leaf = LookupTrie (dest.Get ());
+      if (leaf == 0)
+        {
+          return 0;
+        }
+      const Group &group = m_groups[leaf - 1];
+      const Ipv4CmdSRoutingTableEntry::NextHop *begin = &m_nextHops[group.offset];
+      return m_table[group.entry].GetRoute (flowid, dest, m_routeCache, flows, begin, begin + group.count, m_queueSizes, best, *m_rand);
+    }
+
+  if (!sorted)
+    {
+      std::sort (m_table.begin (), m_table.end ());
+      sorted = true;
+    }
+
+  for (table_iterator i = m_table.begin (); i != m_table.end (); i++) 
+    if (i->IsMatch (dest))
+        return i->GetRoute (flowid, dest, m_routeCache, flows, m_queueSizeMap, best, *m_rand);        
+  return 0;
+}
+
+Ptr<Ipv4Route> Ipv4CmdSRoutingTable::LookupP4 (Ptr<Ipv4> ipv4, Ipv4CmdSP4Pipeline &pipeline,
+  const Ipv4CmdSP4Pipeline::FlowKey &key, uint32_t ts, Ipv4Address dest)
+{
+  if (m_routeCache == 0)
+    {
+      m_routeCache = Ipv4RouteCache::GetRouteCache (ipv4);
+    }
+
+  // fib_lpm_t is always a real LPM table on the switch
+  if (m_dirty)
+    {
+      Compile ();
+    }
+
+  uint32_t leaf = LookupTrie (dest.Get ());
+  if (leaf == 0)
+    {
+      return 0;
+    }
+  const Group &group = m_groups[leaf - 1];
+  const Ipv4CmdSRoutingTableEntry::NextHop *hops = &m_nextHops[group.offset];
+
+  // The control plane fills findecmphop_t round-robin over the group and
+  // points findleast at the least loaded hop of the group
+  uint32_t ecmpTable[Ipv4CmdSP4Pipeline::ECMP_TABLE_SIZE];
+  for (uint32_t i = 0; i < Ipv4CmdSP4Pipeline::ECMP_TABLE_SIZE; ++i)
+    {
+      ecmpTable[i] = hops[i % group.count].interface;
+    }
+  uint32_t leastHop = hops[0].interface;
+  uint32_t leastVal = m_queueSizes[hops[0].neighbor];
+  for (uint32_t i = 1; i < group.count; ++i)
+    {
+      if (m_queueSizes[hops[i].neighbor] < leastVal)
+        {
+          leastHop = hops[i].interface;
+          leastVal = m_queueSizes[hops[i].neighbor];
+        }
+    }
+
+  // A remembered hop written by a colliding flow of another group is used
+  // as is, like on the hardware; port 0 (never written) has no ns-3
+  // counterpart and falls back to the least loaded hop
+  uint32_t port = pipeline.Process (key, ts, ecmpTable, leastHop);
+  if (port == 0)
+    {
+      port = leastHop;
+    }
+  return m_routeCache->GetRoute (port, dest);
+}
+
 }
\ No newline at end of file
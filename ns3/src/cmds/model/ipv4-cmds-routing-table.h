@@ -1,61 +1,147 @@
-#ifndef NS3_IPV4_CMDS_ROUTING_TABLE
-#define NS3_IPV4_CMDS_ROUTING_TABLE
-
-#include "ns3/ptr.h"
-#include "ns3/ipv4.h"
-#include "ns3/ipv4-header.h"
-#include "ns3/ipv4-route.h"
-
-#include <map>
-#include <vector>
-
-
-
-namespace ns3 {
-
-class Ipv4CmdSRoutingTableEntry {
-public:
-  typedef std::pair<uint32_t, Ipv4Address> RouteEntry;
-
-  Ipv4CmdSRoutingTableEntry (Ptr<Ipv4> ipv4, Ipv4Address dest, Ipv4Mask mask, const std::vector<uint32_t> &interfaces);
-
-  static Ptr<Ipv4Route> ConstructIpv4Route (Ptr<Ipv4> ipv4, uint32_t interface, Ipv4Address dest);
-
-  Ptr<Ipv4Route> GetRoute (uint32_t flowid, Ipv4Address dest, Ptr<Ipv4> ipv4,
-    const std::map<Ipv4Address, uint32_t> &queueSizeMap, bool best);
-
-  bool IsMatch (Ipv4Address dest) const;
-
-  bool operator< (const Ipv4CmdSRoutingTableEntry &oth) const;
-
-private:
-  Ipv4Address m_dest;
-  Ipv4Mask m_mask;
-
-  std::vector<RouteEntry> m_routes;
-  std::map<uint32_t, uint32_t> m_current; // from flowid to interface
-};
-
-class Ipv4CmdSRoutingTable {
-public:
-  Ipv4CmdSRoutingTable ();
-
-  Ptr<Ipv4Route> Lookup (Ptr<Ipv4> ipv4, uint32_t flowid, Ipv4Address dest, bool best = false);
-
-  void UpdateQueueSize (Ipv4Address neighbor, uint32_t queueSize);
-
-  void AddEntry (Ptr<Ipv4> ipv4, Ipv4Address dest, Ipv4Mask mask, const std::vector<uint32_t> &interfaces);
-
-private:
-  typedef std::vector<Ipv4CmdSRoutingTableEntry>::iterator table_iterator;
-
-  std::map<Ipv4Address, uint32_t> m_queueSizeMap;
-
-  std::vector<Ipv4CmdSRoutingTableEntry> m_table;
-
-  bool sorted;
-};
-
-}
-
+#ifndef NS3_IPV4_CMDS_ROUTING_TABLE
+#define NS3_IPV4_CMDS_ROUTING_TABLE
+
+#include "ns3/ptr.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-route-cache.h"
+#include "ns3/ipv4-cmds-flow-table.h"
+#include "ns3/ipv4-cmds-p4-pipeline.h"
+#include "ns3/random-variable-stream.h"
+
+#include <map>
+#include <vector>
+
+
+
+namespace ns3 {
+
+class Ipv4CmdSRoutingTableEntry {
+public:
+  typedef std::pair<uint32_t, Ipv4Address> RouteEntry;
+
+  // One next hop of the compiled table: output interface and dense neighbor index
+  struct NextHop
+  {
+    uint32_t interface;
+    uint32_t neighbor;
+  };
+
+  Ipv4CmdSRoutingTableEntry (Ptr<Ipv4> ipv4, Ipv4Address dest, Ipv4Mask mask, const std::vector<uint32_t> &interfaces);
+
+  static Ptr<Ipv4Route> ConstructIpv4Route (Ptr<Ipv4> ipv4, uint32_t interface, Ipv4Address dest);
+
+  Ptr<Ipv4Route> GetRoute (uint32_t flowid, Ipv4Address dest, Ptr<Ipv4RouteCache> cache, Ipv4CmdSFlowTable *flows,
+    const std::map<Ipv4Address, uint32_t> &queueSizeMap, bool best, UniformRandomVariable &rand);
+
+  // Same decision as above, but over a compiled next hop span with queue sizes indexed by neighbor
+  Ptr<Ipv4Route> GetRoute (uint32_t flowid, Ipv4Address dest, Ptr<Ipv4RouteCache> cache, Ipv4CmdSFlowTable *flows,
+    const NextHop *begin, const NextHop *end, const std::vector<uint32_t> &queueSizes, bool best,
+    UniformRandomVariable &rand);
+
+  bool IsMatch (Ipv4Address dest) const;
+
+  Ipv4Address GetDest (void) const;
+  Ipv4Mask GetMask (void) const;
+  const std::vector<RouteEntry> &GetRoutes (void) const;
+
+  bool operator< (const Ipv4CmdSRoutingTableEntry &oth) const;
+
+private:
+  // Pinned interfaces live in flows when bounded, in m_current otherwise
+  bool FindCurrent (uint32_t flowid, Ipv4CmdSFlowTable *flows, uint32_t &interface) const;
+  void SetCurrent (uint32_t flowid, Ipv4CmdSFlowTable *flows, uint32_t interface);
+
+  Ipv4Address m_dest;
+  Ipv4Mask m_mask;
+
+  std::vector<RouteEntry> m_routes;
+  std::map<uint32_t, uint32_t> m_current; // from flowid to interface
+};
+
+class Ipv4CmdSRoutingTable {
+public:
+  Ipv4CmdSRoutingTable ();
+
+  Ptr<Ipv4Route> Lookup (Ptr<Ipv4> ipv4, uint32_t flowid, Ipv4Address dest, bool best = false);
+
+  // Forwarding decision of the cmds.p4 data plane, with this table as fib_lpm_t
+  Ptr<Ipv4Route> LookupP4 (Ptr<Ipv4> ipv4, Ipv4CmdSP4Pipeline &pipeline,
+    const Ipv4CmdSP4Pipeline::FlowKey &key, uint32_t ts, Ipv4Address dest);
+
+  void UpdateQueueSize (Ipv4Address neighbor, uint32_t queueSize);
+
+  // Last queue size heard from neighbor, UINT32_MAX if none yet
+  uint32_t GetQueueSize (Ipv4Address neighbor) const;
+
+  void AddEntry (Ptr<Ipv4> ipv4, Ipv4Address dest, Ipv4Mask mask, const std::vector<uint32_t> &interfaces);
+
+  /**
+   * \brief Enable or disable the compiled lookup path.
+   *
+   * When enabled, the first Lookup after the last AddEntry builds a
+   * stride-8 multibit trie (with leaf pushing) over all entries, whose
+   * leaves point at contiguous (interface, neighbor index) spans, and
+   * queue sizes are read from a dense vector indexed by neighbor.
+   */
+  void SetCompiled (bool compiled);
+  bool IsCompiled (void) const;
+
+  void Compile (void);
+
+  // Routes are handed out by the node's shared cache, resolved from ipv4 on first lookup if unset
+  void SetRouteCache (Ptr<Ipv4RouteCache> cache);
+
+  // Bounded flow table shared by all entries, used instead of the per-entry maps once sized
+  Ipv4CmdSFlowTable &GetFlowTable (void);
+  const Ipv4CmdSFlowTable &GetFlowTable (void) const;
+
+  // Ties between the best interfaces are broken with a stream of the table
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  typedef std::vector<Ipv4CmdSRoutingTableEntry>::iterator table_iterator;
+
+  static const uint32_t TRIE_CHILD = 0x80000000u;
+  static const uint32_t TRIE_STRIDE = 8;
+  static const uint32_t TRIE_FANOUT = 1u << TRIE_STRIDE;
+
+  // Span of m_nextHops owned by one entry of m_table
+  struct Group
+  {
+    uint32_t entry;
+    uint32_t offset;
+    uint32_t count;
+  };
+
+  uint32_t GetNeighborIndex (Ipv4Address neighbor);
+  uint32_t NewTrieNode (uint32_t fill);
+  void InsertPrefix (uint32_t prefix, uint32_t length, uint32_t value);
+  uint32_t LookupTrie (uint32_t dest) const;
+
+  Ptr<Ipv4RouteCache> m_routeCache;
+  Ptr<UniformRandomVariable> m_rand;
+
+  std::map<Ipv4Address, uint32_t> m_queueSizeMap;
+
+  Ipv4CmdSFlowTable m_flowTable;
+
+  std::vector<Ipv4CmdSRoutingTableEntry> m_table;
+
+  bool sorted;
+
+  bool m_compiled;
+  bool m_dirty;
+
+  std::map<Ipv4Address, uint32_t> m_neighborIndex;
+  std::vector<uint32_t> m_queueSizes;         // indexed by neighbor index
+
+  std::vector<Ipv4CmdSRoutingTableEntry::NextHop> m_nextHops;
+  std::vector<Group> m_groups;
+  std::vector<uint32_t> m_trie;               // TRIE_FANOUT slots per node, node 0 is the root
+};
+
+}
+
 #endif
\ No newline at end of file
@@ -1,265 +1,639 @@
-/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
-
-#include "ipv4-cmds-routing.h"
-
-#include "ns3/log.h"
-#include "ns3/simulator.h"
-#include "ns3/net-device.h"
-#include "ns3/channel.h"
-#include "ns3/node.h"
-#include "ns3/udp-socket-factory.h"
-#include "ns3/flow-id-tag.h"
-
-#include "ns3/ipv4-cmds-tag.h"
-
-#include <algorithm>
-
-#define LOOPBACK_PORT 0
-
-namespace ns3 {
-
-NS_LOG_COMPONENT_DEFINE("Ipv4CmdSRouting");
-
-NS_OBJECT_ENSURE_REGISTERED (Ipv4CmdSRouting);
-
-Ipv4CmdSRouting::Ipv4CmdSRouting ()
-    // Parameters
-    : m_syncPeriod (MilliSeconds (10)),
-    m_syncEvent (),
-    m_ipv4 (0)
-{
-  NS_LOG_FUNCTION (this);
-}
-
-Ipv4CmdSRouting::~Ipv4CmdSRouting ()
-{
-  NS_LOG_FUNCTION (this);
-}
-
-TypeId
-Ipv4CmdSRouting::GetTypeId (void)
-{
-  static TypeId tid = TypeId("ns3::Ipv4CmdSRouting")
-      .SetParent<Object>()
-      .SetGroupName ("Internet")
-      .AddConstructor<Ipv4CmdSRouting> ();
-
-  return tid;
-}
-
-Ptr<Ipv4Route>
-Ipv4CmdSRouting::RouteOutput (Ptr<Packet> packet, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
-{
-  NS_LOG_ERROR (this << " CmdS routing is not support for local routing output");
-  return 0;
-}
-
-void
-Ipv4CmdSRouting::HandleMessage (Ptr<const Packet> packet, const Ipv4Header &header)
-{
-  NS_LOG_DEBUG (GetObject<Node> () << " HandleMessage");
-  
-  Ipv4CmdSTag tag;
-  packet->PeekPacketTag (tag);
-
-  uint32_t queueSize = tag.GetQueueSize ();
-
-  NS_ASSERT (queueSize != Ipv4CmdSTag::DO_SWITCH && queueSize != Ipv4CmdSTag::NO_SWITCH);
-
-  Ipv4Address dest = header.GetDestination ();
-  m_rtable.UpdateQueueSize (dest, queueSize);
-}
-
-void
-Ipv4CmdSRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, std::vector<uint32_t> interfaces)
-{
-  NS_LOG_LOGIC (GetObject<Node> () << " AddRoute: " << network << " " << networkMask);
-  m_rtable.AddEntry (m_ipv4, network, networkMask, interfaces);
-}
-
-void
-Ipv4CmdSRouting::SendMessage (uint32_t npkt) 
-{
-  Ptr<Packet> packet = Create<Packet> (1);
-  Ipv4CmdSTag tag;
-  tag.SetQueueSize (npkt);
-  packet->AddPacketTag (tag);
-  m_socket->Send (packet);
-}
-
-void
-Ipv4CmdSRouting::SyncQueueSize () 
-{ 
-  uint32_t tot = 0;
-
-  
-
-  for (std::vector<Ptr<Queue> >::iterator it = m_queues.begin (); it != m_queues.end (); ++it)
-    {
-      tot += (*it)->GetNPackets ();
-    }
-  
-NS_LOG_DEBUG (GetObject<Node> () << " Sync " << tot << " " << m_queues.size ());
-
-  SendMessage (tot);
-
-  m_syncEvent = Simulator::Schedule (m_syncPeriod, &Ipv4CmdSRouting::SyncQueueSize, this);
-}
-
-void
-Ipv4CmdSRouting::Start ()
-{
-  NS_LOG_DEBUG ("Object " << GetObject<Node> ());
-  m_socket = Socket::CreateSocket (GetObject<Node> (), UdpSocketFactory::GetTypeId ());
-  m_socket->SetAllowBroadcast (true);
-  m_socket->Bind ();
-  m_socket->Connect (Address (InetSocketAddress ("255.255.255.255", 9)));
-  m_syncEvent = Simulator::ScheduleNow (&Ipv4CmdSRouting::SyncQueueSize, this);
-}
-
-void
-Ipv4CmdSRouting::AddQueue (Ptr<Queue> queue)
-{
-  m_queues.push_back (queue);
-}
-
-bool
-Ipv4CmdSRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
-                           UnicastForwardCallback ucb, MulticastForwardCallback mcb,
-                           LocalDeliverCallback lcb, ErrorCallback ecb)
-{
-  NS_LOG_LOGIC (GetObject<Node> () << " RouteInput: " << "Ip header: " << header);
-
-  NS_ASSERT (m_ipv4->GetInterfaceForDevice (idev) >= 0);
-
-  Ptr<Packet> packet = ConstCast<Packet> (p);
-
-  Ipv4Address srcAddress = header.GetSource ();
-  Ipv4Address destAddress = header.GetDestination ();
-
-  FlowIdTag ftag;
-  packet->PeekPacketTag (ftag);
-  uint32_t flowid = ftag.GetFlowId ();
-
-  // CmdS routing only supports unicast
-  if (destAddress.IsMulticast ()) 
-    {
-      NS_LOG_ERROR (this << " CmdS routing only supports unicast");
-      ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
-      return false;
-    }
-
-  // Check if input device supports IP forwarding
-  uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
-  if (m_ipv4->IsForwarding (iif) == false) 
-    {
-      NS_LOG_ERROR (this << " Forwarding disabled for this interface");
-      ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
-      return false;
-    }
-
-  /*if (destAddress.IsBroadcast ())
-    {
-      NS_LOG_DEBUG (GetObject<Node> () << " Broadcast " << srcAddress);
-      HandleMessage (p, header);
-      return true;
-    }*/
-
-  if (m_ipv4->IsDestinationAddress (header.GetDestination (), iif))
-    {
-      Ipv4CmdSTag tag;
-      packet->PeekPacketTag (tag);
-
-      uint32_t queueSize = tag.GetQueueSize ();
-      
-      NS_LOG_DEBUG ("!!! " << srcAddress << " " <<  destAddress << " | " << queueSize);
-
-      if (queueSize != Ipv4CmdSTag::DO_SWITCH && queueSize != Ipv4CmdSTag::NO_SWITCH)
-        {
-          m_rtable.UpdateQueueSize (srcAddress, queueSize);
-          return true;
-        }
-
-
-      
-      
-      if (!lcb.IsNull ())
-        {
-          NS_LOG_LOGIC ("Local delivery to " << header.GetDestination ());
-          lcb (p, header, iif);
-          return true;
-        }
-      else
-        {
-          // The local delivery callback is null.  This may be a multicast
-          // or broadcast packet, so return false so that another
-          // multicast routing protocol can handle it.  It should be possible
-          // to extend this to explicitly check whether it is a unicast
-          // packet, and invoke the error callback if so
-          return false;
-        }
-    }
-
-  Ipv4CmdSTag tag;
-  packet->PeekPacketTag (tag);
-
-  Ptr<Ipv4Route> rtentry = m_rtable.Lookup (m_ipv4, flowid, destAddress, tag.GetQueueSize () == Ipv4CmdSTag::DO_SWITCH);
-  if (rtentry != 0)
-    {
-      NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
-      ucb (rtentry, p, header);
-      return true;
-    }
-  else
-    {
-      NS_LOG_ERROR ("Did not find unicast destination- returning false");
-      return false; // Let other routing protocols try to handle this
-                    // route request.
-    }
-}
-
-void
-Ipv4CmdSRouting::NotifyInterfaceUp (uint32_t interface)
-{
-}
-
-void
-Ipv4CmdSRouting::NotifyInterfaceDown (uint32_t interface)
-{
-}
-
-void
-Ipv4CmdSRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
-{
-}
-
-void
-Ipv4CmdSRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
-{
-}
-
-void
-Ipv4CmdSRouting::SetIpv4 (Ptr<Ipv4> ipv4)
-{
-  NS_LOG_INFO (this << "Setting up Ipv4: " << ipv4);
-  NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
-  m_ipv4 = ipv4;
-  Simulator::ScheduleNow (&Ipv4CmdSRouting::Start, this);
-}
-
-void
-Ipv4CmdSRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
-{
-}
-
-
-void
-Ipv4CmdSRouting::DoDispose (void)
-{
-  m_syncEvent.Cancel ();
-  m_socket->Close ();
-  m_ipv4 = 0;
-  Ipv4RoutingProtocol::DoDispose ();
-}
-
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ipv4-cmds-routing.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/node.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/pointer.h"
+#include "ns3/double.h"
+
+#include <algorithm>
+
+#define LOOPBACK_PORT 0
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("Ipv4CmdSRouting");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv4CmdSRouting);
+
+Ipv4CmdSRouting::Ipv4CmdSRouting ()
+    // Parameters
+    : m_p4DataPlane (false),
+    m_syncPeriod (MilliSeconds (10)),
+    m_syncMetric (METRIC_PACKETS),
+    m_queueSync (SYNC_BROADCAST),
+    m_telemetrySampleRatio (1),
+    m_syncMessages (0),
+    m_telemetryStamps (0),
+    m_telemetryUpdates (0),
+    m_ipv4 (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_syncTick.SetFunction (MakeCallback (&Ipv4CmdSRouting::SyncQueueSize, this));
+}
+
+Ipv4CmdSRouting::~Ipv4CmdSRouting ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TypeId
+Ipv4CmdSRouting::GetTypeId (void)
+{
+  static TypeId tid = TypeId("ns3::Ipv4CmdSRouting")
+      .SetParent<Object>()
+      .SetGroupName ("Internet")
+      .AddConstructor<Ipv4CmdSRouting> ()
+      .AddAttribute ("CompiledFib", "Whether to compile the routing table into a trie with dense next hop arrays on first lookup",
+                     BooleanValue (false),
+                     MakeBooleanAccessor (&Ipv4CmdSRouting::SetCompiledFib,
+                                          &Ipv4CmdSRouting::GetCompiledFib),
+                     MakeBooleanChecker ())
+      .AddAttribute ("FlowTableSize", "Number of slots of the bounded flow table, 0 keeps an unbounded map per route entry",
+                     UintegerValue (0),
+                     MakeUintegerAccessor (&Ipv4CmdSRouting::SetFlowTableSize,
+                                           &Ipv4CmdSRouting::GetFlowTableSize),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("FlowTableAgingTime", "Idle time after which a flow table entry expires, 0 to never expire",
+                     TimeValue (Time (0)),
+                     MakeTimeAccessor (&Ipv4CmdSRouting::SetFlowTableAgingTime,
+                                       &Ipv4CmdSRouting::GetFlowTableAgingTime),
+                     MakeTimeChecker ())
+      .AddAttribute ("FlowTableMaxProbes", "Number of consecutive slots probed from the hashed slot of a flow",
+                     UintegerValue (4),
+                     MakeUintegerAccessor (&Ipv4CmdSRouting::SetFlowTableMaxProbes,
+                                           &Ipv4CmdSRouting::GetFlowTableMaxProbes),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("FlowTableEviction", "What to do with a new flow when all its probed slots hold live flows",
+                     EnumValue (Ipv4CmdSFlowTable::EVICT_LRU),
+                     MakeEnumAccessor (&Ipv4CmdSRouting::SetFlowTableEviction,
+                                       &Ipv4CmdSRouting::GetFlowTableEviction),
+                     MakeEnumChecker (Ipv4CmdSFlowTable::EVICT_LRU, "Lru",
+                                      Ipv4CmdSFlowTable::EVICT_OVERWRITE, "Overwrite",
+                                      Ipv4CmdSFlowTable::EVICT_NONE, "None"))
+      .AddAttribute ("P4DataPlane", "Whether to forward with the behavioral model of the cmds.p4 pipeline instead of exact per-flow state",
+                     BooleanValue (false),
+                     MakeBooleanAccessor (&Ipv4CmdSRouting::m_p4DataPlane),
+                     MakeBooleanChecker ())
+      .AddAttribute ("P4RegisterSize", "Number of slots of each register array of the cmds.p4 pipeline",
+                     UintegerValue (0xFFFF),
+                     MakeUintegerAccessor (&Ipv4CmdSRouting::SetP4RegisterSize),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("P4K", "Increment of the frequency sketch on a matching id (k in cmds.p4)",
+                     UintegerValue (5),
+                     MakeUintegerAccessor (&Ipv4CmdSRouting::SetP4K),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("P4Thresh", "Flowlet gap of the pipeline in timestamp units, i.e. nanoseconds (thresh in cmds.p4)",
+                     UintegerValue (5),
+                     MakeUintegerAccessor (&Ipv4CmdSRouting::SetP4Thresh),
+                     MakeUintegerChecker<uint32_t> ())
+      .AddAttribute ("QueueSync", "How queue sizes reach the neighbors: periodic UDP broadcast or in-band on forwarded packets",
+                     EnumValue (SYNC_BROADCAST),
+                     MakeEnumAccessor (&Ipv4CmdSRouting::SetQueueSyncMode),
+                     MakeEnumChecker (SYNC_BROADCAST, "Broadcast",
+                                      SYNC_INBAND, "InBand"))
+      .AddAttribute ("TelemetrySampleRatio", "Only one in this many packets carrying in-band telemetry on an interface updates the queue size of its neighbor",
+                     UintegerValue (1),
+                     MakeUintegerAccessor (&Ipv4CmdSRouting::SetTelemetrySampleRatio),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("SyncPeriod", "Interval between two queue size broadcasts",
+                     TimeValue (MilliSeconds (10)),
+                     MakeTimeAccessor (&Ipv4CmdSRouting::SetSyncPeriod),
+                     MakeTimeChecker ())
+      .AddAttribute ("SyncMetric", "Load reported by the queue size broadcast",
+                     EnumValue (METRIC_PACKETS),
+                     MakeEnumAccessor (&Ipv4CmdSRouting::SetSyncMetric),
+                     MakeEnumChecker (METRIC_PACKETS, "Packets",
+                                      METRIC_AVG_PACKETS, "AveragePackets",
+                                      METRIC_DRE_BYTES, "DreBytes"))
+      .AddAttribute ("QueueEwmaGain", "Weight of the current depth in the EWMA of each queue",
+                     DoubleValue (0.125),
+                     MakeDoubleAccessor (&Ipv4CmdSRouting::SetQueueEwmaGain),
+                     MakeDoubleChecker<double> (0.0, 1.0))
+      .AddAttribute ("Alpha", "Decay factor of the DRE of each queue",
+                     DoubleValue (0.2),
+                     MakeDoubleAccessor (&Ipv4CmdSRouting::SetAlpha),
+                     MakeDoubleChecker<double> (0.0, 1.0))
+      .AddAttribute ("TDre", "Decay period of the DRE of each queue",
+                     TimeValue (MicroSeconds (200)),
+                     MakeTimeAccessor (&Ipv4CmdSRouting::SetTDre),
+                     MakeTimeChecker ());
+
+  return tid;
+}
+
+Ptr<Ipv4Route>
+Ipv4CmdSRouting::RouteOutput (Ptr<Packet> packet, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
+{
+  NS_LOG_ERROR (this << " CmdS routing is not support for local routing output");
+  return 0;
+}
+
+void
+Ipv4CmdSRouting::HandleMessage (Ptr<const Packet> packet, const Ipv4Header &header)
+{
+  NS_LOG_DEBUG (GetObject<Node> () << " HandleMessage");
+  
+  Ipv4CmdSTag tag;
+  packet->PeekPacketTag (tag);
+
+  uint32_t queueSize = tag.GetQueueSize ();
+
+  NS_ASSERT (queueSize != Ipv4CmdSTag::DO_SWITCH && queueSize != Ipv4CmdSTag::NO_SWITCH);
+
+  Ipv4Address dest = header.GetDestination ();
+  m_rtable.UpdateQueueSize (dest, queueSize);
+}
+
+void
+Ipv4CmdSRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, std::vector<uint32_t> interfaces)
+{
+  NS_LOG_LOGIC (GetObject<Node> () << " AddRoute: " << network << " " << networkMask);
+  m_rtable.AddEntry (m_ipv4, network, networkMask, interfaces);
+}
+
+void
+Ipv4CmdSRouting::SetCompiledFib (bool compiled)
+{
+  m_rtable.SetCompiled (compiled);
+}
+
+bool
+Ipv4CmdSRouting::GetCompiledFib (void) const
+{
+  return m_rtable.IsCompiled ();
+}
+
+void
+Ipv4CmdSRouting::SetFlowTableSize (uint32_t size)
+{
+  m_rtable.GetFlowTable ().SetSize (size);
+}
+
+uint32_t
+Ipv4CmdSRouting::GetFlowTableSize (void) const
+{
+  return m_rtable.GetFlowTable ().GetSize ();
+}
+
+void
+Ipv4CmdSRouting::SetFlowTableAgingTime (Time agingTime)
+{
+  m_rtable.GetFlowTable ().SetAgingTime (agingTime);
+}
+
+Time
+Ipv4CmdSRouting::GetFlowTableAgingTime (void) const
+{
+  return m_rtable.GetFlowTable ().GetAgingTime ();
+}
+
+void
+Ipv4CmdSRouting::SetFlowTableMaxProbes (uint32_t probes)
+{
+  m_rtable.GetFlowTable ().SetMaxProbes (probes);
+}
+
+uint32_t
+Ipv4CmdSRouting::GetFlowTableMaxProbes (void) const
+{
+  return m_rtable.GetFlowTable ().GetMaxProbes ();
+}
+
+void
+Ipv4CmdSRouting::SetFlowTableEviction (Ipv4CmdSFlowTable::EvictionPolicy policy)
+{
+  m_rtable.GetFlowTable ().SetEvictionPolicy (policy);
+}
+
+Ipv4CmdSFlowTable::EvictionPolicy
+Ipv4CmdSRouting::GetFlowTableEviction (void) const
+{
+  return m_rtable.GetFlowTable ().GetEvictionPolicy ();
+}
+
+const Ipv4CmdSFlowTable &
+Ipv4CmdSRouting::GetFlowTable (void) const
+{
+  return m_rtable.GetFlowTable ();
+}
+
+void
+Ipv4CmdSRouting::SetP4RegisterSize (uint32_t size)
+{
+  m_p4Pipeline.SetRegisterSize (size);
+}
+
+void
+Ipv4CmdSRouting::SetP4K (uint32_t k)
+{
+  m_p4Pipeline.SetK (k);
+}
+
+void
+Ipv4CmdSRouting::SetP4Thresh (uint32_t thresh)
+{
+  m_p4Pipeline.SetThresh (thresh);
+}
+
+const Ipv4CmdSP4Pipeline &
+Ipv4CmdSRouting::GetP4Pipeline (void) const
+{
+  return m_p4Pipeline;
+}
+
+void
+Ipv4CmdSRouting::SetSyncPeriod (Time period)
+{
+  m_syncPeriod = period;
+}
+
+void
+Ipv4CmdSRouting::SetSyncMetric (SyncMetric metric)
+{
+  m_syncMetric = metric;
+}
+
+void
+Ipv4CmdSRouting::SetQueueEwmaGain (double gain)
+{
+  m_queueTracker.SetEwmaGain (gain);
+}
+
+void
+Ipv4CmdSRouting::SetAlpha (double alpha)
+{
+  m_queueTracker.SetAlpha (alpha);
+}
+
+void
+Ipv4CmdSRouting::SetTDre (Time time)
+{
+  m_queueTracker.SetTDre (time);
+}
+
+const Ipv4CmdSQueueTracker &
+Ipv4CmdSRouting::GetQueueTracker (void) const
+{
+  return m_queueTracker;
+}
+
+uint32_t
+Ipv4CmdSRouting::GetLocalLoad (void) const
+{
+  switch (m_syncMetric)
+    {
+    case METRIC_AVG_PACKETS:
+      return static_cast<uint32_t> (m_queueTracker.GetTotalAveragePackets () + 0.5);
+    case METRIC_DRE_BYTES:
+      return static_cast<uint32_t> (m_queueTracker.GetTotalDreBytes ());
+    case METRIC_PACKETS:
+    default:
+      return m_queueTracker.GetTotalPackets ();
+    }
+}
+
+void
+Ipv4CmdSRouting::SetQueueSyncMode (QueueSyncMode mode)
+{
+  m_queueSync = mode;
+}
+
+void
+Ipv4CmdSRouting::SetTelemetrySampleRatio (uint32_t ratio)
+{
+  m_telemetrySampleRatio = ratio == 0 ? 1 : ratio;
+}
+
+uint32_t
+Ipv4CmdSRouting::GetNeighborQueueSize (Ipv4Address neighbor) const
+{
+  return m_rtable.GetQueueSize (neighbor);
+}
+
+uint64_t
+Ipv4CmdSRouting::GetSyncMessages (void) const
+{
+  return m_syncMessages;
+}
+
+uint64_t
+Ipv4CmdSRouting::GetTelemetryStamps (void) const
+{
+  return m_telemetryStamps;
+}
+
+uint64_t
+Ipv4CmdSRouting::GetTelemetryUpdates (void) const
+{
+  return m_telemetryUpdates;
+}
+
+void
+Ipv4CmdSRouting::HandleTelemetry (uint32_t iif, uint16_t queueLength)
+{
+  if (iif >= m_telemetryCounters.size ())
+    {
+      m_telemetryCounters.resize (iif + 1, 0);
+    }
+  if (++m_telemetryCounters[iif] < m_telemetrySampleRatio)
+    {
+      return;
+    }
+  m_telemetryCounters[iif] = 0;
+
+  // Like routing_neighbor_queue_length in cmds.p4, the value is filed under
+  // the neighbor on the ingress port
+  Ipv4Address neighbor = m_routeCache->GetGateway (iif);
+  NS_LOG_LOGIC (this << " Telemetry from " << neighbor << ": " << queueLength);
+  m_rtable.UpdateQueueSize (neighbor, queueLength);
+  m_telemetryUpdates++;
+}
+
+void
+Ipv4CmdSRouting::ConnectTelemetry (void)
+{
+  for (uint32_t i = 0; i < m_ipv4->GetNInterfaces (); ++i)
+    {
+      PointerValue queue;
+      if (!m_ipv4->GetNetDevice (i)->GetAttributeFailSafe ("TxQueue", queue) || queue.Get<Queue> () == 0)
+        {
+          continue;
+        }
+      queue.Get<Queue> ()->TraceConnectWithoutContext ("Dequeue",
+        MakeBoundCallback (&Ipv4CmdSRouting::StampTelemetry, this, queue.Get<Queue> ()));
+    }
+}
+
+void
+Ipv4CmdSRouting::StampTelemetry (Ipv4CmdSRouting *routing, Ptr<Queue> queue, Ptr<const Packet> p)
+{
+  // Stamped on the way out, the depth is as fresh as it gets when the
+  // neighbor reads it; op_queue_length is 16 bits wide
+  Ptr<Packet> packet = ConstCast<Packet> (p);
+  Ipv4CmdSTag tag;
+  bool tagged = packet->PeekPacketTag (tag);
+  tag.SetQueueLength (std::min<uint32_t> (queue->GetNPackets (), 0xFFFF));
+  if (tagged)
+    {
+      packet->ReplacePacketTag (tag);
+    }
+  else
+    {
+      packet->AddPacketTag (tag);
+    }
+  routing->m_telemetryStamps++;
+}
+
+Ipv4CmdSP4Pipeline::FlowKey
+Ipv4CmdSRouting::GetP4FlowKey (Ptr<const Packet> packet, const Ipv4Header &header)
+{
+  Ipv4CmdSP4Pipeline::FlowKey key;
+  key.src = header.GetSource ().Get ();
+  key.dst = header.GetDestination ().Get ();
+  key.proto = header.GetProtocol ();
+  key.lookup = 0;
+
+  // The parser looks ahead 32 bits past the IPv4 header
+  uint8_t buf[4] = { 0, 0, 0, 0 };
+  packet->CopyData (buf, sizeof (buf));
+  key.lookup = (buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+  return key;
+}
+
+void
+Ipv4CmdSRouting::SendMessage (uint32_t npkt) 
+{
+  Ptr<Packet> packet = Create<Packet> (1);
+  Ipv4CmdSTag tag;
+  tag.SetQueueSize (npkt);
+  packet->AddPacketTag (tag);
+  m_socket->Send (packet);
+}
+
+bool
+Ipv4CmdSRouting::SyncQueueSize () 
+{ 
+  // The tracker follows the queues through their traces, no need to walk them
+  uint32_t tot = GetLocalLoad ();
+
+  NS_LOG_DEBUG (GetObject<Node> () << " Sync " << tot << " " << m_queueTracker.GetNQueues ());
+
+  SendMessage (tot);
+  m_syncMessages++;
+
+  return true;
+}
+
+void
+Ipv4CmdSRouting::Start ()
+{
+  NS_LOG_DEBUG ("Object " << GetObject<Node> ());
+  if (m_queueSync == SYNC_INBAND)
+    {
+      ConnectTelemetry ();
+      return;
+    }
+  m_socket = Socket::CreateSocket (GetObject<Node> (), UdpSocketFactory::GetTypeId ());
+  m_socket->SetAllowBroadcast (true);
+  m_socket->Bind ();
+  m_socket->Connect (Address (InetSocketAddress ("255.255.255.255", 9)));
+  Simulator::ScheduleNow (&Ipv4CmdSRouting::SyncQueueSize, this);
+  m_syncTick.SetPeriod (m_syncPeriod);
+  m_syncTick.Start ();
+}
+
+void
+Ipv4CmdSRouting::AddQueue (Ptr<Queue> queue)
+{
+  m_queueTracker.AddQueue (queue);
+}
+
+bool
+Ipv4CmdSRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                           UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                           LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  NS_LOG_LOGIC (GetObject<Node> () << " RouteInput: " << "Ip header: " << header);
+
+  NS_ASSERT (m_ipv4->GetInterfaceForDevice (idev) >= 0);
+
+  Ptr<Packet> packet = ConstCast<Packet> (p);
+
+  Ipv4Address srcAddress = header.GetSource ();
+  Ipv4Address destAddress = header.GetDestination ();
+
+  FlowIdTag ftag;
+  packet->PeekPacketTag (ftag);
+  uint32_t flowid = ftag.GetFlowId ();
+
+  // CmdS routing only supports unicast
+  if (destAddress.IsMulticast ()) 
+    {
+      NS_LOG_ERROR (this << " CmdS routing only supports unicast");
+      ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
+      return false;
+    }
+
+  // Check if input device supports IP forwarding
+  uint32_t iif = m_ipv4->GetInterfaceForDevice (idev);
+  if (m_ipv4->IsForwarding (iif) == false) 
+    {
+      NS_LOG_ERROR (this << " Forwarding disabled for this interface");
+      ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
+      return false;
+    }
+
+  /*if (destAddress.IsBroadcast ())
+    {
+      NS_LOG_DEBUG (GetObject<Node> () << " Broadcast " << srcAddress);
+      HandleMessage (p, header);
+      return true;
+    }*/
+
+  if (m_ipv4->IsDestinationAddress (header.GetDestination (), iif))
+    {
+      Ipv4CmdSTag tag;
+      packet->PeekPacketTag (tag);
+
+      uint32_t queueSize = tag.GetQueueSize ();
+      
+      NS_LOG_DEBUG ("!!! " << srcAddress << " " <<  destAddress << " | " << queueSize);
+
+      if (queueSize != Ipv4CmdSTag::DO_SWITCH && queueSize != Ipv4CmdSTag::NO_SWITCH)
+        {
+          m_rtable.UpdateQueueSize (srcAddress, queueSize);
+          return true;
+        }
+
+
+      
+      
+      if (!lcb.IsNull ())
+        {
+          NS_LOG_LOGIC ("Local delivery to " << header.GetDestination ());
+          lcb (p, header, iif);
+          return true;
+        }
+      else
+        {
+          // The local delivery callback is null.  This may be a multicast
+          // or broadcast packet, so return false so that another
+          // multicast routing protocol can handle it.  It should be possible
+          // to extend this to explicitly check whether it is a unicast
+          // packet, and invoke the error callback if so
+          return false;
+        }
+    }
+
+  Ipv4CmdSTag tag;
+  packet->PeekPacketTag (tag);
+
+  if (m_queueSync == SYNC_INBAND && tag.HasQueueLength ())
+    {
+      HandleTelemetry (iif, tag.GetQueueLength ());
+    }
+
+  Ptr<Ipv4Route> rtentry;
+  if (m_p4DataPlane)
+    {
+      // ingress_mac_tstamp is in nanoseconds, the pipeline keeps its 32 low bits
+      uint32_t ts = static_cast<uint32_t> (Simulator::Now ().GetNanoSeconds ());
+      rtentry = m_rtable.LookupP4 (m_ipv4, m_p4Pipeline, GetP4FlowKey (packet, header), ts, destAddress);
+    }
+  else
+    {
+      rtentry = m_rtable.Lookup (m_ipv4, flowid, destAddress, tag.GetQueueSize () == Ipv4CmdSTag::DO_SWITCH);
+    }
+  if (rtentry != 0)
+    {
+      NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
+      ucb (rtentry, p, header);
+      return true;
+    }
+  else
+    {
+      NS_LOG_ERROR ("Did not find unicast destination- returning false");
+      return false; // Let other routing protocols try to handle this
+                    // route request.
+    }
+}
+
+void
+Ipv4CmdSRouting::NotifyInterfaceUp (uint32_t interface)
+{
+}
+
+void
+Ipv4CmdSRouting::NotifyInterfaceDown (uint32_t interface)
+{
+  if (m_routeCache != 0)
+    {
+      m_routeCache->Invalidate (interface);
+    }
+}
+
+void
+Ipv4CmdSRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+  if (m_routeCache != 0)
+    {
+      m_routeCache->Invalidate (interface);
+    }
+}
+
+void
+Ipv4CmdSRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
+{
+}
+
+void
+Ipv4CmdSRouting::SetIpv4 (Ptr<Ipv4> ipv4)
+{
+  NS_LOG_INFO (this << "Setting up Ipv4: " << ipv4);
+  NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
+  m_ipv4 = ipv4;
+  m_routeCache = Ipv4RouteCache::GetRouteCache (ipv4);
+  m_rtable.SetRouteCache (m_routeCache);
+  Simulator::ScheduleNow (&Ipv4CmdSRouting::Start, this);
+}
+
+void
+Ipv4CmdSRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
+{
+}
+
+
+int64_t
+Ipv4CmdSRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  return m_rtable.AssignStreams (stream);
+}
+
+void
+Ipv4CmdSRouting::DoDispose (void)
+{
+  m_syncTick.Cancel ();
+  if (m_socket != 0)
+    {
+      m_socket->Close ();
+      m_socket = 0;
+    }
+  m_queueTracker.Clear ();
+  m_rtable.SetRouteCache (0);
+  m_routeCache = 0;
+  m_ipv4 = 0;
+  Ipv4RoutingProtocol::DoDispose ();
+}
+
 }
\ No newline at end of file
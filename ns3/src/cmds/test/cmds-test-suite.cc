@@ -3,6 +3,29 @@
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include "ns3/ipv4-cmds-routing-table.h"
+#include "ns3/ipv4-cmds-flow-table.h"
+#include "ns3/ipv4-cmds-p4-pipeline.h"
+#include "ns3/ipv4-cmds-queue-tracker.h"
+#include "ns3/ipv4-cmds-routing.h"
+#include "ns3/ipv4-cmds-routing-helper.h"
+#include "ns3/ipv4-cmds-tag.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/queue.h"
+#include "ns3/drop-tail-queue.h"
+
+#include <cmath>
+#include <cstdlib>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
@@ -43,6 +66,863 @@ CmdsTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Check that the compiled trie picks the same entry and the same next hop
+// as the linear table for overlapping prefixes of different lengths
+class CmdsCompiledFibTestCase : public TestCase
+{
+public:
+  CmdsCompiledFibTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CmdsCompiledFibTestCase::CmdsCompiledFibTestCase ()
+  : TestCase ("Compiled CmdS FIB matches the linear table")
+{
+}
+
+void
+CmdsCompiledFibTestCase::DoRun (void)
+{
+  NodeContainer leaf;
+  leaf.Create (1);
+  NodeContainer peers;
+  peers.Create (4);
+
+  InternetStackHelper internet;
+  internet.Install (leaf);
+  internet.Install (peers);
+
+  SimpleNetDeviceHelper simple;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("192.168.0.0", "255.255.255.0");
+  std::vector<uint32_t> interfaces;
+  for (uint32_t i = 0; i < peers.GetN (); ++i)
+    {
+      NetDeviceContainer devices = simple.Install (NodeContainer (leaf.Get (0), peers.Get (i)));
+      ipv4.Assign (devices);
+      ipv4.NewNetwork ();
+      interfaces.push_back (devices.Get (0)->GetIfIndex ());
+    }
+
+  Ptr<Ipv4> leafIpv4 = leaf.Get (0)->GetObject<Ipv4> ();
+
+  Ipv4CmdSRoutingTable linear;
+  Ipv4CmdSRoutingTable compiled;
+  compiled.SetCompiled (true);
+
+  // Same stream in both tables, so that they break ties the same way
+  linear.AssignStreams (7);
+  compiled.AssignStreams (7);
+
+  Ipv4CmdSRoutingTable *tables[] = { &linear, &compiled };
+  for (uint32_t t = 0; t < 2; ++t)
+    {
+      std::vector<uint32_t> low (interfaces.begin (), interfaces.begin () + 2);
+      std::vector<uint32_t> high (interfaces.begin () + 2, interfaces.end ());
+      std::vector<uint32_t> one (1, interfaces[3]);
+      tables[t]->AddEntry (leafIpv4, Ipv4Address ("10.1.2.3"), Ipv4Mask ("255.255.255.255"), one);
+      tables[t]->AddEntry (leafIpv4, Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), interfaces);
+      tables[t]->AddEntry (leafIpv4, Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), low);
+      tables[t]->AddEntry (leafIpv4, Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.255.0"), high);
+      tables[t]->AddEntry (leafIpv4, Ipv4Address ("10.1.2.128"), Ipv4Mask ("255.255.255.128"), low);
+      tables[t]->UpdateQueueSize (Ipv4Address ("192.168.0.2"), 3);
+      tables[t]->UpdateQueueSize (Ipv4Address ("192.168.1.2"), 3);
+      tables[t]->UpdateQueueSize (Ipv4Address ("192.168.2.2"), 5);
+    }
+
+  const char *dests[] = { "10.1.2.3", "10.1.2.4", "10.1.2.200", "10.1.7.1", "10.2.0.1", "172.16.0.1" };
+  for (uint32_t round = 0; round < 4; ++round)
+    {
+      for (uint32_t d = 0; d < sizeof (dests) / sizeof (dests[0]); ++d)
+        {
+          for (uint32_t flow = 0; flow < 8; ++flow)
+            {
+              bool best = (round == 2);
+              Ptr<Ipv4Route> a = linear.Lookup (leafIpv4, flow, Ipv4Address (dests[d]), best);
+              Ptr<Ipv4Route> b = compiled.Lookup (leafIpv4, flow, Ipv4Address (dests[d]), best);
+              NS_TEST_ASSERT_MSG_NE (a, 0, "Linear lookup should find a route to " << dests[d]);
+              NS_TEST_ASSERT_MSG_NE (b, 0, "Compiled lookup should find a route to " << dests[d]);
+              NS_TEST_ASSERT_MSG_EQ (a->GetOutputDevice (), b->GetOutputDevice (), "Different next hop for " << dests[d]);
+              NS_TEST_ASSERT_MSG_EQ (a->GetGateway (), b->GetGateway (), "Different gateway for " << dests[d]);
+            }
+        }
+      // Shift the load so that later rounds exercise a different best set
+      linear.UpdateQueueSize (Ipv4Address ("192.168.3.2"), round);
+      compiled.UpdateQueueSize (Ipv4Address ("192.168.3.2"), round);
+    }
+
+  Simulator::Destroy ();
+}
+
+// Check eviction, rejection and aging of the bounded flow table
+class CmdsFlowTableTestCase : public TestCase
+{
+public:
+  CmdsFlowTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckAged (void);
+
+  Ipv4CmdSFlowTable m_aging;
+};
+
+CmdsFlowTableTestCase::CmdsFlowTableTestCase ()
+  : TestCase ("Bounded CmdS flow table evicts and ages flows")
+{
+}
+
+void
+CmdsFlowTableTestCase::CheckAged (void)
+{
+  uint32_t interface;
+  NS_TEST_ASSERT_MSG_EQ (m_aging.Lookup (7, interface), true, "Flow 7 was refreshed and should be live");
+  NS_TEST_ASSERT_MSG_EQ (m_aging.Lookup (8, interface), false, "Flow 8 should have aged out");
+  NS_TEST_ASSERT_MSG_EQ (m_aging.GetExpirations (), 1, "One flow should have expired");
+  NS_TEST_ASSERT_MSG_EQ (m_aging.GetOccupancy (), 1, "Only flow 7 should remain");
+}
+
+void
+CmdsFlowTableTestCase::DoRun (void)
+{
+  uint32_t interface = 0;
+
+  Ipv4CmdSFlowTable lru;
+  lru.SetSize (1);
+  lru.SetMaxProbes (1);
+  lru.Insert (1, 10);
+  NS_TEST_ASSERT_MSG_EQ (lru.Lookup (1, interface), true, "Flow 1 should be found");
+  NS_TEST_ASSERT_MSG_EQ (interface, 10, "Flow 1 should be pinned to interface 10");
+  lru.Insert (2, 20);
+  NS_TEST_ASSERT_MSG_EQ (lru.Lookup (1, interface), false, "Flow 1 should have been evicted");
+  NS_TEST_ASSERT_MSG_EQ (lru.Lookup (2, interface), true, "Flow 2 should be found");
+  NS_TEST_ASSERT_MSG_EQ (lru.GetCollisions (), 1, "Flow 2 should have collided with flow 1");
+  NS_TEST_ASSERT_MSG_EQ (lru.GetEvictions (), 1, "Flow 2 should have evicted flow 1");
+
+  Ipv4CmdSFlowTable none;
+  none.SetSize (1);
+  none.SetEvictionPolicy (Ipv4CmdSFlowTable::EVICT_NONE);
+  none.Insert (1, 10);
+  none.Insert (2, 20);
+  NS_TEST_ASSERT_MSG_EQ (none.Lookup (1, interface), true, "Flow 1 should be kept");
+  NS_TEST_ASSERT_MSG_EQ (none.Lookup (2, interface), false, "Flow 2 should not be stored");
+  NS_TEST_ASSERT_MSG_EQ (none.GetRejections (), 1, "Flow 2 should have been rejected");
+
+  // Flows 1 and 3 share the home slot of a 2-slot table, so flow 3 is pinned
+  // past flow 1 and refreshing it must not count again
+  Ipv4CmdSFlowTable probed;
+  probed.SetSize (2);
+  probed.SetMaxProbes (2);
+  probed.Insert (1, 10);
+  probed.Insert (3, 30);
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      probed.Insert (1, 10);
+      probed.Insert (3, 30);
+    }
+  NS_TEST_ASSERT_MSG_EQ (probed.GetCollisions (), 1, "Refreshing pinned flows should not count collisions");
+  NS_TEST_ASSERT_MSG_EQ (probed.GetOccupancy (), 2, "Both slots should be held");
+
+  Ptr<Ipv4CmdSRouting> routing = CreateObject<Ipv4CmdSRouting> ();
+  routing->SetAttribute ("FlowTableSize", UintegerValue (64));
+  routing->SetAttribute ("FlowTableMaxProbes", UintegerValue (3));
+  routing->SetAttribute ("FlowTableAgingTime", TimeValue (MilliSeconds (5)));
+  routing->SetAttribute ("FlowTableEviction", EnumValue (Ipv4CmdSFlowTable::EVICT_NONE));
+  UintegerValue size;
+  UintegerValue maxProbes;
+  TimeValue agingTime;
+  EnumValue eviction;
+  routing->GetAttribute ("FlowTableSize", size);
+  routing->GetAttribute ("FlowTableMaxProbes", maxProbes);
+  routing->GetAttribute ("FlowTableAgingTime", agingTime);
+  routing->GetAttribute ("FlowTableEviction", eviction);
+  NS_TEST_ASSERT_MSG_EQ (size.Get (), 64, "FlowTableSize should read back");
+  NS_TEST_ASSERT_MSG_EQ (maxProbes.Get (), 3, "FlowTableMaxProbes should read back");
+  NS_TEST_ASSERT_MSG_EQ (agingTime.Get (), MilliSeconds (5), "FlowTableAgingTime should read back");
+  NS_TEST_ASSERT_MSG_EQ (eviction.Get (), Ipv4CmdSFlowTable::EVICT_NONE, "FlowTableEviction should read back");
+
+  m_aging.SetSize (16);
+  m_aging.SetAgingTime (MilliSeconds (1));
+  m_aging.Insert (7, 1);
+  m_aging.Insert (8, 2);
+  Simulator::Schedule (MicroSeconds (800), &Ipv4CmdSFlowTable::Lookup, &m_aging, 7, interface);
+  Simulator::Schedule (MicroSeconds (1500), &CmdsFlowTableTestCase::CheckAged, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+// Check that the queue tracker follows depth, drops, EWMA and DRE from
+// the queue traces alone
+class CmdsQueueTrackerTestCase : public TestCase
+{
+public:
+  CmdsQueueTrackerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckDecay (void);
+
+  Ptr<Queue> m_queue;
+  Ipv4CmdSQueueTracker m_tracker;
+};
+
+CmdsQueueTrackerTestCase::CmdsQueueTrackerTestCase ()
+  : TestCase ("CmdS queue tracker follows queue traces")
+{
+}
+
+void
+CmdsQueueTrackerTestCase::CheckDecay (void)
+{
+  // Two DRE periods later the 100 dequeued bytes have decayed twice
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_tracker.GetDreBytes (0), 100 * 0.5 * 0.5, 1e-9, "DRE should decay once per period");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_tracker.GetTotalDreBytes (), 100 * 0.5 * 0.5, 1e-9, "Total DRE should decay alike");
+
+  m_queue->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_tracker.GetDreBytes (0), 25 + 100, 1e-9, "DRE should add the dequeued bytes");
+  NS_TEST_ASSERT_MSG_EQ (m_tracker.GetPackets (0), m_queue->GetNPackets (), "Depth should match the queue");
+}
+
+void
+CmdsQueueTrackerTestCase::DoRun (void)
+{
+  m_queue = CreateObject<DropTailQueue> ();
+  m_queue->SetAttribute ("MaxPackets", UintegerValue (3));
+
+  m_tracker.SetEwmaGain (0.5);
+  m_tracker.SetAlpha (0.5);
+  m_tracker.SetTDre (MicroSeconds (10));
+  m_tracker.AddQueue (m_queue);
+
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      m_queue->Enqueue (Create<QueueItem> (Create<Packet> (100)));
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_tracker.GetPackets (0), 3, "The fourth packet should have been dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_tracker.GetBytes (0), 300, "Three packets should be queued");
+  NS_TEST_ASSERT_MSG_EQ (m_tracker.GetDrops (0), 1, "One drop should be counted");
+  NS_TEST_ASSERT_MSG_EQ (m_tracker.GetTotalPackets (), 3, "Total should follow the only queue");
+
+  // EWMA with gain 0.5 over depths 1, 2, 3
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_tracker.GetAveragePackets (0), 2.125, 1e-9, "EWMA should be updated on every enqueue");
+
+  m_queue->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_tracker.GetAveragePackets (0), 2.0625, 1e-9, "EWMA should be updated on dequeue");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_tracker.GetTotalAveragePackets (), 2.0625, 1e-9, "Total EWMA should follow");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_tracker.GetDreBytes (0), 100, 1e-9, "DRE should count the dequeued bytes");
+
+  Simulator::Schedule (MicroSeconds (25), &CmdsQueueTrackerTestCase::CheckDecay, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  m_tracker.Clear ();
+  m_queue->Dequeue ();
+  NS_TEST_ASSERT_MSG_EQ (m_tracker.GetNQueues (), 0, "Clear should drop the queues");
+  m_queue = 0;
+}
+
+// Literal transliteration of the Ingress apply block of src/switch/cmds.p4,
+// with both register arrays of each stage and bitwise CRCs, used as the
+// reference the pipeline model must match packet for packet
+class CmdsP4Reference
+{
+public:
+  CmdsP4Reference (uint32_t size, uint32_t k, uint32_t thresh)
+    : m_size (size), m_k (k), m_thresh (thresh),
+      m_fre1 (size, std::make_pair (0u, 0u)), m_fre2 (size, std::make_pair (0u, 0u)),
+      m_ts1 (size, std::make_pair (0u, 0u)), m_ts2 (size, std::make_pair (0u, 0u)),
+      m_nexthop (size, 0)
+  {
+  }
+
+  static uint32_t Crc (const uint8_t *data, uint32_t size, uint32_t width, uint32_t poly,
+                       uint32_t init, bool reflect, uint32_t xorout)
+  {
+    uint32_t top = 1u << (width - 1);
+    uint32_t mask = width == 32 ? 0xffffffffu : (1u << width) - 1;
+    uint32_t crc = init;
+    for (uint32_t i = 0; i < size; ++i)
+      {
+        for (uint32_t b = 0; b < 8; ++b)
+          {
+            uint32_t bit = reflect ? (data[i] >> b) & 1 : (data[i] >> (7 - b)) & 1;
+            bool msb = (crc & top) != 0;
+            crc = (crc << 1) & mask;
+            if (msb != (bit != 0))
+              {
+                crc ^= poly;
+              }
+          }
+      }
+    if (reflect)
+      {
+        uint32_t r = 0;
+        for (uint32_t b = 0; b < width; ++b)
+          {
+            r |= ((crc >> b) & 1) << (width - 1 - b);
+          }
+        crc = r;
+      }
+    return (crc ^ xorout) & mask;
+  }
+
+  // One register action of id1_fre_reg1/2, returning the given field
+  uint32_t Work1 (std::pair<uint32_t, uint32_t> &reg, uint32_t id, bool wantFre)
+  {
+    if (reg.first == id)
+      reg.second = reg.second + m_k;
+    if (reg.first != id && reg.second != 0)
+      reg.second = reg.second - 1;
+    if (reg.first != id && reg.second == 0)
+      reg.first = id;
+    return wantFre ? reg.second : reg.first;
+  }
+
+  // One register action of id2_ts_reg1/2, returning the given field
+  uint32_t Work2 (std::pair<uint32_t, uint32_t> &reg, uint32_t id, uint32_t ts, bool wantTs)
+  {
+    uint32_t result = wantTs ? reg.second : reg.first;
+    if (ts > reg.second + m_thresh)
+      reg.second = ts;
+    if (ts > reg.second + m_thresh && id != reg.first)
+      reg.first = id;
+    if (ts <= reg.second + m_thresh && id == reg.first)
+      reg.second = ts | 0x80000000u;
+    return result;
+  }
+
+  uint32_t Process (const uint8_t buf[13], uint32_t ingressTs, const uint32_t *ecmp, uint32_t least)
+  {
+    uint32_t id = Crc (buf, 13, 32, 0x04C11DB7u, 0xffffffffu, true, 0xffffffffu);
+    uint32_t index = Crc (buf, 13, 16, 0x8005, 0, true, 0) % m_size;
+    uint32_t hopindex = Crc (buf, 13, 8, 0x07, 0, false, 0) & 0xf;
+    uint32_t ecmphop = ecmp[hopindex];
+    uint32_t finalhop = 0;
+    uint32_t ts = ingressTs;
+    uint32_t nexthop = 0;
+    bool sch = false;
+    bool flagforpend2 = false;
+
+    Work1 (m_fre1[index], id, true);
+    uint32_t id1 = Work1 (m_fre2[index], id, false);
+    if (id1 != id)
+      ts = ts & 0x7fffffff;
+    else
+      ts = ts | 0x80000000;
+    uint32_t oldTs = Work2 (m_ts1[index], id, ts, true);
+    uint32_t oldId2 = Work2 (m_ts2[index], id, ts, false);
+    if (id == oldId2)
+      flagforpend2 = true;
+    uint32_t tsd = oldTs + m_thresh;
+    uint32_t flag4pend = tsd > ts ? tsd : ts;
+    if (flag4pend == ts)
+      {
+        nexthop = flagforpend2 ? least : ecmphop;
+        sch = true;
+      }
+    else
+      {
+        if (flagforpend2)
+          {
+            sch = true;
+            nexthop = 0;
+          }
+        else
+          nexthop = ecmphop;
+      }
+    if (sch)
+      {
+        if (nexthop != 0)
+          m_nexthop[index] = nexthop;
+        finalhop = m_nexthop[index];
+      }
+    else
+      finalhop = ecmphop;
+    return finalhop;
+  }
+
+private:
+  uint32_t m_size;
+  uint32_t m_k;
+  uint32_t m_thresh;
+  std::vector<std::pair<uint32_t, uint32_t> > m_fre1;
+  std::vector<std::pair<uint32_t, uint32_t> > m_fre2;
+  std::vector<std::pair<uint32_t, uint32_t> > m_ts1;
+  std::vector<std::pair<uint32_t, uint32_t> > m_ts2;
+  std::vector<uint32_t> m_nexthop;
+};
+
+// Feed the same packet trace to the pipeline model and to the reference
+// and compare every next hop decision
+class CmdsP4PipelineTestCase : public TestCase
+{
+public:
+  CmdsP4PipelineTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CmdsP4PipelineTestCase::CmdsP4PipelineTestCase ()
+  : TestCase ("CmdS P4 pipeline model matches cmds.p4 decisions")
+{
+}
+
+void
+CmdsP4PipelineTestCase::DoRun (void)
+{
+  const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+  NS_TEST_ASSERT_MSG_EQ (Ipv4CmdSP4Pipeline::Crc32 (check, 9), 0xCBF43926u, "CRC32 check value");
+  NS_TEST_ASSERT_MSG_EQ (Ipv4CmdSP4Pipeline::Crc16 (check, 9), 0xBB3D, "CRC16 check value");
+  NS_TEST_ASSERT_MSG_EQ (Ipv4CmdSP4Pipeline::Crc8 (check, 9), 0xF4, "CRC8 check value");
+
+  // Few slots and short gaps so that sketch takeovers, flowlet collisions
+  // and remembered hops of other flows all occur in the trace
+  const uint32_t size = 61;
+  Ipv4CmdSP4Pipeline model;
+  model.SetRegisterSize (size);
+  model.SetK (5);
+  model.SetThresh (40);
+  CmdsP4Reference reference (size, 5, 40);
+
+  uint32_t ecmp[Ipv4CmdSP4Pipeline::ECMP_TABLE_SIZE];
+  for (uint32_t i = 0; i < Ipv4CmdSP4Pipeline::ECMP_TABLE_SIZE; ++i)
+    {
+      ecmp[i] = 1 + i % 3;
+    }
+
+  srand (4);
+  uint32_t ts = 0x7fffff00u;    // cross the MSB and wrap during the trace
+  for (uint32_t n = 0; n < 200000; ++n)
+    {
+      Ipv4CmdSP4Pipeline::FlowKey key;
+      uint32_t flow = rand () % 300;
+      key.src = 0x0a000001 + flow % 17;
+      key.dst = 0x0a010001 + flow % 5;
+      key.proto = 6;
+      key.lookup = (10000 + flow) << 16 | 80;
+      ts += rand () % 30;
+      uint32_t least = 1 + rand () % 3;
+
+      uint8_t buf[13];
+      Ipv4CmdSP4Pipeline::Serialize (key, buf);
+      uint32_t expected = reference.Process (buf, ts, ecmp, least);
+      uint32_t actual = model.Process (key, ts, ecmp, least);
+      NS_TEST_ASSERT_MSG_EQ (actual, expected, "Next hop differs at packet " << n);
+    }
+
+  NS_TEST_ASSERT_MSG_GT (model.GetSketchTakeovers (), size, "The trace should exercise sketch takeovers");
+  NS_TEST_ASSERT_MSG_GT (model.GetFlowletCollisions (), 0, "The trace should exercise flowlet collisions");
+}
+
+// Check that in-band telemetry is sampled on ingress and stamped on egress
+class CmdsInBandSyncTestCase : public TestCase
+{
+public:
+  CmdsInBandSyncTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Probe (void);
+
+  static void Forward (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header);
+
+  Ptr<Ipv4CmdSRouting> m_routing;
+  Ptr<NetDevice> m_fromNeighbor;
+  Ptr<NetDevice> m_toDest;
+  Ipv4Address m_neighbor;
+};
+
+CmdsInBandSyncTestCase::CmdsInBandSyncTestCase ()
+  : TestCase ("In-band CmdS queue sync samples and stamps queue lengths")
+{
+}
+
+void
+CmdsInBandSyncTestCase::Forward (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header)
+{
+}
+
+void
+CmdsInBandSyncTestCase::Probe (void)
+{
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.8.0.1"));
+  header.SetDestination (Ipv4Address ("10.9.0.1"));
+
+  uint16_t lengths[] = { 7, 9, 4 };
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Ptr<Packet> packet = Create<Packet> (100);
+      Ipv4CmdSTag tag;
+      tag.SetQueueLength (lengths[i]);
+      packet->AddPacketTag (tag);
+      bool routed = m_routing->RouteInput (packet, header, m_fromNeighbor,
+                                           MakeCallback (&CmdsInBandSyncTestCase::Forward),
+                                           Ipv4RoutingProtocol::MulticastForwardCallback (),
+                                           Ipv4RoutingProtocol::LocalDeliverCallback (),
+                                           Ipv4RoutingProtocol::ErrorCallback ());
+      NS_TEST_EXPECT_MSG_EQ (routed, true, "Packet should be forwarded");
+      if (i == 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_routing->GetNeighborQueueSize (m_neighbor), UINT32_MAX,
+                                 "First packet should be skipped with a sample ratio of 2");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_routing->GetNeighborQueueSize (m_neighbor), 9, "Second packet should update the neighbor");
+  NS_TEST_EXPECT_MSG_EQ (m_routing->GetTelemetryUpdates (), 1, "Only one in two packets should be sampled");
+
+  PointerValue txQueue;
+  m_toDest->GetAttribute ("TxQueue", txQueue);
+  Ptr<Queue> queue = txQueue.Get<Queue> ();
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      queue->Enqueue (Create<QueueItem> (Create<Packet> (10)));
+    }
+  Ptr<QueueItem> item = queue->Dequeue ();
+  Ipv4CmdSTag tag;
+  NS_TEST_EXPECT_MSG_EQ (item->GetPacket ()->PeekPacketTag (tag), true, "Dequeued packet should carry a tag");
+  NS_TEST_EXPECT_MSG_EQ (tag.HasQueueLength (), true, "Dequeued packet should carry a queue length");
+  NS_TEST_EXPECT_MSG_EQ (tag.GetQueueLength (), 2, "Queue length should be the depth left behind");
+  NS_TEST_EXPECT_MSG_EQ (m_routing->GetTelemetryStamps (), 1, "One packet left the queue");
+}
+
+void
+CmdsInBandSyncTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::QueueSync", EnumValue (Ipv4CmdSRouting::SYNC_INBAND));
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::TelemetrySampleRatio", UintegerValue (2));
+
+  NodeContainer sw;
+  sw.Create (1);
+  NodeContainer hosts;
+  hosts.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (hosts);
+  Ipv4CmdSRoutingHelper cmdsRoutingHelper;
+  internet.SetRoutingHelper (cmdsRoutingHelper);
+  internet.Install (sw);
+
+  SimpleNetDeviceHelper simple;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("192.168.0.0", "255.255.255.0");
+  NetDeviceContainer neighbor = simple.Install (NodeContainer (sw.Get (0), hosts.Get (0)));
+  Ipv4InterfaceContainer neighborAddr = ipv4.Assign (neighbor);
+  ipv4.NewNetwork ();
+  NetDeviceContainer dest = simple.Install (NodeContainer (sw.Get (0), hosts.Get (1)));
+  ipv4.Assign (dest);
+
+  m_routing = cmdsRoutingHelper.GetCmdSRouting (sw.Get (0)->GetObject<Ipv4> ());
+  m_fromNeighbor = neighbor.Get (0);
+  m_toDest = dest.Get (0);
+  m_neighbor = neighborAddr.GetAddress (1);
+  m_routing->AddRoute (Ipv4Address ("10.9.0.0"), Ipv4Mask ("255.255.0.0"),
+                       std::vector<uint32_t> (1, m_toDest->GetIfIndex ()));
+
+  Simulator::Schedule (MilliSeconds (1), &CmdsInBandSyncTestCase::Probe, this);
+  Simulator::Run ();
+
+  m_routing = 0;
+  m_fromNeighbor = 0;
+  m_toDest = 0;
+  Simulator::Destroy ();
+
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::QueueSync", EnumValue (Ipv4CmdSRouting::SYNC_BROADCAST));
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::TelemetrySampleRatio", UintegerValue (1));
+}
+
+// Route a packet trace through RouteInput of a switch in P4DataPlane mode,
+// check every hop against the reference pipeline, and replay the trace in
+// the exact per-flow state mode to show where the two modes diverge.
+//
+// work2 of id2_ts_reg2 only writes id2 when ts > ts + thresh, which needs the
+// 32 bit timestamp to overflow; before the ingress timestamp gets close to
+// 2^32 ns the flowlet state is inert and the pipeline is plain ECMP on the
+// CRC8 of the flow, so the trace is replayed at both times
+class CmdsP4RouteInputTestCase : public TestCase
+{
+public:
+  CmdsP4RouteInputTestCase ();
+
+private:
+  struct Result
+  {
+    uint32_t moves;             // hop changes of a flow between two of its packets
+    uint32_t flowletMoves;      // the same, with the packets at most thresh apart
+    uint32_t leastLoaded;       // packets sent to the least loaded hop
+    uint32_t ecmp;              // packets sent to the ECMP hop of their flow
+    uint64_t collisions;        // flowlet collisions counted by the pipeline
+    std::vector<uint32_t> hops;
+  };
+
+  virtual void DoRun (void);
+  Result RunTrace (bool p4, uint64_t start);
+  void Receive (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header);
+  void SendPacket (uint32_t n);
+
+  static const uint32_t REGISTER_SIZE;
+  static const uint32_t THRESH;
+  static const uint32_t FLOWS;
+
+  std::vector<uint32_t> m_traceFlows;
+  std::vector<uint32_t> m_traceGaps;
+
+  bool m_p4;
+  Ptr<Ipv4> m_ipv4;
+  Ptr<Ipv4CmdSRouting> m_routing;
+  Ptr<NetDevice> m_fromHost;
+  std::vector<uint32_t> m_egress;
+  uint32_t m_least;
+  CmdsP4Reference *m_reference;
+  Ptr<Ipv4Route> m_route;
+  Result m_result;
+  std::vector<uint32_t> m_lastHop;
+  std::vector<uint32_t> m_lastTime;
+};
+
+const uint32_t CmdsP4RouteInputTestCase::REGISTER_SIZE = 5;
+const uint32_t CmdsP4RouteInputTestCase::THRESH = 40;
+const uint32_t CmdsP4RouteInputTestCase::FLOWS = 6;
+
+CmdsP4RouteInputTestCase::CmdsP4RouteInputTestCase ()
+  : TestCase ("CmdS RouteInput in P4 data plane mode follows the pipeline"),
+    m_p4 (false),
+    m_least (0),
+    m_reference (0)
+{
+}
+
+void
+CmdsP4RouteInputTestCase::Receive (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header)
+{
+  m_route = route;
+}
+
+void
+CmdsP4RouteInputTestCase::SendPacket (uint32_t n)
+{
+  uint32_t flow = m_traceFlows[n];
+  uint32_t ts = static_cast<uint32_t> (Simulator::Now ().GetNanoSeconds ());
+
+  Ipv4Header header;
+  header.SetSource (Ipv4Address (0x0a080001 + flow % 4));
+  header.SetDestination (Ipv4Address (0x0a090001 + flow % 3));
+  header.SetProtocol (6);
+
+  // The first 32 bits past the IPv4 header are the TCP ports
+  uint8_t payload[20] = { 0 };
+  uint16_t sport = 10000 + flow;
+  payload[0] = sport >> 8;
+  payload[1] = sport & 0xff;
+  payload[3] = 80;
+  Ptr<Packet> packet = Create<Packet> (payload, sizeof (payload));
+  packet->AddPacketTag (FlowIdTag (flow + 1));
+
+  m_route = 0;
+  bool routed = m_routing->RouteInput (packet, header, m_fromHost,
+                                       MakeCallback (&CmdsP4RouteInputTestCase::Receive, this),
+                                       Ipv4RoutingProtocol::MulticastForwardCallback (),
+                                       Ipv4RoutingProtocol::LocalDeliverCallback (),
+                                       Ipv4RoutingProtocol::ErrorCallback ());
+  NS_TEST_EXPECT_MSG_EQ ((routed && m_route != 0), true, "Packet " << n << " should be forwarded");
+  if (m_route == 0)
+    {
+      return;
+    }
+  uint32_t hop = m_ipv4->GetInterfaceForDevice (m_route->GetOutputDevice ());
+
+  if (m_p4)
+    {
+      Ipv4CmdSP4Pipeline::FlowKey key;
+      key.src = header.GetSource ().Get ();
+      key.dst = header.GetDestination ().Get ();
+      key.proto = 6;
+      key.lookup = sport << 16 | 80;
+      uint8_t buf[13];
+      Ipv4CmdSP4Pipeline::Serialize (key, buf);
+      if (hop == m_egress[(Ipv4CmdSP4Pipeline::Crc8 (buf, 13) & 0xf) % m_egress.size ()])
+        {
+          m_result.ecmp++;
+        }
+
+      uint32_t ecmp[Ipv4CmdSP4Pipeline::ECMP_TABLE_SIZE];
+      for (uint32_t i = 0; i < Ipv4CmdSP4Pipeline::ECMP_TABLE_SIZE; ++i)
+        {
+          ecmp[i] = m_egress[i % m_egress.size ()];
+        }
+      uint32_t expected = m_reference->Process (buf, ts, ecmp, m_least);
+      if (expected == 0)
+        {
+          expected = m_least;
+        }
+      NS_TEST_EXPECT_MSG_EQ (hop, expected, "Hop differs from the pipeline at packet " << n);
+    }
+
+  if (m_lastHop[flow] != 0 && m_lastHop[flow] != hop)
+    {
+      m_result.moves++;
+      if (ts - m_lastTime[flow] <= THRESH)
+        {
+          m_result.flowletMoves++;
+        }
+    }
+  if (hop == m_least)
+    {
+      m_result.leastLoaded++;
+    }
+  m_lastHop[flow] = hop;
+  m_lastTime[flow] = ts;
+  m_result.hops.push_back (hop);
+}
+
+CmdsP4RouteInputTestCase::Result
+CmdsP4RouteInputTestCase::RunTrace (bool p4, uint64_t start)
+{
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::P4DataPlane", BooleanValue (p4));
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::P4RegisterSize", UintegerValue (REGISTER_SIZE));
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::P4Thresh", UintegerValue (THRESH));
+
+  // One ingress host and three egress hosts towards 10.9.0.0/16
+  NodeContainer sw;
+  sw.Create (1);
+  NodeContainer hosts;
+  hosts.Create (4);
+
+  InternetStackHelper internet;
+  internet.Install (hosts);
+  Ipv4CmdSRoutingHelper cmdsRoutingHelper;
+  internet.SetRoutingHelper (cmdsRoutingHelper);
+  internet.Install (sw);
+
+  SimpleNetDeviceHelper simple;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("192.168.0.0", "255.255.255.0");
+  std::vector<Ptr<NetDevice> > devices;
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      NetDeviceContainer link = simple.Install (NodeContainer (sw.Get (0), hosts.Get (i)));
+      ipv4.Assign (link);
+      ipv4.NewNetwork ();
+      devices.push_back (link.Get (0));
+    }
+
+  m_p4 = p4;
+  m_ipv4 = sw.Get (0)->GetObject<Ipv4> ();
+  m_routing = cmdsRoutingHelper.GetCmdSRouting (m_ipv4);
+  m_fromHost = devices[0];
+  m_egress.clear ();
+  for (uint32_t i = 1; i < 4; ++i)
+    {
+      m_egress.push_back (m_ipv4->GetInterfaceForDevice (devices[i]));
+    }
+  m_least = m_egress[1];
+  m_routing->AddRoute (Ipv4Address ("10.9.0.0"), Ipv4Mask ("255.255.0.0"), m_egress);
+
+  // Queue sizes synced by the egress neighbors make the second egress hop
+  // the least loaded one
+  uint32_t sizes[] = { 7, 2, 9 };
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Ipv4Header syncHeader;
+      syncHeader.SetSource (hosts.Get (i + 1)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ());
+      syncHeader.SetDestination (m_ipv4->GetAddress (m_egress[i], 0).GetLocal ());
+      Ptr<Packet> sync = Create<Packet> (1);
+      Ipv4CmdSTag tag;
+      tag.SetQueueSize (sizes[i]);
+      sync->AddPacketTag (tag);
+      m_routing->RouteInput (sync, syncHeader, devices[i + 1],
+                             MakeCallback (&CmdsP4RouteInputTestCase::Receive, this),
+                             Ipv4RoutingProtocol::MulticastForwardCallback (),
+                             Ipv4RoutingProtocol::LocalDeliverCallback (),
+                             Ipv4RoutingProtocol::ErrorCallback ());
+    }
+
+  CmdsP4Reference reference (REGISTER_SIZE, 5, THRESH);
+  m_reference = &reference;
+  m_result.moves = 0;
+  m_result.flowletMoves = 0;
+  m_result.leastLoaded = 0;
+  m_result.ecmp = 0;
+  m_result.collisions = 0;
+  m_result.hops.clear ();
+  m_lastHop.assign (FLOWS, 0);
+  m_lastTime.assign (FLOWS, 0);
+
+  uint64_t ts = start;
+  for (uint32_t n = 0; n < m_traceFlows.size (); ++n)
+    {
+      ts += m_traceGaps[n];
+      Simulator::Schedule (NanoSeconds (ts), &CmdsP4RouteInputTestCase::SendPacket, this, n);
+    }
+  // The switch keeps syncing its own queue size
+  Simulator::Stop (NanoSeconds (ts + 1));
+  Simulator::Run ();
+  m_result.collisions = m_routing->GetP4Pipeline ().GetFlowletCollisions ();
+
+  m_reference = 0;
+  m_route = 0;
+  m_routing = 0;
+  m_fromHost = 0;
+  m_ipv4 = 0;
+  Simulator::Destroy ();
+
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::P4DataPlane", BooleanValue (false));
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::P4RegisterSize", UintegerValue (0xFFFF));
+  Config::SetDefault ("ns3::Ipv4CmdSRouting::P4Thresh", UintegerValue (5));
+
+  return m_result;
+}
+
+void
+CmdsP4RouteInputTestCase::DoRun (void)
+{
+  // More flows than register slots, with gaps short enough that several
+  // packets fall in the last thresh nanoseconds before the wrap
+  srand (7);
+  for (uint32_t n = 0; n < 5000; ++n)
+    {
+      m_traceFlows.push_back (rand () % FLOWS);
+      m_traceGaps.push_back (rand () % 8);
+    }
+
+  Result exact = RunTrace (false, 1000);
+  Result p4 = RunTrace (true, 1000);
+  Result wrap = RunTrace (true, 0x7fffff00u);
+  NS_TEST_ASSERT_MSG_EQ (exact.hops.size (), m_traceFlows.size (), "Every packet should be routed in exact mode");
+  NS_TEST_ASSERT_MSG_EQ (p4.hops.size (), m_traceFlows.size (), "Every packet should be routed in P4 mode");
+  NS_TEST_ASSERT_MSG_EQ (wrap.hops.size (), m_traceFlows.size (), "Every packet should be routed near the wrap");
+
+  // Exact state: a flow is placed once on the least loaded hop and stays
+  // there as long as it does not ask to switch
+  NS_TEST_EXPECT_MSG_EQ (exact.moves, 0, "Exact state never moves a flow on its own");
+  NS_TEST_EXPECT_MSG_EQ (exact.leastLoaded, m_traceFlows.size (), "Exact state places new flows on the least loaded hop");
+
+  // Divergence 1: with the flowlet state inert, every packet takes the
+  // ECMP hop of its flow and the queue lengths are ignored
+  uint32_t differ = 0;
+  for (uint32_t n = 0; n < p4.hops.size (); ++n)
+    {
+      if (p4.hops[n] != exact.hops[n])
+        {
+          differ++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (p4.collisions, 0, "id2 is never written far from the wrap");
+  NS_TEST_EXPECT_MSG_EQ (p4.ecmp, p4.hops.size (), "Far from the wrap the pipeline is ECMP");
+  NS_TEST_EXPECT_MSG_EQ (p4.moves, 0, "ECMP never moves a flow");
+  NS_TEST_EXPECT_MSG_GT (differ, 0, "Flows hashed off the least loaded hop stay off it");
+
+  // Divergence 2: once the flowlet state works, a flowlet gap re-picks the
+  // hop, and flows colliding in a register slot take over each other's
+  // remembered hop even inside a flowlet
+  NS_TEST_EXPECT_MSG_GT (wrap.collisions, 0, "The trace should exercise flowlet collisions");
+  NS_TEST_EXPECT_MSG_GT (wrap.moves, 0, "The pipeline should move flows between flowlets");
+  NS_TEST_EXPECT_MSG_GT (wrap.flowletMoves, 0, "Register collisions should move flows inside a flowlet");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -58,6 +938,12 @@ CmdsTestSuite::CmdsTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new CmdsTestCase1, TestCase::QUICK);
+  AddTestCase (new CmdsCompiledFibTestCase, TestCase::QUICK);
+  AddTestCase (new CmdsFlowTableTestCase, TestCase::QUICK);
+  AddTestCase (new CmdsQueueTrackerTestCase, TestCase::QUICK);
+  AddTestCase (new CmdsP4PipelineTestCase, TestCase::QUICK);
+  AddTestCase (new CmdsInBandSyncTestCase, TestCase::QUICK);
+  AddTestCase (new CmdsP4RouteInputTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -6,7 +6,12 @@ namespace ns3
 const unsigned Ipv4CmdSTag::DO_SWITCH = 0xffffffffu;
 const unsigned Ipv4CmdSTag::NO_SWITCH = 0xfffffffeu;
 
-Ipv4CmdSTag::Ipv4CmdSTag () {}
+Ipv4CmdSTag::Ipv4CmdSTag ()
+  : m_queueSize (NO_SWITCH),
+    m_hasQueueLength (false),
+    m_queueLength (0)
+{
+}
 
 TypeId
 Ipv4CmdSTag::GetTypeId (void)
@@ -30,6 +35,25 @@ Ipv4CmdSTag::GetQueueSize (void) const
   return m_queueSize;
 }
 
+void
+Ipv4CmdSTag::SetQueueLength (uint16_t queueLength)
+{
+  m_hasQueueLength = true;
+  m_queueLength = queueLength;
+}
+
+uint16_t
+Ipv4CmdSTag::GetQueueLength (void) const
+{
+  return m_queueLength;
+}
+
+bool
+Ipv4CmdSTag::HasQueueLength (void) const
+{
+  return m_hasQueueLength;
+}
+
 TypeId
 Ipv4CmdSTag::GetInstanceTypeId (void) const
 {
@@ -39,25 +63,33 @@ Ipv4CmdSTag::GetInstanceTypeId (void) const
 uint32_t
 Ipv4CmdSTag::GetSerializedSize (void) const
 {
-  return sizeof (uint32_t);
+  return sizeof (uint32_t) + sizeof (uint8_t) + sizeof (uint16_t);
 }
 
 void
 Ipv4CmdSTag::Serialize (TagBuffer i) const
 {
   i.WriteU32(m_queueSize);
+  i.WriteU8 (m_hasQueueLength ? 1 : 0);
+  i.WriteU16 (m_queueLength);
 }
 
 void
 Ipv4CmdSTag::Deserialize (TagBuffer i)
 {
   m_queueSize = i.ReadU32 ();
+  m_hasQueueLength = i.ReadU8 () != 0;
+  m_queueLength = i.ReadU16 ();
 }
 
 void
 Ipv4CmdSTag::Print (std::ostream &os) const
 {
   os << "Queue Size = " << m_queueSize;
+  if (m_hasQueueLength)
+    {
+      os << " Queue Length = " << m_queueLength;
+    }
 }
 
 }
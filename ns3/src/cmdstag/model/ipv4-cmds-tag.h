@@ -18,6 +18,12 @@ public:
     void SetQueueSize (uint32_t queueSize);
     uint32_t GetQueueSize (void) const;
 
+    // In-band telemetry, the op_queue_length option of cmds.p4: depth of the
+    // egress queue the last switch put the packet in
+    void SetQueueLength (uint16_t queueLength);
+    uint16_t GetQueueLength (void) const;
+    bool HasQueueLength (void) const;
+
     virtual TypeId GetInstanceTypeId (void) const;
 
     virtual uint32_t GetSerializedSize (void) const;
@@ -30,8 +36,10 @@ public:
 
 private:
 	uint32_t m_queueSize;
+	bool m_hasQueueLength;
+	uint16_t m_queueLength;
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+// Check that, once warmed up, Conga RouteInput allocates nothing but the
+// Conga tag.  The heap allocations are counted by replacing the global
+// operator new, which is why this is a program of its own and not a test
+// case of the test runner.  The program fails when a count is off.
+
+#include "ns3/core-module.h"
+#include "ns3/ipv4-conga-routing.h"
+#include "ns3/ipv4-conga-routing-helper.h"
+#include "ns3/ipv4-conga-tag.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4CongaRoutingAllocations");
+
+// Heap allocations are counted while g_countAllocations is set
+static bool g_countAllocations = false;
+static uint64_t g_allocations = 0;
+
+void *
+operator new (std::size_t size) throw (std::bad_alloc)
+{
+  if (g_countAllocations)
+    {
+      g_allocations++;
+    }
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) throw ()
+{
+  std::free (p);
+}
+
+static Ptr<Ipv4CongaRouting> g_leaf;
+static Ptr<Ipv4CongaRouting> g_spine;
+static Ptr<NetDevice> g_leafDev;
+static Ptr<NetDevice> g_spineDev;
+static Ipv4RoutingProtocol::UnicastForwardCallback g_ucb;
+static Ipv4RoutingProtocol::MulticastForwardCallback g_mcb;
+static Ipv4RoutingProtocol::LocalDeliverCallback g_lcb;
+static Ipv4RoutingProtocol::ErrorCallback g_ecb;
+static uint32_t g_forwarded = 0;
+static uint32_t g_errors = 0;
+
+static void
+Forward (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header)
+{
+  g_forwarded++;
+}
+
+static void
+Check (uint64_t actual, uint64_t expected, const char *what)
+{
+  if (actual != expected)
+    {
+      std::cerr << what << ": got " << actual << ", expected " << expected << std::endl;
+      g_errors++;
+    }
+}
+
+static Ptr<Packet>
+CreatePacket (uint32_t flowId, bool congaTag)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  packet->AddPacketTag (FlowIdTag (flowId));
+  if (congaTag)
+    {
+      Ipv4CongaTag tag;
+      tag.SetLbTag (1);
+      tag.SetCe (0);
+      tag.SetFbLbTag (2);
+      tag.SetFbMetric (1);
+      packet->AddPacketTag (tag);
+    }
+  return packet;
+}
+
+static uint64_t
+CountRouteInput (Ptr<Ipv4CongaRouting> routing, Ptr<Packet> packet, const Ipv4Header &header)
+{
+  g_allocations = 0;
+  g_countAllocations = true;
+  Ptr<NetDevice> idev = routing == g_leaf ? g_leafDev : g_spineDev;
+  bool routed = routing->RouteInput (packet, header, idev, g_ucb, g_mcb, g_lcb, g_ecb);
+  g_countAllocations = false;
+  Check (routed, true, "Packet should be forwarded");
+  return g_allocations;
+}
+
+static void
+Probe (void)
+{
+  Ipv4Header outbound;
+  outbound.SetSource (Ipv4Address ("10.1.0.1"));
+  outbound.SetDestination (Ipv4Address ("10.2.0.1"));
+  Ipv4Header inbound;
+  inbound.SetSource (Ipv4Address ("10.2.0.1"));
+  inbound.SetDestination (Ipv4Address ("10.1.0.1"));
+
+  // Warm up the lookup caches, the route cache and the tables
+  for (uint32_t flowId = 0; flowId < 32; ++flowId)
+    {
+      g_leaf->RouteInput (CreatePacket (flowId, false), outbound, g_leafDev, g_ucb, g_mcb, g_lcb, g_ecb);
+      g_leaf->RouteInput (CreatePacket (flowId, true), inbound, g_leafDev, g_ucb, g_mcb, g_lcb, g_ecb);
+      g_spine->RouteInput (CreatePacket (flowId, true), outbound, g_spineDev, g_ucb, g_mcb, g_lcb, g_ecb);
+    }
+
+  for (uint32_t flowId = 100; flowId < 132; ++flowId)
+    {
+      // New flowlets and flowlet hits at the sender leaf
+      for (uint32_t i = 0; i < 2; ++i)
+        {
+          Check (CountRouteInput (g_leaf, CreatePacket (flowId, false), outbound), 1,
+                 "Sender leaf should only allocate the Conga tag");
+        }
+      Check (CountRouteInput (g_leaf, CreatePacket (flowId, true), inbound), 0,
+             "Receiver leaf should not allocate");
+      Check (CountRouteInput (g_spine, CreatePacket (flowId, true), outbound), 0,
+             "Spine should not allocate");
+    }
+
+  // ECMP mode forwards once and returns
+  g_leaf->EnableEcmpMode ();
+  g_forwarded = 0;
+  Check (CountRouteInput (g_leaf, CreatePacket (200, false), outbound), 0,
+         "ECMP mode should not allocate");
+  Check (g_forwarded, 1, "ECMP mode should forward the packet exactly once");
+}
+
+int
+main (int argc, char *argv[])
+{
+  CommandLine cmd;
+  cmd.Parse (argc, argv);
+
+  NodeContainer switches;
+  switches.Create (2);
+  NodeContainer neighbors;
+  neighbors.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (neighbors);
+  Ipv4CongaRoutingHelper congaRoutingHelper;
+  internet.SetRoutingHelper (congaRoutingHelper);
+  internet.Install (switches);
+
+  SimpleNetDeviceHelper simple;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("192.168.0.0", "255.255.255.0");
+  NetDeviceContainer uplinks;
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      NetDeviceContainer link = simple.Install (NodeContainer (switches.Get (i), neighbors.Get (0)));
+      ipv4.Assign (link);
+      ipv4.NewNetwork ();
+      uplinks.Add (link.Get (0));
+      link = simple.Install (NodeContainer (switches.Get (i), neighbors.Get (1)));
+      ipv4.Assign (link);
+      ipv4.NewNetwork ();
+      uplinks.Add (link.Get (0));
+    }
+
+  g_leaf = congaRoutingHelper.GetCongaRouting (switches.Get (0)->GetObject<Ipv4> ());
+  g_leaf->SetLeafId (0);
+  g_leaf->AddAddressToLeafIdMap (Ipv4Address ("10.1.0.1"), 0);
+  g_leaf->AddAddressToLeafIdMap (Ipv4Address ("10.2.0.1"), 1);
+  g_spine = congaRoutingHelper.GetCongaRouting (switches.Get (1)->GetObject<Ipv4> ());
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      g_leaf->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.255.0"), uplinks.Get (i)->GetIfIndex ());
+      g_leaf->AddRoute (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.255.0"), uplinks.Get (i)->GetIfIndex ());
+      g_spine->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.255.0"), uplinks.Get (2 + i)->GetIfIndex ());
+    }
+  g_leafDev = uplinks.Get (0);
+  g_spineDev = uplinks.Get (2);
+
+  g_ucb = MakeCallback (&Forward);
+  g_ecb = MakeNullCallback<void, Ptr<const Packet>, const Ipv4Header &, Socket::SocketErrno> ();
+
+  Simulator::Schedule (MilliSeconds (1), &Probe);
+  Simulator::Run ();
+
+  g_leaf = 0;
+  g_spine = 0;
+  g_leafDev = 0;
+  g_spineDev = 0;
+  g_ucb = Ipv4RoutingProtocol::UnicastForwardCallback ();
+  g_ecb = Ipv4RoutingProtocol::ErrorCallback ();
+  Simulator::Destroy ();
+
+  if (g_errors > 0)
+    {
+      std::cerr << g_errors << " allocation check(s) failed" << std::endl;
+      return 1;
+    }
+  NS_LOG_UNCOND ("Conga RouteInput makes no heap allocation in steady state");
+  return 0;
+}
@@ -42,5 +42,22 @@ Ipv4CongaRoutingHelper::GetCongaRouting (Ptr<Ipv4> ipv4) const
   return 0;
 }
 
+int64_t
+Ipv4CongaRoutingHelper::AssignStreams (NodeContainer c, int64_t stream) const
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Ipv4> ipv4 = (*i)->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, "Ipv4 not installed on node");
+      Ptr<Ipv4CongaRouting> routing = GetCongaRouting (ipv4);
+      if (routing)
+        {
+          currentStream += routing->AssignStreams (currentStream);
+        }
+    }
+  return (currentStream - stream);
+}
+
 }
 
@@ -11,6 +11,7 @@
 #include "ipv4-conga-tag.h"
 
 #include <algorithm>
+#include <sstream>
 
 #define LOOPBACK_PORT 0
 
@@ -20,6 +21,13 @@ NS_LOG_COMPONENT_DEFINE("Ipv4CongaRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4CongaRouting);
 
+// The table dumps walk every table, only build them when logic logs are on
+#ifdef NS3_LOG_ENABLE
+#define CONGA_LOG_TABLES (g_log.IsEnabled (LOG_LOGIC))
+#else
+#define CONGA_LOG_TABLES false
+#endif
+
 Ipv4CongaRouting::Ipv4CongaRouting ():
     // Parameters
     m_isLeaf (false),
@@ -33,11 +41,14 @@ Ipv4CongaRouting::Ipv4CongaRouting ():
     m_ecmpMode (false),
     // Variables
     m_feedbackIndex (0),
-    m_dreEvent (),
-    m_agingEvent (),
+    m_dreRunning (false),
+    m_agingRunning (false),
     m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
+  // Large enough for the usual experiments never to evict
+  m_flowletTable.SetSize (65536);
 }
 
 Ipv4CongaRouting::~Ipv4CongaRouting ()
@@ -69,6 +80,12 @@ Ipv4CongaRouting::SetFlowletTimeout (Time timeout)
   m_flowletTimeout = timeout;
 }
 
+void
+Ipv4CongaRouting::SetFlowletTableSize (uint32_t size)
+{
+  m_flowletTable.SetSize (size);
+}
+
 void
 Ipv4CongaRouting::SetAlpha (double alpha)
 {
@@ -90,6 +107,10 @@ Ipv4CongaRouting::SetLinkCapacity (DataRate dataRate)
 void
 Ipv4CongaRouting::SetLinkCapacity (uint32_t interface, DataRate dataRate)
 {
+  if (interface >= m_Cs.size ())
+  {
+    m_Cs.resize (interface + 1, DataRate (0));
+  }
   m_Cs[interface] = dataRate;
 }
 
@@ -126,18 +147,48 @@ Ipv4CongaRouting::GetQueue (void) const
 void
 Ipv4CongaRouting::InitCongestion (uint32_t leafId, uint32_t port, uint32_t congestion)
 {
-  std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator itr =
-      m_congaToLeafTable.find(leafId);
-  if (itr != m_congaToLeafTable.end ())
+  CongaToLeafEntry &entry = Ipv4CongaRouting::GetCongaToLeafEntry (leafId, port);
+  entry.ce = congestion;
+  entry.updateTime = Simulator::Now ();
+  entry.valid = true;
+}
+
+CongaToLeafEntry &
+Ipv4CongaRouting::GetCongaToLeafEntry (uint32_t leafId, uint32_t port)
+{
+  if (leafId >= m_congaToLeafTable.size ())
   {
-    (itr->second)[port] = std::make_pair(Simulator::Now (), congestion);
+    m_congaToLeafTable.resize (leafId + 1);
   }
-  else
+  std::vector<CongaToLeafEntry> &row = m_congaToLeafTable[leafId];
+  if (port >= row.size ())
+  {
+    CongaToLeafEntry empty;
+    empty.ce = 0;
+    empty.valid = false;
+    row.resize (port + 1, empty);
+  }
+  return row[port];
+}
+
+FeedbackInfo &
+Ipv4CongaRouting::GetCongaFromLeafEntry (uint32_t leafId, uint32_t port)
+{
+  if (leafId >= m_congaFromLeafTable.size ())
+  {
+    m_congaFromLeafTable.resize (leafId + 1);
+    m_congaFromLeafSize.resize (leafId + 1, 0);
+  }
+  std::vector<FeedbackInfo> &row = m_congaFromLeafTable[leafId];
+  if (port >= row.size ())
   {
-    std::map<uint32_t, std::pair<Time, uint32_t> > newMap;
-    newMap[port] = std::make_pair(Simulator::Now (), congestion);
-    m_congaToLeafTable[leafId] = newMap;
+    FeedbackInfo empty;
+    empty.ce = 0;
+    empty.change = false;
+    empty.valid = false;
+    row.resize (port + 1, empty);
   }
+  return row[port];
 }
 
 void
@@ -149,38 +200,44 @@ Ipv4CongaRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t
   congaRouteEntry.networkMask = networkMask;
   congaRouteEntry.port = port;
   m_routeEntryList.push_back (congaRouteEntry);
+
+  // The candidate ports of every destination may have changed
+  m_candidatePortSpans.clear ();
+  m_candidatePorts.clear ();
 }
 
-std::vector<CongaRouteEntry>
-Ipv4CongaRouting::LookupCongaRouteEntries (Ipv4Address dest)
+const uint32_t *
+Ipv4CongaRouting::LookupCandidatePorts (Ipv4Address dest, uint32_t &size)
 {
-  std::vector<CongaRouteEntry> congaRouteEntries;
-  std::vector<CongaRouteEntry>::iterator itr = m_routeEntryList.begin ();
-  for ( ; itr != m_routeEntryList.end (); ++itr)
+  std::map<Ipv4Address, CandidatePortSpan>::iterator spanItr = m_candidatePortSpans.find (dest);
+  if (spanItr == m_candidatePortSpans.end ())
   {
-    if((*itr).networkMask.IsMatch(dest, (*itr).network))
+    // First packet to this destination, match it against the route entries once
+    CandidatePortSpan span;
+    span.begin = m_candidatePorts.size ();
+    std::vector<CongaRouteEntry>::iterator itr = m_routeEntryList.begin ();
+    for ( ; itr != m_routeEntryList.end (); ++itr)
     {
-      congaRouteEntries.push_back (*itr);
+      if((*itr).networkMask.IsMatch(dest, (*itr).network))
+      {
+        m_candidatePorts.push_back ((*itr).port);
+      }
     }
+    span.size = m_candidatePorts.size () - span.begin;
+    spanItr = m_candidatePortSpans.insert (std::make_pair (dest, span)).first;
   }
-  return congaRouteEntries;
+  size = (spanItr->second).size;
+  if (size == 0)
+  {
+    return NULL;
+  }
+  return &m_candidatePorts[(spanItr->second).begin];
 }
 
 Ptr<Ipv4Route>
 Ipv4CongaRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
 {
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
-  Ptr<Channel> channel = dev->GetChannel ();
-  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-  Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-  uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-  Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4>()->GetAddress(nextIf,0).GetLocal();
-  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (m_ipv4->GetNetDevice (port));
-  route->SetGateway (nextHopAddr);
-  route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
-  route->SetDestination (destAddress);
-  return route;
+  return m_routeCache->GetRoute (port, destAddress);
 }
 
 Ptr<Ipv4Route>
@@ -233,9 +290,10 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   }
   flowId = flowIdTag.GetFlowId ();
 
-  std::vector<CongaRouteEntry> routeEntries = Ipv4CongaRouting::LookupCongaRouteEntries (destAddress);
+  uint32_t nPorts = 0;
+  const uint32_t *ports = Ipv4CongaRouting::LookupCandidatePorts (destAddress, nPorts);
 
-  if (routeEntries.empty ())
+  if (nPorts == 0)
   {
     NS_LOG_ERROR (this << " Conga routing cannot find routing entry");
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
@@ -245,24 +303,15 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   // Dev use
   if (m_ecmpMode)
   {
-    uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()].port;
+    uint32_t selectedPort = ports[flowId % nPorts];
     Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route (selectedPort, destAddress);
     ucb (route, packet, header);
+    return true;
   }
 
-  // Turn on DRE event scheduler if it is not running
-  if (!m_dreEvent.IsRunning ())
-  {
-    NS_LOG_LOGIC (this << " Conga routing restarts dre event scheduling");
-    m_dreEvent = Simulator::Schedule(m_tdre, &Ipv4CongaRouting::DreEvent, this);
-  }
-
-  // Turn on aging event scheduler if it is not running
-  if (!m_agingEvent.IsRunning ())
-  {
-    NS_LOG_LOGIC (this << "Conga routing restarts aging event scheduling");
-    m_agingEvent = Simulator::Schedule(m_agingTime / 4, &Ipv4CongaRouting::AgingEvent, this);
-  }
+  // Apply the DRE and aging events due since the last packet
+  // and turn them on again if they went idle
+  Ipv4CongaRouting::RunDueEvents (now);
 
   // First, check if this switch if leaf switch
   if (m_isLeaf)
@@ -282,9 +331,12 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       // Build an empty Conga header (as the packet tag)
       // Determine the port and fill the header fields
 
-      Ipv4CongaRouting::PrintDreTable ();
-      Ipv4CongaRouting::PrintCongaToLeafTable ();
-      Ipv4CongaRouting::PrintFlowletTable ();
+      if (CONGA_LOG_TABLES)
+      {
+        Ipv4CongaRouting::PrintDreTable ();
+        Ipv4CongaRouting::PrintCongaToLeafTable ();
+        Ipv4CongaRouting::PrintFlowletTable ();
+      }
 
       // Determine the dest switch leaf id
       std::map<Ipv4Address, uint32_t>::iterator itr = m_ipLeafIdMap.find(destAddress);
@@ -296,36 +348,46 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       }
       uint32_t destLeafId = itr->second;
 
-      // Check piggyback information
-      std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator fbItr =
-          m_congaFromLeafTable.find (destLeafId);
-
       uint32_t fbLbTag = LOOPBACK_PORT;
       uint32_t fbMetric = 0;
 
       // Piggyback according to round robin and favoring those that has been changed
-      if (fbItr != m_congaFromLeafTable.end ())
+      if (destLeafId < m_congaFromLeafSize.size () && m_congaFromLeafSize[destLeafId] != 0)
       {
-        std::map<uint32_t, FeedbackInfo>::iterator innerFbItr = (fbItr->second).begin ();
-        std::advance (innerFbItr, m_feedbackIndex++ % (fbItr->second).size ()); // round robin
+        std::vector<FeedbackInfo> &fbRow = m_congaFromLeafTable[destLeafId];
+        uint32_t fbSize = m_congaFromLeafSize[destLeafId];
 
-        if ((innerFbItr->second).change == false)  // prefer the changed ones
+        // round robin over the valid entries, in port order
+        uint32_t rank = m_feedbackIndex++ % fbSize;
+        uint32_t fbPort = 0;
+        for ( ; ; ++fbPort)
         {
-          for (unsigned loopIndex = 0; loopIndex < (fbItr->second).size (); loopIndex ++) // prevent infinite looping
+          if (fbRow[fbPort].valid && rank-- == 0)
           {
-            if (++innerFbItr == (fbItr->second).end ()) {
-              innerFbItr = (fbItr->second).begin (); // start from the beginning
-            }
-            if ((innerFbItr->second).change == true)
+            break;
+          }
+        }
+
+        if (fbRow[fbPort].change == false)  // prefer the changed ones
+        {
+          for (unsigned loopIndex = 0; loopIndex < fbSize; loopIndex ++) // prevent infinite looping
+          {
+            do
+            {
+              if (++fbPort == fbRow.size ()) {
+                fbPort = 0; // start from the beginning
+              }
+            } while (!fbRow[fbPort].valid);
+            if (fbRow[fbPort].change == true)
             {
               break;
             }
           }
         }
 
-        fbLbTag = innerFbItr->first;
-        fbMetric = (innerFbItr->second).ce;
-        (innerFbItr->second).change = false;
+        fbLbTag = fbPort;
+        fbMetric = fbRow[fbPort].ce;
+        fbRow[fbPort].change = false;
       }
 
       // Port determination logic:
@@ -333,21 +395,18 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       // If not hit, determine the port based on the congestion degree of the link
 
       // Flowlet table look up
-      struct Flowlet *flowlet = NULL;
+      FlowletTable::Flowlet &flowlet = m_flowletTable.Lookup (flowId, now, m_flowletTimeout);
 
       // If the flowlet table entry is valid, return the port
-      std::map<uint32_t, struct Flowlet *>::iterator flowletItr = m_flowletTable.find (flowId);
-      if (flowletItr != m_flowletTable.end ())
+      if (flowlet.used)
       {
-        flowlet = flowletItr->second;
-        if (flowlet != NULL && // Impossible in normal cases
-            now - flowlet->activeTime <= m_flowletTimeout)
+        if (now - flowlet.lastSeen <= m_flowletTimeout)
         {
           // Do not forget to update the flowlet active time
-          flowlet->activeTime = now;
+          flowlet.lastSeen = now;
 
           // Return the port information used for routing routine to select the port
-          selectedPort = flowlet->port;
+          selectedPort = flowlet.port;
 
           // Construct Conga Header for the packet
           ipv4CongaTag.SetLbTag (selectedPort);
@@ -374,34 +433,34 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       // Not hit. Determine the port
 
       // 1. Select port congestion information based on dest leaf switch id
-      std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator
-          congaToLeafItr = m_congaToLeafTable.find (destLeafId);
+      const std::vector<CongaToLeafEntry> *congaToLeafRow = NULL;
+      if (destLeafId < m_congaToLeafTable.size ())
+      {
+        congaToLeafRow = &m_congaToLeafTable[destLeafId];
+      }
 
       // 2. Prepare the candidate port
       // For a new flowlet, we pick the uplink port that minimizes the maximum of the local metric (from the local DREs)
       // and the remote metric (from the Congestion-To-Leaf Table).
       uint32_t minPortCongestion = (std::numeric_limits<uint32_t>::max)();
 
-      std::vector<uint32_t> portCandidates;
-      std::vector<CongaRouteEntry>::iterator routeEntryItr = routeEntries.begin ();
+      std::vector<uint32_t> &portCandidates = m_portCandidates;
+      portCandidates.clear ();
 
-      for ( ; routeEntryItr != routeEntries.end (); ++routeEntryItr)
+      for (uint32_t portIndex = 0; portIndex < nPorts; ++portIndex)
       {
-        uint32_t port = (*routeEntryItr).port;
+        uint32_t port = ports[portIndex];
         uint32_t localCongestion = 0;
         uint32_t remoteCongestion = 0;
 
-        std::map<uint32_t, uint32_t>::iterator localCongestionItr = m_XMap.find (port);
-        if (localCongestionItr != m_XMap.end ())
+        if (port < m_XMap.size ())
         {
-          localCongestion = Ipv4CongaRouting::QuantizingX (port, localCongestionItr->second);
+          localCongestion = Ipv4CongaRouting::QuantizingX (port, m_XMap[port]);
         }
 
-        std::map<uint32_t, std::pair<Time, uint32_t> >::iterator remoteCongestionItr =
-            (congaToLeafItr->second).find (port);
-        if (remoteCongestionItr != (congaToLeafItr->second).end ())
+        if (congaToLeafRow != NULL && port < congaToLeafRow->size () && (*congaToLeafRow)[port].valid)
         {
-          remoteCongestion = (remoteCongestionItr->second).second;
+          remoteCongestion = (*congaToLeafRow)[port].ce;
         }
 
         uint32_t congestionDegree = std::max (localCongestion, remoteCongestion);
@@ -421,30 +480,21 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       }
 
       // 3. Select one port from all those candidate ports
-      if (flowlet != NULL &&
-            std::find(portCandidates.begin (), portCandidates.end (), flowlet->port) != portCandidates.end ())
+      if (flowlet.used &&
+            std::find(portCandidates.begin (), portCandidates.end (), flowlet.port) != portCandidates.end ())
       {
         // Prefer the port cached in flowlet table
-        selectedPort = flowlet->port;
+        selectedPort = flowlet.port;
         // Activate the flowlet entry again
-        flowlet->activeTime = now;
+        flowlet.lastSeen = now;
       }
       else
       {
         // If there are no cached ports, we randomly choose a good port
-        selectedPort = portCandidates[rand() % portCandidates.size ()];
-        if (flowlet == NULL)
-        {
-          struct Flowlet *newFlowlet = new Flowlet;
-          newFlowlet->port = selectedPort;
-          newFlowlet->activeTime = now;
-          m_flowletTable[flowId] = newFlowlet;
-        }
-        else
-        {
-          flowlet->port = selectedPort;
-          flowlet->activeTime = now;
-        }
+        selectedPort = portCandidates[m_rand->GetInteger (0, portCandidates.size () - 1)];
+        flowlet.used = true;
+        flowlet.port = selectedPort;
+        flowlet.lastSeen = now;
       }
 
       // 4. Construct Conga Header for the packet
@@ -486,54 +536,23 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       uint32_t sourceLeafId = itr->second;
 
       // 1. Update the CongaFromLeafTable
-      std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator fromLeafItr = m_congaFromLeafTable.find (sourceLeafId);
-
-      if (fromLeafItr == m_congaFromLeafTable.end ())
+      FeedbackInfo &feedbackInfo = Ipv4CongaRouting::GetCongaFromLeafEntry (sourceLeafId, ipv4CongaTag.GetLbTag ());
+      if (!feedbackInfo.valid)
       {
-        std::map<uint32_t, FeedbackInfo> newMap;
-        FeedbackInfo feedbackInfo;
-        feedbackInfo.ce = ipv4CongaTag.GetCe ();
-        feedbackInfo.change = true;
-        feedbackInfo.updateTime = Simulator::Now ();
-        newMap[ipv4CongaTag.GetLbTag ()] = feedbackInfo;
-        m_congaFromLeafTable[sourceLeafId] = newMap;
-      }
-      else
-      {
-        std::map<uint32_t, FeedbackInfo>::iterator innerItr = (fromLeafItr->second).find (ipv4CongaTag.GetLbTag ());
-        if (innerItr == (fromLeafItr->second).end ())
-        {
-          FeedbackInfo feedbackInfo;
-          feedbackInfo.ce = ipv4CongaTag.GetCe ();
-          feedbackInfo.change = true;
-          feedbackInfo.updateTime = Simulator::Now ();
-          (fromLeafItr->second)[ipv4CongaTag.GetLbTag ()] = feedbackInfo;
-        }
-        else
-        {
-          (innerItr->second).ce = ipv4CongaTag.GetCe ();
-          (innerItr->second).change = true;
-          (innerItr->second).updateTime = Simulator::Now ();
-        }
+        feedbackInfo.valid = true;
+        m_congaFromLeafSize[sourceLeafId]++;
       }
+      feedbackInfo.ce = ipv4CongaTag.GetCe ();
+      feedbackInfo.change = true;
+      feedbackInfo.updateTime = Simulator::Now ();
 
       // 2. Update the CongaToLeafTable
       if (ipv4CongaTag.GetFbLbTag () != LOOPBACK_PORT)
       {
-        std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator toLeafItr =
-            m_congaToLeafTable.find(sourceLeafId);
-        if (toLeafItr != m_congaToLeafTable.end ())
-        {
-          (toLeafItr->second)[ipv4CongaTag.GetFbLbTag ()] =
-              std::make_pair(Simulator::Now (), ipv4CongaTag.GetFbMetric ());
-        }
-        else
-        {
-          std::map<uint32_t, std::pair<Time, uint32_t> > newMap;
-          newMap[ipv4CongaTag.GetFbLbTag ()] =
-              std::make_pair(Simulator::Now (), ipv4CongaTag.GetFbMetric ());
-          m_congaToLeafTable[sourceLeafId] = newMap;
-        }
+        CongaToLeafEntry &toLeafEntry = Ipv4CongaRouting::GetCongaToLeafEntry (sourceLeafId, ipv4CongaTag.GetFbLbTag ());
+        toLeafEntry.ce = ipv4CongaTag.GetFbMetric ();
+        toLeafEntry.updateTime = Simulator::Now ();
+        toLeafEntry.valid = true;
       }
 
       // Not necessary
@@ -541,16 +560,19 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       packet->RemovePacketTag (ipv4CongaTag);
 
       // Pick port using standard ECMP
-      uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()].port;
+      uint32_t selectedPort = ports[flowId % nPorts];
 
       Ipv4CongaRouting::UpdateLocalDre (header, packet, selectedPort);
 
       Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route (selectedPort, destAddress);
       ucb (route, packet, header);
 
-      Ipv4CongaRouting::PrintDreTable ();
-      Ipv4CongaRouting::PrintCongaToLeafTable ();
-      Ipv4CongaRouting::PrintCongaFromLeafTable ();
+      if (CONGA_LOG_TABLES)
+      {
+        Ipv4CongaRouting::PrintDreTable ();
+        Ipv4CongaRouting::PrintCongaToLeafTable ();
+        Ipv4CongaRouting::PrintCongaFromLeafTable ();
+      }
 
       return true;
     }
@@ -569,7 +591,7 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     }
 
     // Determine the port using standard ECMP
-    uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()].port;
+    uint32_t selectedPort = ports[flowId % nPorts];
 
     // Update local dre
     uint32_t X = Ipv4CongaRouting::UpdateLocalDre (header, packet, selectedPort);
@@ -603,11 +625,19 @@ Ipv4CongaRouting::NotifyInterfaceUp (uint32_t interface)
 void
 Ipv4CongaRouting::NotifyInterfaceDown (uint32_t interface)
 {
+  if (m_routeCache != 0)
+    {
+      m_routeCache->Invalidate (interface);
+    }
 }
 
 void
 Ipv4CongaRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  if (m_routeCache != 0)
+    {
+      m_routeCache->Invalidate (interface);
+    }
 }
 
 void
@@ -621,6 +651,7 @@ Ipv4CongaRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_LOGIC (this << "Setting up Ipv4: " << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  m_routeCache = Ipv4RouteCache::GetRouteCache (ipv4);
 }
 
 void
@@ -629,16 +660,20 @@ Ipv4CongaRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 }
 
 
+int64_t
+Ipv4CongaRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 void
 Ipv4CongaRouting::DoDispose (void)
 {
-  std::map<uint32_t, Flowlet *>::iterator itr = m_flowletTable.begin ();
-  for ( ; itr != m_flowletTable.end (); ++itr )
-  {
-    delete (itr->second);
-  }
-  m_dreEvent.Cancel ();
-  m_agingEvent.Cancel ();
+  m_dreRunning = false;
+  m_agingRunning = false;
+  m_routeCache = 0;
   m_ipv4=0;
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -646,62 +681,92 @@ Ipv4CongaRouting::DoDispose (void)
 uint32_t
 Ipv4CongaRouting::UpdateLocalDre (const Ipv4Header &header, Ptr<Packet> packet, uint32_t port)
 {
-  uint32_t X = 0;
-  std::map<uint32_t, uint32_t>::iterator XItr = m_XMap.find(port);
-  if (XItr != m_XMap.end ())
+  if (port >= m_XMap.size ())
   {
-    X = XItr->second;
+    m_XMap.resize (port + 1, 0);
   }
-  uint32_t newX = X + packet->GetSize () + header.GetSerializedSize ();
+  uint32_t newX = m_XMap[port] + packet->GetSize () + header.GetSerializedSize ();
   NS_LOG_LOGIC (this << " Update local dre, new X: " << newX);
   m_XMap[port] = newX;
   return newX;
 }
 
 void
+Ipv4CongaRouting::RunDueEvents (Time now)
+{
+  // Nothing reads the tables between two packets, so running the events
+  // late, in order and at their own time, gives the same tables as
+  // scheduling them.  An event that goes idle stops the catch up.
+  while (m_dreRunning && m_dreNextTick <= now)
+  {
+    m_dreRunning = Ipv4CongaRouting::DreEvent ();
+    m_dreNextTick += m_tdre;
+  }
+  if (!m_dreRunning)
+  {
+    NS_LOG_LOGIC (this << " Conga routing restarts dre event scheduling");
+    m_dreRunning = true;
+    m_dreNextTick = now + m_tdre;
+  }
+
+  while (m_agingRunning && m_agingNextTick <= now)
+  {
+    m_agingRunning = Ipv4CongaRouting::AgingEvent (m_agingNextTick);
+    m_agingNextTick += m_agingTime / 4;
+  }
+  if (!m_agingRunning)
+  {
+    NS_LOG_LOGIC (this << "Conga routing restarts aging event scheduling");
+    m_agingRunning = true;
+    m_agingNextTick = now + m_agingTime / 4;
+  }
+}
+
+bool
 Ipv4CongaRouting::DreEvent ()
 {
   bool moveToIdleStatus = true;
 
-  std::map<uint32_t, uint32_t>::iterator itr = m_XMap.begin ();
+  std::vector<uint32_t>::iterator itr = m_XMap.begin ();
   for ( ; itr != m_XMap.end (); ++itr )
   {
-    uint32_t newX = itr->second * (1 - m_alpha);
-    itr->second = newX;
+    uint32_t newX = *itr * (1 - m_alpha);
+    *itr = newX;
     if (newX != 0)
     {
       moveToIdleStatus = false;
     }
   }
 
-  NS_LOG_LOGIC (this << " Dre event finished, the dre table is now: ");
-  Ipv4CongaRouting::PrintDreTable ();
-
-  if (!moveToIdleStatus)
+  if (CONGA_LOG_TABLES)
   {
-    m_dreEvent = Simulator::Schedule(m_tdre, &Ipv4CongaRouting::DreEvent, this);
+    NS_LOG_LOGIC (this << " Dre event finished, the dre table is now: ");
+    Ipv4CongaRouting::PrintDreTable ();
   }
-  else
+
+  if (moveToIdleStatus)
   {
     NS_LOG_LOGIC (this << " Dre event goes into idle status");
   }
+  return !moveToIdleStatus;
 }
 
-void
-Ipv4CongaRouting::AgingEvent ()
+bool
+Ipv4CongaRouting::AgingEvent (Time now)
 {
     bool moveToIdleStatus = true;
-    std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator itr =
-        m_congaToLeafTable.begin ();
-    for ( ; itr != m_congaToLeafTable.end (); ++itr)
+    for (uint32_t leafId = 0; leafId < m_congaToLeafTable.size (); ++leafId)
     {
-      std::map<uint32_t, std::pair<Time, uint32_t> >::iterator innerItr =
-        (itr->second).begin ();
-      for (; innerItr != (itr->second).end (); ++innerItr)
+      std::vector<CongaToLeafEntry> &row = m_congaToLeafTable[leafId];
+      for (uint32_t port = 0; port < row.size (); ++port)
       {
-        if (Simulator::Now () - (innerItr->second).first > m_agingTime)
+        if (!row[port].valid)
         {
-          (innerItr->second).second = 0;
+          continue;
+        }
+        if (now - row[port].updateTime > m_agingTime)
+        {
+          row[port].ce = 0;
         }
         else
         {
@@ -709,21 +774,19 @@ Ipv4CongaRouting::AgingEvent ()
         }
       }
     }
-    std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator itr2 =
-        m_congaFromLeafTable.begin ();
-    for ( ; itr2 != m_congaFromLeafTable.end (); ++itr2 )
+    for (uint32_t leafId = 0; leafId < m_congaFromLeafTable.size (); ++leafId)
     {
-        std::map<uint32_t, FeedbackInfo>::iterator innerItr2 =
-          (itr2->second).begin ();
-        for ( ; innerItr2 != (itr2->second).end (); ++innerItr2)
+        std::vector<FeedbackInfo> &row = m_congaFromLeafTable[leafId];
+        for (uint32_t port = 0; port < row.size (); ++port)
         {
-          if (Simulator::Now () - (innerItr2->second).updateTime > m_agingTime)
+          if (!row[port].valid)
           {
-            (itr2->second).erase (innerItr2);
-            if ((itr2->second).empty ())
-            {
-                m_congaFromLeafTable.erase (itr2);
-            }
+            continue;
+          }
+          if (now - row[port].updateTime > m_agingTime)
+          {
+            row[port].valid = false;
+            m_congaFromLeafSize[leafId]--;
           }
           else
           {
@@ -732,25 +795,20 @@ Ipv4CongaRouting::AgingEvent ()
         }
     }
 
-
-    if (!moveToIdleStatus)
-    {
-      m_agingEvent = Simulator::Schedule(m_agingTime / 4, &Ipv4CongaRouting::AgingEvent, this);
-    }
-    else
+    if (moveToIdleStatus)
     {
       NS_LOG_LOGIC (this << " Aging event goes into idle status");
     }
+    return !moveToIdleStatus;
 }
 
 uint32_t
 Ipv4CongaRouting::QuantizingX (uint32_t interface, uint32_t X)
 {
   DataRate c = m_C;
-  std::map<uint32_t, DataRate>::iterator itr = m_Cs.find (interface);
-  if (itr != m_Cs.end ())
+  if (interface < m_Cs.size () && m_Cs[interface].GetBitRate () != 0)
   {
-    c = itr->second;
+    c = m_Cs[interface];
   }
   double ratio = static_cast<double> (X * 8) / (c.GetBitRate () * m_tdre.GetSeconds () / m_alpha);
   NS_LOG_LOGIC ("ratio: " << ratio);
@@ -760,87 +818,77 @@ Ipv4CongaRouting::QuantizingX (uint32_t interface, uint32_t X)
 void
 Ipv4CongaRouting::PrintCongaToLeafTable ()
 {
-/*
   std::ostringstream oss;
   oss << "===== CongaToLeafTable For Leaf: " << m_leafId <<"=====" << std::endl;
-  std::map<uint32_t, std::map<uint32_t, uint32_t> >::iterator itr = m_congaToLeafTable.begin ();
-  for ( ; itr != m_congaToLeafTable.end (); ++itr )
+  for (uint32_t leafId = 0; leafId < m_congaToLeafTable.size (); ++leafId)
   {
-    oss << "Leaf ID: " << itr->first << std::endl<<"\t";
-    std::map<uint32_t, uint32_t>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr)
+    oss << "Leaf ID: " << leafId << std::endl<<"\t";
+    const std::vector<CongaToLeafEntry> &row = m_congaToLeafTable[leafId];
+    for (uint32_t port = 0; port < row.size (); ++port)
     {
-      oss << "{ port: "
-          << innerItr->first << ", ce: "  << (innerItr->second)
-          << " } ";
+      if (row[port].valid)
+      {
+        oss << "{ port: "
+            << port << ", ce: "  << row[port].ce
+            << " } ";
+      }
     }
     oss << std::endl;
   }
   oss << "============================";
   NS_LOG_LOGIC (oss.str ());
-*/
 }
 
 void
 Ipv4CongaRouting::PrintCongaFromLeafTable ()
 {
-/*
   std::ostringstream oss;
   oss << "===== CongaFromLeafTable For Leaf: " << m_leafId << "=====" <<std::endl;
-  std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator itr = m_congaFromLeafTable.begin ();
-  for ( ; itr != m_congaFromLeafTable.end (); ++itr )
+  for (uint32_t leafId = 0; leafId < m_congaFromLeafTable.size (); ++leafId)
   {
-    oss << "Leaf ID: " << itr->first << std::endl << "\t";
-    std::map<uint32_t, FeedbackInfo>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr)
+    oss << "Leaf ID: " << leafId << std::endl << "\t";
+    const std::vector<FeedbackInfo> &row = m_congaFromLeafTable[leafId];
+    for (uint32_t port = 0; port < row.size (); ++port)
     {
-      oss << "{ port: "
-          << innerItr->first << ", ce: "  << (innerItr->second).ce
-          << ", change: " << (innerItr->second).change
-          << " } ";
+      if (row[port].valid)
+      {
+        oss << "{ port: "
+            << port << ", ce: "  << row[port].ce
+            << ", change: " << row[port].change
+            << " } ";
+      }
     }
     oss << std::endl;
   }
   oss << "==============================";
   NS_LOG_LOGIC (oss.str ());
-*/
 }
 
 void
 Ipv4CongaRouting::PrintFlowletTable ()
 {
-/*
   std::ostringstream oss;
   oss << "===== Flowlet For Leaf: " << m_leafId << "=====" << std::endl;
-  std::map<uint32_t, Flowlet*>::iterator itr = m_flowletTable.begin ();
-  for ( ; itr != m_flowletTable.end(); ++itr )
-  {
-    oss << "flowId: " << itr->first << std::endl << "\t"
-        << "port: " << (itr->second)->port << "\t"
-        << "activeTime" << (itr->second)->activeTime << std::endl;
-  }
+  oss << "slots: " << m_flowletTable.GetSize ()
+      << ", evictions: " << m_flowletTable.GetNEvictions () << std::endl;
   oss << "===================";
   NS_LOG_LOGIC (oss.str ());
-*/
 }
 
 void
 Ipv4CongaRouting::PrintDreTable ()
 {
-/*
   std::ostringstream oss;
   std::string switchType = m_isLeaf == true ? "leaf switch" : "spine switch";
   oss << "==== Local Dre for " << switchType << " ====" <<std::endl;
-  std::map<uint32_t, uint32_t>::iterator itr = m_XMap.begin ();
-  for ( ; itr != m_XMap.end (); ++itr)
+  for (uint32_t port = 0; port < m_XMap.size (); ++port)
   {
-    oss << "port: " << itr->first <<
-      ", X: " << itr->second <<
-      ", Quantized X: " << Ipv4CongaRouting::QuantizingX (itr->second) <<std::endl;
+    oss << "port: " << port <<
+      ", X: " << m_XMap[port] <<
+      ", Quantized X: " << Ipv4CongaRouting::QuantizingX (port, m_XMap[port]) <<std::endl;
   }
   oss << "=================================";
   NS_LOG_LOGIC (oss.str ());
-*/
 }
 
 
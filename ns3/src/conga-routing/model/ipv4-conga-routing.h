@@ -4,6 +4,7 @@
 
 #include <cstring>
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route-cache.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -20,6 +21,8 @@
 #include "ns3/ptr.h"
 #include "ns3/mac48-address.h"
 #include "ns3/queue.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/flowlet-table.h"
 
 
 #include <map>
@@ -27,15 +30,17 @@
 
 namespace ns3 {
 
-struct Flowlet {
-  uint32_t port;
-  Time activeTime;
-};
-
 struct FeedbackInfo {
   uint32_t ce;
   bool change;
   Time updateTime;
+  bool valid;
+};
+
+struct CongaToLeafEntry {
+  uint32_t ce;
+  Time updateTime;
+  bool valid;
 };
 
 struct CongaRouteEntry {
@@ -66,6 +71,8 @@ public:
 
   void SetFlowletTimeout (Time timeout);
 
+  void SetFlowletTableSize (uint32_t size);
+
   void AddAddressToLeafIdMap (Ipv4Address addr, uint32_t leafId);
 
   void AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port);
@@ -106,6 +113,13 @@ public:
 
   virtual void DoDispose (void);
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   */
+  int64_t AssignStreams (int64_t stream);
+
 private:
 
   // ------ Parameters ------
@@ -122,7 +136,8 @@ private:
 
   DataRate m_C;
 
-  std::map<uint32_t, DataRate> m_Cs;
+  // Per interface capacity, a zero rate means m_C
+  std::vector<DataRate> m_Cs;
 
   // Quantizing bits
   uint32_t m_Q;
@@ -139,48 +154,76 @@ private:
   // Used to maintain the round robin
   unsigned long m_feedbackIndex;
 
-  // Dre Event ID
-  EventId m_dreEvent;
+  // The DRE and aging events are not scheduled, the ones due are run
+  // when the next packet arrives, so an idle switch costs nothing
+  bool m_dreRunning;
+  Time m_dreNextTick;
 
-  // Metric aging event
-  EventId m_agingEvent;
+  bool m_agingRunning;
+  Time m_agingNextTick;
 
   // Ipv4 associated with this router
   Ptr<Ipv4> m_ipv4;
+  Ptr<Ipv4RouteCache> m_routeCache;
+
+  Ptr<UniformRandomVariable> m_rand;
 
   // Route table
   std::vector<CongaRouteEntry> m_routeEntryList;
 
+  // Candidate ports of each destination seen, as spans of m_candidatePorts
+  struct CandidatePortSpan
+  {
+    uint32_t begin;
+    uint32_t size;
+  };
+  std::map<Ipv4Address, CandidatePortSpan> m_candidatePortSpans;
+  std::vector<uint32_t> m_candidatePorts;
+
+  // Best ports of a new flowlet, kept across packets to reuse its storage
+  std::vector<uint32_t> m_portCandidates;
+
   // Ip and leaf switch map,
   // used to determine the which leaf switch the packet would go through
   std::map<Ipv4Address, uint32_t> m_ipLeafIdMap;
 
-  // Congestion To Leaf Table
-  std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > > m_congaToLeafTable;
+  // Congestion To Leaf Table, indexed by [leaf id][port]
+  std::vector<std::vector<CongaToLeafEntry> > m_congaToLeafTable;
+
+  // Congestion From Leaf Table, indexed by [leaf id][port]
+  std::vector<std::vector<FeedbackInfo> > m_congaFromLeafTable;
 
-  // Congestion From Leaf Table
-  std::map<uint32_t, std::map<uint32_t, FeedbackInfo> > m_congaFromLeafTable;
+  // Number of valid entries in each row of the Congestion From Leaf Table
+  std::vector<uint32_t> m_congaFromLeafSize;
 
   // Flowlet Table
-  std::map<uint32_t, Flowlet *> m_flowletTable;
+  FlowletTable m_flowletTable;
 
   // Parameters
-  // DRE
-  std::map<uint32_t, uint32_t> m_XMap;
+  // DRE, indexed by port
+  std::vector<uint32_t> m_XMap;
 
   // ------ Functions ------
   // DRE algorithm
   uint32_t UpdateLocalDre (const Ipv4Header &header, Ptr<Packet> packet, uint32_t path);
 
-  void DreEvent();
+  void RunDueEvents (Time now);
+
+  // Both return whether the event keeps running
+  bool DreEvent();
+
+  bool AgingEvent (Time now);
 
-  void AgingEvent ();
+  // Entries of the congestion tables, the rows grow on demand
+  CongaToLeafEntry &GetCongaToLeafEntry (uint32_t leafId, uint32_t port);
+  FeedbackInfo &GetCongaFromLeafEntry (uint32_t leafId, uint32_t port);
 
   // Quantizing X to metrics degree
   // X is bytes here and we quantizing it to 0 - 2^Q
   uint32_t QuantizingX (uint32_t interface, uint32_t X);
 
-  std::vector<CongaRouteEntry> LookupCongaRouteEntries (Ipv4Address dest);
+  // Ports of the route entries matching dest, computed on the first lookup
+  const uint32_t *LookupCandidatePorts (Ipv4Address dest, uint32_t &size);
 
   Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
 
@@ -2,54 +2,192 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-conga-routing.h"
+#include "ns3/ipv4-conga-routing-helper.h"
+#include "ns3/ipv4-conga-tag.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/ipv4-route-input-test.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <set>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
 
-// This is an example TestCase.
-class Ipv4CongaRoutingTestCase1 : public TestCase
+namespace {
+
+const Ipv4Address g_local ("10.1.0.2");
+const Ipv4Address g_leaf2 ("10.2.0.1");
+const Ipv4Address g_leaf3 ("10.3.0.1");
+
+}
+
+// Leaf 1 running CONGA with one ingress port and n uplink ports, all of
+// them routes to 10.0.0.0/8; the hosts 10.2.0.1 and 10.3.0.1 are under
+// the leaves 2 and 3, and 10.1.0.2 under this one
+class CongaSwitch : public Ipv4RouteInputSwitch<Ipv4CongaRouting, SimpleNetDeviceHelper>
+{
+public:
+  CongaSwitch (uint32_t nPorts);
+
+  // Sends a packet of the flow from a local host, the chosen port is
+  // returned and the CONGA header it was given is left in tag
+  uint32_t Send (uint32_t flowId, Ipv4Address dest, Ipv4CongaTag &tag);
+
+  // Receives a packet with the CONGA header from a host under another leaf
+  uint32_t Receive (uint32_t flowId, Ipv4Address source, uint32_t lbTag, uint32_t ce,
+                    uint32_t fbLbTag, uint32_t fbMetric);
+};
+
+CongaSwitch::CongaSwitch (uint32_t nPorts)
+  : Ipv4RouteInputSwitch<Ipv4CongaRouting, SimpleNetDeviceHelper> (Ipv4CongaRoutingHelper (), nPorts)
+{
+  routing->SetLeafId (1);
+  routing->AddAddressToLeafIdMap (g_local, 1);
+  routing->AddAddressToLeafIdMap (g_leaf2, 2);
+  routing->AddAddressToLeafIdMap (g_leaf3, 3);
+  for (uint32_t index = 0; index < ports.size (); ++index)
+    {
+      routing->AddRoute (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), ports[index]);
+    }
+  routing->AssignStreams (1);
+}
+
+uint32_t
+CongaSwitch::Send (uint32_t flowId, Ipv4Address dest, Ipv4CongaTag &tag)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  packet->AddPacketTag (FlowIdTag (flowId));
+  uint32_t port = Route (packet, dest, g_local);
+  packet->PeekPacketTag (tag);
+  return port;
+}
+
+uint32_t
+CongaSwitch::Receive (uint32_t flowId, Ipv4Address source, uint32_t lbTag, uint32_t ce,
+                      uint32_t fbLbTag, uint32_t fbMetric)
+{
+  Ipv4CongaTag tag;
+  tag.SetLbTag (lbTag);
+  tag.SetCe (ce);
+  tag.SetFbLbTag (fbLbTag);
+  tag.SetFbMetric (fbMetric);
+  Ptr<Packet> packet = Create<Packet> (100);
+  packet->AddPacketTag (FlowIdTag (flowId));
+  packet->AddPacketTag (tag);
+  return Route (packet, g_local, source);
+}
+
+class CongaFeedbackTestCase : public TestCase
 {
 public:
-  Ipv4CongaRoutingTestCase1 ();
-  virtual ~Ipv4CongaRoutingTestCase1 ();
+  CongaFeedbackTestCase ();
 
 private:
   virtual void DoRun (void);
 };
 
-// Add some help text to this case to describe what it is intended to test
-Ipv4CongaRoutingTestCase1::Ipv4CongaRoutingTestCase1 ()
-  : TestCase ("CongaRouting test case (does nothing)")
+CongaFeedbackTestCase::CongaFeedbackTestCase ()
+  : TestCase ("CONGA feeds back the congestion from each leaf round robin, to that leaf only")
 {
 }
 
-// This destructor does nothing but we include it as a reminder that
-// the test case should clean up after itself
-Ipv4CongaRoutingTestCase1::~Ipv4CongaRoutingTestCase1 ()
+void
+CongaFeedbackTestCase::DoRun (void)
+{
+  CongaSwitch sw (2);
+
+  // Leaf 2 reports its ports 1 to 3, with the CE equal to the port, and
+  // leaf 3 its port 5
+  for (uint32_t lbTag = 1; lbTag <= 3; ++lbTag)
+    {
+      NS_TEST_ASSERT_MSG_NE (sw.Receive (lbTag, g_leaf2, lbTag, lbTag, 0, 0), 0, "A packet from leaf 2 should be routed");
+    }
+  NS_TEST_ASSERT_MSG_NE (sw.Receive (4, g_leaf3, 5, 6, 0, 0), 0, "A packet from leaf 3 should be routed");
+
+  // Each changed entry is fed back once, then the entries keep rotating
+  Ipv4CongaTag tag;
+  uint32_t flowId = 100;
+  for (uint32_t round = 0; round < 3; ++round)
+    {
+      std::set<uint32_t> fed;
+      for (uint32_t packet = 0; packet < 3; ++packet)
+        {
+          NS_TEST_ASSERT_MSG_NE (sw.Send (flowId++, g_leaf2, tag), 0, "A packet to leaf 2 should be routed");
+          NS_TEST_ASSERT_MSG_EQ ((tag.GetFbLbTag () >= 1 && tag.GetFbLbTag () <= 3), true,
+                                 "Port " << tag.GetFbLbTag () << " was not reported by leaf 2");
+          NS_TEST_ASSERT_MSG_EQ (tag.GetFbMetric (), tag.GetFbLbTag (), "The CE reported for the port should be fed back");
+          fed.insert (tag.GetFbLbTag ());
+        }
+      NS_TEST_ASSERT_MSG_EQ (fed.size (), 3, "Round " << round << " should feed back every port of leaf 2");
+    }
+
+  // The packets to leaf 3 carry its only port, whatever the rotation is at
+  for (uint32_t packet = 0; packet < 3; ++packet)
+    {
+      sw.Send (flowId++, g_leaf3, tag);
+      NS_TEST_ASSERT_MSG_EQ (tag.GetFbLbTag (), 5, "The feedback to leaf 3 should be its own port");
+      NS_TEST_ASSERT_MSG_EQ (tag.GetFbMetric (), 6, "The feedback to leaf 3 should be its own CE");
+    }
+
+  // A new report from leaf 2 jumps the rotation
+  sw.Receive (1, g_leaf2, 2, 7, 0, 0);
+  sw.Send (flowId++, g_leaf2, tag);
+  NS_TEST_ASSERT_MSG_EQ (tag.GetFbLbTag (), 2, "The changed entry should be fed back first");
+  NS_TEST_ASSERT_MSG_EQ (tag.GetFbMetric (), 7, "The new CE should be fed back");
+
+  // A leaf that reported nothing gets the loopback port
+  sw.routing->AddAddressToLeafIdMap (Ipv4Address ("10.4.0.1"), 4);
+  sw.Send (flowId++, Ipv4Address ("10.4.0.1"), tag);
+  NS_TEST_ASSERT_MSG_EQ (tag.GetFbLbTag (), 0, "Nothing should be fed back to a silent leaf");
+}
+
+class CongaSparseTableTestCase : public TestCase
+{
+public:
+  CongaSparseTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CongaSparseTableTestCase::CongaSparseTableTestCase ()
+  : TestCase ("CONGA takes leaf ids and ports beyond the ones configured")
 {
 }
 
-//
-// This method is the pure virtual method from class TestCase that every
-// TestCase must implement
-//
 void
-Ipv4CongaRoutingTestCase1::DoRun (void)
+CongaSparseTableTestCase::DoRun (void)
 {
-  // A wide variety of test macros are available in src/core/test.h
-  NS_TEST_ASSERT_MSG_EQ (true, true, "true doesn't equal true for some reason");
-  // Use this one for floating point comparisons
-  NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
+  CongaSwitch sw (2);
+  const Ipv4Address far ("10.200.0.1");
+  sw.routing->AddAddressToLeafIdMap (far, 1000);
+
+  // A new flowlet to a leaf that never reported, which used to read its
+  // row through end ()
+  Ipv4CongaTag tag;
+  uint32_t port = sw.Send (1, far, tag);
+  NS_TEST_ASSERT_MSG_EQ ((port == sw.ports[0] || port == sw.ports[1]), true, "A flow to a new leaf should take an uplink");
+  NS_TEST_ASSERT_MSG_EQ (tag.GetLbTag (), port, "The LbTag should be the uplink taken");
+
+  // Reports with ports far beyond the uplinks grow the rows
+  NS_TEST_ASSERT_MSG_NE (sw.Receive (2, far, 4000, 5, 3000, 7), 0, "A report with a large port should be routed");
+  sw.routing->InitCongestion (2000, 5000, 3);
+  sw.Send (3, far, tag);
+  NS_TEST_ASSERT_MSG_EQ (tag.GetFbLbTag (), 4000, "The large port of leaf 1000 should be fed back");
+  NS_TEST_ASSERT_MSG_EQ (tag.GetFbMetric (), 5, "The CE of the large port should be fed back");
+
+  // The congestion fed back by leaf 1000 steers the new flowlets to it
+  sw.Receive (4, far, 1, 0, sw.ports[0], 7);
+  for (uint32_t flowId = 10; flowId < 30; ++flowId)
+    {
+      NS_TEST_ASSERT_MSG_EQ (sw.Send (flowId, far, tag), sw.ports[1], "Flow " << flowId << " took the congested uplink");
+    }
 }
 
-// The TestSuite class names the TestSuite, identifies what type of TestSuite,
-// and enables the TestCases to be run.  Typically, only the constructor for
-// this class must be defined
-//
 class CongaRoutingTestSuite : public TestSuite
 {
 public:
@@ -59,10 +197,9 @@ public:
 CongaRoutingTestSuite::CongaRoutingTestSuite ()
   : TestSuite ("conga-routing", UNIT)
 {
-  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
-  AddTestCase (new Ipv4CongaRoutingTestCase1, TestCase::QUICK);
+  AddTestCase (new CongaFeedbackTestCase, TestCase::QUICK);
+  AddTestCase (new CongaSparseTableTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
 static CongaRoutingTestSuite congaRoutingTestSuite;
-
@@ -4,6 +4,7 @@
 
 #include "ns3/ipv4-drb-routing.h"
 #include "ns3/ipv4-routing-helper.h"
+#include "ns3/node-container.h"
 
 namespace ns3 {
 
@@ -18,6 +19,13 @@ public:
     virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
 
     Ptr<Ipv4DrbRouting> GetDrbRouting (Ptr<Ipv4> ipv4) const;
+
+    /**
+     * Assign a fixed random variable stream number to the Ipv4DrbRouting
+     * of each node of the container, nodes without one are skipped.  Return
+     * the number of streams that have been assigned.
+     */
+    int64_t AssignStreams (NodeContainer c, int64_t stream) const;
 };
 
 }
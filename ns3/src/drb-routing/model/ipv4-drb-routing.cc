@@ -9,12 +9,62 @@
 #include "ns3/ipv4-xpath-tag.h"
 #include "ns3/uinteger.h"
 
+#include <algorithm>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4DrbRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4DrbRouting);
 
+void
+Ipv4DrbRouting::PathTable::Add (uint32_t weight, uint32_t path)
+{
+  m_paths.push_back (path);
+  m_ends.push_back (GetTotalWeight () + weight);
+}
+
+bool
+Ipv4DrbRouting::PathTable::SetWeight (uint32_t path, uint32_t weight)
+{
+  // A path added several times keeps the first place it had
+  std::vector<uint32_t> paths;
+  std::vector<uint32_t> ends;
+  bool found = false;
+  uint32_t begin = 0;
+  for (uint32_t index = 0; index < m_paths.size (); index++)
+  {
+    uint32_t pathWeight = m_ends[index] - begin;
+    begin = m_ends[index];
+    if (m_paths[index] == path)
+    {
+      if (found)
+      {
+        continue;
+      }
+      found = true;
+      pathWeight = weight;
+    }
+    paths.push_back (m_paths[index]);
+    ends.push_back ((ends.empty () ? 0 : ends.back ()) + pathWeight);
+  }
+  m_paths.swap (paths);
+  m_ends.swap (ends);
+  return found;
+}
+
+uint32_t
+Ipv4DrbRouting::PathTable::GetTotalWeight (void) const
+{
+  return m_ends.empty () ? 0 : m_ends.back ();
+}
+
+uint32_t
+Ipv4DrbRouting::PathTable::GetPath (uint32_t position) const
+{
+  return m_paths[std::upper_bound (m_ends.begin (), m_ends.end (), position) - m_ends.begin ()];
+}
+
 TypeId
 Ipv4DrbRouting::GetTypeId (void)
 {
@@ -35,6 +85,7 @@ Ipv4DrbRouting::Ipv4DrbRouting () :
     m_mode (PER_FLOW)
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4DrbRouting::~Ipv4DrbRouting ()
@@ -56,10 +107,7 @@ Ipv4DrbRouting::AddPath (uint32_t weight, uint32_t path)
     NS_LOG_ERROR ("You have to use the PER_FLOW mode when the weight != 1");
     return false;
   }
-  for (uint32_t i = 0; i < weight; i++)
-  {
-    m_paths.push_back (path);
-  }
+  m_paths.Add (weight, path);
   return true;
 }
 
@@ -72,20 +120,14 @@ Ipv4DrbRouting::AddWeightedPath (uint32_t weight, uint32_t path,
   Ipv4DrbRouting::AddPath (weight, path);
 
   // Add rules to all other tables
-  std::map<Ipv4Address, std::vector<uint32_t> >::iterator itr = m_extraPaths.begin ();
+  std::map<Ipv4Address, PathTable>::iterator itr = m_extraPaths.begin ();
   for (; itr != m_extraPaths.end (); ++itr)
   {
-    Ipv4Address key = itr->first;
-    if (exclusiveIPs.find (key) != exclusiveIPs.end ())
+    if (exclusiveIPs.find (itr->first) != exclusiveIPs.end ())
     {
       continue;
     }
-    std::vector<uint32_t> paths = itr->second;
-    for (uint32_t i = 0; i < weight; i++)
-    {
-      paths.push_back (path);
-    }
-    m_extraPaths[key] = paths;
+    (itr->second).Add (weight, path);
   }
   return true;
 }
@@ -93,24 +135,46 @@ Ipv4DrbRouting::AddWeightedPath (uint32_t weight, uint32_t path,
 bool
 Ipv4DrbRouting::AddWeightedPath (Ipv4Address destAddr, uint32_t weight, uint32_t path)
 {
-  std::vector<uint32_t> paths;
-  std::map<Ipv4Address, std::vector<uint32_t> >::iterator itr = m_extraPaths.find (destAddr);
-  if (itr != m_extraPaths.end ())
+  std::map<Ipv4Address, PathTable>::iterator itr = m_extraPaths.find (destAddr);
+  if (itr == m_extraPaths.end ())
   {
-    paths = itr->second;
+    itr = m_extraPaths.insert (std::make_pair (destAddr, m_paths)).first;
   }
-  else
+  (itr->second).Add (weight, path);
+  return true;
+}
+
+bool
+Ipv4DrbRouting::SetPathWeight (uint32_t path, uint32_t weight)
+{
+  if (weight > 1 && m_mode != PER_FLOW)
   {
-    paths = m_paths;
+    NS_LOG_ERROR ("You have to use the PER_FLOW mode when the weight != 1");
+    return false;
   }
-
-  for (uint32_t i = 0; i < weight; i++)
+  bool found = m_paths.SetWeight (path, weight);
+  std::map<Ipv4Address, PathTable>::iterator itr = m_extraPaths.begin ();
+  for (; itr != m_extraPaths.end (); ++itr)
   {
-    paths.push_back (path);
+    found = (itr->second).SetWeight (path, weight) || found;
   }
+  return found;
+}
 
-  m_extraPaths[destAddr] = paths;
-  return true;
+bool
+Ipv4DrbRouting::SetPathWeight (Ipv4Address destAddr, uint32_t path, uint32_t weight)
+{
+  if (weight > 1 && m_mode != PER_FLOW)
+  {
+    NS_LOG_ERROR ("You have to use the PER_FLOW mode when the weight != 1");
+    return false;
+  }
+  std::map<Ipv4Address, PathTable>::iterator itr = m_extraPaths.find (destAddr);
+  if (itr == m_extraPaths.end ())
+  {
+    itr = m_extraPaths.insert (std::make_pair (destAddr, m_paths)).first;
+  }
+  return (itr->second).SetWeight (path, weight);
 }
 
 /* Inherit From Ipv4RoutingProtocol */
@@ -148,28 +212,37 @@ Ipv4DrbRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDev
     return 0;
   }
 
-  /* Ugly code, patch to support Weighted Presto */
-  std::vector<uint32_t> paths;
-  std::map<Ipv4Address, std::vector<uint32_t> >::iterator extraItr = m_extraPaths.find (header.GetDestination ());
-  if (extraItr == m_extraPaths.end ())
+  // Weighted Presto may give a destination a table of its own
+  const PathTable *paths = &m_paths;
+  std::map<Ipv4Address, PathTable>::iterator extraItr = m_extraPaths.find (header.GetDestination ());
+  if (extraItr != m_extraPaths.end ())
   {
-    paths = m_paths;
+    paths = &extraItr->second;
   }
-  else
+
+  uint32_t totalWeight = paths->GetTotalWeight ();
+  if (totalWeight == 0)
   {
-    paths = extraItr->second;
+    NS_LOG_ERROR ("DRB has no path in use towards " << header.GetDestination ());
+    sockerr = Socket::ERROR_NOROUTETOHOST;
+    return 0;
   }
-  /* Breathe a fresh air to celebrate the end of ugly code */
 
-  uint32_t index = rand () % paths.size ();
+  // The position of the flow in the table, kept modulo a weight change
+  uint32_t position;
   std::map<uint32_t, uint32_t>::iterator itr = m_indexMap.find (flowIndentify);
   if (itr != m_indexMap.end ())
   {
-    index = itr->second;
+    position = itr->second % totalWeight;
+  }
+  else
+  {
+    position = m_rand->GetInteger (0, totalWeight - 1);
+    itr = m_indexMap.insert (std::make_pair (flowIndentify, position)).first;
   }
 
-  uint32_t path = paths[index];
-  m_indexMap[flowIndentify] = (index + 1) % paths.size ();
+  uint32_t path = paths->GetPath (position);
+  itr->second = (position + 1) % totalWeight;
 
   Ipv4XPathTag ipv4XPathTag;
   ipv4XPathTag.SetPathId (path);
@@ -225,6 +298,14 @@ Ipv4DrbRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 {
 }
 
+int64_t
+Ipv4DrbRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 void
 Ipv4DrbRouting::DoDispose (void)
 {
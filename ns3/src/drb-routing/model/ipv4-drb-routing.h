@@ -8,8 +8,11 @@
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
 
 #include <set>
+#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -36,6 +39,16 @@ public:
           const std::set<Ipv4Address>& exclusiveIPs = std::set<Ipv4Address> ());
   bool AddWeightedPath (Ipv4Address destAddr, uint32_t weight, uint32_t path);
 
+  /**
+   * Changes the weight of a path, the number of packets a flow sends on
+   * it in a row, in the default table and the tables of all destinations.
+   * A weight of 0 takes the path out of use.
+   */
+  bool SetPathWeight (uint32_t path, uint32_t weight);
+
+  // Changes the weight of a path towards one destination only
+  bool SetPathWeight (Ipv4Address destAddr, uint32_t path, uint32_t weight);
+
   /* Inherit From Ipv4RoutingProtocol */
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
   virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
@@ -50,11 +63,38 @@ public:
 
   virtual void DoDispose (void);
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   */
+  int64_t AssignStreams (int64_t stream);
+
 private:
-  std::vector<uint32_t> m_paths;
-  std::map<Ipv4Address, std::vector<uint32_t> > m_extraPaths;
+  /**
+   * Paths with their weights.  A flow goes round the paths from a random
+   * position of the table, sending weight packets in a row on each, as if
+   * every path were listed weight times but without the copies.
+   */
+  class PathTable
+  {
+  public:
+    void Add (uint32_t weight, uint32_t path);
+    bool SetWeight (uint32_t path, uint32_t weight);
+    uint32_t GetTotalWeight (void) const;
+    // The path at a position, from 0 to the total weight excluded
+    uint32_t GetPath (uint32_t position) const;
+
+  private:
+    std::vector<uint32_t> m_paths;
+    std::vector<uint32_t> m_ends;    // Cumulative weights
+  };
+
+  PathTable m_paths;
+  std::map<Ipv4Address, PathTable> m_extraPaths;
   std::map<uint32_t, uint32_t> m_indexMap;
   enum DrbRoutingMode m_mode;
+  Ptr<UniformRandomVariable> m_rand;
 
   Ptr<Ipv4> m_ipv4;
 };
@@ -2,6 +2,14 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-drb-routing.h"
+#include "ns3/ipv4-xpath-tag.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+
+#include <algorithm>
+#include <vector>
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +54,110 @@ DrbRoutingTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Weighted paths are taken in runs of their weight, without copies in the table
+class DrbRoutingWeightTestCase : public TestCase
+{
+public:
+  DrbRoutingWeightTestCase ();
+
+private:
+  virtual void DoRun (void);
+  // The paths of the next packets of flow 1
+  std::vector<uint32_t> Route (Ptr<Ipv4DrbRouting> drb, uint32_t packets);
+  // Whether paths go round cycle, from any position
+  bool IsRotationOf (const std::vector<uint32_t> &paths, const std::vector<uint32_t> &cycle);
+};
+
+DrbRoutingWeightTestCase::DrbRoutingWeightTestCase ()
+  : TestCase ("DrbRouting sends weight packets in a row on each path, weights can change")
+{
+}
+
+std::vector<uint32_t>
+DrbRoutingWeightTestCase::Route (Ptr<Ipv4DrbRouting> drb, uint32_t packets)
+{
+  std::vector<uint32_t> paths;
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address ("10.1.1.2"));
+  for (uint32_t i = 0; i < packets; ++i)
+    {
+      Ptr<Packet> packet = Create<Packet> (100);
+      packet->AddPacketTag (FlowIdTag (1));
+      Socket::SocketErrno sockerr;
+      drb->RouteOutput (packet, header, 0, sockerr);
+      Ipv4XPathTag tag;
+      if (sockerr == Socket::ERROR_NOTERROR && packet->PeekPacketTag (tag))
+        {
+          paths.push_back (tag.GetPathId ());
+        }
+    }
+  return paths;
+}
+
+bool
+DrbRoutingWeightTestCase::IsRotationOf (const std::vector<uint32_t> &paths, const std::vector<uint32_t> &cycle)
+{
+  for (uint32_t start = 0; start < cycle.size (); ++start)
+    {
+      bool match = true;
+      for (uint32_t i = 0; i < paths.size () && match; ++i)
+        {
+          match = (paths[i] == cycle[(start + i) % cycle.size ()]);
+        }
+      if (match)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+DrbRoutingWeightTestCase::DoRun (void)
+{
+  Ptr<Ipv4DrbRouting> drb = CreateObject<Ipv4DrbRouting> ();
+  drb->AssignStreams (3);
+  NS_TEST_ASSERT_MSG_EQ (drb->AddPath (3, 10), true, "Weighted paths need the per flow mode, the default");
+  drb->AddPath (1, 20);
+
+  std::vector<uint32_t> cycle;
+  cycle.push_back (10);
+  cycle.push_back (10);
+  cycle.push_back (10);
+  cycle.push_back (20);
+  std::vector<uint32_t> paths = Route (drb, 12);
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 12, "Every packet should get a path");
+  NS_TEST_ASSERT_MSG_EQ (IsRotationOf (paths, cycle), true, "Path 10 should take 3 packets in a row, path 20 one");
+
+  drb->SetPathWeight (20, 0);
+  paths = Route (drb, 5);
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 5, "Every packet should get a path");
+  NS_TEST_ASSERT_MSG_EQ (std::count (paths.begin (), paths.end (), 10), 5, "A path of weight 0 should not be used");
+
+  drb->SetPathWeight (10, 1);
+  drb->SetPathWeight (20, 2);
+  cycle.clear ();
+  cycle.push_back (10);
+  cycle.push_back (20);
+  cycle.push_back (20);
+  paths = Route (drb, 9);
+  NS_TEST_ASSERT_MSG_EQ (IsRotationOf (paths, cycle), true, "The flow should follow the new weights");
+
+  drb->SetPathWeight (10, 0);
+  drb->SetPathWeight (20, 0);
+  paths = Route (drb, 1);
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 0, "No packet should be routed without a path in use");
+
+  Ptr<Ipv4DrbRouting> perDest = CreateObject<Ipv4DrbRouting> ();
+  perDest->SetAttribute ("Mode", UintegerValue (PER_DEST));
+  perDest->AddPath (1, 10);
+  NS_TEST_ASSERT_MSG_EQ (perDest->SetPathWeight (10, 2), false, "Weights above 1 need the per flow mode");
+  NS_TEST_ASSERT_MSG_EQ (perDest->SetPathWeight (Ipv4Address ("10.1.1.2"), 10, 2), false,
+                         "Weights above 1 towards a destination need the per flow mode");
+  NS_TEST_ASSERT_MSG_EQ (perDest->SetPathWeight (Ipv4Address ("10.1.1.2"), 10, 0), true,
+                         "A path can be taken out of use in any mode");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +173,7 @@ DrbRoutingTestSuite::DrbRoutingTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new DrbRoutingTestCase1, TestCase::QUICK);
+  AddTestCase (new DrbRoutingWeightTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -10,7 +10,6 @@
 #include "ns3/point-to-point-net-device.h"
 
 #include <algorithm>
-#include <limits>
 
 namespace ns3 {
 
@@ -28,16 +27,24 @@ Ipv4DrillRouting::GetTypeId (void)
       .AddAttribute ("d", "Sample d random outputs queue",
                      UintegerValue (2),
                      MakeUintegerAccessor (&Ipv4DrillRouting::m_d),
-                     MakeUintegerChecker<uint32_t> ())
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("m", "Remember the m least loaded queues of each prefix across packets",
+                     UintegerValue (1),
+                     MakeUintegerAccessor (&Ipv4DrillRouting::m_m),
+                     MakeUintegerChecker<uint32_t> (1))
   ;
 
   return tid;
 }
 
 Ipv4DrillRouting::Ipv4DrillRouting ()
-    : m_d (2)
+    : m_d (2),
+      m_m (1),
+      m_prefixesValid (false),
+      m_memoryWidth (0)
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4DrillRouting::~Ipv4DrillRouting ()
@@ -54,6 +61,88 @@ Ipv4DrillRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t
   drillRouteEntry.networkMask = networkMask;
   drillRouteEntry.port = port;
   m_routeEntryList.push_back (drillRouteEntry);
+
+  // The prefixes are grouped again, and their memory reset, on the next packet
+  m_prefixesValid = false;
+}
+
+uint64_t
+Ipv4DrillRouting::PrefixKey (Ipv4Address network, Ipv4Mask mask)
+{
+  return (static_cast<uint64_t> (mask.Get ()) << 32) | network.CombineMask (mask).Get ();
+}
+
+void
+Ipv4DrillRouting::BuildPrefixes (void)
+{
+  m_prefixes.clear ();
+  m_prefixPorts.clear ();
+  m_prefixMasks.clear ();
+  m_prefixIndices.clear ();
+
+  // Ports of every prefix, in the order their route entries were added
+  std::vector<std::vector<uint32_t> > ports;
+  std::vector<DrillRouteEntry>::iterator itr = m_routeEntryList.begin ();
+  for ( ; itr != m_routeEntryList.end (); ++itr)
+  {
+    uint64_t key = PrefixKey ((*itr).network, (*itr).networkMask);
+    std::map<uint64_t, uint32_t>::iterator indexItr = m_prefixIndices.find (key);
+    if (indexItr == m_prefixIndices.end ())
+    {
+      DrillPrefix prefix;
+      prefix.network = (*itr).network.CombineMask ((*itr).networkMask);
+      prefix.mask = (*itr).networkMask;
+      prefix.begin = 0;
+      prefix.size = 0;
+      prefix.nRemembered = 0;
+      indexItr = m_prefixIndices.insert (std::make_pair (key, m_prefixes.size ())).first;
+      m_prefixes.push_back (prefix);
+      ports.push_back (std::vector<uint32_t> ());
+
+      // Masks are few, kept longest first for the lookups
+      std::vector<Ipv4Mask>::iterator maskItr = m_prefixMasks.begin ();
+      while (maskItr != m_prefixMasks.end ()
+             && (*maskItr).GetPrefixLength () > (*itr).networkMask.GetPrefixLength ())
+      {
+        ++maskItr;
+      }
+      if (maskItr == m_prefixMasks.end () || *maskItr != (*itr).networkMask)
+      {
+        m_prefixMasks.insert (maskItr, (*itr).networkMask);
+      }
+    }
+    ports[indexItr->second].push_back ((*itr).port);
+  }
+
+  for (uint32_t index = 0; index < m_prefixes.size (); index++)
+  {
+    m_prefixes[index].begin = m_prefixPorts.size ();
+    m_prefixes[index].size = ports[index].size ();
+    m_prefixPorts.insert (m_prefixPorts.end (), ports[index].begin (), ports[index].end ());
+  }
+
+  m_memoryWidth = m_m;
+  m_memory.assign (m_prefixes.size () * m_memoryWidth, 0);
+  m_prefixesValid = true;
+}
+
+Ipv4DrillRouting::DrillPrefix *
+Ipv4DrillRouting::LookupPrefix (Ipv4Address dest)
+{
+  if (!m_prefixesValid)
+  {
+    BuildPrefixes ();
+  }
+  std::vector<Ipv4Mask>::iterator maskItr = m_prefixMasks.begin ();
+  for ( ; maskItr != m_prefixMasks.end (); ++maskItr)
+  {
+    std::map<uint64_t, uint32_t>::iterator indexItr = m_prefixIndices.find (PrefixKey (dest, *maskItr));
+    if (indexItr != m_prefixIndices.end ())
+    {
+      return &m_prefixes[indexItr->second];
+    }
+  }
+  return NULL;
 }
 
 std::vector<DrillRouteEntry>
@@ -71,18 +160,41 @@ Ipv4DrillRouting::LookupDrillRouteEntries (Ipv4Address dest)
   return drillRouteEntries;
 }
 
-uint32_t
-Ipv4DrillRouting::CalculateQueueLength (uint32_t interface)
+std::vector<uint32_t>
+Ipv4DrillRouting::GetRememberedPorts (Ipv4Address dest)
 {
+  DrillPrefix *prefix = LookupPrefix (dest);
+  if (prefix == NULL)
+  {
+    return std::vector<uint32_t> ();
+  }
+  const uint32_t *memory = &m_memory[(prefix - &m_prefixes[0]) * m_memoryWidth];
+  return std::vector<uint32_t> (memory, memory + prefix->nRemembered);
+}
+
+const Ipv4DrillRouting::DrillPortQueues &
+Ipv4DrillRouting::GetPortQueues (uint32_t interface)
+{
+  if (interface >= m_portQueues.size ())
+  {
+    DrillPortQueues unresolved;
+    unresolved.resolved = false;
+    m_portQueues.resize (interface + 1, unresolved);
+  }
+
+  DrillPortQueues &queues = m_portQueues[interface];
+  if (queues.resolved)
+  {
+    return queues;
+  }
+
   Ptr<Ipv4L3Protocol> ipv4L3Protocol = DynamicCast<Ipv4L3Protocol> (m_ipv4);
   if (!ipv4L3Protocol)
   {
     NS_LOG_ERROR (this << " Drill routing cannot work other than Ipv4L3Protocol");
-    return 0;
+    return queues;
   }
 
-  uint32_t totalLength = 0;
-
   const Ptr<NetDevice> netDevice = this->m_ipv4->GetNetDevice (interface);
 
   if (netDevice->IsPointToPoint ())
@@ -90,41 +202,59 @@ Ipv4DrillRouting::CalculateQueueLength (uint32_t interface)
     Ptr<PointToPointNetDevice> p2pNetDevice = DynamicCast<PointToPointNetDevice> (netDevice);
     if (p2pNetDevice)
     {
-      totalLength += p2pNetDevice->GetQueue ()->GetNBytes ();
+      queues.queue = p2pNetDevice->GetQueue ();
     }
   }
 
   Ptr<TrafficControlLayer> tc = ipv4L3Protocol->GetNode ()->GetObject<TrafficControlLayer> ();
-
-  if (!tc)
+  if (tc)
   {
-    return totalLength;
+    queues.queueDisc = tc->GetRootQueueDiscOnDevice (netDevice);
   }
 
-  Ptr<QueueDisc> queueDisc = tc->GetRootQueueDiscOnDevice (netDevice);
-  if (queueDisc)
+  queues.resolved = true;
+  return queues;
+}
+
+uint32_t
+Ipv4DrillRouting::GetQueueLength (const DrillPortQueues &queues)
+{
+  uint32_t totalLength = 0;
+  if (queues.queue)
   {
-    totalLength += queueDisc->GetNBytes ();
+    totalLength += queues.queue->GetNBytes ();
+  }
+  if (queues.queueDisc)
+  {
+    totalLength += queues.queueDisc->GetNBytes ();
   }
-
   return totalLength;
 }
 
+uint32_t
+Ipv4DrillRouting::CalculateQueueLength (uint32_t interface)
+{
+  return GetQueueLength (GetPortQueues (interface));
+}
+
+void
+Ipv4DrillRouting::InsertCandidate (uint32_t load, uint32_t port)
+{
+  // At most m + d candidates, an insertion keeps them sorted
+  m_candidates.push_back (std::make_pair (load, port));
+  uint32_t index = m_candidates.size () - 1;
+  while (index > 0 && m_candidates[index - 1].first > load)
+  {
+    m_candidates[index] = m_candidates[index - 1];
+    index--;
+  }
+  m_candidates[index] = std::make_pair (load, port);
+}
+
 Ptr<Ipv4Route>
 Ipv4DrillRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
 {
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
-  Ptr<Channel> channel = dev->GetChannel ();
-  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-  Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-  uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-  Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4>()->GetAddress(nextIf,0).GetLocal();
-  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (m_ipv4->GetNetDevice (port));
-  route->SetGateway (nextHopAddr);
-  route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
-  route->SetDestination (destAddress);
-  return route;
+  return m_routeCache->GetRoute (port, destAddress);
 }
 
 
@@ -164,43 +294,60 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     return false;
   }
 
-  std::vector<DrillRouteEntry> allPorts = Ipv4DrillRouting::LookupDrillRouteEntries (destAddress);
+  DrillPrefix *prefix = Ipv4DrillRouting::LookupPrefix (destAddress);
 
-  if (allPorts.empty ())
+  if (prefix == NULL)
   {
     NS_LOG_ERROR (this << " Drill routing cannot find routing entry");
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
     return false;
   }
 
-  uint32_t leastLoadInterface = 0;
-  uint32_t leastLoad = std::numeric_limits<uint32_t>::max ();
+  // DRILL(d, m): the remembered ports and d random ones are compared, the least loaded
+  // is chosen and the m least loaded are remembered.  Candidates are kept sorted by load,
+  // remembered ones first and samples in draw order among equal loads
+  uint32_t *memory = &m_memory[(prefix - &m_prefixes[0]) * m_memoryWidth];
+  m_candidates.clear ();
 
-  std::random_shuffle (allPorts.begin (), allPorts.end ());
-
-  std::map<Ipv4Address, uint32_t>::iterator itr = m_previousBestQueueMap.find (destAddress);
-
-  if (itr != m_previousBestQueueMap.end ())
+  for (uint32_t remembered = 0; remembered < prefix->nRemembered; remembered++)
   {
-    leastLoadInterface = itr->second;
-    leastLoad = CalculateQueueLength (itr->second);
+    uint32_t load = GetQueueLength (GetPortQueues (memory[remembered]));
+    InsertCandidate (load, memory[remembered]);
   }
 
-  uint32_t sampleNum = m_d < allPorts.size () ? m_d : allPorts.size ();
+  uint32_t *ports = &m_prefixPorts[prefix->begin];
+  uint32_t sampleNum = m_d < prefix->size ? m_d : prefix->size;
 
+  // Partial Fisher-Yates, the first sampleNum ports of the span become a uniform sample
+  // of distinct ports, leaving the span a permutation of the same ports
   for (uint32_t samplePort = 0; samplePort < sampleNum; samplePort ++)
   {
-    uint32_t sampleLoad = Ipv4DrillRouting::CalculateQueueLength (allPorts[samplePort].port);
-    if (sampleLoad < leastLoad)
+    uint32_t pick = samplePort + m_rand->GetInteger (0, prefix->size - samplePort - 1);
+    std::swap (ports[samplePort], ports[pick]);
+    if (std::find (memory, memory + prefix->nRemembered, ports[samplePort]) == memory + prefix->nRemembered)
     {
-      leastLoad = sampleLoad;
-      leastLoadInterface = allPorts[samplePort].port;
+      uint32_t sampleLoad = GetQueueLength (GetPortQueues (ports[samplePort]));
+      InsertCandidate (sampleLoad, ports[samplePort]);
     }
   }
 
+  if (m_candidates.empty ())
+  {
+    NS_LOG_ERROR (this << " Drill routing has no port to compare");
+    ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
+    return false;
+  }
+
+  uint32_t leastLoad = m_candidates.front ().first;
+  uint32_t leastLoadInterface = m_candidates.front ().second;
+
   NS_LOG_INFO (this << " Drill routing chooses interface: " << leastLoadInterface << ", since its load is: " << leastLoad);
 
-  m_previousBestQueueMap[destAddress] = leastLoadInterface;
+  prefix->nRemembered = m_memoryWidth < m_candidates.size () ? m_memoryWidth : m_candidates.size ();
+  for (uint32_t remembered = 0; remembered < prefix->nRemembered; remembered++)
+  {
+    memory[remembered] = m_candidates[remembered].second;
+  }
 
   Ptr<Ipv4Route> route = Ipv4DrillRouting::ConstructIpv4Route (leastLoadInterface, destAddress);
   ucb (route, packet, header);
@@ -216,11 +363,31 @@ Ipv4DrillRouting::NotifyInterfaceUp (uint32_t interface)
 void
 Ipv4DrillRouting::NotifyInterfaceDown (uint32_t interface)
 {
+  if (m_routeCache != 0)
+    {
+      m_routeCache->Invalidate (interface);
+    }
+  if (interface < m_portQueues.size ())
+    {
+      m_portQueues[interface].resolved = false;
+      m_portQueues[interface].queue = 0;
+      m_portQueues[interface].queueDisc = 0;
+    }
 }
 
 void
 Ipv4DrillRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  if (m_routeCache != 0)
+    {
+      m_routeCache->Invalidate (interface);
+    }
+  if (interface < m_portQueues.size ())
+    {
+      m_portQueues[interface].resolved = false;
+      m_portQueues[interface].queue = 0;
+      m_portQueues[interface].queueDisc = 0;
+    }
 }
 
 void
@@ -234,6 +401,7 @@ Ipv4DrillRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_LOGIC (this << "Setting up Ipv4: " << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  m_routeCache = Ipv4RouteCache::GetRouteCache (ipv4);
 }
 
 void
@@ -241,9 +409,19 @@ Ipv4DrillRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 {
 }
 
+int64_t
+Ipv4DrillRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 void
 Ipv4DrillRouting::DoDispose (void)
 {
+  m_routeCache = 0;
+  m_portQueues.clear ();
 }
 }
 
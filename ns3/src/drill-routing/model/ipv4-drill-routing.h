@@ -3,14 +3,19 @@
 #define IPV4_DRILL_ROUTING_H
 
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route-cache.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/queue.h"
+#include "ns3/queue-disc.h"
 
 #include <vector>
 #include <map>
+#include <utility>
 
 namespace ns3 {
 
@@ -32,6 +37,9 @@ public:
   void AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port);
   std::vector<DrillRouteEntry> LookupDrillRouteEntries (Ipv4Address dest);
 
+  // The ports remembered for the prefix dest resolves to, least loaded first
+  std::vector<uint32_t> GetRememberedPorts (Ipv4Address dest);
+
   uint32_t CalculateQueueLength (uint32_t interface);
   Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
 
@@ -50,12 +58,66 @@ public:
 
   virtual void DoDispose (void);
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   */
+  int64_t AssignStreams (int64_t stream);
+
 private:
+  // Ports of a prefix, as a span of m_prefixPorts, and the number of ports
+  // remembered for it, stored from its index * m_memoryWidth in m_memory
+  struct DrillPrefix
+  {
+    Ipv4Address network;
+    Ipv4Mask mask;
+    uint32_t begin;
+    uint32_t size;
+    uint32_t nRemembered;
+  };
+
+  // The queues of a port, resolved on the first sample of the port
+  struct DrillPortQueues
+  {
+    bool resolved;
+    Ptr<Queue> queue;
+    Ptr<QueueDisc> queueDisc;
+  };
+
+  // Groups the route entries by prefix, on the first packet after a route is added
+  void BuildPrefixes (void);
+  // The longest prefix matching dest, or NULL
+  DrillPrefix *LookupPrefix (Ipv4Address dest);
+  const DrillPortQueues &GetPortQueues (uint32_t interface);
+  void InsertCandidate (uint32_t load, uint32_t port);
+
+  static uint64_t PrefixKey (Ipv4Address network, Ipv4Mask mask);
+  static uint32_t GetQueueLength (const DrillPortQueues &queues);
+
   uint32_t m_d;
-  std::map<Ipv4Address, uint32_t> m_previousBestQueueMap;
+  uint32_t m_m;
 
   Ptr<Ipv4> m_ipv4;
+  Ptr<Ipv4RouteCache> m_routeCache;
   std::vector<DrillRouteEntry> m_routeEntryList;
+
+  bool m_prefixesValid;
+  std::vector<DrillPrefix> m_prefixes;
+  std::vector<uint32_t> m_prefixPorts;
+  std::vector<Ipv4Mask> m_prefixMasks;             // Longest first
+  std::map<uint64_t, uint32_t> m_prefixIndices;   /* <<Mask, Network>, Prefix index> */
+
+  // The m least loaded ports of every prefix after its last packet, least loaded first
+  std::vector<uint32_t> m_memory;
+  uint32_t m_memoryWidth;
+
+  // <Load, Port> of the ports compared for a packet, kept to reuse its storage
+  std::vector<std::pair<uint32_t, uint32_t> > m_candidates;
+
+  std::vector<DrillPortQueues> m_portQueues;   // Indexed by interface
+
+  Ptr<UniformRandomVariable> m_rand;
 };
 
 }
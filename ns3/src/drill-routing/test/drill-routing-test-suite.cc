@@ -2,14 +2,68 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-drill-routing.h"
+#include "ns3/ipv4-drill-routing-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/uinteger.h"
+#include "ns3/ipv4-route-input-test.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <algorithm>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
 
+// A switch running DRILL with one ingress port and n egress ports, each to
+// a host of its own; the load of a port is set by filling its device queue
+class DrillSwitch : public Ipv4RouteInputSwitch<Ipv4DrillRouting, PointToPointHelper>
+{
+public:
+  DrillSwitch (uint32_t nPorts, uint32_t d, uint32_t m);
+
+  // The chosen port, 0 if the packet is not routed
+  uint32_t Route (Ipv4Address dest);
+  Ptr<PointToPointNetDevice> GetDevice (uint32_t port);
+  void SetLoad (uint32_t port, uint32_t packets);
+};
+
+DrillSwitch::DrillSwitch (uint32_t nPorts, uint32_t d, uint32_t m)
+  : Ipv4RouteInputSwitch<Ipv4DrillRouting, PointToPointHelper> (Ipv4DrillRoutingHelper (), nPorts)
+{
+  routing->SetAttribute ("d", UintegerValue (d));
+  routing->SetAttribute ("m", UintegerValue (m));
+}
+
+uint32_t
+DrillSwitch::Route (Ipv4Address dest)
+{
+  return Ipv4RouteInputSwitch<Ipv4DrillRouting, PointToPointHelper>::Route (Create<Packet> (100), dest);
+}
+
+Ptr<PointToPointNetDevice>
+DrillSwitch::GetDevice (uint32_t port)
+{
+  return DynamicCast<PointToPointNetDevice> (ipv4->GetNetDevice (port));
+}
+
+void
+DrillSwitch::SetLoad (uint32_t port, uint32_t packets)
+{
+  Ptr<Queue> queue = GetDevice (port)->GetQueue ();
+  while (!queue->IsEmpty ())
+    {
+      queue->Dequeue ();
+    }
+  for (uint32_t i = 0; i < packets; ++i)
+    {
+      queue->Enqueue (Create<QueueItem> (Create<Packet> (100)));
+    }
+}
+
 // This is an example TestCase.
 class DrillRoutingTestCase1 : public TestCase
 {
@@ -46,6 +100,385 @@ DrillRoutingTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// DRILL(d, m) remembers the m least loaded ports it compared, least loaded
+// first, remembered ports before samples of the same load
+class DrillMemoryTestCase : public TestCase
+{
+public:
+  DrillMemoryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DrillMemoryTestCase::DrillMemoryTestCase ()
+  : TestCase ("Drill remembers the m least loaded ports in load and tie order")
+{
+}
+
+void
+DrillMemoryTestCase::DoRun (void)
+{
+  Ipv4Address dest ("10.2.0.1");
+  {
+    // Distinct loads: the memory converges to the two least loaded ports
+    DrillSwitch sw (4, 1, 2);
+    uint32_t loads[] = { 30, 10, 20, 40 };
+    for (uint32_t i = 0; i < 4; ++i)
+      {
+        sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), sw.ports[i]);
+        sw.SetLoad (sw.ports[i], loads[i]);
+      }
+    NS_TEST_ASSERT_MSG_EQ (sw.routing->GetRememberedPorts (dest).size (), 0, "Nothing is remembered before the first packet");
+
+    uint32_t port = sw.Route (dest);
+    std::vector<uint32_t> memory = sw.routing->GetRememberedPorts (dest);
+    NS_TEST_ASSERT_MSG_EQ (memory.size (), 1, "One sample, one port to remember");
+    NS_TEST_ASSERT_MSG_EQ (memory[0], port, "The chosen port is remembered");
+
+    for (uint32_t n = 0; n < 64; ++n)
+      {
+        port = sw.Route (dest);
+        memory = sw.routing->GetRememberedPorts (dest);
+        NS_TEST_ASSERT_MSG_EQ (memory[0], port, "The chosen port is the least loaded remembered one");
+        // A sample drawn among the remembered ports adds nothing to compare
+        if (memory.size () == 2)
+          {
+            NS_TEST_ASSERT_MSG_LT (sw.GetDevice (memory[0])->GetQueue ()->GetNBytes (),
+                                   sw.GetDevice (memory[1])->GetQueue ()->GetNBytes (),
+                                   "The memory is kept least loaded first");
+          }
+      }
+    NS_TEST_ASSERT_MSG_EQ (memory.size (), 2, "m ports should be remembered once two were compared");
+    NS_TEST_ASSERT_MSG_EQ (memory[0], sw.ports[1], "The least loaded port should be remembered first");
+    NS_TEST_ASSERT_MSG_EQ (memory[1], sw.ports[2], "The second least loaded port should be remembered second");
+
+    // The remembered port got loaded: it is still compared, but loses
+    sw.SetLoad (sw.ports[1], 50);
+    NS_TEST_ASSERT_MSG_EQ (sw.Route (dest), sw.ports[2], "The other remembered port should win");
+    NS_TEST_ASSERT_MSG_EQ (sw.routing->GetRememberedPorts (dest)[0], sw.ports[2], "The memory should be reordered");
+  }
+  {
+    // Equal loads: remembered ports keep their order ahead of the samples,
+    // so the first choice sticks
+    DrillSwitch sw (6, 2, 3);
+    for (uint32_t i = 0; i < 6; ++i)
+      {
+        sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), sw.ports[i]);
+      }
+    uint32_t first = sw.Route (dest);
+    std::vector<uint32_t> memory = sw.routing->GetRememberedPorts (dest);
+    NS_TEST_ASSERT_MSG_EQ (memory.size (), 2, "Both samples should be remembered");
+    NS_TEST_ASSERT_MSG_EQ (memory[0], first, "Among ties the first sample wins");
+    for (uint32_t n = 0; n < 32; ++n)
+      {
+        NS_TEST_ASSERT_MSG_EQ (sw.Route (dest), first, "A remembered port wins the ties");
+        std::vector<uint32_t> next = sw.routing->GetRememberedPorts (dest);
+        NS_TEST_ASSERT_MSG_EQ (next.size (), 3, "The memory should fill up to m");
+        NS_TEST_ASSERT_MSG_EQ ((next[0] == memory[0] && next[1] == memory[1]), true,
+                               "The remembered ports stay ahead of the new samples");
+        if (n > 0)
+          {
+            NS_TEST_ASSERT_MSG_EQ (next[2], memory[2], "A full memory of ties keeps its order");
+          }
+        memory = next;
+      }
+  }
+}
+
+// With m = 1 the choice is the one of DRILL before the memory was widened:
+// the previous best port against d samples, a sample winning only if less
+// loaded
+class DrillSingleMemoryTestCase : public TestCase
+{
+public:
+  DrillSingleMemoryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DrillSingleMemoryTestCase::DrillSingleMemoryTestCase ()
+  : TestCase ("Drill with m = 1 chooses as the previous-best algorithm")
+{
+}
+
+void
+DrillSingleMemoryTestCase::DoRun (void)
+{
+  const uint32_t nPorts = 6;
+  const uint32_t d = 2;
+  DrillSwitch sw (nPorts, d, 1);
+  for (uint32_t i = 0; i < nPorts; ++i)
+    {
+      sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), sw.ports[i]);
+    }
+  sw.routing->AssignStreams (3);
+
+  // The reference draws the same numbers on the same stream
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (3);
+  Ptr<UniformRandomVariable> loads = CreateObject<UniformRandomVariable> ();
+  loads->SetStream (4);
+  std::vector<uint32_t> ports = sw.ports;
+  bool hasPreviousBest = false;
+  uint32_t previousBest = 0;
+
+  Ipv4Address dest ("10.2.0.1");
+  for (uint32_t n = 0; n < 500; ++n)
+    {
+      // Few distinct loads, so that ties are common
+      for (uint32_t i = 0; i < nPorts; ++i)
+        {
+          sw.SetLoad (sw.ports[i], loads->GetInteger (0, 3));
+        }
+
+      uint32_t expected = 0;
+      uint32_t leastLoad = UINT32_MAX;
+      if (hasPreviousBest)
+        {
+          expected = previousBest;
+          leastLoad = sw.routing->CalculateQueueLength (previousBest);
+        }
+      for (uint32_t sample = 0; sample < d; ++sample)
+        {
+          uint32_t pick = sample + rand->GetInteger (0, nPorts - sample - 1);
+          std::swap (ports[sample], ports[pick]);
+          uint32_t load = sw.routing->CalculateQueueLength (ports[sample]);
+          if (load < leastLoad)
+            {
+              leastLoad = load;
+              expected = ports[sample];
+            }
+        }
+      hasPreviousBest = true;
+      previousBest = expected;
+
+      NS_TEST_ASSERT_MSG_EQ (sw.Route (dest), expected, "Packet " << n << " took another port");
+    }
+}
+
+// A destination resolves to its longest matching prefix only
+class DrillLongestPrefixTestCase : public TestCase
+{
+public:
+  DrillLongestPrefixTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DrillLongestPrefixTestCase::DrillLongestPrefixTestCase ()
+  : TestCase ("Drill routes a destination through its longest matching prefix")
+{
+}
+
+void
+DrillLongestPrefixTestCase::DoRun (void)
+{
+  DrillSwitch sw (5, 4, 1);
+  // The more specific prefix comes between the entries of the shorter one
+  sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), sw.ports[0]);
+  sw.routing->AddRoute (Ipv4Address ("10.2.1.0"), Ipv4Mask ("255.255.255.0"), sw.ports[2]);
+  sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), sw.ports[1]);
+  sw.routing->AddRoute (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), sw.ports[3]);
+  sw.routing->AddRoute (Ipv4Address ("10.2.1.128"), Ipv4Mask ("255.255.255.128"), sw.ports[4]);
+
+  // The ports of the longer prefixes are idle, they would win any comparison
+  sw.SetLoad (sw.ports[0], 5);
+  sw.SetLoad (sw.ports[1], 5);
+  sw.SetLoad (sw.ports[3], 5);
+
+  for (uint32_t n = 0; n < 16; ++n)
+    {
+      uint32_t port = sw.Route (Ipv4Address ("10.2.7.1"));
+      NS_TEST_ASSERT_MSG_EQ ((port == sw.ports[0] || port == sw.ports[1]), true, "/16 should use its own ports");
+      NS_TEST_ASSERT_MSG_EQ (sw.Route (Ipv4Address ("10.2.1.1")), sw.ports[2], "/24 should use its own port");
+      NS_TEST_ASSERT_MSG_EQ (sw.Route (Ipv4Address ("10.2.1.200")), sw.ports[4], "/25 should use its own port");
+      NS_TEST_ASSERT_MSG_EQ (sw.Route (Ipv4Address ("10.9.0.1")), sw.ports[3], "/8 should use its own port");
+    }
+  NS_TEST_ASSERT_MSG_EQ (sw.Route (Ipv4Address ("11.0.0.1")), 0, "A destination without a prefix is not routed");
+
+  std::vector<DrillRouteEntry> entries = sw.routing->LookupDrillRouteEntries (Ipv4Address ("10.2.1.1"));
+  NS_TEST_ASSERT_MSG_EQ (entries.size (), 4, "LookupDrillRouteEntries still returns every matching entry");
+}
+
+// A route added after traffic groups the prefixes again and resets their memory
+class DrillAddRouteTestCase : public TestCase
+{
+public:
+  DrillAddRouteTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DrillAddRouteTestCase::DrillAddRouteTestCase ()
+  : TestCase ("Drill resets the memory of the prefixes when a route is added")
+{
+}
+
+void
+DrillAddRouteTestCase::DoRun (void)
+{
+  DrillSwitch sw (4, 3, 2);
+  Ipv4Address dest ("10.2.0.1");
+  Ipv4Address other ("10.3.0.1");
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), sw.ports[i]);
+      sw.SetLoad (sw.ports[i], 10 + i);
+    }
+  sw.routing->AddRoute (Ipv4Address ("10.3.0.0"), Ipv4Mask ("255.255.0.0"), sw.ports[0]);
+
+  NS_TEST_ASSERT_MSG_EQ (sw.Route (dest), sw.ports[0], "The least loaded port should be chosen");
+  sw.Route (other);
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->GetRememberedPorts (dest).size (), 2, "m ports should be remembered");
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->GetRememberedPorts (other).size (), 1, "The other prefix has one port");
+
+  // The new port is idle; the prefixes forget everything until their next packet
+  sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), sw.ports[3]);
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->GetRememberedPorts (dest).size (), 0, "AddRoute should reset the memory");
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->GetRememberedPorts (other).size (), 0, "AddRoute resets every prefix");
+
+  bool newPort = false;
+  for (uint32_t n = 0; n < 16 && !newPort; ++n)
+    {
+      newPort = sw.Route (dest) == sw.ports[3];
+    }
+  NS_TEST_ASSERT_MSG_EQ (newPort, true, "The added port should be sampled and chosen");
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->GetRememberedPorts (dest)[0], sw.ports[3], "The added port should be remembered");
+}
+
+// Every packet compares min (d, n) distinct ports
+class DrillSampleTestCase : public TestCase
+{
+public:
+  DrillSampleTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DrillSampleTestCase::DrillSampleTestCase ()
+  : TestCase ("Drill samples min (d, n) distinct ports")
+{
+}
+
+void
+DrillSampleTestCase::DoRun (void)
+{
+  // With a memory wider than the prefix, the first packet of a prefix
+  // remembers exactly the ports it sampled
+  const uint32_t nPorts = 5;
+  uint32_t ds[] = { 1, 2, 3, 5, 7 };
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      for (uint32_t run = 0; run < 8; ++run)
+        {
+          DrillSwitch sw (nPorts, ds[i], nPorts + 1);
+          sw.routing->AssignStreams (run);
+          for (uint32_t k = 0; k < nPorts; ++k)
+            {
+              sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), sw.ports[k]);
+            }
+          sw.Route (Ipv4Address ("10.2.0.1"));
+
+          std::vector<uint32_t> sampled = sw.routing->GetRememberedPorts (Ipv4Address ("10.2.0.1"));
+          NS_TEST_ASSERT_MSG_EQ (sampled.size (), std::min (ds[i], nPorts), "Wrong number of ports sampled with d = " << ds[i]);
+          std::sort (sampled.begin (), sampled.end ());
+          NS_TEST_ASSERT_MSG_EQ ((std::unique (sampled.begin (), sampled.end ()) == sampled.end ()), true,
+                                 "The sampled ports should be distinct with d = " << ds[i]);
+          for (uint32_t k = 0; k < sampled.size (); ++k)
+            {
+              NS_TEST_ASSERT_MSG_EQ ((std::find (sw.ports.begin (), sw.ports.end (), sampled[k]) != sw.ports.end ()), true,
+                                     "A sampled port should be a port of the prefix");
+            }
+        }
+    }
+}
+
+// d = 0 would leave the first packet of a prefix nothing to compare
+class DrillZeroSampleTestCase : public TestCase
+{
+public:
+  DrillZeroSampleTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DrillZeroSampleTestCase::DrillZeroSampleTestCase ()
+  : TestCase ("Drill rejects d = 0")
+{
+}
+
+void
+DrillZeroSampleTestCase::DoRun (void)
+{
+  DrillSwitch sw (3, 2, 1);
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), sw.ports[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->SetAttributeFailSafe ("d", UintegerValue (0)), false, "d = 0 should be rejected");
+  UintegerValue d;
+  sw.routing->GetAttribute ("d", d);
+  NS_TEST_ASSERT_MSG_EQ (d.Get (), 2, "A rejected d should leave the previous one");
+
+  uint32_t port = sw.Route (Ipv4Address ("10.2.0.1"));
+  NS_TEST_ASSERT_MSG_EQ ((std::find (sw.ports.begin (), sw.ports.end (), port) != sw.ports.end ()), true,
+                         "The first packet should be routed through a port of the prefix");
+}
+
+// The queues of a port are resolved once and looked up again after the
+// interface goes down or gets an address
+class DrillPortQueuesTestCase : public TestCase
+{
+public:
+  DrillPortQueuesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DrillPortQueuesTestCase::DrillPortQueuesTestCase ()
+  : TestCase ("Drill resolves the queues of a port again when the interface changes")
+{
+}
+
+void
+DrillPortQueuesTestCase::DoRun (void)
+{
+  DrillSwitch sw (2, 2, 1);
+  Ipv4Address dest ("10.2.0.1");
+  uint32_t a = sw.ports[0];
+  uint32_t b = sw.ports[1];
+  sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), a);
+  sw.routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.0.0"), b);
+  sw.SetLoad (a, 10);
+  sw.SetLoad (b, 5);
+  NS_TEST_ASSERT_MSG_EQ (sw.Route (dest), b, "The least loaded port should be chosen");
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->CalculateQueueLength (a), 1000, "Wrong load of the first port");
+
+  // A new, idle queue on the device is not seen through the cached one
+  sw.GetDevice (a)->SetQueue (CreateObject<DropTailQueue> ());
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->CalculateQueueLength (a), 1000, "The queues of a port should be cached");
+  NS_TEST_ASSERT_MSG_EQ (sw.Route (dest), b, "The cached load should still be used");
+
+  sw.ipv4->SetDown (a);
+  sw.ipv4->SetUp (a);
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->CalculateQueueLength (a), 0, "NotifyInterfaceDown should drop the cached queues");
+  NS_TEST_ASSERT_MSG_EQ (sw.Route (dest), a, "The new queue should be used");
+
+  sw.GetDevice (b)->SetQueue (CreateObject<DropTailQueue> ());
+  sw.SetLoad (a, 10);
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->CalculateQueueLength (b), 500, "The queues of a port should be cached");
+  sw.ipv4->AddAddress (b, Ipv4InterfaceAddress (Ipv4Address ("192.168.9.1"), Ipv4Mask ("255.255.255.0")));
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->CalculateQueueLength (b), 0, "NotifyAddAddress should drop the cached queues");
+  NS_TEST_ASSERT_MSG_EQ (sw.Route (dest), b, "The new queue should be used");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,8 +494,14 @@ DrillRoutingTestSuite::DrillRoutingTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new DrillRoutingTestCase1, TestCase::QUICK);
+  AddTestCase (new DrillMemoryTestCase, TestCase::QUICK);
+  AddTestCase (new DrillSingleMemoryTestCase, TestCase::QUICK);
+  AddTestCase (new DrillLongestPrefixTestCase, TestCase::QUICK);
+  AddTestCase (new DrillAddRouteTestCase, TestCase::QUICK);
+  AddTestCase (new DrillSampleTestCase, TestCase::QUICK);
+  AddTestCase (new DrillZeroSampleTestCase, TestCase::QUICK);
+  AddTestCase (new DrillPortQueuesTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
 static DrillRoutingTestSuite drillRoutingTestSuite;
-
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "flow-hash.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+namespace {
+
+// The CRC tables of the reflected polynomials, one step per byte
+class CrcTables
+{
+public:
+  CrcTables ()
+  {
+    for (uint32_t i = 0; i < 256; i++)
+      {
+        uint32_t crc32 = i;
+        uint16_t crc16 = i;
+        for (uint32_t bit = 0; bit < 8; bit++)
+          {
+            crc32 = (crc32 & 1) ? (crc32 >> 1) ^ 0xedb88320 : crc32 >> 1;
+            crc16 = (crc16 & 1) ? (crc16 >> 1) ^ 0xa001 : crc16 >> 1;
+          }
+        crc32Table[i] = crc32;
+        crc16Table[i] = crc16;
+      }
+  }
+
+  uint32_t crc32Table[256];
+  uint16_t crc16Table[256];
+};
+
+const CrcTables g_crcTables;
+
+// The Microsoft RSS key
+const uint8_t TOEPLITZ_KEY[40] = {
+  0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2,
+  0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+  0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4,
+  0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+  0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa
+};
+
+// An odd constant, the golden ratio times 2^64
+const uint64_t MULTIPLY_SHIFT_FACTOR = 0x9e3779b97f4a7c15ULL;
+
+}
+
+uint32_t
+FlowHash::Crc32 (const uint8_t *data, uint32_t size, uint32_t seed)
+{
+  uint32_t crc = 0xffffffff ^ seed;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      crc = g_crcTables.crc32Table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+  return crc ^ 0xffffffff;
+}
+
+uint16_t
+FlowHash::Crc16 (const uint8_t *data, uint32_t size, uint32_t seed)
+{
+  uint16_t crc = seed & 0xffff;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      crc = g_crcTables.crc16Table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+  return crc;
+}
+
+uint32_t
+FlowHash::Toeplitz (const uint8_t *data, uint32_t size, uint32_t seed)
+{
+  NS_ASSERT (size + 4 <= sizeof (TOEPLITZ_KEY));
+  // The 32 bits of the key under the current input bit, shifted in bit by bit
+  uint32_t window = ((TOEPLITZ_KEY[0] << 24) | (TOEPLITZ_KEY[1] << 16)
+                     | (TOEPLITZ_KEY[2] << 8) | TOEPLITZ_KEY[3]) ^ seed;
+  uint32_t hash = 0;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      uint8_t next = TOEPLITZ_KEY[i + 4];
+      for (uint32_t bit = 0; bit < 8; bit++)
+        {
+          if (data[i] & (0x80 >> bit))
+            {
+              hash ^= window;
+            }
+          window = (window << 1) | ((next >> (7 - bit)) & 1);
+        }
+    }
+  return hash;
+}
+
+uint32_t
+FlowHash::MultiplyShift (uint64_t key, uint32_t seed)
+{
+  return static_cast<uint32_t> (((key ^ seed) * MULTIPLY_SHIFT_FACTOR) >> 32);
+}
+
+} // namespace ns3
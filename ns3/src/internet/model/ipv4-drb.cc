@@ -21,6 +21,7 @@ Ipv4Drb::GetTypeId (void)
 Ipv4Drb::Ipv4Drb ()
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4Drb::~Ipv4Drb ()
@@ -40,7 +41,7 @@ Ipv4Drb::GetCoreSwitchAddress (uint32_t flowId)
     return Ipv4Address ();
   }
 
-  uint32_t index = rand () % listSize;
+  uint32_t index;
 
   std::map<uint32_t, uint32_t>::iterator itr = m_indexMap.find (flowId);
 
@@ -48,6 +49,10 @@ Ipv4Drb::GetCoreSwitchAddress (uint32_t flowId)
   {
     index = itr->second;
   }
+  else
+  {
+    index = m_rand->GetInteger (0, listSize - 1);
+  }
   m_indexMap[flowId] = ((index + 1) % listSize);
 
   Ipv4Address addr = m_coreSwitchAddressList[index];
@@ -72,4 +77,12 @@ Ipv4Drb::AddCoreSwitchAddress (uint32_t k, Ipv4Address addr)
   }
 }
 
+int64_t
+Ipv4Drb::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 }
@@ -17,6 +17,7 @@
 //
 
 #include <vector>
+#include <algorithm>
 #include <iomanip>
 #include "ns3/names.h"
 #include "ns3/log.h"
@@ -27,11 +28,14 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
 #include "ns3/flow-id-tag.h"
 #include "ns3/hash.h"
+#include "flow-hash.h"
 
 namespace ns3 {
 
@@ -55,6 +59,20 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_perFlowEcmpRouting),
                    MakeBooleanChecker ())
+    .AddAttribute ("EcmpHash",
+                   "The hash function per flow ECMP selects the route with",
+                   EnumValue (ECMP_HASH_STRING),
+                   MakeEnumAccessor (&Ipv4GlobalRouting::m_ecmpHash),
+                   MakeEnumChecker (ECMP_HASH_STRING, "String",
+                                    ECMP_HASH_CRC32, "Crc32",
+                                    ECMP_HASH_CRC16, "Crc16",
+                                    ECMP_HASH_TOEPLITZ, "Toeplitz",
+                                    ECMP_HASH_MULTIPLY_SHIFT, "MultiplyShift"))
+    .AddAttribute ("EcmpHashSeed",
+                   "The seed of the per flow ECMP hash, not used by the String hash",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4GlobalRouting::m_ecmpHashSeed),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("RespondToInterfaceEvents",
                    "Set to true if you want to dynamically recompute the global routes upon Interface notification events (up/down, or add/remove address)",
                    BooleanValue (false),
@@ -67,7 +85,10 @@ Ipv4GlobalRouting::GetTypeId (void)
 Ipv4GlobalRouting::Ipv4GlobalRouting ()
   : m_randomEcmpRouting (false),
     m_perFlowEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_ecmpHash (ECMP_HASH_STRING),
+    m_ecmpHashSeed (0),
+    m_respondToInterfaceEvents (false),
+    m_routeIndexValid (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -88,6 +109,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_routeIndexValid = false;
 }
 
 void
@@ -98,6 +120,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_routeIndexValid = false;
 }
 
 void
@@ -113,6 +136,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_routeIndexValid = false;
 }
 
 void
@@ -126,6 +150,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_routeIndexValid = false;
 }
 
 void
@@ -141,8 +166,37 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_routeIndexValid = false;
 }
 
+uint32_t
+Ipv4GlobalRouting::HashFlow (uint32_t flowId, uint8_t ttl) const
+{
+  // The flow id in network order, as a switch reads the header fields
+  uint8_t key[4];
+  key[0] = flowId >> 24;
+  key[1] = flowId >> 16;
+  key[2] = flowId >> 8;
+  key[3] = flowId;
+  switch (m_ecmpHash)
+    {
+    case ECMP_HASH_CRC32:
+      return FlowHash::Crc32 (key, sizeof (key), m_ecmpHashSeed);
+    case ECMP_HASH_CRC16:
+      return FlowHash::Crc16 (key, sizeof (key), m_ecmpHashSeed);
+    case ECMP_HASH_TOEPLITZ:
+      return FlowHash::Toeplitz (key, sizeof (key), m_ecmpHashSeed);
+    case ECMP_HASH_MULTIPLY_SHIFT:
+      return FlowHash::MultiplyShift (flowId, m_ecmpHashSeed);
+    default:
+      {
+        std::stringstream hash_string;
+        hash_string << flowId;
+        hash_string << ttl;
+        return Hash32 (hash_string.str ()); // Hash Perturbe
+      }
+    }
+}
 
 Ptr<Ipv4Route>
 Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv4Header &header, uint32_t flowId, Ptr<NetDevice> oif)
@@ -150,55 +204,44 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv
   NS_LOG_FUNCTION (this << dest << oif);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
+  if (!m_routeIndexValid)
+    {
+      BuildRouteIndex ();
+    }
   // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
+  m_matches.clear ();
 
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin ();
-       i != m_hostRoutes.end ();
-       i++)
+  uint32_t group = m_hostIndex.Find (RouteKey (dest.Get (), 0xffffffff));
+  if (group != IndexMap::NONE)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest))
-        {
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i);
-        }
+      MatchGroup (group, oif);
+      NS_LOG_LOGIC (m_matches.size () << " global host routes found");
     }
-  if (allRoutes.size () == 0) // if no host route is found
+  if (m_matches.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin ();
-           j != m_networkRoutes.end ();
-           j++)
+      // Every network route matching the destination counts, not only the longest prefix
+      bool isMerged = false;
+      for (std::vector<uint32_t>::const_iterator mask = m_networkMasks.begin ();
+           mask != m_networkMasks.end ();
+           mask++)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          group = m_networkIndex.Find (RouteKey (dest.Get () & *mask, *mask));
+          if (group != IndexMap::NONE)
             {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              isMerged = isMerged || m_matches.size () > 0;
+              MatchGroup (group, oif);
             }
         }
+      if (isMerged)
+        {
+          // Back to the order of the routing table
+          std::sort (m_matches.begin (), m_matches.end ());
+        }
+      NS_LOG_LOGIC (m_matches.size () << " global network routes found");
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  if (m_matches.size () == 0)  // consider external if no host/network found
     {
       for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
            k != m_ASexternalRoutes.end ();
@@ -217,12 +260,12 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv
                       continue;
                     }
                 }
-              allRoutes.push_back (*k);
+              m_matches.push_back (std::make_pair (0u, *k));
               break;
             }
         }
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+  if (m_matches.size () > 0 ) // if route(s) is found
     {
       // pick up one of the routes uniformly at random if random
       // ECMP routing is enabled, or always select the first route
@@ -230,22 +273,18 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv
       uint32_t selectIndex;
       if (m_randomEcmpRouting)
         {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
+          selectIndex = m_rand->GetInteger (0, m_matches.size ()-1);
         }
       else if (m_perFlowEcmpRouting && flowId != 0) // If the flow id is 0, it may be the socket setup endpoint request, we simply return the first
         {                                           // available route to indicate the address is not local
-          std::stringstream hash_string;
-          hash_string << flowId;
-          hash_string << header.GetTtl ();
-          uint32_t hashPerturbe = Hash32 (hash_string.str ()); // Hash Perturbe
-          selectIndex = hashPerturbe % allRoutes.size();
+          selectIndex = HashFlow (flowId, header.GetTtl ()) % m_matches.size();
           NS_LOG_LOGIC ("Per flow ECMP is enabled, select index: " << selectIndex << " for flow: " << flowId);
         }
       else
         {
           selectIndex = 0;
         }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex);
+      Ipv4RoutingTableEntry* route = m_matches.at (selectIndex).second;
       // create a Ipv4Route object from the selected routing table entry
       rtentry = Create<Ipv4Route> ();
       rtentry->SetDestination (route->GetDest ());
@@ -262,6 +301,95 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv
     }
 }
 
+uint64_t
+Ipv4GlobalRouting::RouteKey (uint32_t network, uint32_t mask)
+{
+  return (static_cast<uint64_t> (mask) << 32) | (network & mask);
+}
+
+uint32_t
+Ipv4GlobalRouting::AddRouteToGroup (IndexMap &index, uint64_t key)
+{
+  uint32_t group = index.Insert (key, m_routeGroups.size ());
+  if (group == m_routeGroups.size ())
+    {
+      RouteGroup newGroup;
+      newGroup.begin = 0;
+      newGroup.size = 0;
+      m_routeGroups.push_back (newGroup);
+    }
+  m_routeGroups[group].size++;
+  return group;
+}
+
+void
+Ipv4GlobalRouting::BuildRouteIndex (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routeGroups.clear ();
+  m_networkMasks.clear ();
+  m_hostIndex.Reset (m_hostRoutes.size ());
+  m_networkIndex.Reset (m_networkRoutes.size ());
+
+  // The group of every route first, then the routes laid out group by group
+  std::vector<uint32_t> routeGroups;
+  std::vector<uint32_t> routeOrders;
+  std::vector<Ipv4RoutingTableEntry *> routes;
+  uint32_t order = 0;
+  for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++, order++)
+    {
+      NS_ASSERT ((*i)->IsHost ());
+      routeGroups.push_back (AddRouteToGroup (m_hostIndex, RouteKey ((*i)->GetDest ().Get (), 0xffffffff)));
+      routeOrders.push_back (order);
+      routes.push_back (*i);
+    }
+  order = 0;
+  for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++, order++)
+    {
+      uint32_t mask = (*j)->GetDestNetworkMask ().Get ();
+      if (std::find (m_networkMasks.begin (), m_networkMasks.end (), mask) == m_networkMasks.end ())
+        {
+          m_networkMasks.push_back (mask);
+        }
+      routeGroups.push_back (AddRouteToGroup (m_networkIndex, RouteKey ((*j)->GetDestNetwork ().Get (), mask)));
+      routeOrders.push_back (order);
+      routes.push_back (*j);
+    }
+
+  uint32_t begin = 0;
+  for (std::vector<RouteGroup>::iterator itr = m_routeGroups.begin (); itr != m_routeGroups.end (); itr++)
+    {
+      itr->begin = begin;
+      begin += itr->size;
+      itr->size = 0;
+    }
+  m_groupRoutes.resize (routes.size ());
+  m_groupOrders.resize (routes.size ());
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      RouteGroup &routeGroup = m_routeGroups[routeGroups[i]];
+      m_groupRoutes[routeGroup.begin + routeGroup.size] = routes[i];
+      m_groupOrders[routeGroup.begin + routeGroup.size] = routeOrders[i];
+      routeGroup.size++;
+    }
+  m_routeIndexValid = true;
+}
+
+void
+Ipv4GlobalRouting::MatchGroup (uint32_t group, Ptr<NetDevice> oif)
+{
+  const RouteGroup &routeGroup = m_routeGroups[group];
+  for (uint32_t i = routeGroup.begin; i < routeGroup.begin + routeGroup.size; i++)
+    {
+      if (oif != 0 && oif != m_ipv4->GetNetDevice (m_groupRoutes[i]->GetInterface ()))
+        {
+          NS_LOG_LOGIC ("Not on requested interface, skipping");
+          continue;
+        }
+      m_matches.push_back (std::make_pair (m_groupOrders[i], m_groupRoutes[i]));
+    }
+}
+
 uint32_t
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -326,6 +454,7 @@ void
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  m_routeIndexValid = false;
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -409,6 +538,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_routeIndexValid = false;
+  m_groupRoutes.clear ();
+  m_matches.clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
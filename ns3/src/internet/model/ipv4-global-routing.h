@@ -21,8 +21,11 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
+#include <utility>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
+#include "ns3/index-map.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
@@ -226,6 +229,16 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /// The hash functions per flow ECMP can split the flows with
+  enum EcmpHash
+  {
+    ECMP_HASH_STRING,         //!< Hash32 of the flow id and the TTL as text
+    ECMP_HASH_CRC32,          //!< CRC-32 of the flow id
+    ECMP_HASH_CRC16,          //!< CRC-16 of the flow id
+    ECMP_HASH_TOEPLITZ,       //!< Toeplitz hash of the flow id
+    ECMP_HASH_MULTIPLY_SHIFT  //!< Multiply shift hash of the flow id
+  };
+
 protected:
   void DoDispose (void);
 
@@ -235,6 +248,11 @@ private:
 
   bool m_perFlowEcmpRouting;
 
+  /// The hash per flow ECMP selects the route with
+  EcmpHash m_ecmpHash;
+  /// The seed of the hash, distinct seeds on the switches de-polarize it
+  uint32_t m_ecmpHashSeed;
+
   /// Set to true if this interface should respond to interface events by globallly recomputing routes
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP
@@ -263,10 +281,56 @@ private:
 
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv4Header &header, uint32_t flowId, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Hashes the flow for per flow ECMP.
+   *
+   * The CRC, Toeplitz and multiply shift hashes cover the bytes of the
+   * flow id only, like a switch hashing the five tuple, so that a flow is
+   * split the same way at every hop unless the seeds differ.  The string
+   * hash mixes the TTL in and so differs from hop to hop.
+   */
+  uint32_t HashFlow (uint32_t flowId, uint8_t ttl) const;
+
+  /// The routes to one host or one network, a span of m_groupRoutes
+  struct RouteGroup
+  {
+    uint32_t begin;
+    uint32_t size;
+  };
+
+  /// \return the key of the network under the mask
+  static uint64_t RouteKey (uint32_t network, uint32_t mask);
+
+  /**
+   * \brief Indexes the host and network routes by their destination.
+   *
+   * The routes with the same destination form a group, in the order of
+   * the routing table, so that a lookup returns the same routes as the
+   * scan of the tables did.  Called by LookupGlobal whenever the routes
+   * have changed since the last build.
+   */
+  void BuildRouteIndex (void);
+
+  /// \return the group of the key, adding one if the key is new
+  uint32_t AddRouteToGroup (IndexMap &index, uint64_t key);
+
+  /// Appends the routes of the group on the interface of oif, if any, to m_matches
+  void MatchGroup (uint32_t group, Ptr<NetDevice> oif);
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  bool m_routeIndexValid;                         //!< Whether the index is up to date with the routes
+  IndexMap m_hostIndex;                           //!< Host address to group
+  IndexMap m_networkIndex;                        //!< Key of the network and mask to group
+  std::vector<uint32_t> m_networkMasks;           //!< Distinct masks of the network routes
+  std::vector<RouteGroup> m_routeGroups;          //!< Groups of the host and network routes
+  std::vector<Ipv4RoutingTableEntry *> m_groupRoutes; //!< Routes by group
+  std::vector<uint32_t> m_groupOrders;            //!< Position of each route of m_groupRoutes in its table
+  /// The matching routes of a lookup with their position in their table
+  std::vector<std::pair<uint32_t, Ipv4RoutingTableEntry *> > m_matches;
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
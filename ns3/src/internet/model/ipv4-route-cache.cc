@@ -0,0 +1,141 @@
+#include "ipv4-route-cache.h"
+
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/node.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteCache");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv4RouteCache);
+
+TypeId
+Ipv4RouteCache::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv4RouteCache")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<Ipv4RouteCache> ();
+
+  return tid;
+}
+
+Ipv4RouteCache::Ipv4RouteCache ()
+  : m_ipv4 (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4RouteCache::~Ipv4RouteCache ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<Ipv4RouteCache>
+Ipv4RouteCache::GetRouteCache (Ptr<Ipv4> ipv4)
+{
+  Ptr<Ipv4RouteCache> cache = ipv4->GetObject<Ipv4RouteCache> ();
+  if (cache == 0)
+    {
+      cache = CreateObject<Ipv4RouteCache> ();
+      cache->SetIpv4 (ipv4);
+      ipv4->AggregateObject (cache);
+    }
+  return cache;
+}
+
+void
+Ipv4RouteCache::SetIpv4 (Ptr<Ipv4> ipv4)
+{
+  NS_LOG_FUNCTION (this << ipv4);
+  m_ipv4 = ipv4;
+  InvalidateAll ();
+}
+
+Ipv4RouteCache::InterfaceState &
+Ipv4RouteCache::GetInterfaceState (uint32_t interface)
+{
+  if (interface >= m_interfaces.size ())
+    {
+      InterfaceState empty;
+      empty.m_valid = false;
+      m_interfaces.resize (interface + 1, empty);
+    }
+
+  InterfaceState &state = m_interfaces[interface];
+  if (!state.m_valid)
+    {
+      Ptr<NetDevice> dev = m_ipv4->GetNetDevice (interface);
+      Ptr<Channel> channel = dev->GetChannel ();
+      uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
+      Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
+      uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
+
+      state.m_device = dev;
+      state.m_gateway = nextHop->GetObject<Ipv4> ()->GetAddress (nextIf, 0).GetLocal ();
+      state.m_source = m_ipv4->GetAddress (interface, 0).GetLocal ();
+      state.m_routes.clear ();
+      state.m_valid = true;
+
+      NS_LOG_LOGIC (this << " interface " << interface << " resolved to gateway " << state.m_gateway);
+    }
+  return state;
+}
+
+Ptr<Ipv4Route>
+Ipv4RouteCache::GetRoute (uint32_t interface, Ipv4Address dest)
+{
+  InterfaceState &state = GetInterfaceState (interface);
+
+  std::map<Ipv4Address, Ptr<Ipv4Route> >::iterator it = state.m_routes.find (dest);
+  if (it != state.m_routes.end ())
+    {
+      return it->second;
+    }
+
+  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+  route->SetOutputDevice (state.m_device);
+  route->SetGateway (state.m_gateway);
+  route->SetSource (state.m_source);
+  route->SetDestination (dest);
+  state.m_routes[dest] = route;
+  return route;
+}
+
+Ipv4Address
+Ipv4RouteCache::GetGateway (uint32_t interface)
+{
+  return GetInterfaceState (interface).m_gateway;
+}
+
+void
+Ipv4RouteCache::Invalidate (uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << interface);
+  if (interface < m_interfaces.size ())
+    {
+      m_interfaces[interface].m_valid = false;
+      m_interfaces[interface].m_device = 0;
+      m_interfaces[interface].m_routes.clear ();
+    }
+}
+
+void
+Ipv4RouteCache::InvalidateAll (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_interfaces.clear ();
+}
+
+void
+Ipv4RouteCache::DoDispose (void)
+{
+  m_interfaces.clear ();
+  m_ipv4 = 0;
+  Object::DoDispose ();
+}
+
+}
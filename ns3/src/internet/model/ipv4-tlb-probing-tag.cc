@@ -18,14 +18,14 @@ Ipv4TLBProbingTag::Ipv4TLBProbingTag ()
 
 }
 
-uint16_t
+uint32_t
 Ipv4TLBProbingTag::GetId (void) const
 {
     return m_id;
 }
 
 void
-Ipv4TLBProbingTag::SetId (uint16_t id)
+Ipv4TLBProbingTag::SetId (uint32_t id)
 {
     m_id = id;
 }
@@ -111,7 +111,7 @@ Ipv4TLBProbingTag::GetInstanceTypeId (void) const
 uint32_t
 Ipv4TLBProbingTag::GetSerializedSize (void) const
 {
-    return sizeof (uint16_t)
+    return sizeof (uint32_t)
          + sizeof (uint16_t)
          + sizeof (uint32_t)
          + sizeof (uint8_t)
@@ -123,7 +123,7 @@ Ipv4TLBProbingTag::GetSerializedSize (void) const
 void
 Ipv4TLBProbingTag::Serialize (TagBuffer i) const
 {
-    i.WriteU16 (m_id);
+    i.WriteU32 (m_id);
     i.WriteU16 (m_path);
     i.WriteU32 (m_probeAddress.Get ());
     i.WriteU8 (m_isReply);
@@ -135,7 +135,7 @@ Ipv4TLBProbingTag::Serialize (TagBuffer i) const
 void
 Ipv4TLBProbingTag::Deserialize (TagBuffer i)
 {
-    m_id = i.ReadU16 ();
+    m_id = i.ReadU32 ();
     m_path = i.ReadU16 ();
     m_probeAddress = Ipv4Address (i.ReadU32 ());
     m_isReply = i.ReadU8 ();
@@ -15,9 +15,9 @@ public:
 
     Ipv4TLBProbingTag ();
 
-    uint16_t GetId (void) const;
+    uint32_t GetId (void) const;
 
-    void SetId (uint16_t id);
+    void SetId (uint32_t id);
 
     uint16_t GetPath (void) const;
 
@@ -54,7 +54,7 @@ public:
     virtual void Print (std::ostream &os) const;
 
 private:
-    uint16_t m_id;
+    uint32_t m_id;
     uint16_t m_path;
     Ipv4Address m_probeAddress;
     uint8_t  m_isReply;     // 0 for false and 1 for true
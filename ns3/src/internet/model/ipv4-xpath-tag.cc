@@ -1,8 +1,20 @@
 #include "ipv4-xpath-tag.h"
 
+#include "ns3/assert.h"
+
 namespace ns3 {
 
-Ipv4XPathTag::Ipv4XPathTag () {}
+const uint32_t Ipv4XPathTag::MAX_ROUTE_BITS;
+const uint32_t Ipv4XPathTag::MAX_PORT_BITS;
+
+Ipv4XPathTag::Ipv4XPathTag ()
+  : m_nHops (0),
+    m_hop (0),
+    m_portBits (1)
+{
+  m_route[0] = 0;
+  m_route[1] = 0;
+}
 
 TypeId
 Ipv4XPathTag::GetTypeId (void)
@@ -18,13 +30,115 @@ Ipv4XPathTag::GetTypeId (void)
 uint32_t
 Ipv4XPathTag::GetPathId (void)
 {
-  return m_pathId;
+  uint64_t pathId = 0;
+  for (uint32_t hop = m_nHops; hop > m_hop; hop--)
+  {
+    pathId = pathId * 100 + GetPort (hop - 1);
+  }
+  NS_ASSERT_MSG (pathId <= 0xffffffff, "The route does not fit in a path id");
+  return static_cast<uint32_t> (pathId);
 }
 
 void
 Ipv4XPathTag::SetPathId (uint32_t pathId)
 {
-  m_pathId = pathId;
+  // A uint32_t has at most 5 base-100 digits
+  uint32_t ports[5];
+  uint32_t nPorts = 0;
+  for ( ; pathId != 0; pathId /= 100)
+  {
+    ports[nPorts++] = pathId % 100;
+  }
+  Ipv4XPathTag::SetRoute (ports, nPorts);
+}
+
+bool
+Ipv4XPathTag::SetRoute (const std::vector<uint32_t> &ports)
+{
+  return Ipv4XPathTag::SetRoute (ports.empty () ? 0 : &ports[0], ports.size ());
+}
+
+bool
+Ipv4XPathTag::SetRoute (const uint32_t *ports, uint32_t nPorts)
+{
+  m_route[0] = 0;
+  m_route[1] = 0;
+  m_nHops = 0;
+  m_hop = 0;
+  m_portBits = 1;
+
+  uint32_t maxPort = 0;
+  for (uint32_t hop = 0; hop < nPorts; hop++)
+  {
+    maxPort = ports[hop] > maxPort ? ports[hop] : maxPort;
+  }
+  uint32_t portBits = 1;
+  while (portBits < 32 && (maxPort >> portBits) != 0)
+  {
+    portBits++;
+  }
+  if (portBits > MAX_PORT_BITS || nPorts * portBits > MAX_ROUTE_BITS)
+  {
+    return false;
+  }
+
+  m_portBits = portBits;
+  for (uint32_t hop = 0; hop < nPorts; hop++)
+  {
+    // A port may straddle the two words
+    uint32_t bit = hop * m_portBits;
+    m_route[bit / 64] |= static_cast<uint64_t> (ports[hop]) << (bit % 64);
+    if (bit % 64 + m_portBits > 64)
+    {
+      m_route[bit / 64 + 1] |= static_cast<uint64_t> (ports[hop]) >> (64 - bit % 64);
+    }
+  }
+  m_nHops = nPorts;
+  return true;
+}
+
+uint32_t
+Ipv4XPathTag::GetNHops (void) const
+{
+  return m_nHops;
+}
+
+uint32_t
+Ipv4XPathTag::GetHop (void) const
+{
+  return m_hop;
+}
+
+bool
+Ipv4XPathTag::IsRouteDone (void) const
+{
+  return m_hop >= m_nHops;
+}
+
+uint32_t
+Ipv4XPathTag::GetPort (uint32_t hop) const
+{
+  NS_ASSERT (hop < m_nHops);
+  uint32_t bit = hop * m_portBits;
+  uint64_t port = m_route[bit / 64] >> (bit % 64);
+  if (bit % 64 + m_portBits > 64)
+  {
+    port |= m_route[bit / 64 + 1] << (64 - bit % 64);
+  }
+  return static_cast<uint32_t> (port & ((1u << m_portBits) - 1));
+}
+
+uint32_t
+Ipv4XPathTag::GetCurrentPort (void) const
+{
+  return GetPort (m_hop);
+}
+
+void
+Ipv4XPathTag::NextHop (void)
+{
+  NS_ASSERT (m_hop < m_nHops);
+  m_hop++;
 }
 
 TypeId
@@ -33,28 +147,52 @@ Ipv4XPathTag::GetInstanceTypeId (void) const
   return GetTypeId ();
 }
 
+uint32_t
+Ipv4XPathTag::GetRouteBytes (void) const
+{
+  return (m_nHops * m_portBits + 7) / 8;
+}
+
 uint32_t
 Ipv4XPathTag::GetSerializedSize (void) const
 {
-  return sizeof (uint32_t);
+  return 3 + GetRouteBytes ();
 }
 
 void
 Ipv4XPathTag::Serialize (TagBuffer i) const
 {
-  i.WriteU32 (m_pathId);
+  i.WriteU8 (m_nHops);
+  i.WriteU8 (m_hop);
+  i.WriteU8 (m_portBits);
+  for (uint32_t byte = 0; byte < GetRouteBytes (); byte++)
+  {
+    i.WriteU8 (static_cast<uint8_t> (m_route[byte / 8] >> (byte % 8 * 8)));
+  }
 }
 
 void
 Ipv4XPathTag::Deserialize (TagBuffer i)
 {
-  m_pathId = i.ReadU32 ();
+  m_nHops = i.ReadU8 ();
+  m_hop = i.ReadU8 ();
+  m_portBits = i.ReadU8 ();
+  m_route[0] = 0;
+  m_route[1] = 0;
+  for (uint32_t byte = 0; byte < GetRouteBytes (); byte++)
+  {
+    m_route[byte / 8] |= static_cast<uint64_t> (i.ReadU8 ()) << (byte % 8 * 8);
+  }
 }
 
 void
 Ipv4XPathTag::Print (std::ostream &os) const
 {
-  os << "Path Id = " << m_pathId;
+  os << "Route =";
+  for (uint32_t hop = 0; hop < m_nHops; hop++)
+  {
+    os << (hop == m_hop ? " [" : " ") << GetPort (hop) << (hop == m_hop ? "]" : "");
+  }
 }
 
 }
@@ -3,19 +3,55 @@
 
 #include "ns3/tag.h"
 
+#include <vector>
+
 namespace ns3 {
 
+/**
+ * \brief The source route of a packet, one output port per hop.
+ *
+ * The ports are bit packed, each on the bits needed by the largest of
+ * them, and a hop pointer tells the port of the current hop.  XPath
+ * routing advances the pointer with Packet::ReplacePacketTag, so the
+ * tag keeps its size along the route.  A route holds up to 128 bits of
+ * ports, e.g. 16 hops of ports below 256 or 8 hops of ports below 65536.
+ *
+ * SetPathId and GetPathId keep the former encoding of a route as a
+ * base-100 number, the lowest digits being the port of the first hop.
+ */
 class Ipv4XPathTag: public Tag
 {
 public:
+    static const uint32_t MAX_ROUTE_BITS = 128;
+    static const uint32_t MAX_PORT_BITS = 16;
+
     Ipv4XPathTag ();
 
     static TypeId GetTypeId (void);
 
+    // The ports of the hops left as a base-100 number, 0 at the end of the route
     uint32_t GetPathId (void);
 
     void SetPathId (uint32_t pathId);
 
+    // Returns false, leaving the route empty, if the ports do not fit in the tag
+    bool SetRoute (const std::vector<uint32_t> &ports);
+
+    bool SetRoute (const uint32_t *ports, uint32_t nPorts);
+
+    uint32_t GetNHops (void) const;
+
+    // The index of the current hop, GetNHops once the route is done
+    uint32_t GetHop (void) const;
+
+    bool IsRouteDone (void) const;
+
+    uint32_t GetPort (uint32_t hop) const;
+
+    uint32_t GetCurrentPort (void) const;
+
+    void NextHop (void);
+
     virtual TypeId GetInstanceTypeId (void) const;
 
     virtual uint32_t GetSerializedSize (void) const;
@@ -27,7 +63,12 @@ public:
     virtual void Print (std::ostream &os) const;
 
 private:
-    uint32_t m_pathId;
+    uint32_t GetRouteBytes (void) const;
+
+    uint64_t m_route[MAX_ROUTE_BITS / 64];
+    uint8_t m_nHops;
+    uint8_t m_hop;
+    uint8_t m_portBits;
 };
 
 }
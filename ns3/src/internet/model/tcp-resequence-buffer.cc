@@ -7,6 +7,8 @@
 #include "ns3/tcp-socket-base.h"
 #include "ns3/flow-id-tag.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -14,6 +16,9 @@ NS_LOG_COMPONENT_DEFINE ("TcpResequenceBuffer");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpResequenceBuffer);
 
+// The least number of slots of the out order window
+static const uint32_t MIN_OUT_ORDER_SLOTS = 64;
+
 TypeId
 TcpResequenceBuffer::GetTypeId (void)
 {
@@ -37,7 +42,7 @@ TcpResequenceBuffer::GetTypeId (void)
                    MakeTimeAccessor (&TcpResequenceBuffer::m_outOrderQueueTimerLimit),
                    MakeTimeChecker  ())
     .AddAttribute ("PeriodicalCheckTime",
-                   "Periodical check time",
+                   "Periodical check time, unused since the timeouts fire at their deadlines (Deprecated!)",
                    TimeValue (MicroSeconds (10)),
                    MakeTimeAccessor (&TcpResequenceBuffer::m_periodicalCheckTime),
                    MakeTimeChecker  ())
@@ -65,10 +70,15 @@ TcpResequenceBuffer::TcpResequenceBuffer ():
     m_size (0),
     m_inOrderQueueTimer (Simulator::Now ()),
     m_outOrderQueueTimer (Simulator::Now ()),
-    m_checkEvent (),
+    m_timeoutEvent (),
+    m_timeoutDeadline (Simulator::Now ()),
     m_hasStopped (false),
     m_firstSeq (SequenceNumber32 (0)),
-    m_nextSeq (SequenceNumber32 (0))
+    m_nextSeq (SequenceNumber32 (0)),
+    m_outOrderSegSize (0),
+    m_outOrderSlotMask (0),
+    m_outOrderSize (0),
+    m_tcp (NULL)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -83,11 +93,10 @@ TcpResequenceBuffer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_inOrderQueue.clear ();
-  while (!m_outOrderQueue.empty ())
-  {
-    m_outOrderQueue.pop ();
-  }
-  m_outOrderSeqSet.clear ();
+  m_outOrderWindow.clear ();
+  m_outOrderPresent.clear ();
+  m_outOrderOverflow.clear ();
+  m_outOrderSize = 0;
 }
 
 void
@@ -102,11 +111,10 @@ TcpResequenceBuffer::BufferPacket (Ptr<Packet> packet,
     return;
   }
 
-  // Turn on the periodical check and reset the timer
-  if (!m_checkEvent.IsRunning ())
+  // Reset the timers when the buffer gets a packet while idle
+  if (!m_timeoutEvent.IsRunning ())
   {
-    NS_LOG_LOGIC ("Turn on periodical check");
-    m_checkEvent = Simulator::Schedule (m_periodicalCheckTime, &TcpResequenceBuffer::PeriodicalCheck, this);
+    NS_LOG_LOGIC ("Start the queue timers");
     m_inOrderQueueTimer = Simulator::Now ();
     m_outOrderQueueTimer = Simulator::Now ();
   }
@@ -176,17 +184,10 @@ TcpResequenceBuffer::BufferPacket (Ptr<Packet> packet,
   else if (TcpResequenceBuffer::PutInTheInOrderQueue (element))
   {
     // Try to fill the in order queue from the out order queue
-    while (!m_outOrderQueue.empty ())
+    TcpResequenceBufferElement next;
+    while (m_outOrderSize != 0 && TcpResequenceBuffer::TakeOutOrder (m_nextSeq, next))
     {
-      if (TcpResequenceBuffer::PutInTheInOrderQueue (m_outOrderQueue.top ()))
-      {
-        m_outOrderSeqSet.erase (m_outOrderQueue.top ().m_seq);
-        m_outOrderQueue.pop ();
-      }
-      else
-      {
-        break;
-      }
+      TcpResequenceBuffer::PutInTheInOrderQueue (next);
       m_outOrderQueueTimer = Simulator::Now ();
     }
     // If the size exceeds the limit
@@ -200,12 +201,10 @@ TcpResequenceBuffer::BufferPacket (Ptr<Packet> packet,
   // If the seq > next seq
   else
   {
-    if (m_outOrderSeqSet.find (element.m_seq) == m_outOrderSeqSet.end())
-    {
-      m_outOrderQueue.push (element);
-      m_outOrderSeqSet.insert (element.m_seq);
-    }
+    TcpResequenceBuffer::InsertOutOrder (element);
   }
+
+  TcpResequenceBuffer::UpdateTimeout ();
 }
 
 
@@ -218,10 +217,10 @@ TcpResequenceBuffer::SetTcp (TcpSocketBase *tcp)
 void
 TcpResequenceBuffer::Stop (void)
 {
-  // After the hasStopped flag turned into true, it would never activate the
-  // periodical check event again to prepare for the destruction
+  // After the hasStopped flag turned into true, it would never schedule the
+  // timeout event again to prepare for the destruction
   m_hasStopped = true;
-  m_checkEvent.Cancel ();
+  m_timeoutEvent.Cancel ();
   m_tcp = NULL;
 }
 
@@ -258,7 +257,39 @@ TcpResequenceBuffer::CalculateNextSeq (const TcpResequenceBufferElement &element
 }
 
 void
-TcpResequenceBuffer::PeriodicalCheck ()
+TcpResequenceBuffer::UpdateTimeout (void)
+{
+  if (m_hasStopped)
+  {
+    return;
+  }
+
+  if (m_inOrderQueue.empty () && m_outOrderSize == 0)
+  {
+    NS_LOG_LOGIC ("Both queues are empty, no timeout is pending");
+    m_timeoutEvent.Cancel ();
+    return;
+  }
+
+  // A queue times out once its timer is strictly over the limit.  Both
+  // timers run while the buffer is active, an empty queue merely restarts
+  // its timer when it times out
+  Time deadline = std::min (m_inOrderQueueTimer + m_inOrderQueueTimerLimit,
+                            m_outOrderQueueTimer + m_outOrderQueueTimerLimit) + TimeStep (1);
+  deadline = std::max (deadline, Simulator::Now ());
+
+  // Only move the event when the deadline has changed
+  if (m_timeoutEvent.IsRunning () && m_timeoutDeadline == deadline)
+  {
+    return;
+  }
+  m_timeoutEvent.Cancel ();
+  m_timeoutDeadline = deadline;
+  m_timeoutEvent = Simulator::Schedule (deadline - Simulator::Now (), &TcpResequenceBuffer::Timeout, this);
+}
+
+void
+TcpResequenceBuffer::Timeout (void)
 {
   if (m_hasStopped)
   {
@@ -278,14 +309,7 @@ TcpResequenceBuffer::PeriodicalCheck ()
     m_firstSeq = m_nextSeq;
   }
 
-  if (!m_inOrderQueue.empty () || !m_outOrderQueue.empty ())
-  {
-    m_checkEvent = Simulator::Schedule (m_periodicalCheckTime, &TcpResequenceBuffer::PeriodicalCheck, this);
-  }
-  else
-  {
-	NS_LOG_LOGIC ("Turn the periodical check into idle status");
-  }
+  TcpResequenceBuffer::UpdateTimeout ();
 }
 
 void
@@ -297,7 +321,7 @@ TcpResequenceBuffer::FlushOneElement (const TcpResequenceBufferElement &element,
   }
   NS_LOG_INFO ("Flush packet: " << element.m_packet);
   m_tcpRBFlush (m_traceFlowId, Simulator::Now (), element.m_seq, m_inOrderQueue.size (),
-          m_outOrderQueue.size (), reason);
+          m_outOrderSize, reason);
   m_tcp->DoForwardUp (element.m_packet, element.m_fromAddress, element.m_toAddress);
 }
 
@@ -330,20 +354,137 @@ void
 TcpResequenceBuffer::FlushOutOrderQueue (TcpRBPopReason reason)
 {
   NS_LOG_FUNCTION (this);
-  // Flush the data
-  while (!m_outOrderQueue.empty ())
+  uint32_t slots = m_outOrderPresent.size ();
+  uint32_t firstSlot = slots != 0 ? TcpResequenceBuffer::GetOutOrderSlot (m_nextSeq) : 0;
+
+  // The packets the next seq has moved past, or fallen behind of, are
+  // no longer in the order of the slots
+  for (uint32_t index = 0; index < slots; ++index)
   {
-    if (m_hasStopped)
+    uint32_t slot = (firstSlot + index) & m_outOrderSlotMask;
+    if (m_outOrderPresent[slot] && !TcpResequenceBuffer::IsInOutOrderWindow (m_outOrderWindow[slot].m_seq))
     {
-      break;
+      m_outOrderOverflow.insert (std::make_pair (m_outOrderWindow[slot].m_seq, m_outOrderWindow[slot]));
+      m_outOrderWindow[slot].m_packet = 0;
+      m_outOrderPresent[slot] = false;
     }
-    TcpResequenceBuffer::FlushOneElement (m_outOrderQueue.top (), reason);
-    m_outOrderQueue.pop ();
   }
-  m_outOrderSeqSet.clear ();
+
+  // Flush the data, the slots from the next seq on merged with the overflow map
+  std::map<SequenceNumber32, TcpResequenceBufferElement>::const_iterator overflowItr = m_outOrderOverflow.begin ();
+  for (uint32_t index = 0; index < slots; ++index)
+  {
+    uint32_t slot = (firstSlot + index) & m_outOrderSlotMask;
+    if (!m_outOrderPresent[slot])
+    {
+      continue;
+    }
+    for ( ; overflowItr != m_outOrderOverflow.end () && overflowItr->first < m_outOrderWindow[slot].m_seq; ++overflowItr)
+    {
+      TcpResequenceBuffer::FlushOneElement (overflowItr->second, reason);
+      m_outOrderSize--;
+    }
+    TcpResequenceBuffer::FlushOneElement (m_outOrderWindow[slot], reason);
+    m_outOrderSize--;
+    m_outOrderWindow[slot].m_packet = 0;
+    m_outOrderPresent[slot] = false;
+  }
+  for ( ; overflowItr != m_outOrderOverflow.end (); ++overflowItr)
+  {
+    TcpResequenceBuffer::FlushOneElement (overflowItr->second, reason);
+    m_outOrderSize--;
+  }
+  m_outOrderOverflow.clear ();
+  m_outOrderSize = 0;
 
   // Reset the timer
   m_outOrderQueueTimer = Simulator::Now ();
 }
 
+void
+TcpResequenceBuffer::InitOutOrderWindow (void)
+{
+  // Enough slots for the size limit of segments, as a power of two
+  m_outOrderSegSize = m_tcp != NULL ? std::max (m_tcp->GetSegSize (), 1u) : 536;
+  uint32_t slots = MIN_OUT_ORDER_SLOTS;
+  while (slots < m_sizeLimit / m_outOrderSegSize)
+  {
+    slots <<= 1;
+  }
+  m_outOrderWindow.resize (slots);
+  m_outOrderPresent.assign (slots, false);
+  m_outOrderSlotMask = slots - 1;
+}
+
+uint32_t
+TcpResequenceBuffer::GetOutOrderSlot (SequenceNumber32 seq) const
+{
+  return (seq.GetValue () / m_outOrderSegSize) & m_outOrderSlotMask;
+}
+
+bool
+TcpResequenceBuffer::IsInOutOrderWindow (SequenceNumber32 seq) const
+{
+  uint32_t first = m_nextSeq.GetValue () / m_outOrderSegSize;
+  uint32_t last = seq.GetValue () / m_outOrderSegSize;
+  return m_nextSeq <= seq && first <= last && last - first <= m_outOrderSlotMask;
+}
+
+bool
+TcpResequenceBuffer::InsertOutOrder (const TcpResequenceBufferElement &element)
+{
+  if (m_outOrderWindow.empty ())
+  {
+    TcpResequenceBuffer::InitOutOrderWindow ();
+  }
+  uint32_t slot = TcpResequenceBuffer::GetOutOrderSlot (element.m_seq);
+  if (m_outOrderPresent[slot] && m_outOrderWindow[slot].m_seq == element.m_seq)
+  {
+    return false;
+  }
+  if (!m_outOrderOverflow.empty () && m_outOrderOverflow.find (element.m_seq) != m_outOrderOverflow.end ())
+  {
+    return false;
+  }
+  if (m_outOrderPresent[slot] || !TcpResequenceBuffer::IsInOutOrderWindow (element.m_seq))
+  {
+    // Another seq holds the slot, not segment aligned, or the seq is beyond the window
+    m_outOrderOverflow.insert (std::make_pair (element.m_seq, element));
+  }
+  else
+  {
+    m_outOrderWindow[slot] = element;
+    m_outOrderPresent[slot] = true;
+  }
+  m_outOrderSize++;
+  return true;
+}
+
+bool
+TcpResequenceBuffer::TakeOutOrder (SequenceNumber32 seq, TcpResequenceBufferElement &element)
+{
+  uint32_t slot = TcpResequenceBuffer::GetOutOrderSlot (seq);
+  if (m_outOrderPresent[slot] && m_outOrderWindow[slot].m_seq == seq)
+  {
+    element = m_outOrderWindow[slot];
+    m_outOrderWindow[slot].m_packet = 0;
+    m_outOrderPresent[slot] = false;
+    m_outOrderSize--;
+    return true;
+  }
+  if (m_outOrderOverflow.empty ())
+  {
+    return false;
+  }
+  std::map<SequenceNumber32, TcpResequenceBufferElement>::iterator itr = m_outOrderOverflow.find (seq);
+  if (itr == m_outOrderOverflow.end ())
+  {
+    return false;
+  }
+  element = itr->second;
+  m_outOrderOverflow.erase (itr);
+  m_outOrderSize--;
+  return true;
+}
+
 }
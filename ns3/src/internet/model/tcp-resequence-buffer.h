@@ -10,8 +10,7 @@
 #include "ns3/traced-value.h"
 
 #include <vector>
-#include <queue>
-#include <set>
+#include <map>
 
 namespace ns3
 {
@@ -44,9 +43,9 @@ public:
 
   Address m_toAddress;
 
-  friend inline bool operator > (const TcpResequenceBufferElement &l, const TcpResequenceBufferElement &r)
+  friend inline bool operator < (const TcpResequenceBufferElement &l, const TcpResequenceBufferElement &r)
   {
-    return l.m_seq > r.m_seq;
+    return l.m_seq < r.m_seq;
   }
 };
 
@@ -77,28 +76,40 @@ private:
   bool PutInTheInOrderQueue (const TcpResequenceBufferElement &element);
   SequenceNumber32 CalculateNextSeq (const TcpResequenceBufferElement &element);
 
-  void PeriodicalCheck ();
+  // Keeps the timeout event at the earliest deadline of the non empty queues
+  void UpdateTimeout (void);
+  void Timeout (void);
 
   void FlushOneElement (const TcpResequenceBufferElement &element, TcpRBPopReason reason);
   void FlushInOrderQueue (TcpRBPopReason reason);
   void FlushOutOrderQueue (TcpRBPopReason reason);
 
+  // The out order queue, returns false for a duplicate packet
+  bool InsertOutOrder (const TcpResequenceBufferElement &element);
+  bool TakeOutOrder (SequenceNumber32 seq, TcpResequenceBufferElement &element);
+  void InitOutOrderWindow (void);
+  uint32_t GetOutOrderSlot (SequenceNumber32 seq) const;
+  // Whether the seq is in the slots ahead of the next seq, without wrapping around
+  bool IsInOutOrderWindow (SequenceNumber32 seq) const;
+
   // Parameters
   uint32_t m_sizeLimit;
 
   Time m_inOrderQueueTimerLimit;
   Time m_outOrderQueueTimerLimit;
-
-  Time m_periodicalCheckTime;
+  Time m_periodicalCheckTime; // Unused, the timeouts are scheduled at their deadlines
 
   uint32_t m_traceFlowId;
 
   // Variables
   uint32_t m_size;
+  // The timers start when the buffer gets a packet while idle, and restart
+  // when their queue is flushed
   Time m_inOrderQueueTimer;
   Time m_outOrderQueueTimer;
 
-  EventId m_checkEvent;
+  EventId m_timeoutEvent;
+  Time m_timeoutDeadline;
   bool m_hasStopped;
 
   SequenceNumber32 m_firstSeq;
@@ -106,11 +117,15 @@ private:
 
   std::vector<TcpResequenceBufferElement> m_inOrderQueue;
 
-  std::priority_queue<TcpResequenceBufferElement,
-      std::vector<TcpResequenceBufferElement>,
-      std::greater<TcpResequenceBufferElement> > m_outOrderQueue;
-
-  std::set<SequenceNumber32> m_outOrderSeqSet;
+  // The out order queue is a circular window of slots indexed by seq / segment size,
+  // with a bitmap of the slots holding a packet.  A packet out of the window ahead of
+  // the next seq, or whose slot is taken by another seq, goes to the overflow map instead
+  std::vector<TcpResequenceBufferElement> m_outOrderWindow;
+  std::vector<bool> m_outOrderPresent;
+  uint32_t m_outOrderSegSize;
+  uint32_t m_outOrderSlotMask;
+  std::map<SequenceNumber32, TcpResequenceBufferElement> m_outOrderOverflow;
+  uint32_t m_outOrderSize; // In packets
 
   TcpSocketBase *m_tcp;
 
@@ -67,6 +67,24 @@ NS_LOG_COMPONENT_DEFINE ("TcpSocketBase");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpSocketBase);
 
+// The XPath route of a TLB or Clove path: the ports of its route in the path
+// catalog of the balancer, else the base-100 route of the path id
+template <typename Balancer>
+static void
+SetXPathRoute (Ptr<Balancer> balancer, uint32_t path, Ipv4XPathTag &tag)
+{
+  uint32_t nPorts = 0;
+  const uint32_t *ports = balancer->GetRoute (path, nPorts);
+  if (ports != 0)
+    {
+      tag.SetRoute (ports, nPorts);
+    }
+  else
+    {
+      tag.SetPathId (path);
+    }
+}
+
 TypeId
 TcpSocketBase::GetTypeId (void)
 {
@@ -2554,7 +2572,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
 
       // XPath Support
       Ipv4XPathTag ipv4XPathTag;
-      ipv4XPathTag.SetPathId (path);
+      SetXPathRoute (ipv4TLB, path, ipv4XPathTag);
       p->AddPacketTag (ipv4XPathTag);
 
       // TLB Support
@@ -2606,7 +2624,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
 
       // XPath Support
       Ipv4XPathTag ipv4XPathTag;
-      ipv4XPathTag.SetPathId (path);
+      SetXPathRoute (ipv4TLB, path, ipv4XPathTag);
       p->AddPacketTag (ipv4XPathTag);
     }
   }
@@ -2624,7 +2642,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
 
       // XPath Support
       Ipv4XPathTag ipv4XPathTag;
-      ipv4XPathTag.SetPathId (path);
+      SetXPathRoute (ipv4Clove, path, ipv4XPathTag);
       p->AddPacketTag (ipv4XPathTag);
 
       // Clove Support
@@ -2993,7 +3011,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
         // XPath Support
         Ipv4XPathTag ipv4XPathTag;
-        ipv4XPathTag.SetPathId (path);
+        SetXPathRoute (ipv4TLB, path, ipv4XPathTag);
         p->AddPacketTag (ipv4XPathTag);
 
         // TLB Support
@@ -3033,7 +3051,7 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
           // XPath Support
           Ipv4XPathTag ipv4XPathTag;
-          ipv4XPathTag.SetPathId (path);
+          SetXPathRoute (ipv4Clove, path, ipv4XPathTag);
           p->AddPacketTag (ipv4XPathTag);
 
           // Clove Support
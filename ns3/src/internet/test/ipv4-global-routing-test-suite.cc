@@ -21,6 +21,8 @@
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-route.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
@@ -36,6 +38,9 @@
 #include "ns3/simple-channel.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/enum.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/flow-hash.h"
 
 using namespace ns3;
 
@@ -419,6 +424,151 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class Ipv4GlobalRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ipv4Address Lookup (Ptr<Ipv4GlobalRouting> routing, Ipv4Address dest, Ptr<NetDevice> oif = 0);
+};
+
+Ipv4GlobalRoutingLookupTestCase::Ipv4GlobalRoutingLookupTestCase ()
+  : TestCase ("Indexed global routing lookup keeps the order of the routing table")
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingLookupTestCase::Lookup (Ptr<Ipv4GlobalRouting> routing, Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  Ipv4Header header;
+  header.SetDestination (dest);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = routing->RouteOutput (Create<Packet> (), header, oif, sockerr);
+  if (route == 0)
+    {
+      return Ipv4Address::GetAny ();
+    }
+  return route->GetGateway ();
+}
+
+void
+Ipv4GlobalRoutingLookupTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ptr<SimpleNetDevice> devices[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      devices[i] = CreateObject<SimpleNetDevice> ();
+      devices[i]->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (devices[i]);
+      int32_t ifIndex = ipv4->AddInterface (devices[i]);
+      ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address (0xac100001 + (i << 8)), Ipv4Mask ("/24")));
+      ipv4->SetUp (ifIndex);
+    }
+
+  Ptr<Ipv4GlobalRouting> routing = CreateObject<Ipv4GlobalRouting> ();
+  routing->SetIpv4 (ipv4);
+
+  // Every matching network route counts, in the order they were added, not by prefix length
+  routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("/8"), Ipv4Address ("172.16.0.8"), 1);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("172.16.1.16"), 2);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, Ipv4Address ("10.1.2.3")), Ipv4Address ("172.16.0.8"), "The first matching route should be taken");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, Ipv4Address ("10.1.2.3"), devices[1]), Ipv4Address ("172.16.1.16"), "The route should be on the output device");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, Ipv4Address ("11.1.2.3")), Ipv4Address::GetAny (), "No route should match");
+
+  // Host routes come first, the index follows the changes of the routes
+  routing->AddHostRouteTo (Ipv4Address ("10.1.2.3"), Ipv4Address ("172.16.1.32"), 2);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, Ipv4Address ("10.1.2.3")), Ipv4Address ("172.16.1.32"), "The host route should be taken");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, Ipv4Address ("10.1.2.4")), Ipv4Address ("172.16.0.8"), "Other hosts should take the network route");
+  routing->RemoveRoute (0);
+  routing->RemoveRoute (0);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (routing, Ipv4Address ("10.1.2.3")), Ipv4Address ("172.16.1.16"), "The remaining network route should be taken");
+
+  Simulator::Destroy ();
+}
+
+class Ipv4GlobalRoutingFlowHashTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingFlowHashTestCase ();
+
+private:
+  virtual void DoRun (void);
+  Ipv4Address Lookup (Ptr<Ipv4GlobalRouting> routing, uint32_t flowId);
+};
+
+Ipv4GlobalRoutingFlowHashTestCase::Ipv4GlobalRoutingFlowHashTestCase ()
+  : TestCase ("Per flow ECMP hashes the flow id with the configured function and seed")
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingFlowHashTestCase::Lookup (Ptr<Ipv4GlobalRouting> routing, uint32_t flowId)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddPacketTag (FlowIdTag (flowId));
+  Ipv4Header header;
+  header.SetDestination (Ipv4Address ("10.1.2.3"));
+  header.SetTtl (64);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = routing->RouteOutput (packet, header, 0, sockerr);
+  NS_ASSERT (route != 0);
+  return route->GetGateway ();
+}
+
+void
+Ipv4GlobalRoutingFlowHashTestCase::DoRun (void)
+{
+  const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+  NS_TEST_ASSERT_MSG_EQ (FlowHash::Crc32 (check, sizeof (check), 0), 0xcbf43926, "CRC-32 check value");
+  NS_TEST_ASSERT_MSG_EQ (FlowHash::Crc16 (check, sizeof (check), 0), 0xbb3d, "CRC-16 check value");
+  NS_TEST_ASSERT_MSG_NE (FlowHash::Crc32 (check, sizeof (check), 1), 0xcbf43926, "The seed should change the hash");
+
+  // The RSS verification suite, 66.9.149.187 to 161.142.100.80 without ports
+  const uint8_t rss[] = { 66, 9, 149, 187, 161, 142, 100, 80 };
+  NS_TEST_ASSERT_MSG_EQ (FlowHash::Toeplitz (rss, sizeof (rss), 0), 0x323e8fc2, "Toeplitz check value");
+  NS_TEST_ASSERT_MSG_NE (FlowHash::Toeplitz (rss, sizeof (rss), 1), 0x323e8fc2, "The seed should change the hash");
+
+  NS_TEST_ASSERT_MSG_NE (FlowHash::MultiplyShift (1, 0), FlowHash::MultiplyShift (2, 0), "Keys should spread");
+  NS_TEST_ASSERT_MSG_NE (FlowHash::MultiplyShift (1, 0), FlowHash::MultiplyShift (1, 1), "The seed should change the hash");
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  int32_t ifIndex = ipv4->AddInterface (device);
+  ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("172.16.0.1"), Ipv4Mask ("/24")));
+  ipv4->SetUp (ifIndex);
+
+  Ptr<Ipv4GlobalRouting> routing = CreateObject<Ipv4GlobalRouting> ();
+  routing->SetIpv4 (ipv4);
+  routing->SetAttribute ("PerflowEcmpRouting", BooleanValue (true));
+  routing->SetAttribute ("EcmpHash", EnumValue (Ipv4GlobalRouting::ECMP_HASH_CRC32));
+  routing->SetAttribute ("EcmpHashSeed", UintegerValue (7));
+  Ipv4Address gateways[3] = { Ipv4Address ("172.16.0.8"), Ipv4Address ("172.16.0.9"), Ipv4Address ("172.16.0.10") };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), gateways[i], ifIndex);
+    }
+
+  // The route of a flow is the CRC-32 of its id in network order
+  for (uint32_t flowId = 1; flowId <= 16; flowId++)
+    {
+      const uint8_t key[4] = { 0, 0, 0, static_cast<uint8_t> (flowId) };
+      uint32_t index = FlowHash::Crc32 (key, sizeof (key), 7) % 3;
+      NS_TEST_ASSERT_MSG_EQ (Lookup (routing, flowId), gateways[index], "The flow should follow its hash");
+    }
+
+  Simulator::Destroy ();
+}
 
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
@@ -431,6 +581,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
 {
   AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
   AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingLookupTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingFlowHashTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-route-cache.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/*
+ * A routing protocol using the route cache the way the load balancers do:
+ * it forwards to the peer of the chosen interface and drops the cached
+ * routes of an interface when it goes down or gets a new address.
+ */
+class Ipv4RouteCacheTestRouting : public Ipv4RoutingProtocol
+{
+public:
+  Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)  { return 0; }
+  bool RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                    UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                    LocalDeliverCallback lcb, ErrorCallback ecb) { return false; }
+  void NotifyInterfaceUp (uint32_t interface) {}
+  void NotifyInterfaceDown (uint32_t interface) { m_routeCache->Invalidate (interface); }
+  void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address) { m_routeCache->Invalidate (interface); }
+  void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address) {}
+  void SetIpv4 (Ptr<Ipv4> ipv4) { m_routeCache = Ipv4RouteCache::GetRouteCache (ipv4); }
+  void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const {}
+
+  Ptr<Ipv4Route> Lookup (uint32_t interface, Ipv4Address dest) { return m_routeCache->GetRoute (interface, dest); }
+  Ptr<Ipv4RouteCache> GetRouteCache (void) const { return m_routeCache; }
+
+protected:
+  virtual void DoDispose (void)
+  {
+    m_routeCache = 0;
+    Ipv4RoutingProtocol::DoDispose ();
+  }
+
+private:
+  Ptr<Ipv4RouteCache> m_routeCache;
+};
+
+class Ipv4RouteCacheTestCase : public TestCase
+{
+public:
+  Ipv4RouteCacheTestCase ();
+  virtual void DoRun (void);
+};
+
+Ipv4RouteCacheTestCase::Ipv4RouteCacheTestCase ()
+  : TestCase ("Routes are cached per interface and destination, shared by the protocols of a node and rebuilt on change")
+{
+}
+
+void
+Ipv4RouteCacheTestCase::DoRun (void)
+{
+  // a switch s with two interfaces, to the hosts h1 and h2
+  NodeContainer nodes;
+  nodes.Create (3);
+  Ptr<Node> s = nodes.Get (0);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer toH1 = devHelper.Install (NodeContainer (s, nodes.Get (1)));
+  NetDeviceContainer toH2 = devHelper.Install (NodeContainer (s, nodes.Get (2)));
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (toH1);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  address.Assign (toH2);
+
+  Ptr<Ipv4> ipv4 = s->GetObject<Ipv4> ();
+  Ptr<Ipv4> h1Ipv4 = nodes.Get (1)->GetObject<Ipv4> ();
+  uint32_t h1If = h1Ipv4->GetInterfaceForDevice (toH1.Get (1));
+  uint32_t toH1If = ipv4->GetInterfaceForDevice (toH1.Get (0));
+  uint32_t toH2If = ipv4->GetInterfaceForDevice (toH2.Get (0));
+
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (ipv4->GetRoutingProtocol ());
+  NS_TEST_ASSERT_MSG_NE (list, 0, "The stack helper installs a list routing");
+  Ptr<Ipv4RouteCacheTestRouting> first = CreateObject<Ipv4RouteCacheTestRouting> ();
+  Ptr<Ipv4RouteCacheTestRouting> second = CreateObject<Ipv4RouteCacheTestRouting> ();
+  list->AddRoutingProtocol (first, 20);
+  list->AddRoutingProtocol (second, 10);
+
+  // Both protocols of the node get the cache aggregated to it
+  NS_TEST_ASSERT_MSG_EQ (first->GetRouteCache (), second->GetRouteCache (), "The protocols of a node share one cache");
+  NS_TEST_ASSERT_MSG_EQ (first->GetRouteCache (), ipv4->GetObject<Ipv4RouteCache> (), "The cache is aggregated to the node");
+
+  Ipv4Address dest ("10.1.9.1");
+  Ptr<Ipv4Route> route = first->Lookup (toH1If, dest);
+  NS_TEST_ASSERT_MSG_EQ (route->GetGateway (), Ipv4Address ("10.1.1.2"), "The gateway is the peer of the interface");
+  NS_TEST_ASSERT_MSG_EQ (route->GetSource (), Ipv4Address ("10.1.1.1"), "The source is the address of the interface");
+  NS_TEST_ASSERT_MSG_EQ (route->GetDestination (), dest, "Wrong destination");
+  NS_TEST_ASSERT_MSG_EQ (route->GetOutputDevice (), toH1.Get (0), "Wrong output device");
+
+  // Same (interface, destination): the same route object, from either protocol
+  NS_TEST_ASSERT_MSG_EQ (first->Lookup (toH1If, dest), route, "A cached route is reused");
+  NS_TEST_ASSERT_MSG_EQ (second->Lookup (toH1If, dest), route, "A route cached by one protocol is reused by the other");
+
+  // Another destination or another interface: another route
+  Ptr<Ipv4Route> otherDest = first->Lookup (toH1If, Ipv4Address ("10.1.9.2"));
+  NS_TEST_ASSERT_MSG_NE (otherDest, route, "Each destination has its own route");
+  NS_TEST_ASSERT_MSG_EQ (otherDest->GetGateway (), Ipv4Address ("10.1.1.2"), "Wrong gateway");
+  Ptr<Ipv4Route> otherIf = first->Lookup (toH2If, dest);
+  NS_TEST_ASSERT_MSG_EQ (otherIf->GetGateway (), Ipv4Address ("10.1.2.2"), "Wrong gateway of the second interface");
+  NS_TEST_ASSERT_MSG_EQ (otherIf->GetSource (), Ipv4Address ("10.1.2.1"), "Wrong source of the second interface");
+
+  // The peer is renumbered: the cached gateway stays until the interface
+  // goes down, after which the route is rebuilt with the new gateway
+  h1Ipv4->RemoveAddress (h1If, 0);
+  h1Ipv4->AddAddress (h1If, Ipv4InterfaceAddress (Ipv4Address ("10.1.1.3"), Ipv4Mask ("255.255.255.0")));
+  NS_TEST_ASSERT_MSG_EQ (first->Lookup (toH1If, dest), route, "The cache is kept until it is invalidated");
+  ipv4->SetDown (toH1If);
+  ipv4->SetUp (toH1If);
+  Ptr<Ipv4Route> rebuilt = second->Lookup (toH1If, dest);
+  NS_TEST_ASSERT_MSG_NE (rebuilt, route, "NotifyInterfaceDown drops the cached route");
+  NS_TEST_ASSERT_MSG_EQ (rebuilt->GetGateway (), Ipv4Address ("10.1.1.3"), "The rebuilt route has the new gateway");
+  NS_TEST_ASSERT_MSG_EQ (first->Lookup (toH1If, dest), rebuilt, "The rebuilt route is shared again");
+  NS_TEST_ASSERT_MSG_EQ (first->Lookup (toH2If, dest), otherIf, "The other interfaces keep their routes");
+
+  // The switch is renumbered: NotifyAddAddress rebuilds the route with the
+  // new source
+  ipv4->RemoveAddress (toH1If, 0);
+  ipv4->AddAddress (toH1If, Ipv4InterfaceAddress (Ipv4Address ("10.1.1.4"), Ipv4Mask ("255.255.255.0")));
+  Ptr<Ipv4Route> renumbered = first->Lookup (toH1If, dest);
+  NS_TEST_ASSERT_MSG_NE (renumbered, rebuilt, "NotifyAddAddress drops the cached route");
+  NS_TEST_ASSERT_MSG_EQ (renumbered->GetSource (), Ipv4Address ("10.1.1.4"), "The rebuilt route has the new source");
+  NS_TEST_ASSERT_MSG_EQ (renumbered->GetGateway (), Ipv4Address ("10.1.1.3"), "Wrong gateway after renumbering");
+
+  Simulator::Destroy ();
+}
+
+class Ipv4RouteCacheTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteCacheTestSuite ();
+};
+
+Ipv4RouteCacheTestSuite::Ipv4RouteCacheTestSuite ()
+  : TestSuite ("ipv4-route-cache", UNIT)
+{
+  AddTestCase (new Ipv4RouteCacheTestCase, TestCase::QUICK);
+}
+
+static Ipv4RouteCacheTestSuite ipv4RouteCacheTestSuite;
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV4_ROUTE_INPUT_TEST_H
+#define IPV4_ROUTE_INPUT_TEST_H
+
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup internet
+ * \brief Moves the simulation time forward by delay, running the events
+ * scheduled on the way.
+ */
+inline void
+AdvanceSimulation (Time delay)
+{
+  Simulator::Stop (delay);
+  Simulator::Run ();
+}
+
+/**
+ * \ingroup internet
+ * \brief A switch with one ingress port and n egress ports, each to a host
+ * of its own, for the unit tests of the load balancing routing protocols.
+ *
+ * The switch runs the Routing protocol installed by the routing helper it
+ * is given, over links made by LinkHelper.  The packets are routed by
+ * calling RouteInput as if they came in on the ingress port, without
+ * running the simulation.  The simulator is destroyed with the switch.
+ */
+template <typename Routing, typename LinkHelper>
+class Ipv4RouteInputSwitch
+{
+public:
+  Ipv4RouteInputSwitch (const Ipv4RoutingHelper &routingHelper, uint32_t nPorts);
+  virtual ~Ipv4RouteInputSwitch ();
+
+  // The chosen port, 0 if the packet is not routed
+  uint32_t Route (Ptr<Packet> packet, Ipv4Address dest, Ipv4Address source = Ipv4Address ("10.1.0.1"));
+
+  Ptr<Routing> routing;
+  Ptr<Ipv4> ipv4;
+  std::vector<uint32_t> ports;
+  std::vector<Ptr<NetDevice> > devices;   // Indexed like ports
+
+private:
+  void Forward (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header);
+  void Error (Ptr<const Packet> packet, const Ipv4Header &header, Socket::SocketErrno sockerr);
+
+  Ptr<NetDevice> m_ingress;
+  uint32_t m_port;
+};
+
+template <typename Routing, typename LinkHelper>
+Ipv4RouteInputSwitch<Routing, LinkHelper>::Ipv4RouteInputSwitch (const Ipv4RoutingHelper &routingHelper, uint32_t nPorts)
+  : m_port (0)
+{
+  NodeContainer sw;
+  sw.Create (1);
+  NodeContainer hosts;
+  hosts.Create (nPorts + 1);
+
+  InternetStackHelper internet;
+  internet.SetTLB (false);
+  internet.Install (hosts);
+  internet.SetRoutingHelper (routingHelper);
+  internet.Install (sw);
+
+  LinkHelper link;
+  Ipv4AddressHelper address;
+  address.SetBase ("192.168.0.0", "255.255.255.0");
+  ipv4 = sw.Get (0)->GetObject<Ipv4> ();
+  routing = DynamicCast<Routing> (ipv4->GetRoutingProtocol ());
+  for (uint32_t i = 0; i <= nPorts; ++i)
+    {
+      NetDeviceContainer devs = link.Install (NodeContainer (sw.Get (0), hosts.Get (i)));
+      address.Assign (devs);
+      address.NewNetwork ();
+      if (i == 0)
+        {
+          m_ingress = devs.Get (0);
+          continue;
+        }
+      ports.push_back (ipv4->GetInterfaceForDevice (devs.Get (0)));
+      devices.push_back (devs.Get (0));
+    }
+}
+
+template <typename Routing, typename LinkHelper>
+Ipv4RouteInputSwitch<Routing, LinkHelper>::~Ipv4RouteInputSwitch ()
+{
+  routing = 0;
+  ipv4 = 0;
+  devices.clear ();
+  m_ingress = 0;
+  Simulator::Destroy ();
+}
+
+template <typename Routing, typename LinkHelper>
+void
+Ipv4RouteInputSwitch<Routing, LinkHelper>::Forward (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header)
+{
+  m_port = ipv4->GetInterfaceForDevice (route->GetOutputDevice ());
+}
+
+template <typename Routing, typename LinkHelper>
+void
+Ipv4RouteInputSwitch<Routing, LinkHelper>::Error (Ptr<const Packet> packet, const Ipv4Header &header, Socket::SocketErrno sockerr)
+{
+}
+
+template <typename Routing, typename LinkHelper>
+uint32_t
+Ipv4RouteInputSwitch<Routing, LinkHelper>::Route (Ptr<Packet> packet, Ipv4Address dest, Ipv4Address source)
+{
+  Ipv4Header header;
+  header.SetSource (source);
+  header.SetDestination (dest);
+  m_port = 0;
+  routing->RouteInput (packet, header, m_ingress,
+                       MakeCallback (&Ipv4RouteInputSwitch::Forward, this),
+                       Ipv4RoutingProtocol::MulticastForwardCallback (),
+                       Ipv4RoutingProtocol::LocalDeliverCallback (),
+                       MakeCallback (&Ipv4RouteInputSwitch::Error, this));
+  return m_port;
+}
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_INPUT_TEST_H */
@@ -0,0 +1,590 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/tcp-resequence-buffer.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-header.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+/*
+ * A socket keeping the sequence numbers of the packets its resequence
+ * buffer hands up, instead of processing them
+ */
+class TcpResequenceBufferTestSocket : public TcpSocketBase
+{
+public:
+  static TypeId GetTypeId (void);
+
+  std::vector<SequenceNumber32> m_forwarded;
+
+protected:
+  virtual void DoForwardUp (Ptr<Packet> packet, const Address &fromAddress, const Address &toAddress)
+  {
+    TcpHeader tcpHeader;
+    packet->PeekHeader (tcpHeader);
+    m_forwarded.push_back (tcpHeader.GetSequenceNumber ());
+  }
+};
+
+TypeId
+TcpResequenceBufferTestSocket::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpResequenceBufferTestSocket")
+    .SetParent<TcpSocketBase> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpResequenceBufferTestSocket> ()
+  ;
+  return tid;
+}
+
+/*
+ * Buffers packets at given times and checks the flushes: their sequence
+ * numbers in order, their reasons and their times.  The limits are the
+ * defaults, 20us for the in order queue and 50us for the out order one;
+ * a queue times out once its timer is strictly over its limit, one time
+ * step after the limit
+ */
+class TcpResequenceBufferTestCase : public TestCase
+{
+public:
+  TcpResequenceBufferTestCase (std::string name);
+
+protected:
+  struct Flush
+  {
+    SequenceNumber32 seq;
+    TcpRBPopReason reason;
+    Time time;
+  };
+
+  virtual void DoSetup (void);
+  virtual void DoTeardown (void);
+
+  // Buffers the packet of seq with size bytes of data at the time
+  void Send (Time at, uint32_t seq, uint32_t size);
+  // The next flush should be seq, for the reason, at the time
+  void Expect (uint32_t seq, TcpRBPopReason reason, Time at);
+  // Runs the simulation and checks the flushes against the expected ones
+  void CheckFlushes (void);
+
+  static Time Deadline (Time timer, Time limit);
+
+  Ptr<TcpResequenceBufferTestSocket> m_socket;
+  Ptr<TcpResequenceBuffer> m_buffer;
+
+private:
+  void Buffer (uint32_t seq, uint32_t size);
+  void Flushed (uint32_t flowId, Time time, SequenceNumber32 seq,
+                uint32_t inOrderLength, uint32_t outOrderLength, TcpRBPopReason reason);
+
+  std::vector<Flush> m_flushes;
+  std::vector<Flush> m_expected;
+};
+
+TcpResequenceBufferTestCase::TcpResequenceBufferTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+TcpResequenceBufferTestCase::DoSetup (void)
+{
+  m_socket = CreateObject<TcpResequenceBufferTestSocket> ();
+  m_buffer = m_socket->GetResequenceBuffer ();
+  m_buffer->TraceConnectWithoutContext ("Flush", MakeCallback (&TcpResequenceBufferTestCase::Flushed, this));
+  m_flushes.clear ();
+  m_expected.clear ();
+}
+
+void
+TcpResequenceBufferTestCase::DoTeardown (void)
+{
+  m_buffer = 0;
+  m_socket = 0;
+  Simulator::Destroy ();
+}
+
+void
+TcpResequenceBufferTestCase::Send (Time at, uint32_t seq, uint32_t size)
+{
+  Simulator::Schedule (at, &TcpResequenceBufferTestCase::Buffer, this, seq, size);
+}
+
+void
+TcpResequenceBufferTestCase::Buffer (uint32_t seq, uint32_t size)
+{
+  Ptr<Packet> packet = Create<Packet> (size);
+  TcpHeader tcpHeader;
+  tcpHeader.SetSequenceNumber (SequenceNumber32 (seq));
+  tcpHeader.SetFlags (TcpHeader::ACK);
+  packet->AddHeader (tcpHeader);
+  m_buffer->BufferPacket (packet, Address (), Address ());
+}
+
+void
+TcpResequenceBufferTestCase::Flushed (uint32_t flowId, Time time, SequenceNumber32 seq,
+                                      uint32_t inOrderLength, uint32_t outOrderLength, TcpRBPopReason reason)
+{
+  Flush flush;
+  flush.seq = seq;
+  flush.reason = reason;
+  flush.time = time;
+  m_flushes.push_back (flush);
+}
+
+void
+TcpResequenceBufferTestCase::Expect (uint32_t seq, TcpRBPopReason reason, Time at)
+{
+  Flush flush;
+  flush.seq = SequenceNumber32 (seq);
+  flush.reason = reason;
+  flush.time = at;
+  m_expected.push_back (flush);
+}
+
+Time
+TcpResequenceBufferTestCase::Deadline (Time timer, Time limit)
+{
+  return timer + limit + TimeStep (1);
+}
+
+void
+TcpResequenceBufferTestCase::CheckFlushes (void)
+{
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_flushes.size (), m_expected.size (), "Wrong number of flushes");
+  for (uint32_t i = 0; i < m_expected.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_flushes[i].seq, m_expected[i].seq, "Wrong seq of flush " << i);
+      NS_TEST_ASSERT_MSG_EQ (m_flushes[i].reason, m_expected[i].reason, "Wrong reason of flush " << i << ", seq " << m_expected[i].seq);
+      NS_TEST_ASSERT_MSG_EQ (m_flushes[i].time, m_expected[i].time, "Wrong time of flush " << i << ", seq " << m_expected[i].seq);
+    }
+
+  // Every flushed packet is handed to TCP, in the order of the flushes
+  NS_TEST_ASSERT_MSG_EQ (m_socket->m_forwarded.size (), m_flushes.size (), "Every flush should reach TCP");
+  for (uint32_t i = 0; i < m_flushes.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_socket->m_forwarded[i], m_flushes[i].seq, "Wrong packet handed to TCP at " << i);
+    }
+}
+
+class TcpResequenceBufferInOrderTest : public TcpResequenceBufferTestCase
+{
+public:
+  TcpResequenceBufferInOrderTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpResequenceBufferInOrderTest::TcpResequenceBufferInOrderTest ()
+  : TcpResequenceBufferTestCase ("In order packets are held until the in order timeout, counted from the activation")
+{
+}
+
+void
+TcpResequenceBufferInOrderTest::DoRun (void)
+{
+  Time limit = MicroSeconds (20);
+  // Still accepted from the scripts, nothing polls any more
+  m_buffer->SetAttribute ("PeriodicalCheckTime", TimeValue (MicroSeconds (1)));
+
+  // The buffer is activated by the first packet, not reset by the next ones
+  Send (MicroSeconds (0), 1000, 100);
+  Send (MicroSeconds (5), 1100, 100);
+  Send (MicroSeconds (10), 1200, 100);
+  Time timeout = Deadline (MicroSeconds (0), limit);
+  Expect (1000, IN_ORDER_TIMEOUT, timeout);
+  Expect (1100, IN_ORDER_TIMEOUT, timeout);
+  Expect (1200, IN_ORDER_TIMEOUT, timeout);
+
+  // Emptied, the buffer goes idle and the next packet activates it again
+  Send (MicroSeconds (30), 1300, 100);
+  Expect (1300, IN_ORDER_TIMEOUT, Deadline (MicroSeconds (30), limit));
+
+  // A packet arriving when the timer is exactly at the limit is still held
+  Send (MicroSeconds (60), 1400, 100);
+  Send (MicroSeconds (80), 1500, 100);
+  Expect (1400, IN_ORDER_TIMEOUT, Deadline (MicroSeconds (60), limit));
+  Expect (1500, IN_ORDER_TIMEOUT, Deadline (MicroSeconds (60), limit));
+
+  CheckFlushes ();
+}
+
+class TcpResequenceBufferGapTest : public TcpResequenceBufferTestCase
+{
+public:
+  TcpResequenceBufferGapTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpResequenceBufferGapTest::TcpResequenceBufferGapTest ()
+  : TcpResequenceBufferTestCase ("A filled gap drains the out order queue, under the in order timer of the last flush")
+{
+}
+
+void
+TcpResequenceBufferGapTest::DoRun (void)
+{
+  Time inLimit = MicroSeconds (20);
+
+  // 1100 is missing, 1200 waits in the out order queue
+  Send (MicroSeconds (0), 1000, 100);
+  Send (MicroSeconds (2), 1200, 100);
+  Time firstTimeout = Deadline (MicroSeconds (0), inLimit);
+  Expect (1000, IN_ORDER_TIMEOUT, firstTimeout);
+
+  // The gap is filled while the buffer is still active: the in order
+  // timer runs from its last flush, not from the arrival of 1100
+  Send (MicroSeconds (30), 1100, 100);
+  Time secondTimeout = Deadline (firstTimeout, inLimit);
+  Expect (1100, IN_ORDER_TIMEOUT, secondTimeout);
+  Expect (1200, IN_ORDER_TIMEOUT, secondTimeout);
+
+  CheckFlushes ();
+}
+
+class TcpResequenceBufferOutOrderTimeoutTest : public TcpResequenceBufferTestCase
+{
+public:
+  TcpResequenceBufferOutOrderTimeoutTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpResequenceBufferOutOrderTimeoutTest::TcpResequenceBufferOutOrderTimeoutTest ()
+  : TcpResequenceBufferTestCase ("Packets behind unfilled gaps are flushed in seq order at the out order timeout")
+{
+}
+
+void
+TcpResequenceBufferOutOrderTimeoutTest::DoRun (void)
+{
+  // 1100 and 1300 never come, the packets after them arrive out of order
+  Send (MicroSeconds (0), 1000, 100);
+  Send (MicroSeconds (1), 1400, 100);
+  Send (MicroSeconds (3), 1200, 100);
+  Expect (1000, IN_ORDER_TIMEOUT, Deadline (MicroSeconds (0), MicroSeconds (20)));
+
+  // The out order timer runs from the activation, not from the first out order packet
+  Time timeout = Deadline (MicroSeconds (0), MicroSeconds (50));
+  Expect (1200, OUT_ORDER_TIMEOUT, timeout);
+  Expect (1400, OUT_ORDER_TIMEOUT, timeout);
+
+  CheckFlushes ();
+}
+
+class TcpResequenceBufferDuplicateTest : public TcpResequenceBufferTestCase
+{
+public:
+  TcpResequenceBufferDuplicateTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpResequenceBufferDuplicateTest::TcpResequenceBufferDuplicateTest ()
+  : TcpResequenceBufferTestCase ("Duplicates of held packets are dropped")
+{
+}
+
+void
+TcpResequenceBufferDuplicateTest::DoRun (void)
+{
+  Send (MicroSeconds (0), 1000, 100);
+  // A duplicate of the in order queue
+  Send (MicroSeconds (1), 1000, 100);
+  Send (MicroSeconds (2), 1200, 100);
+  // A duplicate of the out order queue
+  Send (MicroSeconds (3), 1200, 100);
+  Send (MicroSeconds (4), 1100, 100);
+  Time timeout = Deadline (MicroSeconds (0), MicroSeconds (20));
+  Expect (1000, IN_ORDER_TIMEOUT, timeout);
+  Expect (1100, IN_ORDER_TIMEOUT, timeout);
+  Expect (1200, IN_ORDER_TIMEOUT, timeout);
+
+  CheckFlushes ();
+}
+
+class TcpResequenceBufferRetransmissionTest : public TcpResequenceBufferTestCase
+{
+public:
+  TcpResequenceBufferRetransmissionTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpResequenceBufferRetransmissionTest::TcpResequenceBufferRetransmissionTest ()
+  : TcpResequenceBufferTestCase ("A retransmission flushes the in order queue and goes straight up")
+{
+}
+
+void
+TcpResequenceBufferRetransmissionTest::DoRun (void)
+{
+  Time limit = MicroSeconds (20);
+
+  Send (MicroSeconds (0), 1000, 100);
+  Send (MicroSeconds (1), 1100, 100);
+  Expect (1000, IN_ORDER_TIMEOUT, Deadline (MicroSeconds (0), limit));
+  Expect (1100, IN_ORDER_TIMEOUT, Deadline (MicroSeconds (0), limit));
+
+  // The retransmission of the packet just before the queue: 1300 is still expected
+  Send (MicroSeconds (25), 1200, 100);
+  Send (MicroSeconds (26), 1100, 100);
+  Expect (1200, RE_TRANS, MicroSeconds (26));
+  Expect (1100, RE_TRANS, MicroSeconds (26));
+  Send (MicroSeconds (27), 1300, 100);
+  Expect (1300, IN_ORDER_TIMEOUT, Deadline (MicroSeconds (27), limit));
+
+  // The retransmission of an older packet: the packet after it is expected
+  Send (MicroSeconds (60), 1000, 100);
+  Expect (1000, RE_TRANS, MicroSeconds (60));
+  Send (MicroSeconds (61), 1100, 100);
+  Expect (1100, IN_ORDER_TIMEOUT, Deadline (MicroSeconds (61), limit));
+
+  CheckFlushes ();
+}
+
+class TcpResequenceBufferFullTest : public TcpResequenceBufferTestCase
+{
+public:
+  TcpResequenceBufferFullTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpResequenceBufferFullTest::TcpResequenceBufferFullTest ()
+  : TcpResequenceBufferTestCase ("The in order queue is flushed as soon as it reaches the size limit")
+{
+}
+
+void
+TcpResequenceBufferFullTest::DoRun (void)
+{
+  m_buffer->SetAttribute ("SizeLimit", UintegerValue (300));
+
+  Send (MicroSeconds (0), 1000, 100);
+  Send (MicroSeconds (1), 1100, 100);
+  Send (MicroSeconds (2), 1200, 100);
+  Expect (1000, IN_ORDER_FULL, MicroSeconds (2));
+  Expect (1100, IN_ORDER_FULL, MicroSeconds (2));
+  Expect (1200, IN_ORDER_FULL, MicroSeconds (2));
+
+  // Filling a gap drains the out order queue up to the limit
+  Send (MicroSeconds (3), 1400, 100);
+  Send (MicroSeconds (4), 1500, 100);
+  Send (MicroSeconds (5), 1300, 100);
+  Expect (1300, IN_ORDER_FULL, MicroSeconds (5));
+  Expect (1400, IN_ORDER_FULL, MicroSeconds (5));
+  Expect (1500, IN_ORDER_FULL, MicroSeconds (5));
+
+  // Below the limit, the next packet waits for the timeout
+  Send (MicroSeconds (6), 1600, 100);
+  Expect (1600, IN_ORDER_TIMEOUT, Deadline (MicroSeconds (6), MicroSeconds (20)));
+
+  CheckFlushes ();
+}
+
+/*
+ * Out of order packets, with duplicates, in the slots of the out order
+ * queue and in its overflow map: colliding in a slot when smaller than a
+ * segment, not segment aligned, beyond the window, or across the wraparound
+ * of the sequence numbers, depending on the size and the first seq
+ */
+class TcpResequenceBufferWindowTest : public TcpResequenceBufferTestCase
+{
+public:
+  TcpResequenceBufferWindowTest (uint32_t size, uint32_t start, bool fillGap);
+
+private:
+  virtual void DoRun (void);
+
+  static std::string Name (uint32_t size, uint32_t start, bool fillGap);
+
+  uint32_t m_size;
+  uint32_t m_start;
+  bool m_fillGap;
+};
+
+TcpResequenceBufferWindowTest::TcpResequenceBufferWindowTest (uint32_t size, uint32_t start, bool fillGap)
+  : TcpResequenceBufferTestCase (Name (size, start, fillGap)),
+    m_size (size),
+    m_start (start),
+    m_fillGap (fillGap)
+{
+}
+
+std::string
+TcpResequenceBufferWindowTest::Name (uint32_t size, uint32_t start, bool fillGap)
+{
+  std::ostringstream oss;
+  oss << "Out of order packets of " << size << " bytes from seq " << start
+      << (fillGap ? " are drained in order once the gap is filled" : " are flushed in seq order at the out order timeout");
+  return oss.str ();
+}
+
+void
+TcpResequenceBufferWindowTest::DoRun (void)
+{
+  // The test socket has segments of 536 bytes: 128 slots for the default size limit
+  const uint32_t segSize = 536;
+  std::vector<uint32_t> seqs;
+  for (uint32_t k = 0; k <= 6; ++k)
+    {
+      seqs.push_back (m_start + k * m_size);
+    }
+  // Ahead in the window, past the wraparound for the last first seq
+  uint32_t ahead = m_start + 100 * segSize;
+  // Beyond the window, one of them in the slot of the packet 3
+  uint32_t alias = seqs[3] + 128 * segSize;
+  uint32_t far = m_start + 200 * segSize;
+
+  // Behind seq 0 a first packet is taken for a retransmission: it goes
+  // straight up, and the packet after it is expected
+  if (SequenceNumber32 (m_start) < SequenceNumber32 (0))
+    {
+      Send (MicroSeconds (0), m_start - m_size, m_size);
+      Expect (m_start - m_size, RE_TRANS, MicroSeconds (0));
+    }
+
+  // The packet 1 is missing
+  Send (MicroSeconds (0), seqs[0], m_size);
+  Send (MicroSeconds (1), seqs[5], m_size);
+  Send (MicroSeconds (2), seqs[3], m_size);
+  Send (MicroSeconds (3), seqs[4], m_size);
+  Send (MicroSeconds (4), seqs[2], m_size);
+  Send (MicroSeconds (5), seqs[6], m_size);
+  Send (MicroSeconds (6), seqs[4], m_size);
+  Send (MicroSeconds (7), seqs[5], m_size);
+  Send (MicroSeconds (8), ahead, m_size);
+  Send (MicroSeconds (8), alias, m_size);
+  Send (MicroSeconds (9), far, m_size);
+
+  Time inTimeout = Deadline (MicroSeconds (0), MicroSeconds (20));
+  Time outTimeout = Deadline (MicroSeconds (0), MicroSeconds (50));
+  Expect (seqs[0], IN_ORDER_TIMEOUT, inTimeout);
+  if (m_fillGap)
+    {
+      // Draining the out order queue restarts its timer
+      Send (MicroSeconds (10), seqs[1], m_size);
+      outTimeout = Deadline (MicroSeconds (10), MicroSeconds (50));
+      for (uint32_t k = 1; k <= 6; ++k)
+        {
+          Expect (seqs[k], IN_ORDER_TIMEOUT, inTimeout);
+        }
+    }
+  else
+    {
+      for (uint32_t k = 2; k <= 6; ++k)
+        {
+          Expect (seqs[k], OUT_ORDER_TIMEOUT, outTimeout);
+        }
+    }
+  Expect (ahead, OUT_ORDER_TIMEOUT, outTimeout);
+  Expect (alias, OUT_ORDER_TIMEOUT, outTimeout);
+  Expect (far, OUT_ORDER_TIMEOUT, outTimeout);
+
+  CheckFlushes ();
+}
+
+class TcpResequenceBufferStaleTest : public TcpResequenceBufferTestCase
+{
+public:
+  TcpResequenceBufferStaleTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpResequenceBufferStaleTest::TcpResequenceBufferStaleTest ()
+  : TcpResequenceBufferTestCase ("A packet the next seq moved past does not block the drain and is flushed first")
+{
+}
+
+void
+TcpResequenceBufferStaleTest::DoRun (void)
+{
+  const uint32_t segSize = 536;
+
+  Send (MicroSeconds (0), 10 * segSize, segSize);
+  Send (MicroSeconds (1), 12 * segSize + 100, segSize);
+  // Two segments at once: the next seq moves past the packet above
+  Send (MicroSeconds (2), 11 * segSize, 2 * segSize);
+  Send (MicroSeconds (3), 13 * segSize, segSize);
+  Send (MicroSeconds (4), 15 * segSize, segSize);
+  Send (MicroSeconds (5), 16 * segSize, segSize);
+  Send (MicroSeconds (6), 18 * segSize, segSize);
+  // Filling the gap drains the packets after it, not held by the one left behind
+  Send (MicroSeconds (7), 14 * segSize, segSize);
+
+  Time inTimeout = Deadline (MicroSeconds (0), MicroSeconds (20));
+  Expect (10 * segSize, IN_ORDER_TIMEOUT, inTimeout);
+  Expect (11 * segSize, IN_ORDER_TIMEOUT, inTimeout);
+  Expect (13 * segSize, IN_ORDER_TIMEOUT, inTimeout);
+  Expect (14 * segSize, IN_ORDER_TIMEOUT, inTimeout);
+  Expect (15 * segSize, IN_ORDER_TIMEOUT, inTimeout);
+  Expect (16 * segSize, IN_ORDER_TIMEOUT, inTimeout);
+
+  // The packet left behind is in the slot the walk from the next seq reaches last,
+  // the out order timer restarted by the drain
+  Time outTimeout = Deadline (MicroSeconds (7), MicroSeconds (50));
+  Expect (12 * segSize + 100, OUT_ORDER_TIMEOUT, outTimeout);
+  Expect (18 * segSize, OUT_ORDER_TIMEOUT, outTimeout);
+
+  CheckFlushes ();
+}
+
+class TcpResequenceBufferTestSuite : public TestSuite
+{
+public:
+  TcpResequenceBufferTestSuite ();
+};
+
+TcpResequenceBufferTestSuite::TcpResequenceBufferTestSuite ()
+  : TestSuite ("tcp-resequence-buffer", UNIT)
+{
+  AddTestCase (new TcpResequenceBufferInOrderTest, TestCase::QUICK);
+  AddTestCase (new TcpResequenceBufferGapTest, TestCase::QUICK);
+  AddTestCase (new TcpResequenceBufferOutOrderTimeoutTest, TestCase::QUICK);
+  AddTestCase (new TcpResequenceBufferDuplicateTest, TestCase::QUICK);
+  AddTestCase (new TcpResequenceBufferRetransmissionTest, TestCase::QUICK);
+  AddTestCase (new TcpResequenceBufferFullTest, TestCase::QUICK);
+  // Segment aligned, half segments colliding in the slots, not aligned, and
+  // across the wraparound, without a seq landing on 0
+  uint32_t sizes[] = {536, 268, 500, 536};
+  uint32_t starts[] = {5360, 5360, 5360, 4294965797u};
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      AddTestCase (new TcpResequenceBufferWindowTest (sizes[i], starts[i], false), TestCase::QUICK);
+      AddTestCase (new TcpResequenceBufferWindowTest (sizes[i], starts[i], true), TestCase::QUICK);
+    }
+  AddTestCase (new TcpResequenceBufferStaleTest, TestCase::QUICK);
+}
+
+static TcpResequenceBufferTestSuite tcpResequenceBufferTestSuite;
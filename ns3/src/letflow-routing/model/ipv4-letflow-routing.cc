@@ -8,6 +8,9 @@
 #include "ns3/channel.h"
 #include "ns3/node.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
 
 #include <algorithm>
 
@@ -19,9 +22,11 @@ NS_OBJECT_ENSURE_REGISTERED (Ipv4LetFlowRouting);
 
 Ipv4LetFlowRouting::Ipv4LetFlowRouting ():
     m_flowletTimeout (MicroSeconds(50)), // The default value of flowlet timeout is small for experimental purpose
-    m_ipv4 (0)
+    m_ipv4 (0),
+    m_capacityWeighted (false)
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4LetFlowRouting::~Ipv4LetFlowRouting ()
@@ -36,6 +41,22 @@ Ipv4LetFlowRouting::GetTypeId (void)
       .SetParent<Object>()
       .SetGroupName ("Internet")
       .AddConstructor<Ipv4LetFlowRouting> ()
+      .AddAttribute ("FlowletTableSize", "The number of slots of the flowlet table",
+                     UintegerValue (4096),
+                     MakeUintegerAccessor (&Ipv4LetFlowRouting::SetFlowletTableSize,
+                                           &Ipv4LetFlowRouting::GetFlowletTableSize),
+                     MakeUintegerChecker<uint32_t> (1))
+      .AddAttribute ("ExactFlowlets", "Whether flows hashed to the same flowlet slots are told apart, "
+                     "otherwise they share the flowlet like in a switch, unless its port is no route to their destination",
+                     BooleanValue (true),
+                     MakeBooleanAccessor (&Ipv4LetFlowRouting::SetExactFlowlets,
+                                          &Ipv4LetFlowRouting::GetExactFlowlets),
+                     MakeBooleanChecker ())
+      .AddAttribute ("CapacityWeighted", "Whether a new flowlet picks a port with a probability "
+                     "proportional to its data rate, instead of uniformly",
+                     BooleanValue (false),
+                     MakeBooleanAccessor (&Ipv4LetFlowRouting::m_capacityWeighted),
+                     MakeBooleanChecker ())
   ;
 
   return tid;
@@ -50,6 +71,179 @@ Ipv4LetFlowRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_
   letFlowRouteEntry.networkMask = networkMask;
   letFlowRouteEntry.port = port;
   m_routeEntryList.push_back (letFlowRouteEntry);
+
+  // The candidate ports of every destination may have changed
+  InvalidateCandidatePorts ();
+}
+
+void
+Ipv4LetFlowRouting::InvalidateCandidatePorts (void)
+{
+  m_candidatePortSpans.clear ();
+  m_candidatePorts.clear ();
+  m_aliasProbs.clear ();
+  m_aliasIndices.clear ();
+}
+
+const Ipv4LetFlowRouting::CandidatePortSpan &
+Ipv4LetFlowRouting::LookupCandidatePorts (Ipv4Address dest)
+{
+  std::map<Ipv4Address, CandidatePortSpan>::iterator spanItr = m_candidatePortSpans.find (dest);
+  if (spanItr == m_candidatePortSpans.end ())
+  {
+    // First packet to this destination, match it against the route entries once
+    CandidatePortSpan span;
+    span.begin = m_candidatePorts.size ();
+    std::vector<LetFlowRouteEntry>::iterator itr = m_routeEntryList.begin ();
+    for ( ; itr != m_routeEntryList.end (); ++itr)
+    {
+      if((*itr).networkMask.IsMatch(dest, (*itr).network))
+      {
+        m_candidatePorts.push_back ((*itr).port);
+      }
+    }
+    span.size = m_candidatePorts.size () - span.begin;
+    span.weighted = false;
+    m_aliasProbs.resize (m_candidatePorts.size (), 1.0);
+    m_aliasIndices.resize (m_candidatePorts.size (), 0);
+
+    // Ports of equal weights keep the uniform selection
+    if (m_capacityWeighted && span.size > 1)
+    {
+      uint64_t firstWeight = GetPortWeight (m_candidatePorts[span.begin]);
+      for (uint32_t index = span.begin + 1; index < span.begin + span.size; index++)
+      {
+        if (GetPortWeight (m_candidatePorts[index]) != firstWeight)
+        {
+          span.weighted = true;
+          BuildAliasTable (span);
+          break;
+        }
+      }
+    }
+    spanItr = m_candidatePortSpans.insert (std::make_pair (dest, span)).first;
+  }
+  return spanItr->second;
+}
+
+bool
+Ipv4LetFlowRouting::IsCandidatePort (const CandidatePortSpan &span, uint32_t port) const
+{
+  for (uint32_t index = span.begin; index < span.begin + span.size; index++)
+  {
+    if (m_candidatePorts[index] == port)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+Ipv4LetFlowRouting::BuildAliasTable (const CandidatePortSpan &span)
+{
+  // Vose's alias method, a port is then picked with one column and one coin
+  double totalWeight = 0.0;
+  for (uint32_t index = 0; index < span.size; index++)
+  {
+    totalWeight += GetPortWeight (m_candidatePorts[span.begin + index]);
+  }
+
+  std::vector<double> scaled (span.size);
+  std::vector<uint32_t> small;
+  std::vector<uint32_t> large;
+  for (uint32_t index = 0; index < span.size; index++)
+  {
+    scaled[index] = GetPortWeight (m_candidatePorts[span.begin + index]) * span.size / totalWeight;
+    if (scaled[index] < 1.0)
+    {
+      small.push_back (index);
+    }
+    else
+    {
+      large.push_back (index);
+    }
+  }
+
+  while (!small.empty () && !large.empty ())
+  {
+    uint32_t less = small.back ();
+    small.pop_back ();
+    uint32_t more = large.back ();
+    large.pop_back ();
+    m_aliasProbs[span.begin + less] = scaled[less];
+    m_aliasIndices[span.begin + less] = more;
+    scaled[more] = (scaled[more] + scaled[less]) - 1.0;
+    if (scaled[more] < 1.0)
+    {
+      small.push_back (more);
+    }
+    else
+    {
+      large.push_back (more);
+    }
+  }
+
+  // Left overs are full columns, up to rounding errors
+  for (std::vector<uint32_t>::iterator itr = small.begin (); itr != small.end (); ++itr)
+  {
+    m_aliasProbs[span.begin + *itr] = 1.0;
+  }
+  for (std::vector<uint32_t>::iterator itr = large.begin (); itr != large.end (); ++itr)
+  {
+    m_aliasProbs[span.begin + *itr] = 1.0;
+  }
+}
+
+uint32_t
+Ipv4LetFlowRouting::SelectPort (const CandidatePortSpan &span)
+{
+  uint32_t index = m_rand->GetInteger (0, span.size - 1);
+  if (span.weighted && m_rand->GetValue (0.0, 1.0) >= m_aliasProbs[span.begin + index])
+  {
+    index = m_aliasIndices[span.begin + index];
+  }
+  return m_candidatePorts[span.begin + index];
+}
+
+uint64_t
+Ipv4LetFlowRouting::GetPortWeight (uint32_t port)
+{
+  if (port >= m_portWeights.size ())
+  {
+    m_portWeights.resize (port + 1, 0);
+    m_hasPortWeight.resize (port + 1, false);
+  }
+  if (!m_hasPortWeight[port])
+  {
+    // Devices without a data rate count as equal
+    m_portWeights[port] = 1;
+    DataRateValue dataRate;
+    if (m_ipv4 != 0 && port < m_ipv4->GetNInterfaces ()
+        && m_ipv4->GetNetDevice (port)->GetAttributeFailSafe ("DataRate", dataRate))
+    {
+      m_portWeights[port] = dataRate.Get ().GetBitRate ();
+    }
+    m_hasPortWeight[port] = true;
+    NS_LOG_LOGIC (this << " Port " << port << " has weight " << m_portWeights[port]);
+  }
+  return m_portWeights[port];
+}
+
+void
+Ipv4LetFlowRouting::SetPortWeight (uint32_t port, uint64_t weight)
+{
+  GetPortWeight (port);
+  m_portWeights[port] = weight;
+  InvalidateCandidatePorts ();
+}
+
+void
+Ipv4LetFlowRouting::UpdatePortWeights (void)
+{
+  m_portWeights.clear ();
+  m_hasPortWeight.clear ();
+  InvalidateCandidatePorts ();
 }
 
 std::vector<LetFlowRouteEntry>
@@ -70,18 +264,7 @@ Ipv4LetFlowRouting::LookupLetFlowRouteEntries (Ipv4Address dest)
 Ptr<Ipv4Route>
 Ipv4LetFlowRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
 {
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
-  Ptr<Channel> channel = dev->GetChannel ();
-  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-  Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-  uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-  Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4>()->GetAddress(nextIf,0).GetLocal();
-  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (m_ipv4->GetNetDevice (port));
-  route->SetGateway (nextHopAddr);
-  route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
-  route->SetDestination (destAddress);
-  return route;
+  return m_routeCache->GetRoute (port, destAddress);
 }
 
 void
@@ -90,6 +273,36 @@ Ipv4LetFlowRouting::SetFlowletTimeout (Time timeout)
   m_flowletTimeout = timeout;
 }
 
+void
+Ipv4LetFlowRouting::SetFlowletTableSize (uint32_t size)
+{
+  m_flowletTable.SetSize (size);
+}
+
+uint32_t
+Ipv4LetFlowRouting::GetFlowletTableSize (void) const
+{
+  return m_flowletTable.GetSize ();
+}
+
+void
+Ipv4LetFlowRouting::SetExactFlowlets (bool exact)
+{
+  m_flowletTable.SetExact (exact);
+}
+
+bool
+Ipv4LetFlowRouting::GetExactFlowlets (void) const
+{
+  return m_flowletTable.IsExact ();
+}
+
+uint64_t
+Ipv4LetFlowRouting::GetNFlowletEvictions (void) const
+{
+  return m_flowletTable.GetNEvictions ();
+}
+
 Ptr<Ipv4Route>
 Ipv4LetFlowRouting::RouteOutput (Ptr<Packet> packet, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
 {
@@ -140,9 +353,9 @@ Ipv4LetFlowRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, P
   }
   flowId = flowIdTag.GetFlowId ();
 
-  std::vector<LetFlowRouteEntry> routeEntries = Ipv4LetFlowRouting::LookupLetFlowRouteEntries (destAddress);
+  const CandidatePortSpan &span = Ipv4LetFlowRouting::LookupCandidatePorts (destAddress);
 
-  if (routeEntries.empty ())
+  if (span.size == 0)
   {
     NS_LOG_ERROR (this << " LetFlow routing cannot find routing entry");
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
@@ -152,40 +365,34 @@ Ipv4LetFlowRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, P
   uint32_t selectedPort;
 
   // If the flowlet table entry is valid, return the port
-  std::map<uint32_t, struct LetFlowFlowlet>::iterator flowletItr = m_flowletTable.find (flowId);
-  if (flowletItr != m_flowletTable.end ())
+  // Without ExactFlowlets the slot may hold the port of a flow to another
+  // destination, which is reused only if it is a route to this one too
+  FlowletTable::Flowlet &flowlet = m_flowletTable.Lookup (flowId, now, m_flowletTimeout);
+  if (flowlet.used && now - flowlet.lastSeen <= m_flowletTimeout
+      && Ipv4LetFlowRouting::IsCandidatePort (span, flowlet.port))
   {
-    LetFlowFlowlet flowlet = flowletItr->second;
-    if (now - flowlet.activeTime <= m_flowletTimeout)
-    {
-      // Do not forget to update the flowlet active time
-      flowlet.activeTime = now;
+    // Do not forget to update the flowlet active time
+    flowlet.lastSeen = now;
 
-      // Return the port information used for routing routine to select the port
-      selectedPort = flowlet.port;
+    // Return the port information used for routing routine to select the port
+    selectedPort = flowlet.port;
 
-      Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
-      ucb (route, packet, header);
+    Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
+    ucb (route, packet, header);
 
-      m_flowletTable[flowId] = flowlet;
-
-      return true;
-    }
+    return true;
   }
 
   // Not hit. Random Select the Port
-  selectedPort = routeEntries[rand () % routeEntries.size ()].port;
-
-  LetFlowFlowlet flowlet;
+  selectedPort = Ipv4LetFlowRouting::SelectPort (span);
 
+  flowlet.used = true;
   flowlet.port = selectedPort;
-  flowlet.activeTime = now;
+  flowlet.lastSeen = now;
 
   Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
   ucb (route, packet, header);
 
-  m_flowletTable[flowId] = flowlet;
-
   return true;
 }
 
@@ -197,11 +404,19 @@ Ipv4LetFlowRouting::NotifyInterfaceUp (uint32_t interface)
 void
 Ipv4LetFlowRouting::NotifyInterfaceDown (uint32_t interface)
 {
+  if (m_routeCache != 0)
+    {
+      m_routeCache->Invalidate (interface);
+    }
 }
 
 void
 Ipv4LetFlowRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  if (m_routeCache != 0)
+    {
+      m_routeCache->Invalidate (interface);
+    }
 }
 
 void
@@ -215,6 +430,7 @@ Ipv4LetFlowRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_LOGIC (this << "Setting up Ipv4: " << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  m_routeCache = Ipv4RouteCache::GetRouteCache (ipv4);
 }
 
 void
@@ -223,9 +439,18 @@ Ipv4LetFlowRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 }
 
 
+int64_t
+Ipv4LetFlowRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 void
 Ipv4LetFlowRouting::DoDispose (void)
 {
+  m_routeCache = 0;
   m_ipv4=0;
   Ipv4RoutingProtocol::DoDispose ();
 }
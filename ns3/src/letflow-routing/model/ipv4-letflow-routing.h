@@ -3,6 +3,7 @@
 #define IPV4_LETFLOW_ROUTING_H
 
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route-cache.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -10,13 +11,13 @@
 #include "ns3/data-rate.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/flowlet-table.h"
 
-namespace ns3 {
+#include <map>
+#include <vector>
 
-struct LetFlowFlowlet {
-  uint32_t port;
-  Time activeTime;
-};
+namespace ns3 {
 
 struct LetFlowRouteEntry {
   Ipv4Address network;
@@ -53,15 +54,73 @@ public:
 
   void SetFlowletTimeout (Time timeout);
 
+  void SetFlowletTableSize (uint32_t size);
+  uint32_t GetFlowletTableSize (void) const;
+
+  void SetExactFlowlets (bool exact);
+  bool GetExactFlowlets (void) const;
+
+  /// The number of flowlets dropped before expiring, to make room for another flow
+  uint64_t GetNFlowletEvictions (void) const;
+
+  /**
+   * Sets the weight of a port for the capacity weighted selection, in
+   * place of the data rate of its device.
+   */
+  void SetPortWeight (uint32_t port, uint64_t weight);
+
+  /**
+   * Drops the port weights, which are read again from the data rates of
+   * the devices, e.g. after a link rate has changed.
+   */
+  void UpdatePortWeights (void);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   */
+  int64_t AssignStreams (int64_t stream);
+
 private:
   // Flowlet Timeout
   Time m_flowletTimeout;
 
   // Ipv4 associated with this router
   Ptr<Ipv4> m_ipv4;
+  Ptr<Ipv4RouteCache> m_routeCache;
+
+  Ptr<UniformRandomVariable> m_rand;
 
   // Flowlet Table
-  std::map<uint32_t, LetFlowFlowlet> m_flowletTable;
+  FlowletTable m_flowletTable;
+
+  // Whether a new flowlet picks a port with a probability proportional to its weight
+  bool m_capacityWeighted;
+
+  // Port weights, the data rate of the device unless set, indexed by port
+  std::vector<uint64_t> m_portWeights;
+  std::vector<bool> m_hasPortWeight;
+
+  // Candidate ports of each destination seen, as spans of m_candidatePorts.
+  // A weighted span has the alias table of its ports at the same positions
+  struct CandidatePortSpan
+  {
+    uint32_t begin;
+    uint32_t size;
+    bool weighted;
+  };
+  std::map<Ipv4Address, CandidatePortSpan> m_candidatePortSpans;
+  std::vector<uint32_t> m_candidatePorts;
+  std::vector<double> m_aliasProbs;
+  std::vector<uint32_t> m_aliasIndices;
+
+  const CandidatePortSpan &LookupCandidatePorts (Ipv4Address dest);
+  bool IsCandidatePort (const CandidatePortSpan &span, uint32_t port) const;
+  void BuildAliasTable (const CandidatePortSpan &span);
+  uint32_t SelectPort (const CandidatePortSpan &span);
+  uint64_t GetPortWeight (uint32_t port);
+  void InvalidateCandidatePorts (void);
 
   // Route table
   std::vector<LetFlowRouteEntry> m_routeEntryList;
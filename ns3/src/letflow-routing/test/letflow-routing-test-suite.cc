@@ -2,54 +2,372 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-letflow-routing.h"
+#include "ns3/ipv4-letflow-routing-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/ipv4-route-input-test.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <set>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
 
-// This is an example TestCase.
-class LetflowRoutingTestCase1 : public TestCase
+// A switch running LetFlow with one ingress port and n egress ports, each to
+// a host of its own, all of them routes to 10.2.0.0/24; the packets carry
+// the flow id in a FlowIdTag
+class LetFlowSwitch : public Ipv4RouteInputSwitch<Ipv4LetFlowRouting, SimpleNetDeviceHelper>
 {
 public:
-  LetflowRoutingTestCase1 ();
-  virtual ~LetflowRoutingTestCase1 ();
+  LetFlowSwitch (uint32_t nPorts);
+
+  // The chosen port, 0 if the packet is not routed
+  uint32_t Route (uint32_t flowId, Ipv4Address dest = Ipv4Address ("10.2.0.1"));
+
+  // Routes the flows from firstFlowId on, one packet each, and counts the
+  // flows sent to each of the ports
+  std::vector<uint32_t> CountPorts (uint32_t firstFlowId, uint32_t flows);
+  void SetDataRate (uint32_t index, DataRate rate);
+};
+
+LetFlowSwitch::LetFlowSwitch (uint32_t nPorts)
+  : Ipv4RouteInputSwitch<Ipv4LetFlowRouting, SimpleNetDeviceHelper> (Ipv4LetFlowRoutingHelper (), nPorts)
+{
+  for (uint32_t index = 0; index < ports.size (); ++index)
+    {
+      routing->AddRoute (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.255.0"), ports[index]);
+    }
+  routing->SetFlowletTimeout (MicroSeconds (50));
+}
+
+uint32_t
+LetFlowSwitch::Route (uint32_t flowId, Ipv4Address dest)
+{
+  Ptr<Packet> packet = Create<Packet> (100);
+  packet->AddPacketTag (FlowIdTag (flowId));
+  return Ipv4RouteInputSwitch<Ipv4LetFlowRouting, SimpleNetDeviceHelper>::Route (packet, dest);
+}
+
+std::vector<uint32_t>
+LetFlowSwitch::CountPorts (uint32_t firstFlowId, uint32_t flows)
+{
+  std::vector<uint32_t> counts (ports.size (), 0);
+  for (uint32_t flowId = firstFlowId; flowId < firstFlowId + flows; ++flowId)
+    {
+      uint32_t port = Route (flowId);
+      for (uint32_t index = 0; index < ports.size (); ++index)
+        {
+          if (ports[index] == port)
+            {
+              counts[index]++;
+            }
+        }
+    }
+  return counts;
+}
+
+void
+LetFlowSwitch::SetDataRate (uint32_t index, DataRate rate)
+{
+  devices[index]->SetAttribute ("DataRate", DataRateValue (rate));
+}
+
+class LetFlowTimeoutTestCase : public TestCase
+{
+public:
+  LetFlowTimeoutTestCase ();
 
 private:
   virtual void DoRun (void);
 };
 
-// Add some help text to this case to describe what it is intended to test
-LetflowRoutingTestCase1::LetflowRoutingTestCase1 ()
-  : TestCase ("LetflowRouting test case (does nothing)")
+LetFlowTimeoutTestCase::LetFlowTimeoutTestCase ()
+  : TestCase ("A flowlet keeps its port within the timeout and picks a port again after it")
+{
+}
+
+void
+LetFlowTimeoutTestCase::DoRun (void)
 {
+  LetFlowSwitch sw (4);
+  sw.routing->AssignStreams (1);
+  std::set<uint32_t> ports (sw.ports.begin (), sw.ports.end ());
+
+  const uint32_t flows = 64;
+  std::vector<uint32_t> first (flows);
+  for (uint32_t flowId = 0; flowId < flows; ++flowId)
+    {
+      first[flowId] = sw.Route (flowId);
+      NS_TEST_ASSERT_MSG_EQ (ports.count (first[flowId]), 1, "Flow " << flowId << " is not routed to a port of the route");
+    }
+
+  // Gaps below the timeout, adding up to more than it: each packet renews the flowlet
+  for (uint32_t round = 0; round < 5; ++round)
+    {
+      AdvanceSimulation (MicroSeconds (40));
+      for (uint32_t flowId = 0; flowId < flows; ++flowId)
+        {
+          NS_TEST_ASSERT_MSG_EQ (sw.Route (flowId), first[flowId], "Flow " << flowId << " left its port within the timeout");
+        }
+    }
+
+  // A gap above the timeout starts a new flowlet, on a port drawn again
+  AdvanceSimulation (MicroSeconds (60));
+  uint32_t moved = 0;
+  for (uint32_t flowId = 0; flowId < flows; ++flowId)
+    {
+      uint32_t port = sw.Route (flowId);
+      NS_TEST_ASSERT_MSG_EQ (ports.count (port), 1, "Flow " << flowId << " is not routed to a port of the route");
+      if (port != first[flowId])
+        {
+          moved++;
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (moved, flows / 2, "Too few new flowlets changed port, they should be drawn again");
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->GetNFlowletEvictions (), 0, "The default table should evict no flowlet");
 }
 
-// This destructor does nothing but we include it as a reminder that
-// the test case should clean up after itself
-LetflowRoutingTestCase1::~LetflowRoutingTestCase1 ()
+class LetFlowHashCollisionTestCase : public TestCase
+{
+public:
+  LetFlowHashCollisionTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LetFlowHashCollisionTestCase::LetFlowHashCollisionTestCase ()
+  : TestCase ("Without ExactFlowlets the flows hashed to a slot share its port")
 {
 }
 
-//
-// This method is the pure virtual method from class TestCase that every
-// TestCase must implement
-//
 void
-LetflowRoutingTestCase1::DoRun (void)
+LetFlowHashCollisionTestCase::DoRun (void)
 {
-  // A wide variety of test macros are available in src/core/test.h
-  NS_TEST_ASSERT_MSG_EQ (true, true, "true doesn't equal true for some reason");
-  // Use this one for floating point comparisons
-  NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
+  const uint32_t flows = 64;
+
+  // One slot: every flow lands on the flowlet of the first one
+  {
+    LetFlowSwitch sw (8);
+    sw.routing->AssignStreams (2);
+    sw.routing->SetAttribute ("FlowletTableSize", UintegerValue (1));
+    sw.routing->SetAttribute ("ExactFlowlets", BooleanValue (false));
+    uint32_t shared = sw.Route (0);
+    for (uint32_t flowId = 1; flowId < flows; ++flowId)
+      {
+        NS_TEST_ASSERT_MSG_EQ (sw.Route (flowId), shared, "Flow " << flowId << " does not share the port of its slot");
+      }
+    NS_TEST_ASSERT_MSG_EQ (sw.routing->GetNFlowletEvictions (), 0, "Shared flowlets are not evicted");
+  }
+
+  // The same slot with ExactFlowlets: each flow evicts the flowlet of the last one
+  {
+    LetFlowSwitch sw (8);
+    sw.routing->AssignStreams (2);
+    sw.routing->SetAttribute ("FlowletTableSize", UintegerValue (1));
+    std::set<uint32_t> used;
+    for (uint32_t flowId = 0; flowId < flows; ++flowId)
+      {
+        used.insert (sw.Route (flowId));
+      }
+    NS_TEST_ASSERT_MSG_GT (used.size (), 1, "Flows told apart should draw ports of their own");
+    NS_TEST_ASSERT_MSG_EQ (sw.routing->GetNFlowletEvictions (), flows - 1, "Each flow should evict the flowlet in the slot");
+  }
+
+  // Four slots: at most four ports in use, and each flow keeps the port of its slot
+  {
+    LetFlowSwitch sw (8);
+    sw.routing->AssignStreams (3);
+    sw.routing->SetAttribute ("FlowletTableSize", UintegerValue (4));
+    sw.routing->SetAttribute ("ExactFlowlets", BooleanValue (false));
+    std::vector<uint32_t> first (flows);
+    std::set<uint32_t> used;
+    for (uint32_t flowId = 0; flowId < flows; ++flowId)
+      {
+        first[flowId] = sw.Route (flowId);
+        used.insert (first[flowId]);
+      }
+    NS_TEST_ASSERT_MSG_LT_OR_EQ (used.size (), 4, "More flowlets than slots");
+    AdvanceSimulation (MicroSeconds (40));
+    for (uint32_t flowId = 0; flowId < flows; ++flowId)
+      {
+        NS_TEST_ASSERT_MSG_EQ (sw.Route (flowId), first[flowId], "Flow " << flowId << " left the port of its slot");
+      }
+  }
+
+  // One slot shared by two destinations, 10.3.0.0/24 reached by the first
+  // port only: a flow to it never takes the port of a flow to 10.2.0.0/24
+  {
+    LetFlowSwitch sw (8);
+    sw.routing->AssignStreams (4);
+    sw.routing->AddRoute (Ipv4Address ("10.3.0.0"), Ipv4Mask ("255.255.255.0"), sw.ports[0]);
+    sw.routing->SetAttribute ("FlowletTableSize", UintegerValue (1));
+    sw.routing->SetAttribute ("ExactFlowlets", BooleanValue (false));
+    uint32_t foreign = 0;
+    for (uint32_t flowId = 0; flowId < flows; flowId += 2)
+      {
+        uint32_t port = sw.Route (flowId);
+        NS_TEST_ASSERT_MSG_NE (port, 0, "Flow " << flowId << " should be routed");
+        if (port != sw.ports[0])
+          {
+            foreign++;
+          }
+        NS_TEST_ASSERT_MSG_EQ (sw.Route (flowId + 1, Ipv4Address ("10.3.0.1")), sw.ports[0],
+                               "Flow " << flowId + 1 << " took a port that is no route to its destination");
+        AdvanceSimulation (MicroSeconds (60));
+      }
+    NS_TEST_ASSERT_MSG_GT (foreign, 0, "The slot never held a port that is no route to 10.3.0.0/24");
+  }
+}
+
+class LetFlowMemoryTestCase : public TestCase
+{
+public:
+  LetFlowMemoryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LetFlowMemoryTestCase::LetFlowMemoryTestCase ()
+  : TestCase ("The flowlets kept are bounded by the slots of the table whatever the number of flows")
+{
+}
+
+void
+LetFlowMemoryTestCase::DoRun (void)
+{
+  LetFlowSwitch sw (4);
+  sw.routing->SetAttribute ("FlowletTableSize", UintegerValue (64));
+
+  // Ten thousand flows active at once: all but the slots are evicted
+  const uint32_t flows = 10000;
+  for (uint32_t flowId = 0; flowId < flows; ++flowId)
+    {
+      NS_TEST_ASSERT_MSG_NE (sw.Route (flowId), 0, "Flow " << flowId << " is not routed");
+    }
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->GetFlowletTableSize (), 64, "The table should not grow");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (sw.routing->GetNFlowletEvictions (), flows - 64, "More flowlets kept than slots");
+
+  // Once they expired, the slots are reused without eviction
+  AdvanceSimulation (MicroSeconds (60));
+  uint64_t evictions = sw.routing->GetNFlowletEvictions ();
+  for (uint32_t flowId = 0; flowId < 8; ++flowId)
+    {
+      sw.Route (flows + flowId * 64);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sw.routing->GetNFlowletEvictions (), evictions, "Expired flowlets should be reused, not evicted");
+}
+
+class LetFlowCapacityWeightedTestCase : public TestCase
+{
+public:
+  LetFlowCapacityWeightedTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void CheckShares (const std::vector<uint32_t> &counts, const double *shares, const std::string &what);
+};
+
+LetFlowCapacityWeightedTestCase::LetFlowCapacityWeightedTestCase ()
+  : TestCase ("CapacityWeighted picks the ports in proportion to their data rates or weights")
+{
+}
+
+void
+LetFlowCapacityWeightedTestCase::CheckShares (const std::vector<uint32_t> &counts, const double *shares, const std::string &what)
+{
+  uint32_t total = 0;
+  for (uint32_t index = 0; index < counts.size (); ++index)
+    {
+      total += counts[index];
+    }
+  NS_TEST_ASSERT_MSG_GT (total, 0, what << ": no flow routed");
+  for (uint32_t index = 0; index < counts.size (); ++index)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (counts[index] / (double) total, shares[index], 0.02,
+                                 what << ": wrong share of port " << index);
+    }
+}
+
+void
+LetFlowCapacityWeightedTestCase::DoRun (void)
+{
+  const uint32_t flows = 20000;
+  LetFlowSwitch sw (3);
+  sw.routing->AssignStreams (4);
+  sw.routing->SetAttribute ("CapacityWeighted", BooleanValue (true));
+  sw.SetDataRate (0, DataRate ("1Gbps"));
+  sw.SetDataRate (1, DataRate ("2Gbps"));
+  sw.SetDataRate (2, DataRate ("5Gbps"));
+
+  const double byRate[] = { 1 / 8.0, 2 / 8.0, 5 / 8.0 };
+  CheckShares (sw.CountPorts (0, flows), byRate, "Data rates 1:2:5");
+
+  // A weight set on a port takes the place of its data rate
+  sw.routing->SetPortWeight (sw.ports[1], 1000000000);
+  sw.routing->SetPortWeight (sw.ports[2], 6000000000ULL);
+  const double byWeight[] = { 1 / 8.0, 1 / 8.0, 6 / 8.0 };
+  CheckShares (sw.CountPorts (flows, flows), byWeight, "Weights 1:1:6");
+
+  // The data rates are read once, until UpdatePortWeights drops the weights
+  sw.SetDataRate (0, DataRate ("4Gbps"));
+  sw.SetDataRate (1, DataRate ("2Gbps"));
+  sw.SetDataRate (2, DataRate ("2Gbps"));
+  CheckShares (sw.CountPorts (2 * flows, flows), byWeight, "Weights 1:1:6 before the update");
+  sw.routing->UpdatePortWeights ();
+  const double byNewRate[] = { 4 / 8.0, 2 / 8.0, 2 / 8.0 };
+  CheckShares (sw.CountPorts (3 * flows, flows), byNewRate, "Data rates 4:2:2");
+}
+
+class LetFlowEqualWeightsTestCase : public TestCase
+{
+public:
+  LetFlowEqualWeightsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LetFlowEqualWeightsTestCase::LetFlowEqualWeightsTestCase ()
+  : TestCase ("CapacityWeighted over ports of equal data rates keeps the uniform draw")
+{
+}
+
+void
+LetFlowEqualWeightsTestCase::DoRun (void)
+{
+  const uint32_t flows = 1000;
+  std::vector<uint32_t> uniform;
+  {
+    LetFlowSwitch sw (4);
+    sw.routing->AssignStreams (5);
+    for (uint32_t flowId = 0; flowId < flows; ++flowId)
+      {
+        uniform.push_back (sw.Route (flowId));
+      }
+  }
+
+  // Equal rates draw the same ports as the uniform selection on the same stream
+  LetFlowSwitch sw (4);
+  sw.routing->AssignStreams (5);
+  sw.routing->SetAttribute ("CapacityWeighted", BooleanValue (true));
+  for (uint32_t index = 0; index < sw.ports.size (); ++index)
+    {
+      sw.SetDataRate (index, DataRate ("10Gbps"));
+    }
+  for (uint32_t flowId = 0; flowId < flows; ++flowId)
+    {
+      NS_TEST_ASSERT_MSG_EQ (sw.Route (flowId), uniform[flowId], "Flow " << flowId << " is not given the port of the uniform draw");
+    }
 }
 
-// The TestSuite class names the TestSuite, identifies what type of TestSuite,
-// and enables the TestCases to be run.  Typically, only the constructor for
-// this class must be defined
-//
 class LetflowRoutingTestSuite : public TestSuite
 {
 public:
@@ -59,10 +377,12 @@ public:
 LetflowRoutingTestSuite::LetflowRoutingTestSuite ()
   : TestSuite ("letflow-routing", UNIT)
 {
-  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
-  AddTestCase (new LetflowRoutingTestCase1, TestCase::QUICK);
+  AddTestCase (new LetFlowTimeoutTestCase, TestCase::QUICK);
+  AddTestCase (new LetFlowHashCollisionTestCase, TestCase::QUICK);
+  AddTestCase (new LetFlowMemoryTestCase, TestCase::QUICK);
+  AddTestCase (new LetFlowCapacityWeightedTestCase, TestCase::QUICK);
+  AddTestCase (new LetFlowEqualWeightsTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
 static LetflowRoutingTestSuite letflowRoutingTestSuite;
-
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/flowlet-table.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+class FlowletTableExactTestCase : public TestCase
+{
+public:
+  FlowletTableExactTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlowletTableExactTestCase::FlowletTableExactTestCase ()
+  : TestCase ("FlowletTable keeps a flowlet per flow and reuses expired slots")
+{
+}
+
+void
+FlowletTableExactTestCase::DoRun (void)
+{
+  FlowletTable table;
+  table.SetSize (8);
+  Time timeout = MicroSeconds (50);
+
+  // Eight flows fill every slot, each keeps its own flowlet
+  for (uint32_t flowId = 0; flowId < 8; ++flowId)
+    {
+      FlowletTable::Flowlet &flowlet = table.Lookup (flowId, MicroSeconds (flowId), timeout);
+      NS_TEST_ASSERT_MSG_EQ (flowlet.used, false, "Flow " << flowId << " should get a new flowlet");
+      flowlet.used = true;
+      flowlet.port = 100 + flowId;
+      flowlet.lastSeen = MicroSeconds (flowId);
+    }
+  for (uint32_t flowId = 0; flowId < 8; ++flowId)
+    {
+      FlowletTable::Flowlet &flowlet = table.Lookup (flowId, MicroSeconds (10), timeout);
+      NS_TEST_ASSERT_MSG_EQ ((flowlet.used && flowlet.flowId == flowId), true, "Flow " << flowId << " should find its flowlet");
+      NS_TEST_ASSERT_MSG_EQ (flowlet.port, 100 + flowId, "Flow " << flowId << " should keep its port");
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.GetNEvictions (), 0, "No flowlet should be evicted yet");
+
+  // A ninth flow evicts the least recently seen flowlet, flow 0's
+  FlowletTable::Flowlet &ninth = table.Lookup (8, MicroSeconds (20), timeout);
+  NS_TEST_ASSERT_MSG_EQ (ninth.used, false, "Flow 8 should get a new flowlet");
+  ninth.used = true;
+  ninth.port = 108;
+  ninth.lastSeen = MicroSeconds (20);
+  NS_TEST_ASSERT_MSG_EQ (table.GetNEvictions (), 1, "Flow 8 should evict a flowlet");
+  NS_TEST_ASSERT_MSG_EQ (table.Lookup (1, MicroSeconds (20), timeout).port, 101, "Flow 1 should keep its flowlet");
+
+  // Once expired, a flowlet gives its slot without an eviction
+  FlowletTable::Flowlet &tenth = table.Lookup (9, MicroSeconds (100), timeout);
+  NS_TEST_ASSERT_MSG_EQ (tenth.used, false, "Flow 9 should get a new flowlet");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNEvictions (), 1, "Expired flowlets should be reused, not evicted");
+}
+
+class FlowletTableHashTestCase : public TestCase
+{
+public:
+  FlowletTableHashTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlowletTableHashTestCase::FlowletTableHashTestCase ()
+  : TestCase ("FlowletTable in hash collision mode shares a slot between flows")
+{
+}
+
+void
+FlowletTableHashTestCase::DoRun (void)
+{
+  FlowletTable table;
+  table.SetExact (false);
+  table.SetSize (5);
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 8, "The size should be rounded up to a power of two");
+
+  Time timeout = MicroSeconds (50);
+  for (uint32_t flowId = 0; flowId < 64; ++flowId)
+    {
+      FlowletTable::Flowlet &flowlet = table.Lookup (flowId, MicroSeconds (1), timeout);
+      if (!flowlet.used)
+        {
+          flowlet.used = true;
+          flowlet.port = flowId;
+          flowlet.lastSeen = MicroSeconds (1);
+        }
+    }
+
+  // Only eight flows found their slot unused, the others share a flowlet
+  uint32_t owners = 0;
+  for (uint32_t flowId = 0; flowId < 64; ++flowId)
+    {
+      if (table.Lookup (flowId, MicroSeconds (2), timeout).port == flowId)
+        {
+          owners++;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (owners, 8, "Every slot should be shared by the flows hashed to it");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNEvictions (), 0, "Nothing is evicted in hash collision mode");
+}
+
+class FlowletTableTestSuite : public TestSuite
+{
+public:
+  FlowletTableTestSuite ();
+};
+
+FlowletTableTestSuite::FlowletTableTestSuite ()
+  : TestSuite ("flowlet-table", UNIT)
+{
+  AddTestCase (new FlowletTableExactTestCase, TestCase::QUICK);
+  AddTestCase (new FlowletTableHashTestCase, TestCase::QUICK);
+}
+
+static FlowletTableTestSuite g_flowletTableTestSuite;
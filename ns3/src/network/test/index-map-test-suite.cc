@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/index-map.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+class IndexMapTestCase : public TestCase
+{
+public:
+  IndexMapTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+IndexMapTestCase::IndexMapTestCase ()
+  : TestCase ("IndexMap finds, inserts and sets keys while growing")
+{
+}
+
+void
+IndexMapTestCase::DoRun (void)
+{
+  IndexMap map;
+  NS_TEST_ASSERT_MSG_EQ (map.Find (1), IndexMap::NONE, "An empty map should have no key");
+
+  // Enough consecutive keys to grow the map several times
+  for (uint32_t key = 0; key < 1000; ++key)
+    {
+      NS_TEST_ASSERT_MSG_EQ (map.Insert (key << 8, key), key, "Key " << key << " should be new");
+    }
+  NS_TEST_ASSERT_MSG_EQ (map.GetNKeys (), 1000, "Every key should be kept");
+  for (uint32_t key = 0; key < 1000; ++key)
+    {
+      NS_TEST_ASSERT_MSG_EQ (map.Find (key << 8), key, "Key " << key << " should be found after growing");
+    }
+  NS_TEST_ASSERT_MSG_EQ (map.Find (1), IndexMap::NONE, "A missing key should not be found");
+
+  NS_TEST_ASSERT_MSG_EQ (map.Insert (5 << 8, 42), 5, "Insert should keep the value of a known key");
+  map.Set (5 << 8, 42);
+  NS_TEST_ASSERT_MSG_EQ (map.Find (5 << 8), 42, "Set should replace the value of a known key");
+  NS_TEST_ASSERT_MSG_EQ (map.GetNKeys (), 1000, "Replacing a value should not add a key");
+
+  map.Reset (0);
+  NS_TEST_ASSERT_MSG_EQ (map.Find (5 << 8), IndexMap::NONE, "Reset should empty the map");
+  NS_TEST_ASSERT_MSG_EQ (map.GetNKeys (), 0, "Reset should empty the map");
+}
+
+class IndexMapHashTestCase : public TestCase
+{
+public:
+  IndexMapHashTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+IndexMapHashTestCase::IndexMapHashTestCase ()
+  : TestCase ("IndexMap hashes spread consecutive keys over the slots")
+{
+}
+
+void
+IndexMapHashTestCase::DoRun (void)
+{
+  // Consecutive keys, as flow ids often are, should hit every slot
+  std::vector<uint32_t> bitsHits (16, 0);
+  std::vector<uint32_t> rangeHits (13, 0);
+  for (uint64_t key = 0; key < 64; ++key)
+    {
+      uint32_t slot = IndexMap::Hash (key, 4);
+      NS_TEST_ASSERT_MSG_LT (slot, 16, "The slot should be within the 2^bits slots");
+      bitsHits[slot]++;
+      slot = IndexMap::HashRange (key, 13);
+      NS_TEST_ASSERT_MSG_LT (slot, 13, "The slot should be within the range");
+      rangeHits[slot]++;
+    }
+  for (uint32_t slot = 0; slot < 16; ++slot)
+    {
+      NS_TEST_ASSERT_MSG_GT (bitsHits[slot], 0, "Slot " << slot << " of 16 should be hit");
+    }
+  for (uint32_t slot = 0; slot < 13; ++slot)
+    {
+      NS_TEST_ASSERT_MSG_GT (rangeHits[slot], 0, "Slot " << slot << " of 13 should be hit");
+    }
+  NS_TEST_ASSERT_MSG_EQ (IndexMap::Hash (12345, 0), 0, "A single slot table has one slot");
+}
+
+class IndexMapTestSuite : public TestSuite
+{
+public:
+  IndexMapTestSuite ();
+};
+
+IndexMapTestSuite::IndexMapTestSuite ()
+  : TestSuite ("index-map", UNIT)
+{
+  AddTestCase (new IndexMapTestCase, TestCase::QUICK);
+  AddTestCase (new IndexMapHashTestCase, TestCase::QUICK);
+}
+
+static IndexMapTestSuite g_indexMapTestSuite;
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/shared-tick.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+// Records the times it ticks, stops after a given number of ticks
+class TickCounter
+{
+public:
+  TickCounter (uint32_t limit)
+    : m_limit (limit)
+  {
+  }
+
+  bool Tick (void)
+  {
+    m_times.push_back (Simulator::Now ());
+    return m_times.size () < m_limit;
+  }
+
+  uint32_t m_limit;
+  std::vector<Time> m_times;
+};
+
+class SharedTickTestCase : public TestCase
+{
+public:
+  SharedTickTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void StartLate (void);
+  void CancelFirst (void);
+
+  TickCounter m_first;
+  TickCounter m_second;
+  TickCounter m_late;
+  SharedTick m_firstTick;
+  SharedTick m_secondTick;
+  SharedTick m_lateTick;
+};
+
+SharedTickTestCase::SharedTickTestCase ()
+  : TestCase ("SharedTick fires on the multiples of its period and stops when asked"),
+    m_first (100),
+    m_second (3),
+    m_late (100)
+{
+}
+
+void
+SharedTickTestCase::StartLate (void)
+{
+  m_lateTick.Start ();
+}
+
+void
+SharedTickTestCase::CancelFirst (void)
+{
+  m_firstTick.Cancel ();
+  m_lateTick.Cancel ();
+}
+
+void
+SharedTickTestCase::DoRun (void)
+{
+  m_firstTick.SetFunction (MakeCallback (&TickCounter::Tick, &m_first));
+  m_firstTick.SetPeriod (MicroSeconds (10));
+  m_secondTick.SetFunction (MakeCallback (&TickCounter::Tick, &m_second));
+  m_secondTick.SetPeriod (MicroSeconds (10));
+  m_lateTick.SetFunction (MakeCallback (&TickCounter::Tick, &m_late));
+  m_lateTick.SetPeriod (MicroSeconds (10));
+
+  m_firstTick.Start ();
+  m_secondTick.Start ();
+  m_secondTick.Start ();
+  Simulator::Schedule (MicroSeconds (25), &SharedTickTestCase::StartLate, this);
+  Simulator::Schedule (MicroSeconds (55), &SharedTickTestCase::CancelFirst, this);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_first.m_times.size (), 5, "First tick should fire until cancelled at 55us");
+  for (uint32_t i = 0; i < m_first.m_times.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_first.m_times[i], MicroSeconds (10 * (i + 1)), "Tick " << i << " is off the period");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_second.m_times.size (), 3, "Second tick should stop itself after 3 ticks");
+  NS_TEST_ASSERT_MSG_EQ (m_secondTick.IsRunning (), false, "Second tick should no longer run");
+  NS_TEST_ASSERT_MSG_EQ (m_late.m_times.size (), 3, "Late tick should fire at 30, 40 and 50us");
+  NS_TEST_ASSERT_MSG_EQ (m_late.m_times[0], MicroSeconds (30), "Late tick should wait for the next multiple");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), MicroSeconds (55), "No event should be left once every tick stopped");
+
+  Simulator::Destroy ();
+}
+
+// A tick that cancels and starts itself again from its function, then
+// returns false, keeps ticking on its new registration
+class SharedTickRestartTestCase : public TestCase
+{
+public:
+  SharedTickRestartTestCase ();
+
+private:
+  virtual void DoRun (void);
+  bool Restart (void);
+
+  uint32_t m_restarts;
+  std::vector<Time> m_times;
+  std::vector<bool> m_running;
+  SharedTick m_tick;
+};
+
+SharedTickRestartTestCase::SharedTickRestartTestCase ()
+  : TestCase ("SharedTick restarted from its own function keeps one registration"),
+    m_restarts (3)
+{
+}
+
+bool
+SharedTickRestartTestCase::Restart (void)
+{
+  m_times.push_back (Simulator::Now ());
+  m_running.push_back (m_tick.IsRunning ());
+  if (m_restarts == 0)
+    {
+      return false;
+    }
+  m_restarts--;
+  m_tick.Cancel ();
+  m_tick.Start ();
+  return false;
+}
+
+void
+SharedTickRestartTestCase::DoRun (void)
+{
+  m_tick.SetFunction (MakeCallback (&SharedTickRestartTestCase::Restart, this));
+  m_tick.SetPeriod (MicroSeconds (10));
+  m_tick.Start ();
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_times.size (), 4, "The tick should fire once per restart and once more");
+  for (uint32_t i = 0; i < m_times.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_times[i], MicroSeconds (10 * (i + 1)), "Tick " << i << " is off the period");
+      NS_TEST_ASSERT_MSG_EQ (m_running[i], true, "Tick " << i << " should fire from a running registration");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_tick.IsRunning (), false, "The tick should stop once it returns false without restarting");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), MicroSeconds (40), "No event should be left once the tick stopped");
+
+  Simulator::Destroy ();
+}
+
+class SharedTickTestSuite : public TestSuite
+{
+public:
+  SharedTickTestSuite ();
+};
+
+SharedTickTestSuite::SharedTickTestSuite ()
+  : TestSuite ("shared-tick", UNIT)
+{
+  AddTestCase (new SharedTickTestCase, TestCase::QUICK);
+  AddTestCase (new SharedTickRestartTestCase, TestCase::QUICK);
+}
+
+static SharedTickTestSuite g_sharedTickTestSuite;
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "flowlet-table.h"
+#include "index-map.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowletTable");
+
+const uint32_t FlowletTable::PROBES;
+
+FlowletTable::FlowletTable ()
+  : m_size (0),
+    m_bits (0),
+    m_exact (true),
+    m_nEvictions (0)
+{
+  SetSize (4096);
+}
+
+void
+FlowletTable::SetSize (uint32_t size)
+{
+  NS_ASSERT (size > 0 && size <= (1u << 31));
+  m_bits = 0;
+  while ((1u << m_bits) < size)
+    {
+      m_bits++;
+    }
+  m_size = 1u << m_bits;
+  m_slots.clear ();
+}
+
+uint32_t
+FlowletTable::GetSize (void) const
+{
+  return m_size;
+}
+
+void
+FlowletTable::SetExact (bool exact)
+{
+  m_exact = exact;
+  m_slots.clear ();
+}
+
+bool
+FlowletTable::IsExact (void) const
+{
+  return m_exact;
+}
+
+uint32_t
+FlowletTable::Hash (uint32_t flowId) const
+{
+  return IndexMap::Hash (flowId, m_bits);
+}
+
+FlowletTable::Flowlet &
+FlowletTable::Lookup (uint32_t flowId, Time now, Time timeout)
+{
+  if (m_slots.empty ())
+    {
+      Flowlet empty;
+      empty.flowId = 0;
+      empty.port = 0;
+      empty.used = false;
+      m_slots.assign (m_size, empty);
+    }
+
+  uint32_t mask = m_size - 1;
+  uint32_t index = Hash (flowId);
+  if (!m_exact)
+    {
+      m_slots[index].flowId = flowId;
+      return m_slots[index];
+    }
+
+  // The flow may be anywhere in its probes, expired flowlets leave holes
+  uint32_t probes = PROBES < m_size ? PROBES : m_size;
+  Flowlet *freeSlot = 0;
+  Flowlet *oldest = 0;
+  for (uint32_t probe = 0; probe < probes; probe++)
+    {
+      Flowlet &slot = m_slots[(index + probe) & mask];
+      if (slot.used && slot.flowId == flowId)
+        {
+          return slot;
+        }
+      if (!slot.used || now - slot.lastSeen > timeout)
+        {
+          if (freeSlot == 0)
+            {
+              freeSlot = &slot;
+            }
+        }
+      else if (oldest == 0 || slot.lastSeen < oldest->lastSeen)
+        {
+          oldest = &slot;
+        }
+    }
+
+  if (freeSlot == 0)
+    {
+      NS_LOG_LOGIC ("Flow " << flowId << " evicts the flowlet of flow " << oldest->flowId);
+      m_nEvictions++;
+      freeSlot = oldest;
+    }
+  freeSlot->flowId = flowId;
+  freeSlot->used = false;
+  return *freeSlot;
+}
+
+uint64_t
+FlowletTable::GetNEvictions (void) const
+{
+  return m_nEvictions;
+}
+
+}
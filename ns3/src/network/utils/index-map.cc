@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "index-map.h"
+
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+const uint32_t IndexMap::NONE;
+
+uint32_t
+IndexMap::Hash (uint64_t key, uint32_t bits)
+{
+  NS_ASSERT (bits <= 32);
+  if (bits == 0)
+    {
+      return 0;
+    }
+  return static_cast<uint32_t> ((key * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+}
+
+uint32_t
+IndexMap::HashRange (uint64_t key, uint32_t size)
+{
+  // Scales the 32 bit hash to the range, with no division
+  return static_cast<uint32_t> ((static_cast<uint64_t> (Hash (key, 32)) * size) >> 32);
+}
+
+IndexMap::IndexMap ()
+  : m_bits (0),
+    m_used (0)
+{
+  Reset (0);
+}
+
+void
+IndexMap::Reset (uint32_t nKeys)
+{
+  m_bits = 4;
+  while ((1u << m_bits) < 2 * nKeys)
+    {
+      m_bits++;
+    }
+  Entry empty;
+  empty.key = 0;
+  empty.value = NONE;
+  m_entries.assign (1u << m_bits, empty);
+  m_used = 0;
+}
+
+uint32_t
+IndexMap::Find (uint64_t key) const
+{
+  uint32_t mask = m_entries.size () - 1;
+  for (uint32_t index = Hash (key, m_bits); ; index = (index + 1) & mask)
+    {
+      const Entry &entry = m_entries[index];
+      if (entry.value == NONE || entry.key == key)
+        {
+          return entry.value;
+        }
+    }
+}
+
+IndexMap::Entry &
+IndexMap::Probe (uint64_t key)
+{
+  uint32_t mask = m_entries.size () - 1;
+  for (uint32_t index = Hash (key, m_bits); ; index = (index + 1) & mask)
+    {
+      Entry &entry = m_entries[index];
+      if (entry.value == NONE || entry.key == key)
+        {
+          return entry;
+        }
+    }
+}
+
+uint32_t
+IndexMap::Insert (uint64_t key, uint32_t value)
+{
+  NS_ASSERT (value != NONE);
+  if (2 * (m_used + 1) > m_entries.size ())
+    {
+      Grow ();
+    }
+  Entry &entry = Probe (key);
+  if (entry.value == NONE)
+    {
+      entry.key = key;
+      entry.value = value;
+      m_used++;
+    }
+  return entry.value;
+}
+
+void
+IndexMap::Set (uint64_t key, uint32_t value)
+{
+  NS_ASSERT (value != NONE);
+  if (2 * (m_used + 1) > m_entries.size ())
+    {
+      Grow ();
+    }
+  Entry &entry = Probe (key);
+  if (entry.value == NONE)
+    {
+      entry.key = key;
+      m_used++;
+    }
+  entry.value = value;
+}
+
+uint32_t
+IndexMap::GetNKeys (void) const
+{
+  return m_used;
+}
+
+void
+IndexMap::Grow (void)
+{
+  std::vector<Entry> entries;
+  entries.swap (m_entries);
+  m_bits++;
+  Entry empty;
+  empty.key = 0;
+  empty.value = NONE;
+  m_entries.assign (1u << m_bits, empty);
+  for (std::vector<Entry>::const_iterator itr = entries.begin (); itr != entries.end (); ++itr)
+    {
+      if (itr->value != NONE)
+        {
+          Probe (itr->key) = *itr;
+        }
+    }
+}
+
+}
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shared-tick.h"
+
+#include "ns3/simulator.h"
+#include "ns3/simulation-singleton.h"
+#include "ns3/event-id.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SharedTick");
+
+/**
+ * \ingroup network
+ * \brief The running SharedTick objects of a simulation, by period.
+ *
+ * Deleted by Simulator::Destroy, which also drops the pending events.
+ */
+class SharedTickRegistry
+{
+public:
+  ~SharedTickRegistry ();
+
+  void Add (SharedTick *tick);
+  void Remove (SharedTick *tick);
+
+private:
+  struct Period
+  {
+    EventId event;
+    bool firing;
+    std::vector<SharedTick *> ticks;
+  };
+
+  void Schedule (int64_t period, Period &state);
+  void Fire (int64_t period);
+  void Compact (Period &state);
+
+  std::map<int64_t, Period> m_periods;
+};
+
+SharedTickRegistry::~SharedTickRegistry ()
+{
+  // The ticks outlive the simulation, they must not call back into it
+  for (std::map<int64_t, Period>::iterator itr = m_periods.begin (); itr != m_periods.end (); ++itr)
+    {
+      std::vector<SharedTick *> &ticks = (itr->second).ticks;
+      for (std::vector<SharedTick *>::iterator tick = ticks.begin (); tick != ticks.end (); ++tick)
+        {
+          if (*tick != 0)
+            {
+              (*tick)->m_running = false;
+            }
+        }
+    }
+}
+
+void
+SharedTickRegistry::Schedule (int64_t period, Period &state)
+{
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  int64_t next = (now / period + 1) * period;
+  state.event = Simulator::Schedule (TimeStep (next - now), &SharedTickRegistry::Fire, this, period);
+}
+
+void
+SharedTickRegistry::Add (SharedTick *tick)
+{
+  std::map<int64_t, Period>::iterator itr = m_periods.find (tick->m_runningPeriod);
+  if (itr == m_periods.end ())
+    {
+      Period state;
+      state.firing = false;
+      itr = m_periods.insert (std::make_pair (tick->m_runningPeriod, state)).first;
+    }
+  Period &state = itr->second;
+  state.ticks.push_back (tick);
+  // While firing, the next event is scheduled once all the ticks are done
+  if (!state.firing && !state.event.IsRunning ())
+    {
+      Schedule (tick->m_runningPeriod, state);
+    }
+}
+
+void
+SharedTickRegistry::Remove (SharedTick *tick)
+{
+  Period &state = m_periods[tick->m_runningPeriod];
+  std::vector<SharedTick *>::iterator itr = std::find (state.ticks.begin (), state.ticks.end (), tick);
+  NS_ASSERT (itr != state.ticks.end ());
+  *itr = 0;
+  if (!state.firing)
+    {
+      Compact (state);
+      if (state.ticks.empty ())
+        {
+          Simulator::Remove (state.event);
+        }
+    }
+}
+
+void
+SharedTickRegistry::Compact (Period &state)
+{
+  state.ticks.erase (std::remove (state.ticks.begin (), state.ticks.end (), (SharedTick *) 0),
+                     state.ticks.end ());
+}
+
+void
+SharedTickRegistry::Fire (int64_t period)
+{
+  Period &state = m_periods[period];
+  state.firing = true;
+  // Ticks started by these functions wait for the next multiple of the period
+  uint32_t count = state.ticks.size ();
+  NS_LOG_LOGIC ("Tick of period " << period << " for " << count << " timers");
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      SharedTick *tick = state.ticks[i];
+      if (tick == 0)
+        {
+          continue;
+        }
+      bool keep = tick->m_function ();
+      // A function that cancelled its tick, and maybe started it again,
+      // no longer owns this entry: what it returns is about the entry alone
+      if (!keep && state.ticks[i] == tick)
+        {
+          tick->m_running = false;
+          state.ticks[i] = 0;
+        }
+    }
+  state.firing = false;
+  Compact (state);
+  if (!state.ticks.empty ())
+    {
+      Schedule (period, state);
+    }
+}
+
+SharedTick::SharedTick ()
+  : m_period (Seconds (1)),
+    m_runningPeriod (0),
+    m_running (false)
+{
+}
+
+SharedTick::~SharedTick ()
+{
+  Cancel ();
+}
+
+void
+SharedTick::SetFunction (Callback<bool> function)
+{
+  m_function = function;
+}
+
+void
+SharedTick::SetPeriod (Time period)
+{
+  NS_ASSERT (period.IsStrictlyPositive ());
+  m_period = period;
+}
+
+Time
+SharedTick::GetPeriod (void) const
+{
+  return m_period;
+}
+
+void
+SharedTick::Start (void)
+{
+  NS_ASSERT (!m_function.IsNull ());
+  if (m_running)
+    {
+      return;
+    }
+  m_running = true;
+  m_runningPeriod = m_period.GetTimeStep ();
+  SimulationSingleton<SharedTickRegistry>::Get ()->Add (this);
+}
+
+void
+SharedTick::Cancel (void)
+{
+  if (!m_running)
+    {
+      return;
+    }
+  m_running = false;
+  SimulationSingleton<SharedTickRegistry>::Get ()->Remove (this);
+}
+
+bool
+SharedTick::IsRunning (void) const
+{
+  return m_running;
+}
+
+}
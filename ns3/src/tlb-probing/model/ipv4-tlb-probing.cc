@@ -18,6 +18,7 @@
 
 #include <sys/socket.h>
 #include <set>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -36,6 +37,38 @@ Ipv4TLBProbing::GetTypeId (void)
                       TimeValue (MicroSeconds (100)),
                       MakeTimeAccessor (&Ipv4TLBProbing::m_probeInterval),
                       MakeTimeChecker ())
+        .AddAttribute ("ProbeTimeout", "How long a probe waits for its reply before its path times out",
+                      TimeValue (Seconds (0.1)),
+                      MakeTimeAccessor (&Ipv4TLBProbing::m_probeTimeout),
+                      MakeTimeChecker ())
+        .AddAttribute ("Adaptive", "Whether every path is probed when due instead of two random paths per interval",
+                      BooleanValue (false),
+                      MakeBooleanAccessor (&Ipv4TLBProbing::m_adaptive),
+                      MakeBooleanChecker ())
+        .AddAttribute ("AckFreshness", "A path which carried a data ACK within this time is not probed in the Adaptive mode",
+                      TimeValue (MicroSeconds (100)),
+                      MakeTimeAccessor (&Ipv4TLBProbing::m_ackFreshness),
+                      MakeTimeChecker ())
+        .AddAttribute ("MaxProbeInterval", "The longest probe interval a stable path backs off to in the Adaptive mode",
+                      TimeValue (MilliSeconds (1)),
+                      MakeTimeAccessor (&Ipv4TLBProbing::m_maxProbeInterval),
+                      MakeTimeChecker ())
+        .AddAttribute ("StableRttDelta", "The one way RTT change under which a path reply counts as stable in the Adaptive mode",
+                      TimeValue (MicroSeconds (10)),
+                      MakeTimeAccessor (&Ipv4TLBProbing::m_stableRttDelta),
+                      MakeTimeChecker ())
+        .AddTraceSource ("ReportSend",
+                         "When a probe send is reported to the Ipv4TLB of a host",
+                         MakeTraceSourceAccessor (&Ipv4TLBProbing::m_reportSendTrace),
+                         "ns3::Ipv4TLBProbing::ReportCallback")
+        .AddTraceSource ("ReportRecv",
+                         "When a probe reply is reported to the Ipv4TLB of a host",
+                         MakeTraceSourceAccessor (&Ipv4TLBProbing::m_reportRecvTrace),
+                         "ns3::Ipv4TLBProbing::ReportRecvCallback")
+        .AddTraceSource ("ReportTimeout",
+                         "When a probe timeout is reported to the Ipv4TLB of a host",
+                         MakeTraceSourceAccessor (&Ipv4TLBProbing::m_reportTimeoutTrace),
+                         "ns3::Ipv4TLBProbing::ReportCallback")
     ;
 
     return tid;
@@ -49,10 +82,14 @@ Ipv4TLBProbing::GetInstanceTypeId () const
 
 Ipv4TLBProbing::Ipv4TLBProbing ()
     : m_sourceAddress (Ipv4Address ("127.0.0.1")),
-      m_probeAddress (Ipv4Address ("127.0.0.1")),
       m_probeTimeout (Seconds (0.1)),
       m_probeInterval (MicroSeconds (100)),
+      m_adaptive (false),
+      m_ackFreshness (MicroSeconds (100)),
+      m_maxProbeInterval (MilliSeconds (1)),
+      m_stableRttDelta (MicroSeconds (10)),
       m_id (0),
+      m_firstPendingId (0),
       m_hasBestPath (false),
       m_bestPath (0),
       m_bestPathRtt (Seconds (666)),
@@ -61,14 +98,19 @@ Ipv4TLBProbing::Ipv4TLBProbing ()
       m_node ()
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLBProbing::Ipv4TLBProbing (const Ipv4TLBProbing &other)
     : m_sourceAddress (other.m_sourceAddress),
-      m_probeAddress (other.m_probeAddress),
       m_probeTimeout (other.m_probeTimeout),
       m_probeInterval (other.m_probeInterval),
+      m_adaptive (other.m_adaptive),
+      m_ackFreshness (other.m_ackFreshness),
+      m_maxProbeInterval (other.m_maxProbeInterval),
+      m_stableRttDelta (other.m_stableRttDelta),
       m_id (0),
+      m_firstPendingId (0),
       m_hasBestPath (false),
       m_bestPath (0),
       m_bestPathRtt (Seconds (666)),
@@ -77,6 +119,7 @@ Ipv4TLBProbing::Ipv4TLBProbing (const Ipv4TLBProbing &other)
       m_node ()
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLBProbing::~Ipv4TLBProbing ()
@@ -87,13 +130,11 @@ Ipv4TLBProbing::~Ipv4TLBProbing ()
 void
 Ipv4TLBProbing::DoDispose ()
 {
-    std::map <uint32_t, EventId>::iterator itr =
-        m_probingTimeoutMap.begin ();
-    for ( ; itr != m_probingTimeoutMap.end (); ++itr)
-    {
-        (itr->second).Cancel ();
-        m_probingTimeoutMap.erase (itr);
-    }
+    m_probeEvent.Cancel ();
+    m_sweepEvent.Cancel ();
+    m_pendingProbes.clear ();
+    m_tlb = 0;
+    m_rackTlbs.clear ();
 }
 
 void
@@ -105,13 +146,56 @@ Ipv4TLBProbing::SetSourceAddress (Ipv4Address address)
 void
 Ipv4TLBProbing::SetProbeAddress (Ipv4Address address)
 {
-    m_probeAddress = address;
+    m_targets.clear ();
+    Ipv4TLBProbing::AddProbeAddress (address);
+}
+
+void
+Ipv4TLBProbing::AddProbeAddress (Ipv4Address address)
+{
+    Target target;
+    target.address = address;
+    m_targets.push_back (target);
 }
 
 void
 Ipv4TLBProbing::SetNode (Ptr<Node> node)
 {
     m_node = node;
+    m_tlb = node->GetObject<Ipv4TLB> ();
+}
+
+void
+Ipv4TLBProbing::AddRackHost (Ptr<Node> node)
+{
+    Ptr<Ipv4TLB> tlb = node->GetObject<Ipv4TLB> ();
+    if (tlb == 0 || m_tlb == 0)
+    {
+        NS_LOG_ERROR ("Both the prober and the rack host should run TLB");
+        return;
+    }
+    // The hosts sharing a path state learn of a probe once
+    if (tlb == m_tlb || m_tlb->IsRackStateSharedWith (tlb))
+    {
+        return;
+    }
+    std::vector<Ptr<Ipv4TLB> >::const_iterator itr = m_rackTlbs.begin ();
+    for ( ; itr != m_rackTlbs.end (); ++itr)
+    {
+        if (*itr == tlb || (*itr)->IsRackStateSharedWith (tlb))
+        {
+            return;
+        }
+    }
+    m_rackTlbs.push_back (tlb);
+}
+
+int64_t
+Ipv4TLBProbing::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
 }
 
 void
@@ -130,30 +214,40 @@ Ipv4TLBProbing::Init ()
 }
 
 void
-Ipv4TLBProbing::SendProbe (uint32_t path)
+Ipv4TLBProbing::SendProbe (uint32_t target, uint32_t path)
 {
-    Address to = InetSocketAddress (m_probeAddress, 0);
+    Ipv4Address probeAddress = m_targets[target].address;
+    Address to = InetSocketAddress (probeAddress, 0);
 
     Ptr<Packet> packet = Create<Packet> (0);
     Ipv4Header newHeader;
     newHeader.SetSource (m_sourceAddress);
-    newHeader.SetDestination (m_probeAddress);
+    newHeader.SetDestination (probeAddress);
     newHeader.SetProtocol (0);
     newHeader.SetPayloadSize (packet->GetSize ());
     newHeader.SetEcn (Ipv4Header::ECN_ECT1);
     newHeader.SetTtl (255);
     packet->AddHeader (newHeader);
 
-    // XPath tag
+    // XPath tag, the route of the path in the catalog of the TLB if it uses one
     Ipv4XPathTag ipv4XPathTag;
-    ipv4XPathTag.SetPathId (path);
+    uint32_t nPorts = 0;
+    const uint32_t *ports = m_tlb->GetRoute (path, nPorts);
+    if (ports != 0)
+    {
+        ipv4XPathTag.SetRoute (ports, nPorts);
+    }
+    else
+    {
+        ipv4XPathTag.SetPathId (path);
+    }
     packet->AddPacketTag (ipv4XPathTag);
 
     // Probing tag
     Ipv4TLBProbingTag probingTag;
     probingTag.SetId (m_id);
     probingTag.SetPath (path);
-    probingTag.SetProbeAddress (m_probeAddress);
+    probingTag.SetProbeAddress (probeAddress);
     probingTag.SetIsReply (0);
     probingTag.SetTime (Simulator::Now ());
     probingTag.SetIsCE (0);
@@ -161,22 +255,110 @@ Ipv4TLBProbing::SendProbe (uint32_t path)
     packet->AddPacketTag (probingTag);
 
     m_socket->SendTo (packet, 0, to);
+
+    // The probe waits for its reply at the back of the pending probes
+    if (m_pendingProbes.empty ())
+    {
+        m_firstPendingId = m_id;
+    }
+    PendingProbe pendingProbe;
+    pendingProbe.target = target;
+    pendingProbe.path = path;
+    pendingProbe.sendTime = Simulator::Now ();
+    pendingProbe.isPending = true;
+    m_pendingProbes.push_back (pendingProbe);
     m_id ++;
 
-    // Add timeout
-    m_probingTimeoutMap[m_id] =
-        Simulator::Schedule (m_probeTimeout, &Ipv4TLBProbing::ProbeEventTimeout, this, m_id, path);
+    if (!m_sweepEvent.IsRunning ())
+    {
+        m_sweepEvent = Simulator::Schedule (m_probeTimeout, &Ipv4TLBProbing::SweepProbes, this);
+    }
 
-    Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-    ipv4TLB->ProbeSend (m_probeAddress, path);
+    Ipv4TLBProbing::ReportSend (probeAddress, path);
 }
 
 void
-Ipv4TLBProbing::ProbeEventTimeout (uint32_t id, uint32_t path)
+Ipv4TLBProbing::SweepProbes (void)
 {
-    m_probingTimeoutMap.erase (id);
-    Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-    ipv4TLB->ProbeTimeout (path, m_probeAddress);
+    while (!m_pendingProbes.empty ())
+    {
+        const PendingProbe &pendingProbe = m_pendingProbes.front ();
+        if (pendingProbe.isPending)
+        {
+            if (Simulator::Now () - pendingProbe.sendTime < m_probeTimeout)
+            {
+                break;
+            }
+            PathProbe *pathProbe = m_adaptive ? Ipv4TLBProbing::FindPathProbe (pendingProbe.target, pendingProbe.path) : 0;
+            if (pathProbe != 0)
+            {
+                // Probe the path again on the next round
+                pathProbe->interval = m_probeInterval;
+                pathProbe->nextProbe = Simulator::Now ();
+                // The prober may sleep on a backed-off interval
+                Ipv4TLBProbing::WakeUp (pathProbe->nextProbe);
+            }
+            Ipv4TLBProbing::ReportTimeout (pendingProbe.path, m_targets[pendingProbe.target].address);
+        }
+        m_pendingProbes.pop_front ();
+        m_firstPendingId ++;
+    }
+
+    if (!m_pendingProbes.empty ())
+    {
+        m_sweepEvent = Simulator::Schedule (m_pendingProbes.front ().sendTime + m_probeTimeout - Simulator::Now (),
+                                            &Ipv4TLBProbing::SweepProbes, this);
+    }
+}
+
+void
+Ipv4TLBProbing::ReportSend (Ipv4Address daddr, uint32_t path)
+{
+    m_tlb->ProbeSend (daddr, path);
+    m_reportSendTrace (m_tlb, path, daddr);
+    std::vector<Ptr<Ipv4TLB> >::const_iterator itr = m_rackTlbs.begin ();
+    for ( ; itr != m_rackTlbs.end (); ++itr)
+    {
+        (*itr)->ProbeSend (daddr, path);
+        m_reportSendTrace (*itr, path, daddr);
+    }
+}
+
+void
+Ipv4TLBProbing::ReportRecv (uint32_t path, Ipv4Address daddr, uint32_t size, bool isCE, Time oneWayRtt)
+{
+    m_tlb->ProbeRecv (path, daddr, size, isCE, oneWayRtt);
+    m_reportRecvTrace (m_tlb, path, daddr, isCE, oneWayRtt);
+    std::vector<Ptr<Ipv4TLB> >::const_iterator itr = m_rackTlbs.begin ();
+    for ( ; itr != m_rackTlbs.end (); ++itr)
+    {
+        (*itr)->ProbeRecv (path, daddr, size, isCE, oneWayRtt);
+        m_reportRecvTrace (*itr, path, daddr, isCE, oneWayRtt);
+    }
+}
+
+void
+Ipv4TLBProbing::ReportTimeout (uint32_t path, Ipv4Address daddr)
+{
+    m_tlb->ProbeTimeout (path, daddr);
+    m_reportTimeoutTrace (m_tlb, path, daddr);
+    std::vector<Ptr<Ipv4TLB> >::const_iterator itr = m_rackTlbs.begin ();
+    for ( ; itr != m_rackTlbs.end (); ++itr)
+    {
+        (*itr)->ProbeTimeout (path, daddr);
+        m_reportTimeoutTrace (*itr, path, daddr);
+    }
+}
+
+void
+Ipv4TLBProbing::WakeUp (Time nextProbe)
+{
+    if (m_probeEvent.IsRunning () && nextProbe < TimeStep (m_probeEvent.GetTs ()))
+    {
+        m_probeEvent.Cancel ();
+        m_probeEvent = Simulator::Schedule (Max (nextProbe - Simulator::Now (), Time (0)),
+                                            &Ipv4TLBProbing::DoProbe, this);
+    }
 }
 
 void
@@ -232,27 +414,45 @@ Ipv4TLBProbing::ReceivePacket (Ptr<Socket> socket)
     }
     else
     {
-        std::map<uint32_t, EventId>::iterator itr =
-                m_probingTimeoutMap.find (probingTag.GetId ());
-
-        if (itr == m_probingTimeoutMap.end () && !probingTag.GetIsBroadcast ())
-        {
-            // The reply has incurred timeout
-            return;
-        }
-
-        if (!probingTag.GetIsBroadcast ())
-        {
-            // Cancel the probing timeout timer
-            (itr->second).Cancel ();
-            m_probingTimeoutMap.erase (itr);
-        }
-
         uint32_t path = probingTag.GetPath ();
         Time oneWayRtt = probingTag.GetTime ();
         bool isCE = probingTag.GetIsCE () == 1 ? true : false;
         uint32_t size = packet->GetSize () + ipv4Header.GetSerializedSize ();
 
+        if (!probingTag.GetIsBroadcast ())
+        {
+            uint32_t order = probingTag.GetId () - m_firstPendingId;
+            if (order >= m_pendingProbes.size () || !m_pendingProbes[order].isPending)
+            {
+                // The reply has incurred timeout
+                return;
+            }
+            PendingProbe &pendingProbe = m_pendingProbes[order];
+            pendingProbe.isPending = false;
+
+            PathProbe *pathProbe = m_adaptive ? Ipv4TLBProbing::FindPathProbe (pendingProbe.target, path) : 0;
+            if (pathProbe != 0)
+            {
+                // A path whose replies do not change is probed less and less often
+                bool isStable = pathProbe->hasReply && pathProbe->isCE == isCE
+                    && Abs (oneWayRtt - pathProbe->oneWayRtt) <= m_stableRttDelta;
+                pathProbe->interval = isStable ? std::min (pathProbe->interval + pathProbe->interval, m_maxProbeInterval)
+                                               : m_probeInterval;
+                pathProbe->nextProbe = pendingProbe.sendTime + pathProbe->interval;
+                pathProbe->hasReply = true;
+                pathProbe->isCE = isCE;
+                pathProbe->oneWayRtt = oneWayRtt;
+                // A changed path is due sooner than the prober sleeps
+                Ipv4TLBProbing::WakeUp (pathProbe->nextProbe);
+            }
+
+            while (!m_pendingProbes.empty () && !m_pendingProbes.front ().isPending)
+            {
+                m_pendingProbes.pop_front ();
+                m_firstPendingId ++;
+            }
+        }
+
         if (oneWayRtt < m_bestPathRtt)
         {
             m_hasBestPath = true;
@@ -262,8 +462,7 @@ Ipv4TLBProbing::ReceivePacket (Ptr<Socket> socket)
             //m_bestPathSize = size;
         }
 
-        Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-        ipv4TLB->ProbeRecv (path, probingTag.GetProbeAddres (), size, isCE, oneWayRtt);
+        Ipv4TLBProbing::ReportRecv (path, probingTag.GetProbeAddres (), size, isCE, oneWayRtt);
 
         if (!probingTag.GetIsBroadcast ())
         {
@@ -271,7 +470,7 @@ Ipv4TLBProbing::ReceivePacket (Ptr<Socket> socket)
             std::vector<Ipv4Address>::iterator broadcastItr = m_broadcastAddresses.begin ();
             for ( ; broadcastItr != m_broadcastAddresses.end (); broadcastItr ++)
             {
-                Ipv4TLBProbing::ForwardPathInfoTo(*broadcastItr, path, oneWayRtt, isCE);
+                Ipv4TLBProbing::ForwardPathInfoTo (*broadcastItr, probingTag.GetProbeAddres (), path, oneWayRtt, isCE);
             }
         }
     }
@@ -291,6 +490,33 @@ Ipv4TLBProbing::StopProbe (Time stopTime)
 
 void
 Ipv4TLBProbing::DoProbe ()
+{
+    Time nextProbe = Time::Max ();
+    for (uint32_t target = 0; target < m_targets.size (); ++target)
+    {
+        if (m_adaptive)
+        {
+            nextProbe = std::min (nextProbe, Ipv4TLBProbing::ProbeDuePaths (target));
+        }
+        else
+        {
+            Ipv4TLBProbing::ProbeRandomPaths (target);
+        }
+    }
+    m_hasBestPath = false;
+    m_bestPathRtt = Seconds (666);
+
+    // The adaptive prober sleeps until the next path is due
+    Time delay = m_probeInterval;
+    if (m_adaptive && nextProbe != Time::Max ())
+    {
+        delay = std::max (delay, nextProbe - Simulator::Now ());
+    }
+    m_probeEvent = Simulator::Schedule (delay, &Ipv4TLBProbing::DoProbe, this);
+}
+
+void
+Ipv4TLBProbing::ProbeRandomPaths (uint32_t target)
 {
     uint32_t probingCount = 3;
 
@@ -306,17 +532,16 @@ Ipv4TLBProbing::DoProbe ()
         }
         */
 
-        Ipv4TLBProbing::SendProbe (m_bestPath);
+        Ipv4TLBProbing::SendProbe (target, m_bestPath);
         probingCount --;
         pathSet.insert (m_bestPath);
     }
-    Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-    std::vector<uint32_t> availPaths = ipv4TLB->GetAvailPath (m_probeAddress);
+    std::vector<uint32_t> availPaths = m_tlb->GetAvailPath (m_targets[target].address);
     if (!availPaths.empty ())
     {
         for (uint32_t i = 0; i < 10; i++) // Try 8 times
         {
-            uint32_t path = availPaths[rand() % availPaths.size ()];
+            uint32_t path = availPaths[m_rand->GetInteger (0, availPaths.size () - 1)];
             if (pathSet.find (path) != pathSet.end ())
             {
                 continue;
@@ -327,13 +552,78 @@ Ipv4TLBProbing::DoProbe ()
                 break;
             }
             pathSet.insert (path);
-            Ipv4TLBProbing::SendProbe (path);
+            Ipv4TLBProbing::SendProbe (target, path);
         }
     }
-    m_hasBestPath = false;
-    m_bestPathRtt = Seconds (666);
+}
 
-    m_probeEvent = Simulator::Schedule (m_probeInterval, &Ipv4TLBProbing::DoProbe, this);
+Time
+Ipv4TLBProbing::ProbeDuePaths (uint32_t target)
+{
+    Time nextProbe = Time::Max ();
+    const TLBTorRegistry &registry = m_tlb->GetRegistry ();
+    uint32_t torIndex = registry.FindTor (m_targets[target].address);
+    if (torIndex == TLBTorRegistry::NONE)
+    {
+        NS_LOG_ERROR ("Cannot find the tor of probe address " << m_targets[target].address);
+        return nextProbe;
+    }
+    const std::vector<uint32_t> &slots = registry.GetSlots (torIndex);
+    for (std::vector<uint32_t>::const_iterator itr = slots.begin (); itr != slots.end (); ++itr)
+    {
+        PathProbe &pathProbe = Ipv4TLBProbing::GetPathProbe (m_targets[target], *itr);
+        if (pathProbe.nextProbe <= Simulator::Now ())
+        {
+            Time ackTime;
+            if (m_tlb->GetLastAckTime (*itr, ackTime)
+                && Simulator::Now () - ackTime < m_ackFreshness)
+            {
+                // The data ACKs already tell how the path is doing
+                pathProbe.nextProbe = ackTime + m_ackFreshness;
+            }
+            else
+            {
+                Ipv4TLBProbing::SendProbe (target, registry.GetPath (*itr));
+                pathProbe.nextProbe = Simulator::Now () + pathProbe.interval;
+            }
+        }
+        nextProbe = std::min (nextProbe, pathProbe.nextProbe);
+    }
+    return nextProbe;
+}
+
+Ipv4TLBProbing::PathProbe &
+Ipv4TLBProbing::GetPathProbe (Target &target, uint32_t slot)
+{
+    if (slot >= target.paths.size ())
+    {
+        // A new path is due at once
+        PathProbe pathProbe;
+        pathProbe.nextProbe = Time (0);
+        pathProbe.interval = m_probeInterval;
+        pathProbe.hasReply = false;
+        pathProbe.isCE = false;
+        pathProbe.oneWayRtt = Seconds (0);
+        target.paths.resize (m_tlb->GetRegistry ().GetNSlots (), pathProbe);
+    }
+    return target.paths[slot];
+}
+
+Ipv4TLBProbing::PathProbe *
+Ipv4TLBProbing::FindPathProbe (uint32_t target, uint32_t path)
+{
+    const TLBTorRegistry &registry = m_tlb->GetRegistry ();
+    uint32_t torIndex = registry.FindTor (m_targets[target].address);
+    if (torIndex == TLBTorRegistry::NONE)
+    {
+        return 0;
+    }
+    uint32_t slot = registry.FindPath (torIndex, path);
+    if (slot == TLBTorRegistry::NONE)
+    {
+        return 0;
+    }
+    return &Ipv4TLBProbing::GetPathProbe (m_targets[target], slot);
 }
 
 void
@@ -374,7 +664,7 @@ Ipv4TLBProbing::BroadcastBestPathTo (Ipv4Address addr)
 */
 
 void
-Ipv4TLBProbing::ForwardPathInfoTo (Ipv4Address addr, uint32_t path, Time oneWayRtt, bool isCE)
+Ipv4TLBProbing::ForwardPathInfoTo (Ipv4Address addr, Ipv4Address probeAddress, uint32_t path, Time oneWayRtt, bool isCE)
 {
     Address to = InetSocketAddress (addr, 0);
 
@@ -392,7 +682,7 @@ Ipv4TLBProbing::ForwardPathInfoTo (Ipv4Address addr, uint32_t path, Time oneWayR
     Ipv4TLBProbingTag probingTag;
     probingTag.SetId (0);
     probingTag.SetPath (path);
-    probingTag.SetProbeAddress (m_probeAddress);
+    probingTag.SetProbeAddress (probeAddress);
     probingTag.SetIsReply (1);
     probingTag.SetTime (oneWayRtt);
     probingTag.SetIsCE (isCE);
@@ -8,9 +8,10 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
 
 #include <vector>
-#include <map>
+#include <deque>
 
 namespace ns3 {
 
@@ -18,7 +19,24 @@ class Packet;
 class Socket;
 class Node;
 class Ipv4Header;
-
+class Ipv4TLB;
+
+/**
+ * \brief Probes the paths from the ToR of its node to the ToRs of the
+ * probe addresses and reports the replies to the Ipv4TLB of its node.
+ *
+ * Every ProbeInterval the prober sends two probes on random paths to each
+ * probe address.  In the Adaptive mode it instead probes every path when
+ * it is due: a path which carried a data ACK within AckFreshness is not
+ * probed, and a path whose replies do not change, an idle or a stable
+ * one, doubles its probe interval up to MaxProbeInterval.
+ *
+ * A single prober may serve all the hosts under its ToR: the replies,
+ * the sends and the timeouts are reported to the Ipv4TLB of every rack
+ * host, only once for the hosts sharing their path state.  The pending
+ * probes are kept in the order they were sent, and one event sweeps
+ * those which timed out.
+ */
 class Ipv4TLBProbing : public Object
 {
 public:
@@ -33,42 +51,111 @@ public:
 
     void SetSourceAddress (Ipv4Address address);
     void SetProbeAddress (Ipv4Address address);
+    void AddProbeAddress (Ipv4Address address);
+
+    // The TLB of the host is told about the probes of this prober as well
+    void AddRackHost (Ptr<Node> node);
 
     void SetNode (Ptr<Node> node);
 
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.  Return the number of streams (possibly zero) that
+     * have been assigned.
+     */
+    int64_t AssignStreams (int64_t stream);
+
     void AddBroadCastAddress (Ipv4Address addr);
 
     void Init (void);
 
-    void SendProbe (uint32_t path);
+    void SendProbe (uint32_t target, uint32_t path);
 
     void ReceivePacket (Ptr<Socket> socket);
 
-    void ProbeEventTimeout (uint32_t id, uint32_t path);
-
     void StartProbe ();
 
     void StopProbe (Time stopTime);
 
+    typedef void (* ReportCallback) (Ptr<Ipv4TLB> tlb, uint32_t path, Ipv4Address daddr);
+
+    typedef void (* ReportRecvCallback) (Ptr<Ipv4TLB> tlb, uint32_t path, Ipv4Address daddr,
+            bool isCE, Time oneWayRtt);
+
 private:
 
     void DoProbe ();
     void DoStop ();
 
+    void ProbeRandomPaths (uint32_t target);
+
+    // Returns when the next path of the target is due
+    Time ProbeDuePaths (uint32_t target);
+
+    // Times out the pending probes sent more than m_probeTimeout ago
+    void SweepProbes (void);
+
+    void ReportSend (Ipv4Address daddr, uint32_t path);
+    void ReportRecv (uint32_t path, Ipv4Address daddr, uint32_t size, bool isCE, Time oneWayRtt);
+    void ReportTimeout (uint32_t path, Ipv4Address daddr);
+
+    // Probes the paths sooner than the sleeping prober would, in the Adaptive mode
+    void WakeUp (Time nextProbe);
+
     //void BroadcastBestPathTo (Ipv4Address addr);
 
-    void ForwardPathInfoTo (Ipv4Address addr, uint32_t path, Time oneWayRtt, bool isCE);
+    void ForwardPathInfoTo (Ipv4Address addr, Ipv4Address probeAddress, uint32_t path, Time oneWayRtt, bool isCE);
+
+    // The adaptive probing state of a path
+    struct PathProbe
+    {
+        Time nextProbe;
+        Time interval;
+        bool hasReply;
+        bool isCE;
+        Time oneWayRtt;
+    };
+
+    // A flow destination, the server probed under its ToR
+    struct Target
+    {
+        Ipv4Address address;
+        std::vector<PathProbe> paths; /* <Slot, PathProbe> */
+    };
+
+    // The probing state of the path in the slot of the TLB registry
+    PathProbe &GetPathProbe (Target &target, uint32_t slot);
+
+    // The probing state of a path to the target, 0 if the path is not available
+    PathProbe *FindPathProbe (uint32_t target, uint32_t path);
+
+    // A probe waiting for its reply
+    struct PendingProbe
+    {
+        uint32_t target;
+        uint32_t path;
+        Time sendTime;
+        bool isPending;
+    };
 
     // Parameters
     Ipv4Address m_sourceAddress;
-    Ipv4Address m_probeAddress; // The flow destination
 
     Time m_probeTimeout;
     Time m_probeInterval;
 
+    bool m_adaptive;
+    Time m_ackFreshness;
+    Time m_maxProbeInterval;
+    Time m_stableRttDelta;
+
     uint32_t m_id;
 
-    std::map <uint32_t, EventId> m_probingTimeoutMap;
+    std::vector<Target> m_targets;
+
+    std::deque<PendingProbe> m_pendingProbes; /* The probes from id m_firstPendingId on */
+    uint32_t m_firstPendingId;
+    EventId m_sweepEvent;
 
     /* Best path related */
     bool m_hasBestPath;
@@ -87,6 +174,17 @@ private:
 
     Ptr<Node> m_node;
 
+    Ptr<Ipv4TLB> m_tlb;
+    std::vector<Ptr<Ipv4TLB> > m_rackTlbs; // Not sharing the path state of m_tlb or of each other
+
+    // Draws the paths probed besides the best one
+    Ptr<UniformRandomVariable> m_rand;
+
+    // Once for each Ipv4TLB reported to
+    TracedCallback <Ptr<Ipv4TLB>, uint32_t, Ipv4Address> m_reportSendTrace;
+    TracedCallback <Ptr<Ipv4TLB>, uint32_t, Ipv4Address, bool, Time> m_reportRecvTrace;
+    TracedCallback <Ptr<Ipv4TLB>, uint32_t, Ipv4Address> m_reportTimeoutTrace;
+
 };
 
 }
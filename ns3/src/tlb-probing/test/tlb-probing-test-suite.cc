@@ -2,48 +2,632 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-tlb-probing.h"
+#include "ns3/ipv4-tlb-probing-tag.h"
+#include "ns3/ipv4-xpath-tag.h"
+#include "ns3/ipv4-tlb.h"
+#include "ns3/tlb-path-catalog.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-raw-socket-factory.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/socket.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/ipv4-route-input-test.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <set>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
 
-// This is an example TestCase.
-class TlbProbingTestCase1 : public TestCase
+namespace {
+
+const Ipv4Address g_source ("10.0.0.1");
+const Ipv4Address g_dest ("10.0.0.2");
+
+}
+
+/*
+ * A prober on the host 10.0.0.1 under ToR 1, probing the paths 1 to n
+ * to the host 10.0.0.2 under ToR 2 over a link of 10us.  The host
+ * 10.0.0.2 replies to the probes as the test tells it to, with the one
+ * way RTT it is given.  The reports of the prober are recorded
+ */
+class TlbProbingTestCase : public TestCase
+{
+public:
+  TlbProbingTestCase (std::string name);
+
+protected:
+  struct Report
+  {
+    Time time;
+    Ptr<Ipv4TLB> tlb;
+    uint32_t path;
+    Time oneWayRtt;
+  };
+
+  virtual void DoTeardown (void);
+
+  // Builds the hosts, with the paths of the catalog if any
+  void Build (uint32_t nPaths, Ptr<TLBPathCatalog> catalog = 0);
+  // Replies to the received probe of the index after the delay
+  void Reply (uint32_t index, Time delay, Time oneWayRtt);
+  // The times the path was probed at
+  std::vector<Time> GetSendTimes (uint32_t path) const;
+
+  void SetReplyRtt (Time oneWayRtt);
+  // A data ACK of a flow on the path
+  void AckPath (uint32_t path);
+
+  Ptr<Node> m_host;
+  Ptr<Ipv4TLB> m_tlb;
+  Ptr<Ipv4TLBProbing> m_probing;
+
+  // When set, every probe is replied to at once with m_replyRtt
+  bool m_autoReply;
+  Time m_replyRtt;
+  std::vector<Ipv4TLBProbingTag> m_probes;
+  // The XPath tags of the received probes
+  std::vector<Ipv4XPathTag> m_routes;
+
+  std::vector<Report> m_sends;
+  std::vector<Report> m_recvs;
+  std::vector<Report> m_timeouts;
+
+private:
+  void Receive (Ptr<Socket> socket);
+  void SendReply (Ipv4TLBProbingTag probe, Time oneWayRtt);
+  void ReportSend (Ptr<Ipv4TLB> tlb, uint32_t path, Ipv4Address daddr);
+  void ReportRecv (Ptr<Ipv4TLB> tlb, uint32_t path, Ipv4Address daddr, bool isCE, Time oneWayRtt);
+  void ReportTimeout (Ptr<Ipv4TLB> tlb, uint32_t path, Ipv4Address daddr);
+  static Report MakeReport (Ptr<Ipv4TLB> tlb, uint32_t path, Time oneWayRtt);
+
+  Ptr<Socket> m_responder;
+};
+
+TlbProbingTestCase::TlbProbingTestCase (std::string name)
+  : TestCase (name),
+    m_autoReply (false),
+    m_replyRtt (MicroSeconds (10))
+{
+}
+
+void
+TlbProbingTestCase::Build (uint32_t nPaths, Ptr<TLBPathCatalog> catalog)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.SetTLB (false);
+  internet.Install (nodes);
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  simple.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (10)));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  ipv4.Assign (simple.Install (nodes));
+  m_host = nodes.Get (0);
+
+  m_tlb = CreateObject<Ipv4TLB> ();
+  if (catalog != 0)
+    {
+      m_tlb->UsePathCatalog (catalog, 1);
+    }
+  else
+    {
+      m_tlb->AddAddressWithTor (g_source, 1);
+      m_tlb->AddAddressWithTor (g_dest, 2);
+      for (uint32_t path = 1; path <= nPaths; ++path)
+        {
+          m_tlb->AddAvailPath (2, path);
+        }
+    }
+  m_host->AggregateObject (m_tlb);
+
+  m_probing = CreateObject<Ipv4TLBProbing> ();
+  m_probing->SetNode (m_host);
+  m_probing->SetSourceAddress (g_source);
+  m_probing->AddProbeAddress (g_dest);
+  m_probing->Init ();
+  m_probing->TraceConnectWithoutContext ("ReportSend", MakeCallback (&TlbProbingTestCase::ReportSend, this));
+  m_probing->TraceConnectWithoutContext ("ReportRecv", MakeCallback (&TlbProbingTestCase::ReportRecv, this));
+  m_probing->TraceConnectWithoutContext ("ReportTimeout", MakeCallback (&TlbProbingTestCase::ReportTimeout, this));
+
+  m_responder = nodes.Get (1)->GetObject<Ipv4RawSocketFactory> ()->CreateSocket ();
+  m_responder->SetRecvCallback (MakeCallback (&TlbProbingTestCase::Receive, this));
+  m_responder->Bind (InetSocketAddress (Ipv4Address ("0.0.0.0"), 0));
+  m_responder->SetAttribute ("IpHeaderInclude", BooleanValue (true));
+}
+
+void
+TlbProbingTestCase::DoTeardown (void)
+{
+  m_probing = 0;
+  m_tlb = 0;
+  m_host = 0;
+  m_responder = 0;
+  m_sends.clear ();
+  m_recvs.clear ();
+  m_timeouts.clear ();
+  Simulator::Destroy ();
+}
+
+void
+TlbProbingTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet = socket->Recv ();
+  Ipv4TLBProbingTag probe;
+  if (packet->PeekPacketTag (probe) && probe.GetIsReply () == 0)
+    {
+      m_probes.push_back (probe);
+      Ipv4XPathTag route;
+      packet->PeekPacketTag (route);
+      m_routes.push_back (route);
+      if (m_autoReply)
+        {
+          TlbProbingTestCase::SendReply (probe, m_replyRtt);
+        }
+    }
+}
+
+void
+TlbProbingTestCase::Reply (uint32_t index, Time delay, Time oneWayRtt)
+{
+  Simulator::Schedule (delay, &TlbProbingTestCase::SendReply, this, m_probes[index], oneWayRtt);
+}
+
+void
+TlbProbingTestCase::SendReply (Ipv4TLBProbingTag probe, Time oneWayRtt)
+{
+  Ptr<Packet> packet = Create<Packet> (0);
+  Ipv4Header header;
+  header.SetSource (g_dest);
+  header.SetDestination (g_source);
+  header.SetProtocol (0);
+  header.SetPayloadSize (0);
+  header.SetTtl (255);
+  packet->AddHeader (header);
+
+  Ipv4TLBProbingTag reply;
+  reply.SetId (probe.GetId ());
+  reply.SetPath (probe.GetPath ());
+  reply.SetProbeAddress (probe.GetProbeAddres ());
+  reply.SetIsReply (1);
+  reply.SetTime (oneWayRtt);
+  reply.SetIsCE (0);
+  reply.SetIsBroadcast (0);
+  packet->AddPacketTag (reply);
+
+  m_responder->SendTo (packet, 0, InetSocketAddress (g_source, 0));
+}
+
+void
+TlbProbingTestCase::SetReplyRtt (Time oneWayRtt)
+{
+  m_replyRtt = oneWayRtt;
+}
+
+void
+TlbProbingTestCase::AckPath (uint32_t path)
+{
+  m_tlb->FlowRecv (1, path, g_dest, 100, false, MicroSeconds (10));
+}
+
+TlbProbingTestCase::Report
+TlbProbingTestCase::MakeReport (Ptr<Ipv4TLB> tlb, uint32_t path, Time oneWayRtt)
+{
+  Report report;
+  report.time = Simulator::Now ();
+  report.tlb = tlb;
+  report.path = path;
+  report.oneWayRtt = oneWayRtt;
+  return report;
+}
+
+void
+TlbProbingTestCase::ReportSend (Ptr<Ipv4TLB> tlb, uint32_t path, Ipv4Address daddr)
+{
+  m_sends.push_back (MakeReport (tlb, path, Time (0)));
+}
+
+void
+TlbProbingTestCase::ReportRecv (Ptr<Ipv4TLB> tlb, uint32_t path, Ipv4Address daddr, bool isCE, Time oneWayRtt)
+{
+  m_recvs.push_back (MakeReport (tlb, path, oneWayRtt));
+}
+
+void
+TlbProbingTestCase::ReportTimeout (Ptr<Ipv4TLB> tlb, uint32_t path, Ipv4Address daddr)
+{
+  m_timeouts.push_back (MakeReport (tlb, path, Time (0)));
+}
+
+std::vector<Time>
+TlbProbingTestCase::GetSendTimes (uint32_t path) const
+{
+  std::vector<Time> times;
+  for (uint32_t i = 0; i < m_sends.size (); ++i)
+    {
+      if (m_sends[i].path == path)
+        {
+          times.push_back (m_sends[i].time);
+        }
+    }
+  return times;
+}
+
+class TlbProbingReplyTestCase : public TlbProbingTestCase
 {
 public:
-  TlbProbingTestCase1 ();
-  virtual ~TlbProbingTestCase1 ();
+  TlbProbingReplyTestCase ();
 
 private:
   virtual void DoRun (void);
 };
 
-// Add some help text to this case to describe what it is intended to test
-TlbProbingTestCase1::TlbProbingTestCase1 ()
-  : TestCase ("TlbProbing test case (does nothing)")
+TlbProbingReplyTestCase::TlbProbingReplyTestCase ()
+  : TlbProbingTestCase ("A reply is reported once, for its own probe, unless the probe timed out")
 {
 }
 
-// This destructor does nothing but we include it as a reminder that
-// the test case should clean up after itself
-TlbProbingTestCase1::~TlbProbingTestCase1 ()
+void
+TlbProbingReplyTestCase::DoRun (void)
+{
+  Build (3);
+  for (uint32_t path = 1; path <= 3; ++path)
+    {
+      m_probing->SendProbe (0, path);
+    }
+  AdvanceSimulation (MicroSeconds (15));
+  NS_TEST_ASSERT_MSG_EQ (m_probes.size (), 3, "The probes should have reached the host");
+  NS_TEST_ASSERT_MSG_EQ (m_sends.size (), 3, "Each probe should be reported sent");
+
+  // The replies out of order, one of them twice, and none for the probe of path 2
+  Reply (2, MicroSeconds (0), MicroSeconds (30));
+  Reply (0, MicroSeconds (1), MicroSeconds (10));
+  Reply (2, MicroSeconds (2), MicroSeconds (30));
+  AdvanceSimulation (MicroSeconds (50));
+  NS_TEST_ASSERT_MSG_EQ (m_recvs.size (), 2, "Each reply should be reported once");
+  NS_TEST_ASSERT_MSG_EQ (m_recvs[0].path, 3, "The first reply is to the probe of path 3");
+  // The tag keeps the time in seconds as a double, to a rounding
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_recvs[0].oneWayRtt, MicroSeconds (30), NanoSeconds (1), "Wrong RTT of path 3");
+  NS_TEST_ASSERT_MSG_EQ (m_recvs[1].path, 1, "The second reply is to the probe of path 1");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_recvs[1].oneWayRtt, MicroSeconds (10), NanoSeconds (1), "Wrong RTT of path 1");
+
+  // Only the probe without a reply times out, and its late reply is ignored
+  AdvanceSimulation (Seconds (0.1));
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts.size (), 1, "Only the probe without a reply should time out");
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts[0].path, 2, "The probe of path 2 should time out");
+  Reply (1, MicroSeconds (0), MicroSeconds (10));
+  AdvanceSimulation (MicroSeconds (50));
+  NS_TEST_ASSERT_MSG_EQ (m_recvs.size (), 2, "A reply after the timeout should be ignored");
+}
+
+class TlbProbingIdWrapTestCase : public TlbProbingTestCase
+{
+public:
+  TlbProbingIdWrapTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbProbingIdWrapTestCase::TlbProbingIdWrapTestCase ()
+  : TlbProbingTestCase ("The replies are matched with more than 65536 probes pending")
 {
 }
 
-//
-// This method is the pure virtual method from class TestCase that every
-// TestCase must implement
-//
 void
-TlbProbingTestCase1::DoRun (void)
+TlbProbingIdWrapTestCase::DoRun (void)
+{
+  Build (1);
+  // The first probe is lost and holds the later ones pending until it times out
+  m_probing->SendProbe (0, 1);
+  AdvanceSimulation (MicroSeconds (20));
+  NS_TEST_ASSERT_MSG_EQ (m_probes.size (), 1, "The first probe should be received");
+  m_autoReply = true;
+  const uint32_t probes = 66000;
+  for (uint32_t i = 0; i < probes; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (i), &Ipv4TLBProbing::SendProbe, m_probing, 0, 1);
+    }
+  AdvanceSimulation (MicroSeconds (probes + 50));
+  NS_TEST_ASSERT_MSG_EQ (m_recvs.size (), probes, "Every reply should be reported");
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts.size (), 0, "No probe should time out before the timeout");
+  AdvanceSimulation (Seconds (0.2));
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts.size (), 1, "Only the lost probe should time out");
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts[0].time, Seconds (0.1), "The lost probe should time out ProbeTimeout after it was sent");
+  NS_TEST_ASSERT_MSG_EQ (m_recvs.size (), probes, "No reply should be reported twice");
+}
+
+class TlbProbingTimeoutTestCase : public TlbProbingTestCase
+{
+public:
+  TlbProbingTimeoutTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbProbingTimeoutTestCase::TlbProbingTimeoutTestCase ()
+  : TlbProbingTestCase ("A probe without a reply times out ProbeTimeout after it was sent")
 {
-  // A wide variety of test macros are available in src/core/test.h
-  NS_TEST_ASSERT_MSG_EQ (true, true, "true doesn't equal true for some reason");
-  // Use this one for floating point comparisons
-  NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
+}
+
+void
+TlbProbingTimeoutTestCase::DoRun (void)
+{
+  Build (2);
+  m_probing->SetAttribute ("ProbeTimeout", TimeValue (MicroSeconds (200)));
+  m_probing->SendProbe (0, 1);
+  Simulator::Schedule (MicroSeconds (50), &Ipv4TLBProbing::SendProbe, m_probing, 0, 2);
+  AdvanceSimulation (MicroSeconds (100));
+  NS_TEST_ASSERT_MSG_EQ (m_probes.size (), 2, "The probes should have reached the host");
+
+  // Only the probe of path 2 is replied to
+  Reply (1, MicroSeconds (0), MicroSeconds (10));
+  AdvanceSimulation (MicroSeconds (99));
+  NS_TEST_ASSERT_MSG_EQ (m_recvs.size (), 1, "The reply should be reported");
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts.size (), 0, "No probe should time out before ProbeTimeout");
+
+  AdvanceSimulation (MicroSeconds (1));
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts.size (), 1, "The probe of path 1 should time out");
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts[0].path, 1, "Wrong path timed out");
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts[0].time, MicroSeconds (200), "The probe should time out ProbeTimeout after it was sent");
+
+  AdvanceSimulation (Seconds (1));
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts.size (), 1, "The replied probe should not time out");
+}
+
+class TlbProbingBackoffTestCase : public TlbProbingTestCase
+{
+public:
+  TlbProbingBackoffTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbProbingBackoffTestCase::TlbProbingBackoffTestCase ()
+  : TlbProbingTestCase ("A stable path doubles its probe interval up to MaxProbeInterval, a change resets it")
+{
+}
+
+void
+TlbProbingBackoffTestCase::DoRun (void)
+{
+  Build (1);
+  m_probing->SetAttribute ("Adaptive", BooleanValue (true));
+  m_autoReply = true;
+  m_probing->StartProbe ();
+
+  // The replies arrive 20us after their probes: the one of the probe at 3500us changes
+  Simulator::Schedule (MicroSeconds (3000), &TlbProbingBackoffTestCase::SetReplyRtt, this, MicroSeconds (40));
+  AdvanceSimulation (MicroSeconds (3900));
+
+  // The first reply is not stable, the next ones double the interval from
+  // 100us up to 1ms, and the changed one resets it
+  uint32_t expected[] = {0, 100, 300, 700, 1500, 2500, 3500, 3600, 3800};
+  std::vector<Time> times = GetSendTimes (1);
+  NS_TEST_ASSERT_MSG_EQ (times.size (), 9, "Wrong number of probes");
+  for (uint32_t i = 0; i < 9; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (times[i], MicroSeconds (expected[i]), "Wrong time of probe " << i);
+    }
+}
+
+class TlbProbingBackoffTimeoutTestCase : public TlbProbingTestCase
+{
+public:
+  TlbProbingBackoffTimeoutTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void StopReplies (void);
+};
+
+TlbProbingBackoffTimeoutTestCase::TlbProbingBackoffTimeoutTestCase ()
+  : TlbProbingTestCase ("A probe timeout wakes up a prober sleeping on a backed-off interval")
+{
+}
+
+void
+TlbProbingBackoffTimeoutTestCase::StopReplies (void)
+{
+  m_autoReply = false;
+}
+
+void
+TlbProbingBackoffTimeoutTestCase::DoRun (void)
+{
+  Build (1);
+  m_probing->SetAttribute ("Adaptive", BooleanValue (true));
+  m_probing->SetAttribute ("MaxProbeInterval", TimeValue (MilliSeconds (10)));
+  m_probing->SetAttribute ("ProbeTimeout", TimeValue (MicroSeconds (300)));
+  m_autoReply = true;
+  m_probing->StartProbe ();
+
+  // The probe at 6300us, due again at 12700us, is lost and times out at 6600us
+  Simulator::Schedule (MicroSeconds (6000), &TlbProbingBackoffTimeoutTestCase::StopReplies, this);
+  AdvanceSimulation (MicroSeconds (6650));
+
+  uint32_t expected[] = {0, 100, 300, 700, 1500, 3100, 6300, 6600};
+  std::vector<Time> times = GetSendTimes (1);
+  NS_TEST_ASSERT_MSG_EQ (times.size (), 8, "Wrong number of probes");
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (times[i], MicroSeconds (expected[i]), "Wrong time of probe " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_timeouts.size (), 1, "The lost probe should time out");
+}
+
+class TlbProbingAckFreshnessTestCase : public TlbProbingTestCase
+{
+public:
+  TlbProbingAckFreshnessTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbProbingAckFreshnessTestCase::TlbProbingAckFreshnessTestCase ()
+  : TlbProbingTestCase ("A path which carried a data ACK within AckFreshness is not probed")
+{
+}
+
+void
+TlbProbingAckFreshnessTestCase::DoRun (void)
+{
+  Build (2);
+  m_probing->SetAttribute ("Adaptive", BooleanValue (true));
+  m_autoReply = true;
+
+  // Path 2 carries ACKs at 0us and 50us, fresh until 150us
+  AckPath (2);
+  Simulator::Schedule (MicroSeconds (50), &TlbProbingAckFreshnessTestCase::AckPath, this, 2);
+  m_probing->StartProbe ();
+  AdvanceSimulation (MicroSeconds (250));
+
+  std::vector<Time> times = GetSendTimes (1);
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (times.size (), 2, "Path 1 should be probed");
+  NS_TEST_ASSERT_MSG_EQ (times[0], MicroSeconds (0), "Path 1 should be probed at once");
+  NS_TEST_ASSERT_MSG_EQ (times[1], MicroSeconds (100), "Path 1 should be probed again after the interval");
+  times = GetSendTimes (2);
+  NS_TEST_ASSERT_MSG_EQ (times.size (), 1, "Path 2 should be probed once");
+  NS_TEST_ASSERT_MSG_EQ (times[0], MicroSeconds (200), "Path 2 should be probed on the first round after its ACKs went stale");
+}
+
+class TlbProbingRackTestCase : public TlbProbingTestCase
+{
+public:
+  TlbProbingRackTestCase ();
+
+private:
+  virtual void DoRun (void);
+  // The TLBs the reports went to, each counted
+  static std::multiset<Ptr<Ipv4TLB> > GetTlbs (const std::vector<Report> &reports);
+};
+
+TlbProbingRackTestCase::TlbProbingRackTestCase ()
+  : TlbProbingTestCase ("The probes are reported once to each distinct rack state")
+{
+}
+
+std::multiset<Ptr<Ipv4TLB> >
+TlbProbingRackTestCase::GetTlbs (const std::vector<Report> &reports)
+{
+  std::multiset<Ptr<Ipv4TLB> > tlbs;
+  for (uint32_t i = 0; i < reports.size (); ++i)
+    {
+      tlbs.insert (reports[i].tlb);
+    }
+  return tlbs;
+}
+
+void
+TlbProbingRackTestCase::DoRun (void)
+{
+  Ptr<TLBPathCatalog> catalog = Create<TLBPathCatalog> ();
+  catalog->AddTor (1, CreateObject<Node> ());
+  catalog->AddTor (2, CreateObject<Node> ());
+  catalog->AddAddress (g_source, 1);
+  catalog->AddAddress (g_dest, 2);
+  catalog->Build ();
+  Build (0, catalog);
+  m_probing->SetAttribute ("ProbeTimeout", TimeValue (MicroSeconds (200)));
+
+  // Hosts 0 and 1 share the state of the prober, 2 and 3 share one of
+  // their own, and 4 has its own
+  Ptr<Ipv4TLB> tlbs[5];
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      tlbs[i] = CreateObject<Ipv4TLB> ();
+      tlbs[i]->UsePathCatalog (catalog, 1);
+      node->AggregateObject (tlbs[i]);
+      if (i < 2)
+        {
+          tlbs[i]->ShareRackState (m_tlb);
+        }
+      else if (i == 3)
+        {
+          tlbs[i]->ShareRackState (tlbs[2]);
+        }
+      m_probing->AddRackHost (node);
+    }
+  m_probing->AddRackHost (tlbs[4]->GetObject<Node> ());
+  m_probing->AddRackHost (m_host);
+
+  std::multiset<Ptr<Ipv4TLB> > expected;
+  expected.insert (m_tlb);
+  expected.insert (tlbs[2]);
+  expected.insert (tlbs[4]);
+
+  m_probing->SendProbe (0, 1);
+  m_probing->SendProbe (0, 2);
+  AdvanceSimulation (MicroSeconds (15));
+  Reply (0, MicroSeconds (0), MicroSeconds (10));
+  AdvanceSimulation (MicroSeconds (300));
+
+  NS_TEST_ASSERT_MSG_EQ (m_sends.size (), 6, "Each send should be reported once to each rack state");
+  std::vector<Report> first (m_sends.begin (), m_sends.begin () + 3);
+  NS_TEST_ASSERT_MSG_EQ ((GetTlbs (first) == expected), true, "The send should be reported to each rack state");
+  NS_TEST_ASSERT_MSG_EQ ((GetTlbs (m_recvs) == expected), true, "The reply should be reported once to each rack state");
+  NS_TEST_ASSERT_MSG_EQ ((GetTlbs (m_timeouts) == expected), true, "The timeout should be reported once to each rack state");
+}
+
+class TlbProbingRouteTestCase : public TlbProbingTestCase
+{
+public:
+  TlbProbingRouteTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbProbingRouteTestCase::TlbProbingRouteTestCase ()
+  : TlbProbingTestCase ("A probe on a path of the catalog carries the route of the path")
+{
+}
+
+void
+TlbProbingRouteTestCase::DoRun (void)
+{
+  // ToR 1 and ToR 2 linked through a spine
+  Ptr<Node> tor1 = CreateObject<Node> ();
+  Ptr<Node> tor2 = CreateObject<Node> ();
+  Ptr<Node> spine = CreateObject<Node> ();
+  SimpleNetDeviceHelper simple;
+  simple.Install (NodeContainer (tor1, spine));
+  simple.Install (NodeContainer (spine, tor2));
+  Ptr<TLBPathCatalog> catalog = Create<TLBPathCatalog> ();
+  catalog->AddTor (1, tor1);
+  catalog->AddTor (2, tor2);
+  catalog->AddSwitch (spine);
+  catalog->AddAddress (g_source, 1);
+  catalog->AddAddress (g_dest, 2);
+  catalog->Build ();
+  Build (0, catalog);
+
+  std::vector<uint32_t> paths = catalog->GetPaths (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 1, "There should be one path through the spine");
+  m_probing->SendProbe (0, paths[0]);
+  AdvanceSimulation (MicroSeconds (15));
+
+  NS_TEST_ASSERT_MSG_EQ (m_routes.size (), 1, "The probe should be received");
+  uint32_t nPorts = 0;
+  const uint32_t *ports = catalog->GetRoute (paths[0], nPorts);
+  NS_TEST_ASSERT_MSG_EQ (m_routes[0].GetNHops (), 2, "The probe should carry the two hops of the route");
+  for (uint32_t hop = 0; hop < nPorts; ++hop)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_routes[0].GetPort (hop), ports[hop], "Wrong port of hop " << hop);
+    }
 }
 
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
@@ -60,9 +644,15 @@ TlbProbingTestSuite::TlbProbingTestSuite ()
   : TestSuite ("tlb-probing", UNIT)
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
-  AddTestCase (new TlbProbingTestCase1, TestCase::QUICK);
+  AddTestCase (new TlbProbingReplyTestCase, TestCase::QUICK);
+  AddTestCase (new TlbProbingIdWrapTestCase, TestCase::QUICK);
+  AddTestCase (new TlbProbingTimeoutTestCase, TestCase::QUICK);
+  AddTestCase (new TlbProbingBackoffTestCase, TestCase::QUICK);
+  AddTestCase (new TlbProbingBackoffTimeoutTestCase, TestCase::QUICK);
+  AddTestCase (new TlbProbingAckFreshnessTestCase, TestCase::QUICK);
+  AddTestCase (new TlbProbingRackTestCase, TestCase::QUICK);
+  AddTestCase (new TlbProbingRouteTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
 static TlbProbingTestSuite tlbProbingTestSuite;
-
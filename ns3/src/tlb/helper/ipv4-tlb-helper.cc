@@ -2,10 +2,59 @@
 
 #include "ipv4-tlb-helper.h"
 
+#include "ns3/ipv4-tlb.h"
+#include "ns3/node.h"
+
 namespace ns3 {
 
-/* ... */
+int64_t
+Ipv4TLBHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+    int64_t currentStream = stream;
+    for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+        Ptr<Ipv4TLB> tlb = (*i)->GetObject<Ipv4TLB> ();
+        if (tlb)
+        {
+            currentStream += tlb->AssignStreams (currentStream);
+        }
+    }
+    return (currentStream - stream);
+}
 
+void
+Ipv4TLBHelper::UsePathCatalog (NodeContainer c, Ptr<TLBPathCatalog> catalog, uint32_t sourceTor)
+{
+    for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+        Ptr<Ipv4TLB> tlb = (*i)->GetObject<Ipv4TLB> ();
+        if (tlb)
+        {
+            tlb->UsePathCatalog (catalog, sourceTor);
+        }
+    }
+}
 
+void
+Ipv4TLBHelper::ShareRackState (NodeContainer c)
+{
+    Ptr<Ipv4TLB> first;
+    for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+        Ptr<Ipv4TLB> tlb = (*i)->GetObject<Ipv4TLB> ();
+        if (!tlb)
+        {
+            continue;
+        }
+        if (first)
+        {
+            tlb->ShareRackState (first);
+        }
+        else
+        {
+            first = tlb;
+        }
+    }
 }
 
+}
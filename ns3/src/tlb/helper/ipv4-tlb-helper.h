@@ -2,10 +2,35 @@
 #ifndef TLB_HELPER_H
 #define TLB_HELPER_H
 
+#include "ns3/node-container.h"
+#include "ns3/tlb-path-catalog.h"
+
 namespace ns3 {
 
+class Ipv4TLBHelper
+{
+public:
+    /**
+     * Assign a fixed random variable stream number to the Ipv4TLB
+     * aggregated to each node of the container, nodes without one are
+     * skipped.  Return the number of streams that have been assigned.
+     */
+    static int64_t AssignStreams (NodeContainer c, int64_t stream);
+
+    /**
+     * Make the Ipv4TLB aggregated to each node of the container, all of
+     * them under the source ToR, share the paths of the built catalog.
+     */
+    static void UsePathCatalog (NodeContainer c, Ptr<TLBPathCatalog> catalog, uint32_t sourceTor);
+
+    /**
+     * Make the Ipv4TLB aggregated to each node of the container, all of
+     * them under one ToR and using the same path catalog, share the path state
+     * of the first one.
+     */
+    static void ShareRackState (NodeContainer c);
+};
 
 }
 
 #endif /* TLB_HELPER_H */
-
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ipv4-tlb-path-log.h"
+#include "ipv4-tlb.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/simulator.h"
+#include "ns3/callback.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4TLBPathLog");
+
+const uint32_t Ipv4TLBPathLog::FLAG_NEW_FLOW;
+const uint32_t Ipv4TLBPathLog::FLAG_RANDOM;
+const uint32_t Ipv4TLBPathLog::VERSION;
+const uint32_t Ipv4TLBPathLog::HEADER_SIZE;
+const uint32_t Ipv4TLBPathLog::RECORD_SIZE;
+
+// Records kept in memory before being written
+static const uint32_t BUFFER_RECORDS = 2048;
+
+Ipv4TLBPathLog::Ipv4TLBPathLog ()
+    : m_nDecisions (0)
+{
+    m_buffer.reserve (BUFFER_RECORDS * RECORD_SIZE);
+}
+
+Ipv4TLBPathLog::~Ipv4TLBPathLog ()
+{
+    Ipv4TLBPathLog::Close ();
+}
+
+bool
+Ipv4TLBPathLog::Open (std::string filename)
+{
+    Ipv4TLBPathLog::Close ();
+    m_out.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_out.is_open ())
+    {
+        NS_LOG_ERROR ("Cannot open the path log " << filename);
+        return false;
+    }
+    m_buffer.push_back ('T');
+    m_buffer.push_back ('L');
+    m_buffer.push_back ('B');
+    m_buffer.push_back ('P');
+    Ipv4TLBPathLog::WriteU32 (VERSION);
+    Ipv4TLBPathLog::WriteU32 (RECORD_SIZE);
+    m_nDecisions = 0;
+    return true;
+}
+
+void
+Ipv4TLBPathLog::Close (void)
+{
+    if (m_out.is_open ())
+    {
+        Ipv4TLBPathLog::Flush ();
+        m_out.close ();
+    }
+}
+
+void
+Ipv4TLBPathLog::Connect (Ptr<Ipv4TLB> tlb, uint32_t node)
+{
+    tlb->TraceConnectWithoutContext ("PathDecision",
+            MakeCallback (&Ipv4TLBPathLog::PathDecision, this).Bind (node));
+}
+
+void
+Ipv4TLBPathLog::ConnectAll (void)
+{
+    for (NodeList::Iterator itr = NodeList::Begin (); itr != NodeList::End (); ++itr)
+    {
+        Ptr<Ipv4TLB> tlb = (*itr)->GetObject<Ipv4TLB> ();
+        if (tlb != 0)
+        {
+            Ipv4TLBPathLog::Connect (tlb, (*itr)->GetId ());
+        }
+    }
+}
+
+void
+Ipv4TLBPathLog::PathDecision (uint32_t node, uint32_t flowId, uint32_t fromTor, uint32_t toTor,
+                              uint32_t newPath, uint32_t oldPath, bool isNewFlow, bool isRandom)
+{
+    if (!m_out.is_open ())
+    {
+        return;
+    }
+    uint32_t flags = (isNewFlow ? FLAG_NEW_FLOW : 0) | (isRandom ? FLAG_RANDOM : 0);
+    Ipv4TLBPathLog::WriteU64 (static_cast<uint64_t> (Simulator::Now ().GetNanoSeconds ()));
+    Ipv4TLBPathLog::WriteU32 (node);
+    Ipv4TLBPathLog::WriteU32 (flowId);
+    Ipv4TLBPathLog::WriteU32 (fromTor);
+    Ipv4TLBPathLog::WriteU32 (toTor);
+    Ipv4TLBPathLog::WriteU32 (newPath);
+    Ipv4TLBPathLog::WriteU32 (oldPath);
+    Ipv4TLBPathLog::WriteU32 (flags);
+    m_nDecisions++;
+    if (m_buffer.size () >= BUFFER_RECORDS * RECORD_SIZE)
+    {
+        Ipv4TLBPathLog::Flush ();
+    }
+}
+
+uint64_t
+Ipv4TLBPathLog::GetNDecisions (void) const
+{
+    return m_nDecisions;
+}
+
+void
+Ipv4TLBPathLog::WriteU32 (uint32_t value)
+{
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        m_buffer.push_back (static_cast<uint8_t> (value >> (8 * i)));
+    }
+}
+
+void
+Ipv4TLBPathLog::WriteU64 (uint64_t value)
+{
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        m_buffer.push_back (static_cast<uint8_t> (value >> (8 * i)));
+    }
+}
+
+void
+Ipv4TLBPathLog::Flush (void)
+{
+    if (!m_buffer.empty ())
+    {
+        m_out.write (reinterpret_cast<const char *> (&m_buffer[0]), m_buffer.size ());
+        m_buffer.clear ();
+    }
+    m_out.flush ();
+}
+
+static uint64_t
+ReadLe (const uint8_t *data, uint32_t size)
+{
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        value |= static_cast<uint64_t> (data[i]) << (8 * i);
+    }
+    return value;
+}
+
+bool
+Ipv4TLBPathLog::Read (std::string filename, std::vector<TLBPathDecision> &decisions)
+{
+    std::ifstream in (filename.c_str (), std::ios::in | std::ios::binary);
+    uint8_t data[RECORD_SIZE];
+    if (!in.read (reinterpret_cast<char *> (data), HEADER_SIZE)
+            || data[0] != 'T' || data[1] != 'L' || data[2] != 'B' || data[3] != 'P'
+            || ReadLe (data + 4, 4) != VERSION || ReadLe (data + 8, 4) != RECORD_SIZE)
+    {
+        NS_LOG_ERROR ("Not a path log " << filename);
+        return false;
+    }
+    while (in.read (reinterpret_cast<char *> (data), RECORD_SIZE))
+    {
+        TLBPathDecision decision;
+        decision.time = static_cast<int64_t> (ReadLe (data, 8));
+        decision.node = ReadLe (data + 8, 4);
+        decision.flowId = ReadLe (data + 12, 4);
+        decision.fromTor = ReadLe (data + 16, 4);
+        decision.toTor = ReadLe (data + 20, 4);
+        decision.newPath = ReadLe (data + 24, 4);
+        decision.oldPath = ReadLe (data + 28, 4);
+        decision.flags = ReadLe (data + 32, 4);
+        decisions.push_back (decision);
+    }
+    // A truncated last record means the log was not closed
+    return in.gcount () == 0;
+}
+
+}
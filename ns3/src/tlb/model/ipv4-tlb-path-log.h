@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TLB_PATH_LOG_H
+#define TLB_PATH_LOG_H
+
+#include "ns3/ptr.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class Ipv4TLB;
+
+struct TLBPathDecision {
+    int64_t time;      // Nanoseconds
+    uint32_t node;
+    uint32_t flowId;
+    uint32_t fromTor;
+    uint32_t toTor;
+    uint32_t newPath;
+    uint32_t oldPath;  // Equal to newPath for a new flow
+    uint32_t flags;
+};
+
+/**
+ * \brief Binary sink of the Ipv4TLB PathDecision trace
+ *
+ * Every path selection or change is written as a fixed 36 bytes
+ * little-endian record: time (int64, ns), node, flow id, from tor,
+ * to tor, new path, old path and flags (uint32 each), after a 12 bytes
+ * header: "TLBP", the version and the record size (uint32 each).
+ * Records are buffered and written in blocks, so that logging every
+ * decision of a large simulation costs far less than the text traces.
+ * The file can be read back with Read or, e.g., with numpy and the
+ * dtype "<i8,<u4,<u4,<u4,<u4,<u4,<u4,<u4" after an offset of 12.
+ */
+class Ipv4TLBPathLog
+{
+public:
+
+    static const uint32_t FLAG_NEW_FLOW = 1;
+    static const uint32_t FLAG_RANDOM = 2;
+
+    static const uint32_t VERSION = 1;
+    static const uint32_t HEADER_SIZE = 12;
+    static const uint32_t RECORD_SIZE = 36;
+
+    Ipv4TLBPathLog ();
+
+    ~Ipv4TLBPathLog ();
+
+    bool Open (std::string filename);
+
+    void Close (void);
+
+    // The log must outlive the connected Ipv4TLB objects or be closed before the simulation runs on
+    void Connect (Ptr<Ipv4TLB> tlb, uint32_t node);
+
+    // Connects every Ipv4TLB aggregated to a node of the NodeList
+    void ConnectAll (void);
+
+    void PathDecision (uint32_t node, uint32_t flowId, uint32_t fromTor, uint32_t toTor,
+                       uint32_t newPath, uint32_t oldPath, bool isNewFlow, bool isRandom);
+
+    uint64_t GetNDecisions (void) const;
+
+    static bool Read (std::string filename, std::vector<TLBPathDecision> &decisions);
+
+private:
+
+    Ipv4TLBPathLog (const Ipv4TLBPathLog&);
+    Ipv4TLBPathLog &operator = (const Ipv4TLBPathLog&);
+
+    void WriteU32 (uint32_t value);
+    void WriteU64 (uint64_t value);
+    void Flush (void);
+
+    std::ofstream m_out;
+
+    std::vector<uint8_t> m_buffer;
+
+    uint64_t m_nDecisions;
+};
+
+}
+
+#endif /* TLB_PATH_LOG_H */
@@ -64,9 +64,14 @@ Ipv4TLB::Ipv4TLB ():
     // Added at Jan 12nd
     m_flowletTimeout (MicroSeconds (5000000)),
     m_rttAlpha(1.0),
-    m_ecnBeta(0.0)
+    m_ecnBeta(0.0),
+    m_rackStateDelay (Time (0)),
+    m_registry (Create<TLBTorRegistry> ()),
+    m_rack (Create<TLBRackState> ())
 {
     NS_LOG_FUNCTION (this);
+    m_agingTick.SetFunction (MakeCallback (&Ipv4TLB::PathAging, this));
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLB::Ipv4TLB (const Ipv4TLB &other):
@@ -111,9 +116,14 @@ Ipv4TLB::Ipv4TLB (const Ipv4TLB &other):
     */
     m_flowletTimeout (other.m_flowletTimeout),
     m_rttAlpha (other.m_rttAlpha),
-    m_ecnBeta (other.m_ecnBeta)
+    m_ecnBeta (other.m_ecnBeta),
+    m_rackStateDelay (other.m_rackStateDelay),
+    m_registry (Create<TLBTorRegistry> ()),
+    m_rack (Create<TLBRackState> ())
 {
     NS_LOG_FUNCTION (this);
+    m_agingTick.SetFunction (MakeCallback (&Ipv4TLB::PathAging, this));
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 TypeId
@@ -179,6 +189,11 @@ Ipv4TLB::GetTypeId (void)
                       TimeValue (MicroSeconds (500)),
                       MakeTimeAccessor (&Ipv4TLB::m_flowletTimeout),
                       MakeTimeChecker ())
+        .AddAttribute ("RackStateDelay", "The delay before the feedback of the flows and probes reaches the path state, "
+                      "like the reports to a rack agent when the hosts under a ToR share their path state",
+                      TimeValue (Time (0)),
+                      MakeTimeAccessor (&Ipv4TLB::m_rackStateDelay),
+                      MakeTimeChecker (Time (0)))
       .AddAttribute ("RespondToFailure", "Whether TLB reacts to failure",
                      BooleanValue (false),
                      MakeBooleanAccessor (&Ipv4TLB::m_respondToFailure),
@@ -219,6 +234,10 @@ Ipv4TLB::GetTypeId (void)
                          "When the flow changes the path",
                          MakeTraceSourceAccessor (&Ipv4TLB::m_pathChangeTrace),
                          "ns3::Ipv4TLB::TLBPathChangeCallback")
+        .AddTraceSource ("PathDecision",
+                         "When the new flow is assigned the path or the flow changes the path, without the path infos",
+                         MakeTraceSourceAccessor (&Ipv4TLB::m_pathDecisionTrace),
+                         "ns3::Ipv4TLB::TLBPathDecisionCallback")
     ;
 
     return tid;
@@ -227,20 +246,93 @@ Ipv4TLB::GetTypeId (void)
 void
 Ipv4TLB::AddAddressWithTor (Ipv4Address address, uint32_t torId)
 {
-    m_ipTorMap[address] = torId;
+    if (m_catalog != 0)
+    {
+        NS_FATAL_ERROR ("Cannot add address " << address << " to a host using a path catalog, "
+                        "add it to the catalog before building it");
+    }
+    m_registry->AddAddress (address, torId);
 }
 
 void
 Ipv4TLB::AddAvailPath (uint32_t destTor, uint32_t path)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    if (m_catalog != 0)
+    {
+        NS_FATAL_ERROR ("Cannot add path " << path << " to a host using a path catalog, "
+                        "the paths of a catalog are the ones it finds when it is built");
+    }
+    if (m_registry->FindPath (m_registry->GetTorIndex (destTor), path) != TLBTorRegistry::NONE)
+    {
+        NS_LOG_ERROR ("Path " << path << " to tor " << destTor << " is already available");
+        return;
+    }
+    uint32_t torIndex = m_registry->AddTor (destTor);
+    m_registry->AddPath (torIndex, path);
+    m_rack->pathInfo.resize (m_registry->GetNSlots ());
+    m_rack->hasPathInfo.resize (m_registry->GetNSlots (), false);
+    m_rack->ackTime.resize (m_registry->GetNSlots (), Time (-1));
+    m_rack->scoreboards.resize (m_registry->GetNTors ());
+
+    struct PathInfo pathInfo = Ipv4TLB::JudgePath (torIndex, path);
+    m_rack->scoreboards[torIndex].AddPath (path, pathInfo.pathType,
+            Ipv4TLB::RankPath (pathInfo.counter, pathInfo.rttMin), pathInfo.rttMin);
+}
+
+void
+Ipv4TLB::UsePathCatalog (Ptr<TLBPathCatalog> catalog, uint32_t sourceTor)
+{
+    m_registry = catalog->GetRegistry (sourceTor);
+    m_catalog = catalog;
+    Ipv4TLB::ResetPathState ();
+}
+
+const uint32_t *
+Ipv4TLB::GetRoute (uint32_t path, uint32_t &nPorts) const
+{
+    if (m_catalog == 0)
+    {
+        nPorts = 0;
+        return 0;
+    }
+    return m_catalog->GetRoute (path, nPorts);
+}
+
+void
+Ipv4TLB::ShareRackState (Ptr<Ipv4TLB> tlb)
+{
+    if (m_registry != tlb->m_registry)
     {
-        std::vector<uint32_t> paths;
-        m_availablePath[destTor] = paths;
-        itr = m_availablePath.find (destTor);
+        NS_FATAL_ERROR ("Only the hosts under a ToR using the same path catalog can share their path state");
+    }
+    m_rack = tlb->m_rack;
+}
+
+bool
+Ipv4TLB::IsRackStateSharedWith (Ptr<Ipv4TLB> tlb) const
+{
+    return m_rack == tlb->m_rack;
+}
+
+void
+Ipv4TLB::ResetPathState (void)
+{
+    m_rack = Create<TLBRackState> ();
+    m_rack->pathInfo.assign (m_registry->GetNSlots (), TLBPathInfo ());
+    m_rack->hasPathInfo.assign (m_registry->GetNSlots (), false);
+    m_rack->ackTime.assign (m_registry->GetNSlots (), Time (-1));
+    m_rack->scoreboards.assign (m_registry->GetNTors (), TLBPathScoreboard ());
+    for (uint32_t torIndex = 0; torIndex < m_registry->GetNTors (); ++torIndex)
+    {
+        const std::vector<uint32_t> &slots = m_registry->GetSlots (torIndex);
+        for (std::vector<uint32_t>::const_iterator itr = slots.begin (); itr != slots.end (); ++itr)
+        {
+            uint32_t path = m_registry->GetPath (*itr);
+            struct PathInfo pathInfo = Ipv4TLB::JudgePath (torIndex, path);
+            m_rack->scoreboards[torIndex].AddPath (path, pathInfo.pathType,
+                    Ipv4TLB::RankPath (pathInfo.counter, pathInfo.rttMin), pathInfo.rttMin);
+        }
     }
-    (itr->second).push_back (path);
 }
 
 std::vector<uint32_t>
@@ -254,12 +346,11 @@ Ipv4TLB::GetAvailPath (Ipv4Address daddr)
         return emptyVector;
     }
 
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    if (destTor >= m_rack->scoreboards.size ())
     {
         return emptyVector;
     }
-    return itr->second;
+    return m_rack->scoreboards[destTor].GetPaths ();
 }
 
 uint32_t
@@ -337,14 +428,16 @@ Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
 uint32_t
 Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
 {
-    if (!m_agingEvent.IsRunning ())
+    if (!m_agingTick.IsRunning ())
     {
-        m_agingEvent = Simulator::Schedule (m_agingCheckTime, &Ipv4TLB::PathAging, this);
+        m_agingTick.SetPeriod (m_agingCheckTime);
+        m_agingTick.Start ();
     }
 
-    if (!m_dreEvent.IsRunning ())
+    if (!m_rack->dreRunning)
     {
-        m_dreEvent = Simulator::Schedule (m_dreTime, &Ipv4TLB::DreAging, this);
+        m_rack->dreRunning = true;
+        m_rack->dreStart = Simulator::Now ();
     }
 
     uint32_t destTor = 0;
@@ -355,9 +448,14 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
     }
 
     uint32_t sourceTor = 0;
-    if (!Ipv4TLB::FindTorId (saddr, sourceTor))
+    if (Ipv4TLB::FindTorId (saddr, sourceTor))
+    {
+        sourceTor = m_registry->GetTorId (sourceTor);
+    }
+    else
     {
         NS_LOG_ERROR ("Cannot find source tor id based on the given source address");
+        sourceTor = 0;
     }
 
     std::map<uint32_t, TLBFlowInfo>::iterator flowItr = m_flowInfo.find (flowId);
@@ -369,12 +467,12 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
         struct PathInfo newPath;
         if (Ipv4TLB::WhereToChange (destTor, newPath, false, 0))
         {
-            m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, false, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            Ipv4TLB::TracePathSelect (flowId, sourceTor, destTor, newPath, false);
         }
         else
         {
             newPath = Ipv4TLB::SelectRandomPath (destTor);
-            m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, true, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            Ipv4TLB::TracePathSelect (flowId, sourceTor, destTor, newPath, true);
         }
         Ipv4TLB::UpdateFlowPath (flowId, newPath.pathId, destTor);
         Ipv4TLB::AssignFlowToPath (flowId, destTor, newPath.pathId);
@@ -397,7 +495,7 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
             {
                 if (newPath.pathId != oldPath)
                 {
-                    m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                    Ipv4TLB::TracePathChange (flowId, sourceTor, destTor, newPath.pathId, oldPath, false);
                 }
             }
             else
@@ -405,7 +503,7 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                 newPath = Ipv4TLB::SelectRandomPath (destTor);
                 if (newPath.pathId != oldPath)
                 {
-                    m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, true, Ipv4TLB::GatherParallelPaths (destTor));
+                    Ipv4TLB::TracePathChange (flowId, sourceTor, destTor, newPath.pathId, oldPath, true);
                 }
             }
 
@@ -425,7 +523,7 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                 /*&& ((static_cast<double> ((flowItr->second).ecnSize) / (flowItr->second).size > m_ecnPortionHigh && Simulator::Now () - (flowItr->second).timeStamp >= m_T) || (flowItr->second).retransmissionSize > m_flowRetransHigh)*/
                 && Simulator::Now() - (flowItr->second).tryChangePath > MicroSeconds (100))
         {
-            if (rand () % RANDOM_BASE < static_cast<int> (RANDOM_BASE - m_pathChangePoss))
+            if (static_cast<int> (m_rand->GetInteger (0, RANDOM_BASE - 1)) < static_cast<int> (RANDOM_BASE - m_pathChangePoss))
             {
                 (flowItr->second).tryChangePath = Simulator::Now ();
                 return oldPath;
@@ -438,7 +536,7 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                     return oldPath;
                 }
 
-                m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                Ipv4TLB::TracePathChange (flowId, sourceTor, destTor, newPath.pathId, oldPath, false);
 
                 // Calculate the pause time
                 Time pauseTime = oldPathInfo.rttMin - newPath.rttMin;
@@ -514,7 +612,14 @@ Ipv4TLB::FlowSend (uint32_t flowId, Ipv4Address daddr, uint32_t path, uint32_t s
         return;
     }
 
-    Ipv4TLB::SendPath (destTor, path, size);
+    if (m_rackStateDelay.IsZero ())
+    {
+        Ipv4TLB::SendPath (destTor, path, size);
+    }
+    else
+    {
+        Simulator::Schedule (m_rackStateDelay, &Ipv4TLB::SendPath, this, destTor, path, size);
+    }
 
     if (isRetransmission)
     {
@@ -528,7 +633,14 @@ Ipv4TLB::FlowSend (uint32_t flowId, Ipv4Address daddr, uint32_t path, uint32_t s
         }
         if (needRetransPath)
         {
-            Ipv4TLB::RetransPath (destTor, path, needHighRetransPath);
+            if (m_rackStateDelay.IsZero ())
+            {
+                Ipv4TLB::RetransPath (destTor, path, needHighRetransPath);
+            }
+            else
+            {
+                Simulator::Schedule (m_rackStateDelay, &Ipv4TLB::RetransPath, this, destTor, path, needHighRetransPath);
+            }
         }
     }
 }
@@ -549,7 +661,14 @@ Ipv4TLB::FlowTimeout (uint32_t flowId, Ipv4Address daddr, uint32_t path)
     {
         NS_LOG_LOGIC ("The flow has changed the path");
     }
-    Ipv4TLB::TimeoutPath (destTor, path, false, isVeryTimeout);
+    if (m_rackStateDelay.IsZero ())
+    {
+        Ipv4TLB::TimeoutPath (destTor, path, false, isVeryTimeout);
+    }
+    else
+    {
+        Simulator::Schedule (m_rackStateDelay, &Ipv4TLB::TimeoutPath, this, destTor, path, false, isVeryTimeout);
+    }
 }
 
 void
@@ -581,14 +700,7 @@ Ipv4TLB::ProbeSend (Ipv4Address daddr, uint32_t path)
         NS_LOG_ERROR ("Cannot find dest tor id based on the given dest address");
         return;
     }
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    if (itr == m_pathInfo.end ())
-    {
-        m_pathInfo[key] = Ipv4TLB::GetInitPathInfo (path);
-    }
-
+    Ipv4TLB::InsertPathInfo (destTor, path);
 }
 
 void
@@ -604,6 +716,39 @@ Ipv4TLB::ProbeRecv (uint32_t path, Ipv4Address daddr, uint32_t size, bool withEC
     Ipv4TLB::PacketReceive (0, path, destTor, size, withECN, rtt, true);
 }
 
+bool
+Ipv4TLB::GetLastAckTime (Ipv4Address daddr, uint32_t path, Time &ackTime)
+{
+    uint32_t destTor = 0;
+    if (!Ipv4TLB::FindTorId (daddr, destTor))
+    {
+        return false;
+    }
+    uint32_t slot = m_registry->FindPath (destTor, path);
+    if (slot == TLBTorRegistry::NONE)
+    {
+        return false;
+    }
+    return Ipv4TLB::GetLastAckTime (slot, ackTime);
+}
+
+bool
+Ipv4TLB::GetLastAckTime (uint32_t slot, Time &ackTime) const
+{
+    if (m_rack->ackTime[slot].IsStrictlyNegative ())
+    {
+        return false;
+    }
+    ackTime = m_rack->ackTime[slot];
+    return true;
+}
+
+const TLBTorRegistry &
+Ipv4TLB::GetRegistry (void) const
+{
+    return *m_registry;
+}
+
 void
 Ipv4TLB::ProbeTimeout (uint32_t path, Ipv4Address daddr)
 {   uint32_t destTor = 0;
@@ -613,7 +758,14 @@ Ipv4TLB::ProbeTimeout (uint32_t path, Ipv4Address daddr)
         return;
     }
 
-    Ipv4TLB::TimeoutPath (path, destTor, true, false);
+    if (m_rackStateDelay.IsZero ())
+    {
+        Ipv4TLB::TimeoutPath (destTor, path, true, false);
+    }
+    else
+    {
+        Simulator::Schedule (m_rackStateDelay, &Ipv4TLB::TimeoutPath, this, destTor, path, true, false);
+    }
 }
 
 
@@ -623,6 +775,14 @@ Ipv4TLB::SetNode (Ptr<Node> node)
     m_node = node;
 }
 
+int64_t
+Ipv4TLB::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
 void
 Ipv4TLB::PacketReceive (uint32_t flowId, uint32_t path, uint32_t destTorId,
                         uint32_t size, bool withECN, Time rtt, bool isProbing)
@@ -637,7 +797,24 @@ Ipv4TLB::PacketReceive (uint32_t flowId, uint32_t path, uint32_t destTorId,
             NS_LOG_LOGIC ("The flow has changed the path");
         }
     }
-    Ipv4TLB::UpdatePathInfo (destTorId, path, size, withECN, rtt);
+
+    TLBPathFeedback feedback;
+    feedback.destTor = destTorId;
+    feedback.path = path;
+    feedback.size = size;
+    feedback.withECN = withECN;
+    feedback.rtt = rtt;
+    feedback.isProbing = isProbing;
+
+    // The path state only learns of the packet after m_rackStateDelay, if any
+    if (m_rackStateDelay.IsZero ())
+    {
+        Ipv4TLB::UpdatePathInfo (feedback);
+    }
+    else
+    {
+        Simulator::Schedule (m_rackStateDelay, &Ipv4TLB::UpdatePathInfo, this, feedback);
+    }
 }
 
 bool
@@ -699,21 +876,26 @@ Ipv4TLB::UpdateFlowInfo (uint32_t flowId, uint32_t path, uint32_t size, bool wit
 }
 
 void
-Ipv4TLB::UpdatePathInfo (uint32_t destTor, uint32_t path, uint32_t size, bool withECN, Time rtt)
+Ipv4TLB::UpdatePathInfo (TLBPathFeedback feedback)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
+    uint32_t path = feedback.path;
+    uint32_t size = feedback.size;
+    bool withECN = feedback.withECN;
+    Time rtt = feedback.rtt;
 
-    TLBPathInfo pathInfo;
-    if (itr == m_pathInfo.end ())
+    uint32_t slot = Ipv4TLB::InsertPathInfo (feedback.destTor, path);
+    if (slot == TLBTorRegistry::NONE)
     {
-        pathInfo = Ipv4TLB::GetInitPathInfo (path);
+        NS_LOG_LOGIC ("Path " << path << " is not available");
+        return;
     }
-    else
+
+    if (!feedback.isProbing)
     {
-        pathInfo = itr->second;
+        m_rack->ackTime[slot] = Simulator::Now ();
     }
 
+    TLBPathInfo &pathInfo = m_rack->pathInfo[slot];
     pathInfo.size += size;
     if (withECN)
     {
@@ -751,7 +933,7 @@ Ipv4TLB::UpdatePathInfo (uint32_t destTor, uint32_t path, uint32_t size, bool wi
     */
     // --
 
-    m_pathInfo[key] = pathInfo;
+    Ipv4TLB::ScorePath (slot);
 }
 
 bool
@@ -796,16 +978,15 @@ Ipv4TLB::SendFlow (uint32_t flowId, uint32_t path, uint32_t size)
 void
 Ipv4TLB::SendPath (uint32_t destTor, uint32_t path, uint32_t size)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    if (itr == m_pathInfo.end ())
+    uint32_t slot = Ipv4TLB::FindPathInfo (destTor, path);
+    if (slot == TLBTorRegistry::NONE)
     {
         NS_LOG_ERROR ("Cannot send a non-existing path");
         return;
     }
 
-    (itr->second).dreValue += size;
+    Ipv4TLB::DreAging (m_rack->pathInfo[slot]);
+    m_rack->pathInfo[slot].dreValue += size;
 }
 
 bool
@@ -843,42 +1024,42 @@ Ipv4TLB::RetransFlow (uint32_t flowId, uint32_t path, uint32_t size, bool &needR
 void
 Ipv4TLB::TimeoutPath (uint32_t destTor, uint32_t path, bool isProbing, bool isVeryTimeout)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    uint32_t slot = Ipv4TLB::FindPathInfo (destTor, path);
+    if (slot == TLBTorRegistry::NONE)
     {
         NS_LOG_ERROR ("Cannot timeout a non-existing path");
         return;
     }
     if (!isProbing)
     {
-        (itr->second).isTimeout = true;
+        m_rack->pathInfo[slot].isTimeout = true;
         if (isVeryTimeout)
         {
-            (itr->second).isVeryTimeout = true;
+            m_rack->pathInfo[slot].isVeryTimeout = true;
         }
     }
     else
     {
-        (itr->second).isProbingTimeout = true;
+        m_rack->pathInfo[slot].isProbingTimeout = true;
     }
+    Ipv4TLB::ScorePath (slot);
 }
 
 void
 Ipv4TLB::RetransPath (uint32_t destTor, uint32_t path, bool needHighRetransPath)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    uint32_t slot = Ipv4TLB::FindPathInfo (destTor, path);
+    if (slot == TLBTorRegistry::NONE)
     {
         NS_LOG_ERROR ("Cannot timeout a non-existing path");
         return;
     }
-    (itr->second).isRetransmission = true;
+    m_rack->pathInfo[slot].isRetransmission = true;
     if (needHighRetransPath)
     {
-        (itr->second).isHighRetransmission = true;
+        m_rack->pathInfo[slot].isHighRetransmission = true;
     }
+    Ipv4TLB::ScorePath (slot);
 }
 
 void
@@ -934,6 +1115,7 @@ Ipv4TLB::GetInitPathInfo (uint32_t path)
     pathInfo.timeStamp2 = Simulator::Now ();
     pathInfo.timeStamp3 = Simulator::Now ();
     pathInfo.dreValue = 0;
+    pathInfo.dreEpoch = Ipv4TLB::GetDreEpoch ();
 
     // Added Jan 11st
     // Path ECN portion default value
@@ -950,336 +1132,132 @@ Ipv4TLB::GetInitPathInfo (uint32_t path)
 void
 Ipv4TLB::AssignFlowToPath (uint32_t flowId, uint32_t destTor, uint32_t path)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    TLBPathInfo pathInfo;
-    if (itr == m_pathInfo.end ())
+    uint32_t slot = Ipv4TLB::InsertPathInfo (destTor, path);
+    if (slot == TLBTorRegistry::NONE)
     {
-        pathInfo = Ipv4TLB::GetInitPathInfo (path);
-    }
-    else
-    {
-        pathInfo = itr->second;
+        NS_LOG_LOGIC ("Path " << path << " is not available");
+        return;
     }
 
-    pathInfo.flowCounter ++;
-    m_pathInfo[key] = pathInfo;
+    m_rack->pathInfo[slot].flowCounter ++;
+    Ipv4TLB::ScorePath (slot);
 }
 
 void
 Ipv4TLB::RemoveFlowFromPath (uint32_t flowId, uint32_t destTor, uint32_t path)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    uint32_t slot = Ipv4TLB::FindPathInfo (destTor, path);
+    if (slot == TLBTorRegistry::NONE)
     {
         NS_LOG_ERROR ("Cannot remove flow from a non-existing path");
         return;
     }
-    if ((itr->second).flowCounter == 0)
+    if (m_rack->pathInfo[slot].flowCounter == 0)
     {
         NS_LOG_ERROR ("Cannot decrease from counter while it has reached 0");
         return;
     }
-    (itr->second).flowCounter --;
-
+    m_rack->pathInfo[slot].flowCounter --;
+    Ipv4TLB::ScorePath (slot);
 }
 
 bool
 Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, uint32_t oldPath)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-
-    if (itr == m_availablePath.end ())
+    if (destTor >= m_rack->scoreboards.size () || m_rack->scoreboards[destTor].GetNPaths () == 0)
     {
         NS_LOG_ERROR ("Cannot find available paths");
         return false;
     }
-
-    std::vector<uint32_t>::iterator vectorItr = (itr->second).begin ();
+    const TLBPathScoreboard &scoreboard = m_rack->scoreboards[destTor];
 
     // Firstly, checking good path
-    uint32_t minCounter = std::numeric_limits<uint32_t>::max ();
-    Time minRTT = Seconds (666);
-    uint32_t minRTTLevel = 5;
-    uint32_t minDre = std::pow (2, m_dreQ);
-    std::vector<PathInfo> candidatePaths;
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
-    {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
-        if (pathInfo.pathType == GoodPath)
-        {
-            if (m_runMode == TLB_RUNMODE_COUNTER)
-            {
-                if (pathInfo.counter <= minCounter)
-                {
-                    if (pathInfo.counter < minCounter)
-                    {
-                        candidatePaths.clear ();
-                        minCounter = pathInfo.counter;
-                    }
-                    candidatePaths.push_back (pathInfo);
-                }
-            }
-            else if (m_runMode == TLB_RUNMODE_MINRTT)
-            {
-                if (pathInfo.rttMin <= minRTT)
-                {
-                    if (pathInfo.rttMin < minRTT)
-                    {
-                        candidatePaths.clear ();
-                        minRTT = pathInfo.rttMin;
-                    }
-                    candidatePaths.push_back (pathInfo);
-                }
-            }
-            else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
-            {
-                uint32_t RTTLevel = Ipv4TLB::QuantifyRtt (pathInfo.rttMin);
-                if (RTTLevel < minRTTLevel)
-                {
-                    minRTTLevel = RTTLevel;
-                    minCounter = std::numeric_limits<uint32_t>::max ();
-                    candidatePaths.clear ();
-                }
-                if (RTTLevel == minRTTLevel)
-                {
-
-                    if (m_runMode == TLB_RUNMODE_RTT_DRE)
-                    {
-                        if (pathInfo.counter < minCounter)
-                        {
-                            minCounter = pathInfo.counter;
-                            candidatePaths.clear ();
-                        }
-                        if (pathInfo.counter == minCounter)
-                        {
-                            candidatePaths.push_back (pathInfo);
-                        }
-                    }
-                    else if (m_runMode == TLB_RUNMODE_RTT_DRE)
-                    {
-                        if (pathInfo.quantifiedDre < minDre)
-                        {
-                            minDre = pathInfo.quantifiedDre;
-                            candidatePaths.clear ();
-                        }
-                        if (pathInfo.quantifiedDre == minDre)
-                        {
-                            candidatePaths.push_back (pathInfo);
-                        }
-                    }
-                }
-            }
-            else
-            {
-                candidatePaths.push_back (pathInfo);
-            }
-        }
-    }
-
-    if (!candidatePaths.empty ())
+    if (Ipv4TLB::SelectBestPath (destTor, scoreboard, GoodPath, Time::Max (), newPath))
     {
-        if (m_runMode == TLB_RUNMODE_COUNTER)
-        {
-            if (minCounter <= m_K)
-            {
-                newPath = candidatePaths[rand () % candidatePaths.size ()];
-            }
-        }
-        else if (m_runMode == TLB_RUNMODE_MINRTT)
-        {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
-        }
-        else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
-        {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
-        }
-        else
-        {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
-        }
         NS_LOG_LOGIC ("Find Good Path: " << newPath.pathId);
         return true;
     }
 
     // Secondly, checking grey path
-    struct PathInfo originalPath;
+    Time originalRtt = Seconds (666);
     if (hasOldPath)
     {
-        originalPath = JudgePath (destTor, oldPath);
+        originalRtt = Ipv4TLB::JudgePath (destTor, oldPath).rttMin;
     }
-    else
+
+    // Only the paths with an RTT lower than the original one by m_betterPathRttThresh
+    Time maxRtt = originalRtt - m_betterPathRttThresh;
+    if (Ipv4TLB::SelectBestPath (destTor, scoreboard, GreyPath, maxRtt, newPath))
     {
-        originalPath.pathType = GreyPath;
-        originalPath.rttMin = Seconds (666);
-        originalPath.ecnPortion = 1;
-        originalPath.counter = std::numeric_limits<uint32_t>::max ();
-        originalPath.quantifiedDre = std::pow (2, m_dreQ);
+        NS_LOG_LOGIC ("Find Grey Path: " << newPath.pathId);
+        return true;
     }
 
-    minCounter = std::numeric_limits<uint32_t>::max ();
-    minRTT = Seconds (666);
-    minDre = std::pow (2, m_dreQ);
-    candidatePaths.clear ();
-    vectorItr = (itr->second).begin ();
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    // Thirdly, checking bad path
+    uint32_t pathId = 0;
+    if (scoreboard.GetBest (BadPath, maxRtt, 0, pathId))
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
-        if (pathInfo.pathType == GreyPath
-            && Ipv4TLB::PathLIsBetterR (pathInfo, originalPath))
-        {
-            if (m_runMode == TLB_RUNMODE_COUNTER)
-            {
-                if (pathInfo.counter <= minCounter)
-                {
-                    if (pathInfo.counter < minCounter)
-                    {
-                        candidatePaths.clear ();
-                        minCounter = pathInfo.counter;
-                    }
-                    candidatePaths.push_back (pathInfo);
-                }
-            }
-            else if (m_runMode == TLB_RUNMODE_MINRTT)
-            {
-                if (pathInfo.rttMin <= minRTT)
-                {
-                    if (pathInfo.rttMin < minRTT)
-                    {
-                        candidatePaths.clear ();
-                        minRTT = pathInfo.rttMin;
-                    }
-                    candidatePaths.push_back (pathInfo);
-                }
-            }
-            else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
-            {
-                uint32_t RTTLevel = Ipv4TLB::QuantifyRtt (pathInfo.rttMin);
-                if (RTTLevel < minRTTLevel)
-                {
-                    minRTTLevel = RTTLevel;
-                    minCounter = std::numeric_limits<uint32_t>::max ();
-                    candidatePaths.clear ();
-                }
-                if (RTTLevel == minRTTLevel)
-                {
-
-                    if (m_runMode == TLB_RUNMODE_RTT_DRE)
-                    {
-                        if (pathInfo.counter < minCounter)
-                        {
-                            minCounter = pathInfo.counter;
-                            candidatePaths.clear ();
-                        }
-                        if (pathInfo.counter == minCounter)
-                        {
-                            candidatePaths.push_back (pathInfo);
-                        }
-                    }
-                    else if (m_runMode == TLB_RUNMODE_RTT_DRE)
-                    {
-                        if (pathInfo.quantifiedDre < minDre)
-                        {
-                            minDre = pathInfo.quantifiedDre;
-                            candidatePaths.clear ();
-                        }
-                        if (pathInfo.quantifiedDre == minDre)
-                        {
-                            candidatePaths.push_back (pathInfo);
-                        }
-                    }
-                }
-            }
-            else
-            {
-                candidatePaths.push_back (pathInfo);
-            }
-        }
+        newPath = Ipv4TLB::JudgePath (destTor, pathId);
+        NS_LOG_LOGIC ("Find Bad Path: " << newPath.pathId);
+        return true;
     }
 
-    if (!candidatePaths.empty ())
+    // Thirdly, indicating no paths available
+    NS_LOG_LOGIC ("No Path Returned");
+    return false;
+}
+
+bool
+Ipv4TLB::SelectBestPath (uint32_t destTor, const TLBPathScoreboard &scoreboard,
+                         PathType type, Time maxRtt, struct PathInfo &newPath)
+{
+    if (m_runMode == TLB_RUNMODE_RTT_COUNTER)
     {
-        if (m_runMode == TLB_RUNMODE_COUNTER)
-        {
-            if (minCounter <= m_K)
-            {
-                newPath = candidatePaths[rand () % candidatePaths.size ()];
-            }
-        }
-        else if (m_runMode == TLB_RUNMODE_MINRTT)
-        {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
-        }
-        else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
-        {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
-        }
+        // This mode has never ranked any good or grey path, leaving it to the bad ones
+        return false;
+    }
 
-        else
-        {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
-        }
-        NS_LOG_LOGIC ("Find Grey Path: " << newPath.pathId);
-        return true;
+    uint64_t rank = 0;
+    uint32_t count = scoreboard.CountBest (type, maxRtt, rank);
+    if (count == 0)
+    {
+        return false;
     }
 
-   // Thirdly, checking bad path
-    vectorItr = (itr->second).begin ();
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    if (m_runMode == TLB_RUNMODE_COUNTER && rank > m_K)
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
-        if (pathInfo.pathType == BadPath
-            && Ipv4TLB::PathLIsBetterR (pathInfo, originalPath))
-        {
-            newPath = pathInfo;
-            NS_LOG_LOGIC ("Find Bad Path: " << newPath.pathId);
-            return true;
-        }
+        // Every candidate carries too many flows, newPath is left as it is
+        return true;
     }
 
-    // Thirdly, indicating no paths available
-    NS_LOG_LOGIC ("No Path Returned");
-    return false;
+    uint32_t pathId = 0;
+    scoreboard.GetBest (type, maxRtt, m_rand->GetInteger (0, count - 1), pathId);
+    newPath = Ipv4TLB::JudgePath (destTor, pathId);
+    return true;
 }
 
 struct PathInfo
 Ipv4TLB::SelectRandomPath (uint32_t destTor)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-
-    if (itr == m_availablePath.end ())
+    if (destTor >= m_rack->scoreboards.size () || m_rack->scoreboards[destTor].GetNPaths () == 0)
     {
         NS_LOG_ERROR ("Cannot find available paths");
         PathInfo pathInfo;
         pathInfo.pathId = 0;
         return pathInfo;
     }
-
-    std::vector<uint32_t>::iterator vectorItr = (itr->second).begin ();
-    std::vector<PathInfo> availablePaths;
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
-    {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
-        if (pathInfo.pathType == GoodPath || pathInfo.pathType == GreyPath || pathInfo.pathType == BadPath)
-        {
-            availablePaths.push_back (pathInfo);
-        }
-    }
+    const TLBPathScoreboard &scoreboard = m_rack->scoreboards[destTor];
 
     struct PathInfo newPath;
-    if (!availablePaths.empty ())
+    uint32_t availablePaths = scoreboard.GetNPaths () - scoreboard.GetNPaths (FailPath);
+    if (availablePaths != 0)
     {
-        newPath = availablePaths[rand() % availablePaths.size ()];
+        uint32_t pathId = scoreboard.GetUsable (m_rand->GetInteger (0, availablePaths - 1));
+        newPath = Ipv4TLB::JudgePath (destTor, pathId);
     }
     else
     {
-        uint32_t pathId = (itr->second)[rand() % (itr->second).size ()];
+        uint32_t pathId = scoreboard.GetPaths ()[m_rand->GetInteger (0, scoreboard.GetNPaths () - 1)];
         newPath = Ipv4TLB::JudgePath (destTor, pathId);
     }
     NS_LOG_LOGIC ("Random selection return path: " << newPath.pathId);
@@ -1289,12 +1267,11 @@ Ipv4TLB::SelectRandomPath (uint32_t destTor)
 struct PathInfo
 Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair (destTor, pathId);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
+    uint32_t slot = Ipv4TLB::FindPathInfo (destTor, pathId);
 
     struct PathInfo path;
     path.pathId = pathId;
-    if (itr == m_pathInfo.end ())
+    if (slot == TLBTorRegistry::NONE)
     {
         path.pathType = GreyPath;
         /*path.pathType = GoodPath;*/
@@ -1306,13 +1283,20 @@ Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
         path.quantifiedDre = 0;
         return path;
     }
-    TLBPathInfo pathInfo = itr->second;
+    Ipv4TLB::DreAging (m_rack->pathInfo[slot]);
+    const TLBPathInfo &pathInfo = m_rack->pathInfo[slot];
     path.rttMin = pathInfo.minRtt;
     path.size = pathInfo.size;
     path.ecnPortion = static_cast<double>(pathInfo.ecnSize) / pathInfo.size;
     path.counter = pathInfo.flowCounter;
     path.quantifiedDre = Ipv4TLB::QuantifyDre (pathInfo.dreValue);
+    path.pathType = Ipv4TLB::ClassifyPath (pathInfo);
+    return path;
+}
 
+PathType
+Ipv4TLB::ClassifyPath (const TLBPathInfo &pathInfo)
+{
     int consideECN = (pathInfo.size > m_ecnSampleMin) ? 1 : 0;
 
     if ((m_rttAlpha * pathInfo.minRtt + m_ecnBeta * consideECN * static_cast<double>(pathInfo.ecnSize) / pathInfo.size
@@ -1323,16 +1307,14 @@ Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
             /*&& (pathInfo.isVeryTimeout) == false*/
             && (pathInfo.isProbingTimeout == false))
     {
-        path.pathType = GoodPath;
-        return path;
+        return GoodPath;
     }
 
     if (pathInfo.isHighRetransmission
             || pathInfo.isVeryTimeout
             || pathInfo.isProbingTimeout)
     {
-        path.pathType = FailPath;
-        return path;
+        return FailPath;
     }
 
     if ((m_rttAlpha * pathInfo.minRtt + m_ecnBeta * consideECN * static_cast<double>(pathInfo.ecnSize) / pathInfo.size
@@ -1340,112 +1322,174 @@ Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
             || pathInfo.isTimeout == true
             || pathInfo.isRetransmission == true)
     {
-        path.pathType = BadPath;
-        return path;
+        return BadPath;
     }
 
-    path.pathType = GreyPath;
-    return path;
+    return GreyPath;
 }
 
-bool
-Ipv4TLB::PathLIsBetterR (struct PathInfo pathL, struct PathInfo pathR)
+uint64_t
+Ipv4TLB::RankPath (uint32_t counter, Time rtt)
 {
-    if (/*pathR.ecnPortion - pathL.ecnPortion >= m_betterPathEcnThresh // TODO Comment ECN
-        &&*/ pathR.rttMin - pathL.rttMin >= m_betterPathRttThresh)
+    if (m_runMode == TLB_RUNMODE_COUNTER)
     {
-        return true;
+        return counter;
+    }
+    else if (m_runMode == TLB_RUNMODE_MINRTT)
+    {
+        return static_cast<uint64_t> (rtt.GetTimeStep ());
+    }
+    else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
+    {
+        // Minimize the quantified RTT first, then the counter
+        return (static_cast<uint64_t> (Ipv4TLB::QuantifyRtt (rtt)) << 32) | counter;
     }
     else
     {
-        return false;
+        return 0;
     }
 }
 
-bool
-Ipv4TLB::FindTorId (Ipv4Address daddr, uint32_t &destTorId)
+void
+Ipv4TLB::ScorePath (uint32_t slot)
+{
+    const TLBPathInfo &pathInfo = m_rack->pathInfo[slot];
+    m_rack->scoreboards[m_registry->GetSlotTor (slot)].Update (m_registry->GetSlotOrder (slot),
+            Ipv4TLB::ClassifyPath (pathInfo),
+            Ipv4TLB::RankPath (pathInfo.flowCounter, pathInfo.minRtt), pathInfo.minRtt);
+}
+
+uint32_t
+Ipv4TLB::FindPathInfo (uint32_t destTor, uint32_t path)
+{
+    uint32_t slot = m_registry->FindPath (destTor, path);
+    if (slot == TLBTorRegistry::NONE || !m_rack->hasPathInfo[slot])
+    {
+        return TLBTorRegistry::NONE;
+    }
+    return slot;
+}
+
+uint32_t
+Ipv4TLB::InsertPathInfo (uint32_t destTor, uint32_t path)
 {
-    std::map<Ipv4Address, uint32_t>::iterator torItr = m_ipTorMap.find (daddr);
+    uint32_t slot = m_registry->FindPath (destTor, path);
+    if (slot != TLBTorRegistry::NONE && !m_rack->hasPathInfo[slot])
+    {
+        m_rack->pathInfo[slot] = Ipv4TLB::GetInitPathInfo (path);
+        m_rack->hasPathInfo[slot] = true;
+        Ipv4TLB::ScorePath (slot);
+    }
+    return slot;
+}
 
-    if (torItr == m_ipTorMap.end ())
+bool
+Ipv4TLB::FindTorId (Ipv4Address daddr, uint32_t &destTor)
+{
+    uint32_t torIndex = m_registry->FindTor (daddr);
+    if (torIndex == TLBTorRegistry::NONE)
     {
         return false;
     }
-    destTorId = torItr->second;
+    destTor = torIndex;
     return true;
 }
 
 void
-Ipv4TLB::PathAging (void)
+Ipv4TLB::AgePaths (void)
 {
     NS_LOG_LOGIC (this << " Path Info: " << (Simulator::Now ()));
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.begin ();
-    for ( ; itr != m_pathInfo.end (); ++itr)
-    {
-        NS_LOG_LOGIC ("<" << (itr->first).first << "," << (itr->first).second << ">");
-        NS_LOG_LOGIC ("\t" << " Size: " << (itr->second).size
-                           << " ECN Size: " << (itr->second).ecnSize
-                           << " Min RTT: " << (itr->second).minRtt
-                           << " Is Retransmission: " << (itr->second).isRetransmission
-                           << " Is HRetransmission: " << (itr->second).isHighRetransmission
-                           << " Is Timeout: " << (itr->second).isTimeout
-                           << " Is VTimeout: " << (itr->second).isVeryTimeout
-                           << " Is ProbingTimeout: " << (itr->second).isProbingTimeout
-                           << " Flow Counter: " << (itr->second).flowCounter);
-        if (Simulator::Now() - (itr->second).timeStamp1 > m_T1)
+    for (uint32_t slot = 0; slot < m_rack->pathInfo.size (); ++slot)
+    {
+        if (!m_rack->hasPathInfo[slot])
         {
-            (itr->second).size = 1;
-            (itr->second).ecnSize = 0;
-            (itr->second).isTimeout = false;
-            (itr->second).timeStamp1 = Simulator::Now ();
+            continue;
         }
-        if (Simulator::Now () - (itr->second).timeStamp2 > m_T2)
+        std::vector<TLBPathInfo>::iterator itr = m_rack->pathInfo.begin () + slot;
+        NS_LOG_LOGIC ("<" << m_registry->GetTorId (m_registry->GetSlotTor (slot)) << "," << m_registry->GetPath (slot) << ">");
+        NS_LOG_LOGIC ("\t" << " Size: " << (*itr).size
+                           << " ECN Size: " << (*itr).ecnSize
+                           << " Min RTT: " << (*itr).minRtt
+                           << " Is Retransmission: " << (*itr).isRetransmission
+                           << " Is HRetransmission: " << (*itr).isHighRetransmission
+                           << " Is Timeout: " << (*itr).isTimeout
+                           << " Is VTimeout: " << (*itr).isVeryTimeout
+                           << " Is ProbingTimeout: " << (*itr).isProbingTimeout
+                           << " Flow Counter: " << (*itr).flowCounter);
+        bool isAged = false;
+        if (Simulator::Now() - (*itr).timeStamp1 > m_T1)
         {
-            (itr->second).isRetransmission = false;
-            (itr->second).isHighRetransmission = false;
-            (itr->second).isVeryTimeout = false;
-            (itr->second).isProbingTimeout = false;
-            (itr->second).timeStamp2 = Simulator::Now ();
+            (*itr).size = 1;
+            (*itr).ecnSize = 0;
+            (*itr).isTimeout = false;
+            (*itr).timeStamp1 = Simulator::Now ();
+            isAged = true;
         }
-        if (Simulator::Now () - (itr->second).timeStamp3 > m_T1)
+        if (Simulator::Now () - (*itr).timeStamp2 > m_T2)
         {
+            (*itr).isRetransmission = false;
+            (*itr).isHighRetransmission = false;
+            (*itr).isVeryTimeout = false;
+            (*itr).isProbingTimeout = false;
+            (*itr).timeStamp2 = Simulator::Now ();
+            isAged = true;
+        }
+        if (Simulator::Now () - (*itr).timeStamp3 > m_T1)
+        {
+            isAged = true;
             if (m_isSmooth)
             {
                 Time desiredRtt = m_minRtt * m_smoothDesired / SMOOTH_BASE;
-                if ((itr->second).minRtt < desiredRtt)
+                if ((*itr).minRtt < desiredRtt)
                 {
-                    (itr->second).minRtt = std::min (desiredRtt, (itr->second).minRtt * m_smoothBeta1 / SMOOTH_BASE);
+                    (*itr).minRtt = std::min (desiredRtt, (*itr).minRtt * m_smoothBeta1 / SMOOTH_BASE);
                 }
                 else
                 {
-                    (itr->second).minRtt = std::max (desiredRtt, (itr->second).minRtt * m_smoothBeta2 / SMOOTH_BASE);
+                    (*itr).minRtt = std::max (desiredRtt, (*itr).minRtt * m_smoothBeta2 / SMOOTH_BASE);
                 }
             }
             else
             {
-                (itr->second).minRtt = Seconds (666);
+                (*itr).minRtt = Seconds (666);
             }
-            (itr->second).timeStamp3 = Simulator::Now ();
+            (*itr).timeStamp3 = Simulator::Now ();
+        }
+        if (isAged)
+        {
+            Ipv4TLB::ScorePath (slot);
         }
 
         /*
-        if (Simulator::Now () - (itr->second).epTimeStamp > m_epAgingTime)
+        if (Simulator::Now () - (*itr).epTimeStamp > m_epAgingTime)
         {
-            (itr->second).epAckSize = 1;
-            (itr->second).epEcnSize = 0;
-            (itr->second).epEcnPortion = m_epDefaultEcnPortion;
-            (itr->second).epTimeStamp = Simulator::Now ();
+            (*itr).epAckSize = 1;
+            (*itr).epEcnSize = 0;
+            (*itr).epEcnPortion = m_epDefaultEcnPortion;
+            (*itr).epTimeStamp = Simulator::Now ();
         }
         */
     }
+}
+
+bool
+Ipv4TLB::PathAging (void)
+{
+    // The hosts sharing the rack state tick together, the first of them ages the paths for all
+    if (m_rack->lastAging != Simulator::Now ())
+    {
+        m_rack->lastAging = Simulator::Now ();
+        Ipv4TLB::AgePaths ();
+    }
 
     std::map<uint32_t, TLBFlowInfo>::iterator itr2 = m_flowInfo.begin ();
-    for ( ; itr2 != m_flowInfo.end (); ++itr2)
+    while (itr2 != m_flowInfo.end ())
     {
         if (Simulator::Now () - (itr2->second).liveTime >= m_flowDieTime)
         {
             Ipv4TLB::RemoveFlowFromPath ((itr2->second).flowId, (itr2->second).destTor, (itr2->second).path);
-            m_flowInfo.erase (itr2);
+            m_flowInfo.erase (itr2++);
+            continue;
         }
 
         /*
@@ -1457,9 +1501,10 @@ Ipv4TLB::PathAging (void)
             (itr2->second).epTimeStamp = Simulator::Now ();
         }
         */
+        ++itr2;
     }
 
-    m_agingEvent = Simulator::Schedule (m_agingCheckTime, &Ipv4TLB::PathAging, this);
+    return true;
 }
 
 std::vector<PathInfo>
@@ -1467,33 +1512,63 @@ Ipv4TLB::GatherParallelPaths (uint32_t destTor)
 {
     std::vector<PathInfo> paths;
 
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    if (destTor >= m_rack->scoreboards.size ())
     {
         return paths;
     }
 
-    std::vector<uint32_t>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr )
+    std::vector<uint32_t>::const_iterator innerItr = m_rack->scoreboards[destTor].GetPaths ().begin ();
+    for ( ; innerItr != m_rack->scoreboards[destTor].GetPaths ().end (); ++innerItr )
     {
-        paths.push_back(Ipv4TLB::JudgePath ((itr->first), *innerItr));
+        paths.push_back(Ipv4TLB::JudgePath (destTor, *innerItr));
     }
 
     return paths;
 }
 
 void
-Ipv4TLB::DreAging (void)
+Ipv4TLB::TracePathSelect (uint32_t flowId, uint32_t fromTorId, uint32_t toTor, const struct PathInfo &newPath, bool isRandom)
 {
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.begin ();
-    for ( ; itr != m_pathInfo.end (); ++itr)
+    uint32_t toTorId = m_registry->GetTorId (toTor);
+    m_pathDecisionTrace (flowId, fromTorId, toTorId, newPath.pathId, newPath.pathId, true, isRandom);
+    if (!m_pathSelectTrace.IsEmpty ())
     {
-        NS_LOG_LOGIC ("<" << (itr->first).first << "," << (itr->first).second << ">");
-        (itr->second).dreValue *= (1 - m_dreAlpha);
-        NS_LOG_LOGIC ("\tDre value :" << Ipv4TLB::QuantifyDre ((itr->second).dreValue));
+        m_pathSelectTrace (flowId, fromTorId, toTorId, newPath.pathId, isRandom, newPath, Ipv4TLB::GatherParallelPaths (toTor));
     }
+}
 
-    m_dreEvent = Simulator::Schedule (m_dreTime, &Ipv4TLB::DreAging, this);
+void
+Ipv4TLB::TracePathChange (uint32_t flowId, uint32_t fromTorId, uint32_t toTor, uint32_t newPath, uint32_t oldPath, bool isRandom)
+{
+    uint32_t toTorId = m_registry->GetTorId (toTor);
+    m_pathDecisionTrace (flowId, fromTorId, toTorId, newPath, oldPath, false, isRandom);
+    if (!m_pathChangeTrace.IsEmpty ())
+    {
+        m_pathChangeTrace (flowId, fromTorId, toTorId, newPath, oldPath, isRandom, Ipv4TLB::GatherParallelPaths (toTor));
+    }
+}
+
+int64_t
+Ipv4TLB::GetDreEpoch (void) const
+{
+    if (!m_rack->dreRunning)
+    {
+        return 0;
+    }
+    return (Simulator::Now () - m_rack->dreStart).GetTimeStep () / m_dreTime.GetTimeStep ();
+}
+
+void
+Ipv4TLB::DreAging (TLBPathInfo &pathInfo)
+{
+    // Same steps as aging every m_dreTime, rounding included
+    int64_t epoch = Ipv4TLB::GetDreEpoch ();
+    for ( ; pathInfo.dreEpoch < epoch && pathInfo.dreValue != 0; ++pathInfo.dreEpoch)
+    {
+        pathInfo.dreValue *= (1 - m_dreAlpha);
+    }
+    pathInfo.dreEpoch = epoch;
+    NS_LOG_LOGIC ("\tDre value :" << Ipv4TLB::QuantifyDre (pathInfo.dreValue));
 }
 
 uint32_t
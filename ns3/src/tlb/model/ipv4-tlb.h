@@ -8,8 +8,14 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/data-rate.h"
 #include "ns3/event-id.h"
+#include "ns3/shared-tick.h"
+#include "ns3/random-variable-stream.h"
 #include "tlb-flow-info.h"
 #include "tlb-path-info.h"
+#include "tlb-path-scoreboard.h"
+#include "tlb-tor-registry.h"
+#include "tlb-path-catalog.h"
+#include "tlb-rack-state.h"
 
 #include <vector>
 #include <map>
@@ -24,13 +30,6 @@
 
 namespace ns3 {
 
-enum PathType {
-    GoodPath,
-    GreyPath,
-    BadPath,
-    FailPath,
-};
-
 struct PathInfo {
     uint32_t pathId;
     PathType pathType;
@@ -41,6 +40,16 @@ struct PathInfo {
     uint32_t quantifiedDre;
 };
 
+// An ACK or a probe reply on its way to the path state
+struct TLBPathFeedback {
+    uint32_t destTor;
+    uint32_t path;
+    uint32_t size;
+    bool withECN;
+    Time rtt;
+    bool isProbing;
+};
+
 struct TLBAcklet {
     uint32_t pathId;
     Time activeTime;
@@ -59,12 +68,26 @@ public:
 
     static TypeId GetTypeId (void);
 
+    // For the hosts without a path catalog only: the hosts using one share
+    // the registry of their ToR, adding an address or a path to them is a fatal error
     void AddAddressWithTor (Ipv4Address address, uint32_t torId);
 
     void AddAvailPath (uint32_t destTor, uint32_t path);
 
+    // Takes the addresses and the paths from the ToR registry of the catalog, shared with the other hosts
+    void UsePathCatalog (Ptr<TLBPathCatalog> catalog, uint32_t sourceTor);
+
+    // Shares the path state of another host under the same ToR, both using the same path catalog
+    void ShareRackState (Ptr<Ipv4TLB> tlb);
+
+    bool IsRackStateSharedWith (Ptr<Ipv4TLB> tlb) const;
+
     std::vector<uint32_t> GetAvailPath (Ipv4Address daddr);
 
+    // The output ports of a path of the catalog in use, for Ipv4XPathTag::SetRoute,
+    // 0 without a catalog, the path id being then the base-100 route of Ipv4XPathTag::SetPathId
+    const uint32_t *GetRoute (uint32_t path, uint32_t &nPorts) const;
+
     // These methods are used for TCP flows
     uint32_t GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr);
 
@@ -87,9 +110,25 @@ public:
 
     void ProbeTimeout (uint32_t path, Ipv4Address daddr);
 
+    // When the path last carried a data ACK, false if it never did
+    bool GetLastAckTime (Ipv4Address daddr, uint32_t path, Time &ackTime);
+
+    // The same for the path of a slot of the registry
+    bool GetLastAckTime (uint32_t slot, Time &ackTime) const;
+
+    // The ToR indices and the path slots of the available paths
+    const TLBTorRegistry &GetRegistry (void) const;
+
     // Node
     void SetNode (Ptr<Node> node);
 
+    /**
+     * Assign a fixed random variable stream number to the random variables
+     * used by this model.  Return the number of streams (possibly zero) that
+     * have been assigned.
+     */
+    int64_t AssignStreams (int64_t stream);
+
     static std::string GetPathType (PathType type);
 
     static std::string GetLogo (void);
@@ -103,7 +142,11 @@ private:
 
     TLBPathInfo GetInitPathInfo (uint32_t path);
 
-    void UpdatePathInfo (uint32_t destTor, uint32_t path, uint32_t size, bool withECN, Time rtt);
+    // Gives the paths of the registry a scoreboard entry in a new path state, the path infos are created lazily
+    void ResetPathState (void);
+
+    // A data ACK also stamps the ack time of its path, with the rest of the path state
+    void UpdatePathInfo (TLBPathFeedback feedback);
 
     bool TimeoutFlow (uint32_t flowId, uint32_t path, bool &isVeryTimeout);
 
@@ -129,16 +172,43 @@ private:
 
     struct PathInfo JudgePath (uint32_t destTor, uint32_t path);
 
-    bool PathLIsBetterR (struct PathInfo pathL, struct PathInfo pathR);
+    PathType ClassifyPath (const TLBPathInfo &pathInfo);
+
+    // The rank of a good or grey path in the current run mode, lower is better
+    uint64_t RankPath (uint32_t counter, Time rtt);
 
-    bool FindTorId (Ipv4Address daddr, uint32_t &destTorId);
+    // Called whenever the info of a path changes, to keep its scoreboard in sync
+    void ScorePath (uint32_t slot);
 
-    void PathAging (void);
+    // Returns the slot of the path if it has an info, NONE otherwise
+    uint32_t FindPathInfo (uint32_t destTor, uint32_t path);
 
-    void DreAging (void);
+    // Returns the slot of the path, giving it an initial info if it has none,
+    // or NONE if the path is not available
+    uint32_t InsertPathInfo (uint32_t destTor, uint32_t path);
+
+    bool SelectBestPath (uint32_t destTor, const TLBPathScoreboard &scoreboard,
+                         PathType type, Time maxRtt, struct PathInfo &newPath);
+
+    // Sets the index of the ToR of the address, the ToRs are indexed by m_registry
+    bool FindTorId (Ipv4Address daddr, uint32_t &destTor);
+
+    bool PathAging (void);
+
+    // Ages the path infos of the rack state, once per tick whatever the number of hosts sharing it
+    void AgePaths (void);
+
+    void DreAging (TLBPathInfo &pathInfo);
+
+    int64_t GetDreEpoch (void) const;
 
     std::vector<PathInfo> GatherParallelPaths (uint32_t destTor);
 
+    // The parallel paths of the select and change traces are only gathered when they have sinks
+    // fromTorId is a ToR id, toTor a ToR index
+    void TracePathSelect (uint32_t flowId, uint32_t fromTorId, uint32_t toTor, const struct PathInfo &newPath, bool isRandom);
+    void TracePathChange (uint32_t flowId, uint32_t fromTorId, uint32_t toTor, uint32_t newPath, uint32_t oldPath, bool isRandom);
+
     uint32_t QuantifyRtt (Time rtt);
     uint32_t QuantifyDre (uint32_t dre);
 
@@ -221,24 +291,32 @@ private:
     double m_rttAlpha;
     double m_ecnBeta;
 
+    // The delay of the feedback to the path state, modelling a rack agent
+    Time m_rackStateDelay;
+
     // Variables
     std::map<uint32_t, TLBFlowInfo> m_flowInfo; /* <FlowId, TLBFlowInfo> */
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo> m_pathInfo; /* <DestTorId, PathId>, TLBPathInfo> */
+    // The ToR indices and the path slots of the available paths
+    Ptr<TLBTorRegistry> m_registry;
 
-    std::map<uint32_t, TLBAcklet> m_acklets; /* <FlowId, TLBAcklet> */
+    // The catalog the registry comes from, if any, resolving the paths to their routes
+    Ptr<TLBPathCatalog> m_catalog;
 
-    std::map<Ipv4Address, uint32_t> m_ipTorMap; /* <DestAddress, DestTorId> */
+    // The path infos and the scoreboards, possibly shared by the hosts under the ToR
+    Ptr<TLBRackState> m_rack;
 
-    std::map<uint32_t, std::vector<uint32_t> > m_availablePath; /* <DestTorId, List<PathId>> */
+    std::map<uint32_t, TLBAcklet> m_acklets; /* <FlowId, TLBAcklet> */
 
     std::map<uint32_t, Ipv4Address> m_probingAgent; /* <DestTorId, ProbingAgentAddress>*/
 
-    EventId m_agingEvent;
-
-    EventId m_dreEvent;
+    // Shared with the other hosts aging their paths with the same period
+    SharedTick m_agingTick;
 
     Ptr<Node> m_node;
 
+    // Draws the random path choices, instead of the global rand ()
+    Ptr<UniformRandomVariable> m_rand;
+
     std::map<uint32_t, Time> m_pauseTime; // Used in the TCP pause, not mandatory
 
     typedef void (* TLBPathCallback) (uint32_t flowId, uint32_t fromTor,
@@ -251,6 +329,12 @@ private:
 
     TracedCallback <uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, bool, std::vector<PathInfo> > m_pathChangeTrace;
 
+    typedef void (* TLBPathDecisionCallback) (uint32_t flowId, uint32_t fromTor, uint32_t toTor,
+            uint32_t newPath, uint32_t oldPath, bool isNewFlow, bool isRandom);
+
+    // Both selections and changes, without the path infos, cheap enough to be always connected
+    TracedCallback <uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, bool, bool> m_pathDecisionTrace;
+
 
 };
 
@@ -10,7 +10,7 @@ class TLBFlowInfo
 public:
   uint32_t flowId;
   uint32_t path;
-  uint32_t destTor;
+  uint32_t destTor; // Index of the ToR in the registry of Ipv4TLB
   uint32_t size;
   uint32_t ecnSize;
   uint32_t sendSize;
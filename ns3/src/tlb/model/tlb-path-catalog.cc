@@ -0,0 +1,321 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "tlb-path-catalog.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+
+#include <algorithm>
+#include <deque>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TLBPathCatalog");
+
+namespace {
+
+const uint32_t UNREACHABLE = 0xffffffff;
+
+// The limits of Ipv4XPathTag, which the tlb module cannot include
+const uint32_t XPATH_MAX_PORT_BITS = 16;
+const uint32_t XPATH_MAX_ROUTE_BITS = 128;
+
+bool
+FitsXPath (const std::vector<uint32_t> &ports)
+{
+    uint32_t maxPort = 0;
+    for (std::vector<uint32_t>::const_iterator itr = ports.begin (); itr != ports.end (); ++itr)
+    {
+        maxPort = std::max (maxPort, *itr);
+    }
+    uint32_t portBits = 1;
+    while (portBits < 32 && (maxPort >> portBits) != 0)
+    {
+        portBits++;
+    }
+    return portBits <= XPATH_MAX_PORT_BITS && ports.size () * portBits <= XPATH_MAX_ROUTE_BITS;
+}
+
+bool
+CompareHops (const std::pair<uint32_t, uint32_t> &a, const std::pair<uint32_t, uint32_t> &b)
+{
+    return a.first < b.first;
+}
+
+}
+
+TLBPathCatalog::TLBPathCatalog ()
+    : m_maxPaths (0),
+      m_extraHops (0),
+      m_routeBegins (1, 0)
+{
+
+}
+
+uint32_t
+TLBPathCatalog::AddVertex (Ptr<Node> node)
+{
+    std::map<uint32_t, uint32_t>::const_iterator itr = m_vertices.find (node->GetId ());
+    if (itr != m_vertices.end ())
+    {
+        return itr->second;
+    }
+    uint32_t vertex = m_nodes.size ();
+    m_vertices[node->GetId ()] = vertex;
+    m_nodes.push_back (node);
+    m_isTor.push_back (false);
+    return vertex;
+}
+
+void
+TLBPathCatalog::AddTor (uint32_t torId, Ptr<Node> node)
+{
+    uint32_t vertex = TLBPathCatalog::AddVertex (node);
+    m_isTor[vertex] = true;
+    m_torIds.push_back (torId);
+    m_torVertices.push_back (vertex);
+}
+
+void
+TLBPathCatalog::AddSwitch (Ptr<Node> node)
+{
+    TLBPathCatalog::AddVertex (node);
+}
+
+void
+TLBPathCatalog::AddAddress (Ipv4Address address, uint32_t torId)
+{
+    m_addresses.push_back (std::make_pair (address, torId));
+}
+
+void
+TLBPathCatalog::SetMaxPaths (uint32_t maxPaths)
+{
+    m_maxPaths = maxPaths;
+}
+
+void
+TLBPathCatalog::SetExtraHops (uint32_t extraHops)
+{
+    m_extraHops = extraHops;
+}
+
+void
+TLBPathCatalog::BuildLinks (void)
+{
+    m_links.assign (m_nodes.size (), std::vector<Link> ());
+    for (uint32_t vertex = 0; vertex < m_nodes.size (); ++vertex)
+    {
+        Ptr<Node> node = m_nodes[vertex];
+        for (uint32_t i = 0; i < node->GetNDevices (); ++i)
+        {
+            Ptr<NetDevice> device = node->GetDevice (i);
+            Ptr<Channel> channel = device->GetChannel ();
+            if (!channel || channel->GetNDevices () != 2)
+            {
+                continue;
+            }
+            Ptr<NetDevice> peer = channel->GetDevice (0) == device ? channel->GetDevice (1) : channel->GetDevice (0);
+            std::map<uint32_t, uint32_t>::const_iterator itr = m_vertices.find (peer->GetNode ()->GetId ());
+            if (itr == m_vertices.end ())
+            {
+                // Towards a host
+                continue;
+            }
+            Link link;
+            link.port = device->GetIfIndex ();
+            link.peer = itr->second;
+            m_links[vertex].push_back (link);
+        }
+    }
+}
+
+void
+TLBPathCatalog::MeasureDistances (uint32_t torVertex, std::vector<uint32_t> &distances) const
+{
+    // The links are symmetric, so the hops towards the ToR are those from it
+    distances.assign (m_nodes.size (), UNREACHABLE);
+    distances[torVertex] = 0;
+    std::deque<uint32_t> queue;
+    queue.push_back (torVertex);
+    while (!queue.empty ())
+    {
+        uint32_t vertex = queue.front ();
+        queue.pop_front ();
+        if (vertex != torVertex && m_isTor[vertex])
+        {
+            // No path goes through another ToR
+            continue;
+        }
+        std::vector<Link>::const_iterator itr = m_links[vertex].begin ();
+        for ( ; itr != m_links[vertex].end (); ++itr)
+        {
+            if (distances[itr->peer] == UNREACHABLE)
+            {
+                distances[itr->peer] = distances[vertex] + 1;
+                queue.push_back (itr->peer);
+            }
+        }
+    }
+}
+
+void
+TLBPathCatalog::FindRoutes (uint32_t vertex, uint32_t torVertex, uint32_t budget,
+                            const std::vector<uint32_t> &distances,
+                            std::vector<uint32_t> &ports, std::vector<bool> &visited,
+                            std::vector<std::vector<uint32_t> > &routes) const
+{
+    std::vector<Link>::const_iterator itr = m_links[vertex].begin ();
+    for ( ; itr != m_links[vertex].end (); ++itr)
+    {
+        uint32_t peer = itr->peer;
+        if (distances[peer] == UNREACHABLE || distances[peer] + 1 > budget)
+        {
+            continue;
+        }
+        ports.push_back (itr->port);
+        if (peer == torVertex)
+        {
+            routes.push_back (ports);
+        }
+        else if (!m_isTor[peer] && !visited[peer])
+        {
+            visited[peer] = true;
+            TLBPathCatalog::FindRoutes (peer, torVertex, budget - 1, distances, ports, visited, routes);
+            visited[peer] = false;
+        }
+        ports.pop_back ();
+    }
+}
+
+uint32_t
+TLBPathCatalog::AddRoute (const std::vector<uint32_t> &ports)
+{
+    m_routePorts.insert (m_routePorts.end (), ports.begin (), ports.end ());
+    m_routeBegins.push_back (m_routePorts.size ());
+    return m_routeBegins.size () - 1;
+}
+
+const uint32_t *
+TLBPathCatalog::GetRoute (uint32_t path, uint32_t &nPorts) const
+{
+    if (path == 0 || path >= m_routeBegins.size ())
+    {
+        nPorts = 0;
+        return 0;
+    }
+    nPorts = m_routeBegins[path] - m_routeBegins[path - 1];
+    return nPorts == 0 ? 0 : &m_routePorts[m_routeBegins[path - 1]];
+}
+
+void
+TLBPathCatalog::Build (void)
+{
+    TLBPathCatalog::BuildLinks ();
+    m_registries.clear ();
+    m_routeBegins.assign (1, 0);
+    m_routePorts.clear ();
+
+    std::vector<std::vector<uint32_t> > distances (m_torVertices.size ());
+    for (uint32_t dest = 0; dest < m_torVertices.size (); ++dest)
+    {
+        TLBPathCatalog::MeasureDistances (m_torVertices[dest], distances[dest]);
+    }
+
+    // The ToRs and the addresses every registry starts from, the registries
+    // sharing the address table of this one
+    TLBTorRegistry base;
+    for (uint32_t tor = 0; tor < m_torIds.size (); ++tor)
+    {
+        base.AddTor (m_torIds[tor]);
+    }
+    std::vector<std::pair<Ipv4Address, uint32_t> >::const_iterator addressItr = m_addresses.begin ();
+    for ( ; addressItr != m_addresses.end (); ++addressItr)
+    {
+        base.AddAddress (addressItr->first, addressItr->second);
+    }
+
+    uint32_t nPaths = 0;
+    std::vector<bool> visited (m_nodes.size (), false);
+    std::vector<uint32_t> ports;
+    for (uint32_t source = 0; source < m_torVertices.size (); ++source)
+    {
+        Ptr<TLBTorRegistry> registry = Create<TLBTorRegistry> (base);
+
+        uint32_t sourceVertex = m_torVertices[source];
+        for (uint32_t dest = 0; dest < m_torVertices.size (); ++dest)
+        {
+            uint32_t minHops = distances[dest][sourceVertex];
+            if (dest == source || minHops == UNREACHABLE)
+            {
+                continue;
+            }
+            std::vector<std::vector<uint32_t> > routes;
+            visited[sourceVertex] = true;
+            TLBPathCatalog::FindRoutes (sourceVertex, m_torVertices[dest], minHops + m_extraHops,
+                                        distances[dest], ports, visited, routes);
+            visited[sourceVertex] = false;
+
+            // Shortest first, in port order among those as long
+            std::vector<std::pair<uint32_t, uint32_t> > order; /* <Hops, Route> */
+            for (uint32_t i = 0; i < routes.size (); ++i)
+            {
+                order.push_back (std::make_pair (static_cast<uint32_t> (routes[i].size ()), i));
+            }
+            std::stable_sort (order.begin (), order.end (), CompareHops);
+            if (m_maxPaths != 0 && order.size () > m_maxPaths)
+            {
+                order.resize (m_maxPaths);
+            }
+
+            uint32_t torIndex = registry->GetTorIndex (m_torIds[dest]);
+            for (uint32_t i = 0; i < order.size (); ++i)
+            {
+                const std::vector<uint32_t> &route = routes[order[i].second];
+                if (!FitsXPath (route))
+                {
+                    NS_FATAL_ERROR ("A path from tor " << m_torIds[source] << " to tor " << m_torIds[dest]
+                                    << " does not fit in an XPath tag, it has too many hops or too large ports");
+                }
+                registry->AddPath (torIndex, TLBPathCatalog::AddRoute (route));
+            }
+            nPaths += order.size ();
+        }
+        m_registries[m_torIds[source]] = registry;
+    }
+    NS_LOG_INFO ("The catalog holds " << nPaths << " paths between " << m_torIds.size () << " tors");
+}
+
+std::vector<uint32_t>
+TLBPathCatalog::GetPaths (uint32_t sourceTor, uint32_t destTor) const
+{
+    std::vector<uint32_t> paths;
+    Ptr<TLBTorRegistry> registry = TLBPathCatalog::GetRegistry (sourceTor);
+    uint32_t torIndex = registry->GetTorIndex (destTor);
+    if (torIndex == TLBTorRegistry::NONE)
+    {
+        return paths;
+    }
+    const std::vector<uint32_t> &slots = registry->GetSlots (torIndex);
+    for (std::vector<uint32_t>::const_iterator itr = slots.begin (); itr != slots.end (); ++itr)
+    {
+        paths.push_back (registry->GetPath (*itr));
+    }
+    return paths;
+}
+
+Ptr<TLBTorRegistry>
+TLBPathCatalog::GetRegistry (uint32_t sourceTor) const
+{
+    std::map<uint32_t, Ptr<TLBTorRegistry> >::const_iterator itr = m_registries.find (sourceTor);
+    if (itr == m_registries.end ())
+    {
+        NS_FATAL_ERROR ("Tor " << sourceTor << " is not in the catalog or the catalog is not built");
+    }
+    return itr->second;
+}
+
+}
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TLB_PATH_CATALOG_H
+#define TLB_PATH_CATALOG_H
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/node.h"
+#include "tlb-tor-registry.h"
+
+#include <vector>
+#include <map>
+
+namespace ns3 {
+
+/**
+ * \brief The paths between every pair of ToRs, enumerated once for all
+ * the edge load balancers.
+ *
+ * The catalog is given the ToRs, the switches between them and the host
+ * addresses under each ToR.  Build walks the point to point links among
+ * them and enumerates, for every ordered pair of ToRs, the loop free
+ * paths that go through switches only: the shortest ones, and those up
+ * to ExtraHops hops longer if asked, at most MaxPaths of them.  A path
+ * is the list of the output ports, the interface indices, from the
+ * source ToR on.  The routes of all the paths are kept once, in one flat
+ * table, and the id of a path is its index in the table plus one, so a
+ * route is as long and its ports as large as Ipv4XPathTag::SetRoute
+ * takes, not bound by the base-100 path ids of Ipv4XPathTag::SetPathId.
+ *
+ * Every source ToR gets one TLBTorRegistry holding its paths, which
+ * Ipv4TLB and Ipv4Clove share through UsePathCatalog instead of being
+ * given their own copies path by path.  The registries of all the ToRs
+ * share one table of the addresses.
+ */
+class TLBPathCatalog : public SimpleRefCount<TLBPathCatalog>
+{
+public:
+
+    TLBPathCatalog ();
+
+    void AddTor (uint32_t torId, Ptr<Node> node);
+
+    void AddSwitch (Ptr<Node> node);
+
+    void AddAddress (Ipv4Address address, uint32_t torId);
+
+    // 0 keeps every path found
+    void SetMaxPaths (uint32_t maxPaths);
+
+    // 0 keeps the equal cost paths only
+    void SetExtraHops (uint32_t extraHops);
+
+    // Building again gives new path ids, the hosts have to use the catalog again
+    void Build (void);
+
+    // The ids of the paths from one ToR to another, shortest first
+    std::vector<uint32_t> GetPaths (uint32_t sourceTor, uint32_t destTor) const;
+
+    // The output ports of the path, from the source ToR on, 0 if the path is not in the catalog
+    const uint32_t *GetRoute (uint32_t path, uint32_t &nPorts) const;
+
+    // The registry shared by the hosts under the source ToR
+    Ptr<TLBTorRegistry> GetRegistry (uint32_t sourceTor) const;
+
+private:
+
+    uint32_t AddVertex (Ptr<Node> node);
+
+    void BuildLinks (void);
+
+    // The number of hops from every vertex to the ToR through the switches
+    void MeasureDistances (uint32_t torVertex, std::vector<uint32_t> &distances) const;
+
+    // Appends the port lists of the paths to the ToR at most budget hops long
+    void FindRoutes (uint32_t vertex, uint32_t torVertex, uint32_t budget,
+                     const std::vector<uint32_t> &distances,
+                     std::vector<uint32_t> &ports, std::vector<bool> &visited,
+                     std::vector<std::vector<uint32_t> > &routes) const;
+
+    // Returns the id of the new path
+    uint32_t AddRoute (const std::vector<uint32_t> &ports);
+
+    struct Link
+    {
+        uint32_t port;
+        uint32_t peer;
+    };
+
+    uint32_t m_maxPaths;
+    uint32_t m_extraHops;
+
+    std::vector<uint32_t> m_torIds;
+    std::vector<uint32_t> m_torVertices;     /* in the order of m_torIds */
+    std::vector<Ptr<Node> > m_nodes;         /* <Vertex, Node> */
+    std::vector<bool> m_isTor;               /* <Vertex, Whether it is a ToR> */
+    std::map<uint32_t, uint32_t> m_vertices; /* <NodeId, Vertex> */
+    std::vector<std::pair<Ipv4Address, uint32_t> > m_addresses; /* <Address, TorId> */
+
+    std::vector<std::vector<Link> > m_links; /* <Vertex, Links in port order> */
+
+    std::vector<uint32_t> m_routeBegins;     /* Path p spans m_routePorts from entry p - 1 to entry p */
+    std::vector<uint32_t> m_routePorts;
+
+    std::map<uint32_t, Ptr<TLBTorRegistry> > m_registries; /* <SourceTorId, Registry> */
+};
+
+}
+
+#endif /* TLB_PATH_CATALOG_H */
@@ -5,6 +5,13 @@
 
 namespace ns3 {
 
+enum PathType {
+    GoodPath,
+    GreyPath,
+    BadPath,
+    FailPath,
+};
+
 class TLBPathInfo
 {
 public:
@@ -22,6 +29,7 @@ public:
   Time timeStamp2;
   Time timeStamp3;
   uint32_t dreValue;
+  int64_t dreEpoch; // DRE aging periods already applied to dreValue
 
   // Added at Jan 11st
   /*
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "tlb-path-scoreboard.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TLBPathScoreboard");
+
+TLBPathScoreboard::TLBPathScoreboard ()
+{
+
+}
+
+uint32_t
+TLBPathScoreboard::AddPath (uint32_t path, PathType type, uint64_t rank, Time rtt)
+{
+    if (type == BadPath || type == FailPath)
+    {
+        rank = 0;
+    }
+    uint32_t order = m_paths.size ();
+    m_paths.push_back (path);
+    Entry entry;
+    entry.type = type;
+    entry.rank = rank;
+    entry.rtt = rtt;
+    m_entries.push_back (entry);
+    m_buckets[type].insert (std::make_pair (rank, order));
+    return order;
+}
+
+void
+TLBPathScoreboard::Update (uint32_t order, PathType type, uint64_t rank, Time rtt)
+{
+    NS_ASSERT (order < m_entries.size ());
+    if (type == BadPath || type == FailPath)
+    {
+        rank = 0;
+    }
+    Entry &entry = m_entries[order];
+    entry.rtt = rtt;
+    if (entry.type == type && entry.rank == rank)
+    {
+        return;
+    }
+    NS_LOG_LOGIC ("Path " << m_paths[order] << " moves to type " << type << " with rank " << rank);
+    m_buckets[entry.type].erase (std::make_pair (entry.rank, order));
+    entry.type = type;
+    entry.rank = rank;
+    m_buckets[type].insert (std::make_pair (rank, order));
+}
+
+const std::vector<uint32_t> &
+TLBPathScoreboard::GetPaths (void) const
+{
+    return m_paths;
+}
+
+uint32_t
+TLBPathScoreboard::GetNPaths (void) const
+{
+    return m_paths.size ();
+}
+
+uint32_t
+TLBPathScoreboard::GetNPaths (PathType type) const
+{
+    return m_buckets[type].size ();
+}
+
+uint32_t
+TLBPathScoreboard::CountBest (PathType type, Time maxRtt, uint64_t &rank) const
+{
+    uint32_t count = 0;
+    const Bucket &bucket = m_buckets[type];
+    for (Bucket::const_iterator itr = bucket.begin (); itr != bucket.end (); ++itr)
+    {
+        if (count > 0 && itr->first != rank)
+        {
+            break;
+        }
+        if (m_entries[itr->second].rtt <= maxRtt)
+        {
+            rank = itr->first;
+            count++;
+        }
+    }
+    return count;
+}
+
+bool
+TLBPathScoreboard::GetBest (PathType type, Time maxRtt, uint32_t index, uint32_t &path) const
+{
+    uint32_t count = 0;
+    uint64_t rank = 0;
+    const Bucket &bucket = m_buckets[type];
+    for (Bucket::const_iterator itr = bucket.begin (); itr != bucket.end (); ++itr)
+    {
+        if (count > 0 && itr->first != rank)
+        {
+            break;
+        }
+        if (m_entries[itr->second].rtt <= maxRtt)
+        {
+            if (count == index)
+            {
+                path = m_paths[itr->second];
+                return true;
+            }
+            rank = itr->first;
+            count++;
+        }
+    }
+    return false;
+}
+
+uint32_t
+TLBPathScoreboard::GetUsable (uint32_t index) const
+{
+    // The fail paths are in path order, skip those before the index-th usable one
+    uint32_t order = index;
+    const Bucket &failPaths = m_buckets[FailPath];
+    for (Bucket::const_iterator itr = failPaths.begin ();
+            itr != failPaths.end () && itr->second <= order; ++itr)
+    {
+        order++;
+    }
+    NS_ASSERT (order < m_paths.size ());
+    return m_paths[order];
+}
+
+}
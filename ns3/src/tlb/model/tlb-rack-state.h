@@ -0,0 +1,48 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TLB_RACK_STATE_H
+#define TLB_RACK_STATE_H
+
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "tlb-path-info.h"
+#include "tlb-path-scoreboard.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief The path congestion state of Ipv4TLB, indexed by the slots of
+ * its ToR registry.
+ *
+ * Every host has its own unless the hosts under a ToR share one through
+ * Ipv4TLB::ShareRackState, in which case the ACKs, timeouts and sends of
+ * all of them update the same path infos, flow counters and DREs.
+ */
+class TLBRackState : public SimpleRefCount<TLBRackState>
+{
+public:
+  TLBRackState ()
+    : dreRunning (false),
+      lastAging (Time (-1))
+  {
+  }
+
+  std::vector<TLBPathInfo> pathInfo; /* <Slot, TLBPathInfo> */
+  std::vector<bool> hasPathInfo; /* <Slot, Whether the path has been used> */
+  std::vector<Time> ackTime; /* <Slot, When the path last carried a data ACK, negative if never> */
+
+  std::vector<TLBPathScoreboard> scoreboards; /* <DestTorIndex, TLBPathScoreboard> */
+
+  // The DRE of a path is aged lazily, when the path is read or updated,
+  // by the number of DRE periods elapsed since dreStart
+  bool dreRunning;
+  Time dreStart;
+
+  // When the path infos were last aged, by any of the hosts sharing them
+  Time lastAging;
+};
+
+}
+
+#endif /* TLB_RACK_STATE_H */
@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "tlb-tor-registry.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TLBTorRegistry");
+
+const uint32_t TLBTorRegistry::NONE;
+
+TLBTorRegistry::TLBTorRegistry ()
+    : m_addresses (Create<AddressTable> ())
+{
+
+}
+
+uint32_t
+TLBTorRegistry::AddTor (uint32_t torId)
+{
+    uint32_t torIndex = m_torIndices.Find (torId);
+    if (torIndex == NONE)
+    {
+        torIndex = m_torIds.size ();
+        m_torIndices.Insert (torId, torIndex);
+        m_torIds.push_back (torId);
+        m_torSlots.push_back (std::vector<uint32_t> ());
+        NS_LOG_LOGIC ("Tor " << torId << " has index " << torIndex);
+    }
+    return torIndex;
+}
+
+uint32_t
+TLBTorRegistry::GetTorIndex (uint32_t torId) const
+{
+    return m_torIndices.Find (torId);
+}
+
+uint32_t
+TLBTorRegistry::GetTorId (uint32_t torIndex) const
+{
+    return m_torIds[torIndex];
+}
+
+uint32_t
+TLBTorRegistry::GetNTors (void) const
+{
+    return m_torIds.size ();
+}
+
+void
+TLBTorRegistry::AddAddress (Ipv4Address address, uint32_t torId)
+{
+    if (m_addresses->GetReferenceCount () > 1)
+    {
+        m_addresses = Create<AddressTable> (*m_addresses);
+    }
+    m_addresses->torIndices.Set (address.Get (), TLBTorRegistry::AddTor (torId));
+}
+
+uint32_t
+TLBTorRegistry::FindTor (Ipv4Address address) const
+{
+    return m_addresses->torIndices.Find (address.Get ());
+}
+
+uint64_t
+TLBTorRegistry::PathKey (uint32_t torIndex, uint32_t path)
+{
+    return (static_cast<uint64_t> (torIndex) << 32) | path;
+}
+
+uint32_t
+TLBTorRegistry::AddPath (uint32_t torIndex, uint32_t path)
+{
+    NS_ASSERT (torIndex < m_torIds.size ());
+    uint32_t slot = m_pathSlots.Find (PathKey (torIndex, path));
+    if (slot == NONE)
+    {
+        slot = m_slots.size ();
+        m_pathSlots.Insert (PathKey (torIndex, path), slot);
+        Slot newSlot;
+        newSlot.path = path;
+        newSlot.torIndex = torIndex;
+        newSlot.order = m_torSlots[torIndex].size ();
+        m_slots.push_back (newSlot);
+        m_torSlots[torIndex].push_back (slot);
+    }
+    return slot;
+}
+
+uint32_t
+TLBTorRegistry::FindPath (uint32_t torIndex, uint32_t path) const
+{
+    return m_pathSlots.Find (PathKey (torIndex, path));
+}
+
+uint32_t
+TLBTorRegistry::GetNSlots (void) const
+{
+    return m_slots.size ();
+}
+
+const std::vector<uint32_t> &
+TLBTorRegistry::GetSlots (uint32_t torIndex) const
+{
+    return m_torSlots[torIndex];
+}
+
+uint32_t
+TLBTorRegistry::GetPath (uint32_t slot) const
+{
+    return m_slots[slot].path;
+}
+
+uint32_t
+TLBTorRegistry::GetSlotTor (uint32_t slot) const
+{
+    return m_slots[slot].torIndex;
+}
+
+uint32_t
+TLBTorRegistry::GetSlotOrder (uint32_t slot) const
+{
+    return m_slots[slot].order;
+}
+
+}
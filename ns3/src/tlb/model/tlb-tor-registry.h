@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TLB_TOR_REGISTRY_H
+#define TLB_TOR_REGISTRY_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/index-map.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/ptr.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Dense indices for the ToRs known to an edge load balancer.
+ *
+ * ToRs get an index in the order they are first seen, and every path
+ * to a ToR a slot, numbered from 0 across all the ToRs, so that the per
+ * path state can be kept in vectors indexed by slot instead of maps
+ * keyed by <ToR, path>.  Host addresses, ToR ids and paths are resolved
+ * by IndexMaps.
+ *
+ * A registry built by TLBPathCatalog is shared by all the hosts under
+ * the same ToR, which do not change it.  The addresses are
+ * the same from every ToR, so the registries of all the ToRs share one
+ * address table, which a registry copies only when an address is added
+ * to it.
+ */
+class TLBTorRegistry : public SimpleRefCount<TLBTorRegistry>
+{
+public:
+
+    static const uint32_t NONE = IndexMap::NONE;
+
+    TLBTorRegistry ();
+
+    // Returns the index of the ToR, giving it one if it has none
+    uint32_t AddTor (uint32_t torId);
+
+    // Returns the index of the ToR or NONE
+    uint32_t GetTorIndex (uint32_t torId) const;
+
+    uint32_t GetTorId (uint32_t torIndex) const;
+
+    uint32_t GetNTors (void) const;
+
+    void AddAddress (Ipv4Address address, uint32_t torId);
+
+    // Returns the index of the ToR of the address or NONE
+    uint32_t FindTor (Ipv4Address address) const;
+
+    // Returns the slot of the path, giving it one if it has none
+    uint32_t AddPath (uint32_t torIndex, uint32_t path);
+
+    // Returns the slot of the path or NONE
+    uint32_t FindPath (uint32_t torIndex, uint32_t path) const;
+
+    uint32_t GetNSlots (void) const;
+
+    // The slots of the paths to the ToR, in the order they were added
+    const std::vector<uint32_t> &GetSlots (uint32_t torIndex) const;
+
+    uint32_t GetPath (uint32_t slot) const;
+
+    uint32_t GetSlotTor (uint32_t slot) const;
+
+    // The position of the slot among the slots of its ToR
+    uint32_t GetSlotOrder (uint32_t slot) const;
+
+private:
+
+    struct Slot
+    {
+        uint32_t path;
+        uint32_t torIndex;
+        uint32_t order;
+    };
+
+    struct AddressTable : public SimpleRefCount<AddressTable>
+    {
+        IndexMap torIndices; /* <Address, TorIndex> */
+    };
+
+    static uint64_t PathKey (uint32_t torIndex, uint32_t path);
+
+    IndexMap m_torIndices;  /* <TorId, TorIndex> */
+    IndexMap m_pathSlots;   /* <<TorIndex, Path>, Slot> */
+
+    // Shared by the copies of the registry
+    Ptr<AddressTable> m_addresses;
+
+    std::vector<uint32_t> m_torIds;
+    std::vector<std::vector<uint32_t> > m_torSlots;
+    std::vector<Slot> m_slots;
+};
+
+}
+
+#endif /* TLB_TOR_REGISTRY_H */
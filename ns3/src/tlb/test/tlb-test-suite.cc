@@ -2,10 +2,21 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-tlb.h"
+#include "ns3/ipv4-tlb-path-log.h"
+#include "ns3/tlb-path-scoreboard.h"
+#include "ns3/tlb-tor-registry.h"
+#include "ns3/tlb-path-catalog.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include <algorithm>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
@@ -46,6 +57,507 @@ TlbTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Checks that the path decisions reach the binary log, and that the
+// parallel paths are only gathered for connected sinks
+class TlbPathLogTestCase : public TestCase
+{
+public:
+  TlbPathLogTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void PathSelect (uint32_t flowId, uint32_t fromTor, uint32_t toTor, uint32_t path,
+                   bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths);
+
+  uint32_t m_nSelect;
+  uint32_t m_nParallelPaths;
+};
+
+TlbPathLogTestCase::TlbPathLogTestCase ()
+  : TestCase ("Tlb path decisions are written to the binary log"),
+    m_nSelect (0),
+    m_nParallelPaths (0)
+{
+}
+
+void
+TlbPathLogTestCase::PathSelect (uint32_t flowId, uint32_t fromTor, uint32_t toTor, uint32_t path,
+                                bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths)
+{
+  m_nSelect++;
+  m_nParallelPaths = parallelPaths.size ();
+}
+
+void
+TlbPathLogTestCase::DoRun (void)
+{
+  Ptr<Ipv4TLB> tlb = CreateObject<Ipv4TLB> ();
+  Ipv4Address src ("10.1.1.1");
+  Ipv4Address dst ("10.1.2.1");
+  tlb->AddAddressWithTor (src, 1);
+  tlb->AddAddressWithTor (dst, 2);
+  tlb->AddAvailPath (2, 7);
+  tlb->AddAvailPath (2, 9);
+
+  std::string filename = CreateTempDirFilename ("tlb-path-log.bin");
+  Ipv4TLBPathLog log;
+  NS_TEST_ASSERT_MSG_EQ (log.Open (filename), true, "Cannot open the path log");
+  log.Connect (tlb, 5);
+
+  uint32_t path = tlb->GetPath (100, src, dst);
+  NS_TEST_ASSERT_MSG_EQ ((path == 7 || path == 9), true, "The path should be one of the available paths");
+  NS_TEST_ASSERT_MSG_EQ (tlb->GetPath (100, src, dst), path, "An old flow should keep its path");
+
+  tlb->TraceConnectWithoutContext ("SelectPath", MakeCallback (&TlbPathLogTestCase::PathSelect, this));
+  tlb->GetPath (101, src, dst);
+  NS_TEST_ASSERT_MSG_EQ (m_nSelect, 1, "The select trace should fire once");
+  NS_TEST_ASSERT_MSG_EQ (m_nParallelPaths, 2, "The select trace should carry the parallel paths");
+
+  log.Close ();
+  NS_TEST_ASSERT_MSG_EQ (log.GetNDecisions (), 2, "Only the new flows make a decision");
+
+  std::vector<TLBPathDecision> decisions;
+  NS_TEST_ASSERT_MSG_EQ (Ipv4TLBPathLog::Read (filename, decisions), true, "Cannot read the path log back");
+  NS_TEST_ASSERT_MSG_EQ (decisions.size (), 2, "The log should hold every decision");
+  NS_TEST_ASSERT_MSG_EQ (decisions[0].node, 5, "Wrong node");
+  NS_TEST_ASSERT_MSG_EQ (decisions[0].flowId, 100, "Wrong flow id");
+  NS_TEST_ASSERT_MSG_EQ (decisions[0].fromTor, 1, "Wrong source tor");
+  NS_TEST_ASSERT_MSG_EQ (decisions[0].toTor, 2, "Wrong destination tor");
+  NS_TEST_ASSERT_MSG_EQ (decisions[0].newPath, path, "Wrong path");
+  NS_TEST_ASSERT_MSG_EQ (decisions[0].oldPath, path, "A new flow has no other path");
+  NS_TEST_ASSERT_MSG_EQ ((decisions[0].flags & Ipv4TLBPathLog::FLAG_NEW_FLOW), Ipv4TLBPathLog::FLAG_NEW_FLOW, "Should be a new flow");
+  NS_TEST_ASSERT_MSG_EQ (decisions[1].flowId, 101, "Wrong flow id");
+
+  Simulator::Destroy ();
+}
+
+// Checks the best paths of a type are the lowest ranked ones, in path order
+class TlbPathScoreboardTestCase : public TestCase
+{
+public:
+  TlbPathScoreboardTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbPathScoreboardTestCase::TlbPathScoreboardTestCase ()
+  : TestCase ("Tlb path scoreboard keeps the paths bucketed by type and rank")
+{
+}
+
+void
+TlbPathScoreboardTestCase::DoRun (void)
+{
+  TLBPathScoreboard scoreboard;
+  scoreboard.AddPath (10, GoodPath, 2, MicroSeconds (50));
+  scoreboard.AddPath (11, GoodPath, 1, MicroSeconds (70));
+  scoreboard.AddPath (12, GreyPath, 0, MicroSeconds (90));
+  scoreboard.AddPath (13, GoodPath, 1, MicroSeconds (40));
+  scoreboard.AddPath (14, FailPath, 5, MicroSeconds (40));
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.AddPath (15, BadPath, 0, MicroSeconds (40)), 5, "Wrong order of the last path");
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.GetNPaths (), 6, "Wrong number of paths");
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.GetNPaths (GoodPath), 3, "Wrong number of good paths");
+
+  uint64_t rank = 0;
+  uint32_t path = 0;
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.CountBest (GoodPath, Time::Max (), rank), 2, "Paths 11 and 13 share the lowest rank");
+  NS_TEST_ASSERT_MSG_EQ (rank, 1, "Wrong lowest rank");
+  scoreboard.GetBest (GoodPath, Time::Max (), 0, path);
+  NS_TEST_ASSERT_MSG_EQ (path, 11, "The best paths should be in path order");
+  scoreboard.GetBest (GoodPath, Time::Max (), 1, path);
+  NS_TEST_ASSERT_MSG_EQ (path, 13, "The best paths should be in path order");
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.GetBest (GoodPath, Time::Max (), 2, path), false, "Only two best paths");
+
+  // Path 11 is too slow, leaving path 13 alone at rank 1
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.CountBest (GoodPath, MicroSeconds (60), rank), 1, "The RTT bound should skip path 11");
+  scoreboard.GetBest (GoodPath, MicroSeconds (60), 0, path);
+  NS_TEST_ASSERT_MSG_EQ (path, 13, "Wrong best path under the RTT bound");
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.CountBest (GoodPath, MicroSeconds (30), rank), 0, "No path is that fast");
+
+  scoreboard.Update (3, BadPath, 1, MicroSeconds (40));
+  scoreboard.Update (0, FailPath, 2, MicroSeconds (50));
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.CountBest (GoodPath, Time::Max (), rank), 1, "Only path 11 is left good");
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.GetNPaths (FailPath), 2, "Paths 10 and 14 failed");
+
+  // The usable paths are 11, 12, 13 and 15
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.GetUsable (0), 11, "Wrong first usable path");
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.GetUsable (1), 12, "Wrong second usable path");
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.GetUsable (2), 13, "Wrong third usable path");
+  NS_TEST_ASSERT_MSG_EQ (scoreboard.GetUsable (3), 15, "Wrong fourth usable path");
+}
+
+// Checks the ToRs and their paths get dense indices, whatever their ids
+class TlbTorRegistryTestCase : public TestCase
+{
+public:
+  TlbTorRegistryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbTorRegistryTestCase::TlbTorRegistryTestCase ()
+  : TestCase ("Tlb tor registry gives dense tor indices and path slots")
+{
+}
+
+void
+TlbTorRegistryTestCase::DoRun (void)
+{
+  TLBTorRegistry registry;
+  NS_TEST_ASSERT_MSG_EQ (registry.AddTor (1000), 0, "Wrong index of the first tor");
+  NS_TEST_ASSERT_MSG_EQ (registry.AddTor (7), 1, "Wrong index of the second tor");
+  NS_TEST_ASSERT_MSG_EQ (registry.AddTor (1000), 0, "A tor should keep its index");
+  NS_TEST_ASSERT_MSG_EQ (registry.GetTorIndex (8), TLBTorRegistry::NONE, "Tor 8 is unknown");
+  NS_TEST_ASSERT_MSG_EQ (registry.GetTorId (1), 7, "Wrong id of the second tor");
+
+  // Enough addresses and paths to make the tables grow
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      registry.AddAddress (Ipv4Address (0x0a000000 + i), i % 2 ? 7 : 1000);
+    }
+  NS_TEST_ASSERT_MSG_EQ (registry.FindTor (Ipv4Address ("10.0.0.3")), 1, "Wrong tor of 10.0.0.3");
+  NS_TEST_ASSERT_MSG_EQ (registry.FindTor (Ipv4Address ("10.0.0.98")), 0, "Wrong tor of 10.0.0.98");
+  NS_TEST_ASSERT_MSG_EQ (registry.FindTor (Ipv4Address ("10.0.1.0")), TLBTorRegistry::NONE, "10.0.1.0 has no tor");
+  NS_TEST_ASSERT_MSG_EQ (registry.GetNTors (), 2, "Addresses should not add tors");
+
+  for (uint32_t path = 0; path < 50; ++path)
+    {
+      registry.AddPath (path % 2, 100 + path);
+    }
+  NS_TEST_ASSERT_MSG_EQ (registry.GetNSlots (), 50, "Wrong number of slots");
+  NS_TEST_ASSERT_MSG_EQ (registry.AddPath (1, 103), 3, "A path should keep its slot");
+  NS_TEST_ASSERT_MSG_EQ (registry.FindPath (0, 103), TLBTorRegistry::NONE, "Path 103 goes to tor 7 only");
+  uint32_t slot = registry.FindPath (1, 107);
+  NS_TEST_ASSERT_MSG_EQ (slot, 7, "Wrong slot of path 107");
+  NS_TEST_ASSERT_MSG_EQ (registry.GetPath (slot), 107, "Wrong path of the slot");
+  NS_TEST_ASSERT_MSG_EQ (registry.GetSlotTor (slot), 1, "Wrong tor of the slot");
+  NS_TEST_ASSERT_MSG_EQ (registry.GetSlotOrder (slot), 3, "Wrong order of the slot");
+  NS_TEST_ASSERT_MSG_EQ (registry.GetSlots (1).size (), 25, "Wrong number of paths to tor 7");
+  NS_TEST_ASSERT_MSG_EQ (registry.GetSlots (1)[3], slot, "The slots should be in the order of the paths");
+}
+
+static void
+Connect (Ptr<Node> a, Ptr<Node> b)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<SimpleNetDevice> deviceA = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> deviceB = CreateObject<SimpleNetDevice> ();
+  a->AddDevice (deviceA);
+  b->AddDevice (deviceB);
+  deviceA->SetChannel (channel);
+  deviceB->SetChannel (channel);
+}
+
+// Tor 10 with host 10.0.0.1 and tor 11 with host 10.0.0.2
+static Ptr<TLBPathCatalog>
+CreateTwoTorCatalog (void)
+{
+  // Two tors with a host each and two linked spines, port 0 stands for the loopback
+  Ptr<Node> tors[2];
+  Ptr<Node> spines[2];
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      tors[i] = CreateObject<Node> ();
+      spines[i] = CreateObject<Node> ();
+      spines[i]->AddDevice (CreateObject<SimpleNetDevice> ());
+      Connect (tors[i], CreateObject<Node> ());
+    }
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      for (uint32_t k = 0; k < 2; ++k)
+        {
+          // tor i port 1 + k to spine k, spine k port 1 + i to tor i
+          Connect (tors[i], spines[k]);
+        }
+    }
+  Connect (spines[0], spines[1]);
+
+  Ptr<TLBPathCatalog> catalog = Create<TLBPathCatalog> ();
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      catalog->AddTor (10 + i, tors[i]);
+      catalog->AddSwitch (spines[i]);
+      catalog->AddAddress (Ipv4Address (0x0a000001 + i), 10 + i);
+    }
+  catalog->Build ();
+  return catalog;
+}
+
+class TlbPathCatalogTestCase : public TestCase
+{
+public:
+  TlbPathCatalogTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbPathCatalogTestCase::TlbPathCatalogTestCase ()
+  : TestCase ("Tlb path catalog enumerates the paths between the tors once")
+{
+}
+
+void
+TlbPathCatalogTestCase::DoRun (void)
+{
+  Ptr<TLBPathCatalog> catalog = CreateTwoTorCatalog ();
+  std::vector<uint32_t> paths = catalog->GetPaths (10, 11);
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 2, "Only the paths through one spine are the shortest");
+  NS_TEST_ASSERT_MSG_EQ (paths[0], 1, "Wrong path through the first spine");
+  NS_TEST_ASSERT_MSG_EQ (paths[1], 2, "Wrong path through the second spine");
+  NS_TEST_ASSERT_MSG_EQ (catalog->GetPaths (11, 10)[1], 4, "Wrong path back through the second spine");
+  uint32_t nPorts = 0;
+  const uint32_t *route = catalog->GetRoute (paths[1], nPorts);
+  NS_TEST_ASSERT_MSG_EQ (nPorts, 2, "Wrong number of hops");
+  NS_TEST_ASSERT_MSG_EQ ((route[0] == 2 && route[1] == 2), true, "Wrong ports of the route");
+  route = catalog->GetRoute (4, nPorts);
+  NS_TEST_ASSERT_MSG_EQ ((nPorts == 2 && route[0] == 2 && route[1] == 1), true, "Wrong ports of the route back");
+  NS_TEST_ASSERT_MSG_EQ (catalog->GetRoute (0, nPorts), 0, "Path 0 should have no route");
+  NS_TEST_ASSERT_MSG_EQ (catalog->GetRoute (5, nPorts), 0, "A path out of the catalog should have no route");
+
+  Ptr<TLBTorRegistry> registry = catalog->GetRegistry (10);
+  NS_TEST_ASSERT_MSG_EQ (registry->GetTorId (registry->FindTor (Ipv4Address ("10.0.0.2"))), 11, "Wrong tor of 10.0.0.2");
+
+  // The registries share their addresses, a registry adding one copies them
+  Ptr<TLBTorRegistry> other = catalog->GetRegistry (11);
+  NS_TEST_ASSERT_MSG_EQ (other->GetTorId (other->FindTor (Ipv4Address ("10.0.0.1"))), 10, "Wrong tor of 10.0.0.1");
+  Ptr<TLBTorRegistry> copy = Create<TLBTorRegistry> (*other);
+  copy->AddAddress (Ipv4Address ("10.0.0.3"), 10);
+  NS_TEST_ASSERT_MSG_EQ (copy->GetTorId (copy->FindTor (Ipv4Address ("10.0.0.3"))), 10, "The address should be added");
+  NS_TEST_ASSERT_MSG_EQ (copy->GetTorId (copy->FindTor (Ipv4Address ("10.0.0.2"))), 11, "The copy should keep the addresses");
+  NS_TEST_ASSERT_MSG_EQ (other->FindTor (Ipv4Address ("10.0.0.3")), TLBTorRegistry::NONE, "The registry copied should not get the address");
+  NS_TEST_ASSERT_MSG_EQ (registry->FindTor (Ipv4Address ("10.0.0.3")), TLBTorRegistry::NONE, "The other registries should not get the address");
+
+  // The hosts under a tor share its registry
+  Ptr<Ipv4TLB> tlbA = CreateObject<Ipv4TLB> ();
+  Ptr<Ipv4TLB> tlbB = CreateObject<Ipv4TLB> ();
+  tlbA->UsePathCatalog (catalog, 10);
+  tlbB->UsePathCatalog (catalog, 10);
+  NS_TEST_ASSERT_MSG_EQ (registry->GetReferenceCount (), 4, "The registry should be shared");
+  NS_TEST_ASSERT_MSG_EQ (tlbA->GetAvailPath (Ipv4Address ("10.0.0.2")).size (), 2, "Wrong number of available paths");
+  NS_TEST_ASSERT_MSG_EQ (tlbB->GetAvailPath (Ipv4Address ("10.0.0.2")).size (), 2, "Wrong number of available paths");
+
+  // One hop longer, the paths through both spines
+  catalog->SetExtraHops (1);
+  catalog->SetMaxPaths (3);
+  catalog->Build ();
+  paths = catalog->GetPaths (10, 11);
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 3, "The paths should be limited");
+  NS_TEST_ASSERT_MSG_EQ (paths[1], 2, "The shortest paths should come first");
+  route = catalog->GetRoute (paths[2], nPorts);
+  NS_TEST_ASSERT_MSG_EQ (nPorts, 3, "The longer path should have one more hop");
+  NS_TEST_ASSERT_MSG_EQ ((route[0] == 1 && route[1] == 3 && route[2] == 2), true, "Wrong path through both spines");
+
+  Simulator::Destroy ();
+}
+
+class TlbRackStateTestCase : public TestCase
+{
+public:
+  TlbRackStateTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbRackStateTestCase::TlbRackStateTestCase ()
+  : TestCase ("Tlb hosts under a tor share the flow counters of their paths")
+{
+}
+
+void
+TlbRackStateTestCase::DoRun (void)
+{
+  Ptr<TLBPathCatalog> catalog = CreateTwoTorCatalog ();
+  Ipv4Address source ("10.0.0.1");
+  Ipv4Address dest ("10.0.0.2");
+
+  Ptr<Ipv4TLB> hosts[2];
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      hosts[i] = CreateObject<Ipv4TLB> ();
+      hosts[i]->SetAttribute ("RunMode", UintegerValue (TLB_RUNMODE_COUNTER));
+      hosts[i]->UsePathCatalog (catalog, 10);
+      hosts[i]->AssignStreams (i);
+    }
+  hosts[1]->ShareRackState (hosts[0]);
+
+  // Sharing, the second host sees the flow of the first one and takes the other path
+  uint32_t first = hosts[0]->GetPath (1, source, dest);
+  uint32_t second = hosts[1]->GetPath (2, source, dest);
+  NS_TEST_ASSERT_MSG_NE (first, second, "The shared flow counter should steer the second flow away");
+
+  NS_TEST_ASSERT_MSG_EQ (hosts[1]->GetAvailPath (dest).size (), 2, "The hosts should keep the paths of the catalog");
+  NS_TEST_ASSERT_MSG_EQ (hosts[1]->IsRackStateSharedWith (hosts[0]), true, "The hosts should share their path state");
+
+  // The data ACKs of one host mark the path for both, the probes do not
+  Time ackTime;
+  NS_TEST_ASSERT_MSG_EQ (hosts[1]->GetLastAckTime (dest, first, ackTime), false, "No ACK should have been seen yet");
+  hosts[0]->ProbeRecv (first, dest, 64, false, MicroSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (hosts[1]->GetLastAckTime (dest, first, ackTime), false, "A probe is not a data ACK");
+  hosts[0]->FlowRecv (1, first, dest, 1500, false, MicroSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (hosts[1]->GetLastAckTime (dest, first, ackTime), true, "The ACK should mark the path");
+  NS_TEST_ASSERT_MSG_EQ (hosts[1]->GetLastAckTime (dest, second, ackTime), false, "The other path carried no ACK");
+
+  // Once the flow of the first host finishes, its path is the least loaded for both
+  hosts[0]->FlowFinish (1, dest);
+  NS_TEST_ASSERT_MSG_EQ (hosts[1]->GetPath (3, source, dest), first, "The finished flow should free its path");
+
+  // With a rack state delay, the ACK time arrives with the rest of the path state
+  Ptr<Ipv4TLB> delayed = CreateObject<Ipv4TLB> ();
+  delayed->SetAttribute ("RackStateDelay", TimeValue (MicroSeconds (20)));
+  delayed->UsePathCatalog (catalog, 10);
+  uint32_t path = delayed->GetPath (1, source, dest);
+  delayed->FlowRecv (1, path, dest, 1500, false, MicroSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (delayed->GetLastAckTime (dest, path, ackTime), false, "The ACK time should wait for the rack state delay");
+  Simulator::Stop (MicroSeconds (20));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (delayed->GetLastAckTime (dest, path, ackTime), true, "The delayed ACK should mark the path");
+  NS_TEST_ASSERT_MSG_EQ (ackTime, MicroSeconds (20), "The path should be marked when the path state learns of the ACK");
+
+  Simulator::Destroy ();
+}
+
+// The same stream number gives the same paths to a sequence of new flows,
+// another stream number other paths
+class TlbStreamTestCase : public TestCase
+{
+public:
+  TlbStreamTestCase ();
+
+private:
+  virtual void DoRun (void);
+  std::vector<uint32_t> SelectPaths (int64_t stream);
+};
+
+TlbStreamTestCase::TlbStreamTestCase ()
+  : TestCase ("Tlb path choices are reproducible per random stream")
+{
+}
+
+std::vector<uint32_t>
+TlbStreamTestCase::SelectPaths (int64_t stream)
+{
+  Ptr<Ipv4TLB> tlb = CreateObject<Ipv4TLB> ();
+  Ipv4Address src ("10.1.1.1");
+  Ipv4Address dst ("10.1.2.1");
+  tlb->AddAddressWithTor (src, 1);
+  tlb->AddAddressWithTor (dst, 2);
+  for (uint32_t path = 1; path <= 8; ++path)
+    {
+      tlb->AddAvailPath (2, path);
+    }
+  NS_TEST_EXPECT_MSG_EQ (tlb->AssignStreams (stream), 1, "Tlb should use one stream");
+
+  // Without any feedback all the paths tie, the random draw breaks the tie
+  std::vector<uint32_t> paths;
+  for (uint32_t flowId = 0; flowId < 32; ++flowId)
+    {
+      paths.push_back (tlb->GetPath (flowId, src, dst));
+    }
+  return paths;
+}
+
+void
+TlbStreamTestCase::DoRun (void)
+{
+  std::vector<uint32_t> first = SelectPaths (7);
+  std::vector<uint32_t> again = SelectPaths (7);
+  std::vector<uint32_t> other = SelectPaths (8);
+
+  NS_TEST_ASSERT_MSG_EQ ((first == again), true, "The same stream should give the same paths");
+  NS_TEST_ASSERT_MSG_EQ ((first == other), false, "Another stream should give other paths");
+  std::sort (first.begin (), first.end ());
+  NS_TEST_ASSERT_MSG_GT (std::unique (first.begin (), first.end ()) - first.begin (), 1, "The paths should be drawn among the ties");
+
+  Simulator::Destroy ();
+}
+
+// A probe timeout marks the path it timed out on, at once or after the
+// rack state delay
+class TlbProbeTimeoutTestCase : public TestCase
+{
+public:
+  TlbProbeTimeoutTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void PathSelect (uint32_t flowId, uint32_t fromTor, uint32_t toTor, uint32_t path,
+                   bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths);
+  // The type of the path as seen by the next new flow, which is given *selected
+  PathType GetPathType (Ptr<Ipv4TLB> tlb, uint32_t path, uint32_t *selected);
+
+  std::vector<PathInfo> m_parallelPaths;
+  uint32_t m_flowId;
+};
+
+TlbProbeTimeoutTestCase::TlbProbeTimeoutTestCase ()
+  : TestCase ("Tlb probe timeouts mark their path as failed"),
+    m_flowId (0)
+{
+}
+
+void
+TlbProbeTimeoutTestCase::PathSelect (uint32_t flowId, uint32_t fromTor, uint32_t toTor, uint32_t path,
+                                     bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths)
+{
+  m_parallelPaths = parallelPaths;
+}
+
+PathType
+TlbProbeTimeoutTestCase::GetPathType (Ptr<Ipv4TLB> tlb, uint32_t path, uint32_t *selected)
+{
+  m_parallelPaths.clear ();
+  *selected = tlb->GetPath (m_flowId++, Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.0.2"));
+  for (uint32_t i = 0; i < m_parallelPaths.size (); ++i)
+    {
+      if (m_parallelPaths[i].pathId == path)
+        {
+          return m_parallelPaths[i].pathType;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (true, false, "Path " << path << " is not among the parallel paths");
+  return GoodPath;
+}
+
+void
+TlbProbeTimeoutTestCase::DoRun (void)
+{
+  Ptr<TLBPathCatalog> catalog = CreateTwoTorCatalog ();
+  Ipv4Address dest ("10.0.0.2");
+  std::vector<uint32_t> paths = catalog->GetPaths (10, 11);
+  uint32_t selected;
+
+  for (uint32_t delay = 0; delay <= 20; delay += 20)
+    {
+      Ptr<Ipv4TLB> tlb = CreateObject<Ipv4TLB> ();
+      tlb->SetAttribute ("RackStateDelay", TimeValue (MicroSeconds (delay)));
+      tlb->UsePathCatalog (catalog, 10);
+      tlb->TraceConnectWithoutContext ("SelectPath", MakeCallback (&TlbProbeTimeoutTestCase::PathSelect, this));
+
+      // Both paths answer their probes quickly
+      tlb->ProbeRecv (paths[0], dest, 64, false, MicroSeconds (10));
+      tlb->ProbeRecv (paths[1], dest, 64, false, MicroSeconds (10));
+      Simulator::Run ();
+      NS_TEST_ASSERT_MSG_EQ (GetPathType (tlb, paths[0], &selected), GoodPath, "A path answering its probes should be good");
+
+      tlb->ProbeTimeout (paths[0], dest);
+      if (delay > 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (GetPathType (tlb, paths[0], &selected), GoodPath, "The timeout should wait for the rack state delay");
+          Simulator::Stop (MicroSeconds (delay));
+          Simulator::Run ();
+        }
+      NS_TEST_ASSERT_MSG_EQ (GetPathType (tlb, paths[0], &selected), FailPath, "The probe timeout should fail the path, delay " << delay);
+      NS_TEST_ASSERT_MSG_EQ (selected, paths[1], "A new flow should avoid the failed path");
+      NS_TEST_ASSERT_MSG_EQ (GetPathType (tlb, paths[1], &selected), GoodPath, "The other path should stay good");
+
+      Simulator::Destroy ();
+    }
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +573,13 @@ TlbTestSuite::TlbTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new TlbTestCase1, TestCase::QUICK);
+  AddTestCase (new TlbPathLogTestCase, TestCase::QUICK);
+  AddTestCase (new TlbPathScoreboardTestCase, TestCase::QUICK);
+  AddTestCase (new TlbTorRegistryTestCase, TestCase::QUICK);
+  AddTestCase (new TlbPathCatalogTestCase, TestCase::QUICK);
+  AddTestCase (new TlbRackStateTestCase, TestCase::QUICK);
+  AddTestCase (new TlbStreamTestCase, TestCase::QUICK);
+  AddTestCase (new TlbProbeTimeoutTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -69,7 +69,7 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   }
 
   Ipv4XPathTag ipv4XPathTag;
-  bool found = packet->RemovePacketTag (ipv4XPathTag);
+  bool found = packet->PeekPacketTag (ipv4XPathTag);
   if (!found)
   {
     NS_LOG_ERROR (this << " Cannot perform XPath routing without knowing the Path ID");
@@ -77,20 +77,14 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     return false;
   }
 
-  uint32_t pathId = ipv4XPathTag.GetPathId ();
-
-  if (pathId == 0)
+  if (ipv4XPathTag.IsRouteDone ())
   {
     NS_LOG_LOGIC (this << " Reaching final hop, XPath will not handle the final hop");
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
     return false;
   }
 
-  uint32_t currentPort = pathId - (pathId / 100) * 100;
-
-  // NS_LOG_LOGIC (this << " Current port is: " << currentPort);
-
-  // std::cout << "Path: " << pathId << ", Current Port: " << currentPort << std::endl;
+  uint32_t currentPort = ipv4XPathTag.GetCurrentPort ();
 
   if (currentPort > m_ipv4->GetNInterfaces ())
   {
@@ -101,20 +95,11 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
 
   NS_LOG_LOGIC (this << " Forwarding packet: " << packet << " to port: " << currentPort);
 
-  ipv4XPathTag.SetPathId (pathId / 100);
-  packet->AddPacketTag (ipv4XPathTag);
-
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (currentPort);
-  Ptr<Channel> channel = dev->GetChannel ();
-  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-  Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-  uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-  Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4>()->GetAddress (nextIf, 0).GetLocal ();
-  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (m_ipv4->GetNetDevice (currentPort));
-  route->SetGateway (nextHopAddr);
-  route->SetSource (m_ipv4->GetAddress (currentPort, 0).GetLocal ());
-  route->SetDestination (destAddress);
+  // The tag keeps its size, it is rewritten where it lies
+  ipv4XPathTag.NextHop ();
+  packet->ReplacePacketTag (ipv4XPathTag);
+
+  Ptr<Ipv4Route> route = m_routeCache->GetRoute (currentPort, destAddress);
 
   ucb (route, packet, header);
 
@@ -130,13 +115,19 @@ Ipv4XPathRouting::NotifyInterfaceUp (uint32_t interface)
 void
 Ipv4XPathRouting::NotifyInterfaceDown (uint32_t interface)
 {
-
+  if (m_routeCache != 0)
+    {
+      m_routeCache->Invalidate (interface);
+    }
 }
 
 void
 Ipv4XPathRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-
+  if (m_routeCache != 0)
+    {
+      m_routeCache->Invalidate (interface);
+    }
 }
 
 void
@@ -151,6 +142,7 @@ Ipv4XPathRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_LOGIC (this << "Setting up Ipv4: " << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  m_routeCache = Ipv4RouteCache::GetRouteCache (ipv4);
 }
 
 void
@@ -162,6 +154,7 @@ Ipv4XPathRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 void
 Ipv4XPathRouting::DoDispose (void)
 {
+  m_routeCache = 0;
   m_ipv4 = 0;
   Ipv4RoutingProtocol::DoDispose ();
 }
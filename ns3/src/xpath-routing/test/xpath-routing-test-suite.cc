@@ -2,6 +2,10 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-xpath-routing.h"
+#include "ns3/ipv4-xpath-tag.h"
+#include "ns3/packet.h"
+
+#include <vector>
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +50,79 @@ XpathRoutingTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// The route of the tag survives the packet tag list and is walked hop by hop
+class XpathTagTestCase : public TestCase
+{
+public:
+  XpathTagTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+XpathTagTestCase::XpathTagTestCase ()
+  : TestCase ("Ipv4XPathTag packs long routes and keeps the path id encoding")
+{
+}
+
+void
+XpathTagTestCase::DoRun (void)
+{
+  // The former base-100 path ids, lowest digits first
+  Ptr<Packet> packet = Create<Packet> (100);
+  Ipv4XPathTag tag;
+  tag.SetPathId (30201);
+  packet->AddPacketTag (tag);
+
+  uint32_t ports[] = {1, 2, 3};
+  for (uint32_t hop = 0; hop < 3; ++hop)
+    {
+      Ipv4XPathTag hopTag;
+      NS_TEST_ASSERT_MSG_EQ (packet->PeekPacketTag (hopTag), true, "The packet should keep its tag");
+      NS_TEST_ASSERT_MSG_EQ (hopTag.IsRouteDone (), false, "The route should not be done at hop " << hop);
+      NS_TEST_ASSERT_MSG_EQ (hopTag.GetCurrentPort (), ports[hop], "Wrong port at hop " << hop);
+      hopTag.NextHop ();
+      packet->ReplacePacketTag (hopTag);
+    }
+  Ipv4XPathTag lastTag;
+  packet->PeekPacketTag (lastTag);
+  NS_TEST_ASSERT_MSG_EQ (lastTag.IsRouteDone (), true, "The route should be done after 3 hops");
+  NS_TEST_ASSERT_MSG_EQ (lastTag.GetPathId (), 0, "A done route has path id 0");
+
+  Ipv4XPathTag legacyTag;
+  legacyTag.SetPathId (4294967295u);
+  NS_TEST_ASSERT_MSG_EQ (legacyTag.GetNHops (), 5, "A path id has up to 5 hops");
+  NS_TEST_ASSERT_MSG_EQ (legacyTag.GetPathId (), 4294967295u, "The path id should be kept");
+
+  // Ports of 9 bits over 12 hops, the eighth straddling the two words of the route
+  std::vector<uint32_t> route;
+  for (uint32_t hop = 0; hop < 12; ++hop)
+    {
+      route.push_back (511 - hop * 37);
+    }
+  Ipv4XPathTag longTag;
+  NS_TEST_ASSERT_MSG_EQ (longTag.SetRoute (route), true, "12 hops of 9 bits should fit");
+  NS_TEST_ASSERT_MSG_EQ (longTag.GetSerializedSize (), 3 + 14, "The ports should be bit packed");
+
+  Ptr<Packet> longPacket = Create<Packet> (100);
+  longPacket->AddPacketTag (longTag);
+  Ipv4XPathTag readTag;
+  longPacket->PeekPacketTag (readTag);
+  NS_TEST_ASSERT_MSG_EQ (readTag.GetNHops (), 12, "The hops should survive the serialization");
+  for (uint32_t hop = 0; hop < 12; ++hop)
+    {
+      NS_TEST_ASSERT_MSG_EQ (readTag.GetPort (hop), route[hop], "Wrong port at hop " << hop);
+    }
+
+  // 8 hops of 16 bits is the most for ports above 255
+  route.assign (8, 65535);
+  NS_TEST_ASSERT_MSG_EQ (longTag.SetRoute (route), true, "8 hops of 16 bits should fit");
+  NS_TEST_ASSERT_MSG_EQ (longTag.GetPort (7), 65535, "The last port should be read back");
+  route.push_back (256);
+  NS_TEST_ASSERT_MSG_EQ (longTag.SetRoute (route), false, "9 hops of 16 bits should not fit");
+  NS_TEST_ASSERT_MSG_EQ (longTag.GetNHops (), 0, "A route that does not fit leaves the tag empty");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +138,7 @@ XpathRoutingTestSuite::XpathRoutingTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new XpathRoutingTestCase1, TestCase::QUICK);
+  AddTestCase (new XpathTagTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite